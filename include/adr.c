@@ -0,0 +1,316 @@
+#include "adr.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "config.h"
+#include "seqlock.h"
+#include "caminho_quente.h"
+
+/**
+ * @brief Parâmetros de um perfil de modem, em quartos de dB.
+ */
+typedef struct {
+    int16_t ruido_x4;   // 10·log10(largura de banda em Hz)
+    int16_t piso_x4;    // SNR mínima de demodulação do SF (datasheet do SX1276, tabela 13)
+    uint8_t posicao;    // 0 = mais rápido
+} adr_perfil_t;
+
+static const adr_perfil_t TABELA_QUENTE("adr_perfis") _perfis[] = {
+    [BW125_CR45_SF128]   = { 204, -30, 1 },  // 125 kHz, SF7
+    [BW500_CR45_SF128]   = { 228, -30, 0 },  // 500 kHz, SF7
+    [BW31_25_CR48_SF512] = { 180, -50, 2 },  // 31,25 kHz, SF9
+    [BW125_CR48_SF4096]  = { 204, -80, 3 },  // 125 kHz, SF12
+};
+#define NUM_PERFIS (sizeof(_perfis) / sizeof(_perfis[0]))
+
+// Do mais rápido ao mais robusto (tempo de símbolo 2^SF / BW)
+static const uint8_t TABELA_QUENTE("adr_ordem") _ordem[NUM_PERFIS] = {
+    BW500_CR45_SF128, BW125_CR45_SF128, BW31_25_CR48_SF512, BW125_CR48_SF4096
+};
+
+static const char *const _nomes[NUM_PERFIS] = {
+    [BW125_CR45_SF128]   = "125k/SF7",
+    [BW500_CR45_SF128]   = "500k/SF7",
+    [BW31_25_CR48_SF512] = "31k/SF9",
+    [BW125_CR48_SF4096]  = "125k/SF12",
+};
+
+/**
+ * @brief Entrada da tabela, publicada pela ISR através de um seqlock.
+ */
+typedef struct {
+    seqlock_t lock;
+    adr_no_t s;
+} adr_entrada_t;
+
+static adr_entrada_t _tabela[MAX_NOS];
+static volatile uint8_t _num_nos = 0;
+
+// Perfis escutados na frequência de cada rádio (bit = modem_config_t)
+static uint8_t _escutados[LORA_MAX_RADIOS];
+
+static uint32_t _acks_estendidos = 0;
+
+// ============================================================================
+// --- Decisão (contexto de ISR: apenas inteiros) ---
+// ============================================================================
+
+/**
+ * @brief Folga de (perfil, potencia) sobre o piso mais a margem, estimada a
+ *        partir da SNR medida no perfil `ouvido` com a potência `atual`.
+ */
+static int32_t CAMINHO_QUENTE(folga)(int32_t snr_x4, uint8_t ouvido, uint8_t atual, uint8_t perfil, uint8_t potencia) {
+    return snr_x4 + _perfis[ouvido].ruido_x4 - _perfis[perfil].ruido_x4 + 4 * ((int32_t)potencia - atual)
+           - _perfis[perfil].piso_x4 - 4 * ADR_MARGEM_DB;
+}
+
+/**
+ * @brief Perfil mais rápido da máscara que mantém `reserva_x4` de folga na
+ *        potência máxima (ou o mais robusto, se nenhum), e a menor potência
+ *        que ainda a mantém.
+ */
+static void CAMINHO_QUENTE(escolher)(int32_t snr_x4, uint8_t ouvido, uint8_t atual, uint8_t mascara,
+                                     int32_t reserva_x4, uint8_t *perfil, uint8_t *potencia) {
+    uint8_t escolhido = ouvido;
+    int32_t f = folga(snr_x4, ouvido, atual, ouvido, ADR_POTENCIA_MAX) - reserva_x4;
+    for (uint8_t i = 0; i < NUM_PERFIS; ++i) {
+        uint8_t p = _ordem[i];
+        if (!(mascara & (1u << p))) {
+            continue;
+        }
+        escolhido = p;
+        f = folga(snr_x4, ouvido, atual, p, ADR_POTENCIA_MAX) - reserva_x4;
+        if (f >= 0) {
+            break;
+        }
+    }
+    int32_t dbm = ADR_POTENCIA_MAX - (f > 0 ? f / 4 : 0);
+    *perfil = escolhido;
+    *potencia = dbm < ADR_POTENCIA_MIN ? ADR_POTENCIA_MIN : dbm;
+}
+
+/**
+ * @brief Ordem de preferência: perfil mais rápido, depois menor potência.
+ */
+static inline bool melhor(uint8_t perfil_a, uint8_t potencia_a, uint8_t perfil_b, uint8_t potencia_b) {
+    if (perfil_a != perfil_b) {
+        return _perfis[perfil_a].posicao < _perfis[perfil_b].posicao;
+    }
+    return potencia_a < potencia_b;
+}
+
+static void CAMINHO_QUENTE(trocar)(adr_no_t *s, uint8_t perfil, uint8_t potencia) {
+    if (melhor(perfil, potencia, s->modem, s->tx_power)) {
+        s->melhoras++;
+    } else {
+        s->pioras++;
+    }
+    s->modem = perfil;
+    s->tx_power = potencia;
+    s->amostras = 0;
+    s->confirmacoes = 0;
+}
+
+static void CAMINHO_QUENTE(avaliar)(adr_no_t *s, uint8_t mascara) {
+    int32_t snr_x4 = s->snr_ewma_q8 / 256;
+    int32_t atual = folga(snr_x4, s->modem, s->tx_power, s->modem, s->tx_power);
+    s->folga_x4 = atual;
+
+    uint8_t perfil, potencia;
+    if (atual < 0) {
+        // Abaixo da margem: vai direto para a configuração que a recupera
+        escolher(snr_x4, s->modem, s->tx_power, mascara, 0, &perfil, &potencia);
+        if (perfil != s->modem || potencia != s->tx_power) {
+            trocar(s, perfil, potencia);
+        }
+        return;
+    }
+    escolher(snr_x4, s->modem, s->tx_power, mascara, 4 * ADR_HISTERESE_DB, &perfil, &potencia);
+    if (!melhor(perfil, potencia, s->modem, s->tx_power)) {
+        s->confirmacoes = 0;
+    } else if (++s->confirmacoes >= ADR_CONFIRMACOES) {
+        trocar(s, perfil, potencia);
+    }
+}
+
+static adr_entrada_t *CAMINHO_QUENTE(entrada)(uint8_t remetente, bool *nova) {
+    for (uint8_t i = 0; i < _num_nos; ++i) {
+        if (_tabela[i].s.endereco == remetente) {
+            *nova = false;
+            return &_tabela[i];
+        }
+    }
+    *nova = true;
+    if (_num_nos < MAX_NOS) {
+        return &_tabela[_num_nos];
+    }
+    // Tabela cheia: reaproveita o transmissor ouvido há mais tempo
+    adr_entrada_t *e = &_tabela[0];
+    for (uint8_t i = 1; i < MAX_NOS; ++i) {
+        if (_tabela[i].s.ultimo_us < e->s.ultimo_us) {
+            e = &_tabela[i];
+        }
+    }
+    return e;
+}
+
+// ============================================================================
+// --- API ---
+// ============================================================================
+
+void adr_init(const lora_radio_t *radios, uint8_t num_radios) {
+    memset(_tabela, 0, sizeof(_tabela));
+    _num_nos = 0;
+    _acks_estendidos = 0;
+    memset(_escutados, 0, sizeof(_escutados));
+    for (uint8_t i = 0; i < num_radios; ++i) {
+        for (uint8_t j = 0; j < num_radios; ++j) {
+            if (radios[j].config.freq == radios[i].config.freq) {
+                _escutados[radios[i].index] |= 1u << radios[j].config.modem;
+            }
+        }
+    }
+}
+
+uint8_t CAMINHO_QUENTE(adr_ack)(const lora_radio_t *radio, const lora_payload_t *pacote, uint8_t *extra) {
+    uint8_t ouvido = radio->config.modem;
+    bool nova;
+    adr_entrada_t *e = entrada(pacote->header_from, &nova);
+
+    seqlock_write_begin(&e->lock);
+
+    adr_no_t *s = &e->s;
+    if (nova) {
+        memset(s, 0, sizeof(*s));
+        s->endereco = pacote->header_from;
+        s->modem = ouvido;
+        s->tx_power = ADR_POTENCIA_MAX;
+    }
+    s->pacotes++;
+    s->ultimo_us = pacote->rx_timestamp_us;
+
+    bool amostrar = true;
+    if (ouvido != s->modem) {
+        if (_perfis[ouvido].posicao > _perfis[s->modem].posicao) {
+            // Mais lento que o recomendado: o transmissor não está lá
+            trocar(s, ouvido, ADR_POTENCIA_MAX);
+            s->divergentes = 0;
+        } else if (++s->divergentes >= ADR_AMOSTRAS_MIN) {
+            s->ignoradas++;
+            s->modem = ouvido;
+            s->tx_power = ADR_POTENCIA_MAX;
+            s->amostras = 0;
+            s->confirmacoes = 0;
+            s->divergentes = 0;
+        } else {
+            amostrar = false; // SNR de outro perfil: não entra na estimativa
+        }
+    } else {
+        s->divergentes = 0;
+    }
+
+    if (amostrar) {
+        int32_t snr_q8 = (int32_t)pacote->snr_x4 * 256;
+        if (s->amostras == 0) {
+            s->snr_ewma_q8 = snr_q8;
+        } else {
+            s->snr_ewma_q8 += (snr_q8 - s->snr_ewma_q8) / (1 << ADR_EWMA_SHIFT);
+        }
+        if (s->amostras < UINT16_MAX) {
+            s->amostras++;
+        }
+        if (s->amostras >= ADR_AMOSTRAS_MIN) {
+            avaliar(s, _escutados[radio->index] | (1u << ouvido));
+        }
+    }
+
+    int32_t folga_x4 = s->folga_x4;
+    extra[0] = ADR_ACK_TIPO;
+    extra[1] = s->modem;
+    extra[2] = s->tx_power;
+    extra[3] = (uint8_t)(int8_t)(folga_x4 > INT8_MAX ? INT8_MAX : folga_x4 < INT8_MIN ? INT8_MIN : folga_x4);
+
+    seqlock_write_end(&e->lock);
+
+    if (nova && _num_nos < MAX_NOS) {
+        _num_nos++; // Só depois da entrada pronta
+    }
+    _acks_estendidos++;
+    return 4;
+}
+
+bool adr_ler_ack(const lora_payload_t *ack, adr_recomendacao_t *r) {
+    if (!(ack->header_flags & FLAGS_ACK) || (ack->header_flags & FLAGS_FRAGMENT) || ack->length < 4 || ack->message[0] != ADR_ACK_TIPO) {
+        return false;
+    }
+    if (ack->message[1] >= NUM_PERFIS || ack->message[2] < ADR_POTENCIA_MIN || ack->message[2] > 23) {
+        return false;
+    }
+    r->modem = (modem_config_t)ack->message[1];
+    r->tx_power = ack->message[2];
+    r->folga_x4 = (int8_t)ack->message[3];
+    return true;
+}
+
+void adr_transmissor_init(adr_transmissor_t *t, const lora_radio_t *radio) {
+    memset(t, 0, sizeof(*t));
+    t->modem_inicial = radio->config.modem;
+    t->tx_power_inicial = radio->config.tx_power;
+}
+
+bool adr_transmissor_resultado(adr_transmissor_t *t, lora_radio_t *radio, bool ack_ok) {
+    modem_config_t modem;
+    uint8_t tx_power;
+    if (ack_ok) {
+        adr_recomendacao_t r;
+        t->falhas = 0;
+        if (!adr_ler_ack(&radio->last_ack_payload, &r)) {
+            return false;
+        }
+        modem = r.modem;
+        tx_power = r.tx_power;
+    } else {
+        if (++t->falhas < ADR_RECUO_SEM_ACK) {
+            return false;
+        }
+        t->falhas = 0;
+        modem = t->modem_inicial;
+        tx_power = t->tx_power_inicial;
+    }
+    if (modem == radio->config.modem && tx_power == radio->config.tx_power) {
+        return false;
+    }
+    lora_reconfigure(radio, modem, tx_power);
+    if (ack_ok) {
+        t->trocas++;
+    } else {
+        t->recuos++;
+    }
+    return true;
+}
+
+bool adr_copiar(uint8_t indice, adr_no_t *copia) {
+    if (indice >= _num_nos) {
+        return false;
+    }
+    const adr_entrada_t *e = &_tabela[indice];
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&e->lock);
+        *copia = e->s;
+    } while (seqlock_read_retry(&e->lock, seq));
+    return true;
+}
+
+void adr_imprimir(void) {
+    adr_no_t s;
+    printf("ADR: %lu ACKs estendidos, margem %d dB, histerese %d dB\n",
+           (unsigned long)_acks_estendidos, ADR_MARGEM_DB, ADR_HISTERESE_DB);
+    printf("No  pacotes  perfil     dBm  SNR    folga | melhoras pioras ignoradas\n");
+    for (uint8_t i = 0; adr_copiar(i, &s); ++i) {
+        printf("@%-3u %7lu  %-9s %4u %5.1f %6.1f | %8lu %6lu %9lu\n",
+               s.endereco, (unsigned long)s.pacotes, _nomes[s.modem], s.tx_power,
+               s.snr_ewma_q8 / 1024.0f, s.folga_x4 / 4.0f,
+               (unsigned long)s.melhoras, (unsigned long)s.pioras, (unsigned long)s.ignoradas);
+    }
+}
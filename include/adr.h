@@ -0,0 +1,126 @@
+#ifndef ADR_H
+#define ADR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora.h"
+
+// ============================================================================
+// --- Taxa de dados adaptativa decidida pelo receptor (ADR) ---
+//
+// A cada pacote confirmado, o receptor estima a SNR do transmissor (EWMA em
+// quartos de dB) e calcula a folga sobre o piso de demodulação de cada
+// perfil de modem, já descontada a margem ADR_MARGEM_DB. O ACK passa a
+// levar o perfil mais rápido que essa folga sustenta e a menor potência
+// que ainda a mantém (ACK estendido):
+//
+//     para, de, id, FLAGS_ACK, ADR_ACK_TIPO, perfil, potência (dBm), folga (quartos de dB)
+//
+// A SNR medida num perfil é convertida para os outros pela largura de banda
+// (o ruído na banda cresce 10·log10 da razão). Só são recomendados perfis
+// que algum rádio deste receptor escuta na mesma frequência do rádio que
+// recebeu o pacote, senão o transmissor sumiria ao trocar: com um rádio só,
+// ou rádios em frequências diferentes, o perfil fica e só a potência muda.
+//
+// Histerese: piorar (perfil mais lento, potência maior) é imediato quando a
+// folga atual fica negativa; melhorar exige folga de ADR_HISTERESE_DB além
+// da margem em ADR_CONFIRMACOES avaliações seguidas. Depois de cada troca
+// a estimativa recomeça e só volta a valer após ADR_AMOSTRAS_MIN pacotes.
+//
+// A potência efetiva do transmissor não viaja no quadro: supõe-se que ele
+// aplica cada recomendação ao receber o ACK (adr_transmissor_resultado).
+// O perfil, ao contrário, é o do rádio que recebeu o pacote. Um pacote num
+// perfil mais lento que o recomendado (ACK perdido ou recuo do
+// transmissor) faz o receptor adotar esse perfil na hora; num perfil mais
+// rápido, só depois de ADR_AMOSTRAS_MIN pacotes, contados como ignorados.
+// ============================================================================
+
+// Primeiro byte do complemento de um ACK estendido com recomendação de ADR
+#define ADR_ACK_TIPO 0x01
+
+/**
+ * @brief Estado de ADR de um transmissor, visto pelo receptor.
+ */
+typedef struct {
+    uint8_t endereco;
+    uint8_t modem;          // Perfil recomendado (modem_config_t)
+    uint8_t tx_power;       // Potência recomendada, em dBm
+    uint8_t confirmacoes;   // Avaliações seguidas que permitem melhorar
+    uint8_t divergentes;    // Pacotes seguidos num perfil mais rápido que o recomendado
+    uint16_t amostras;      // Pacotes desde a última troca
+    int32_t snr_ewma_q8;    // SNR estimada, em quartos de dB (Q8)
+    int16_t folga_x4;       // Folga da configuração atual sobre a margem, em quartos de dB
+    uint32_t pacotes;
+    uint32_t melhoras;      // Trocas para perfil mais rápido ou potência menor
+    uint32_t pioras;        // Trocas para perfil mais lento ou potência maior
+    uint32_t ignoradas;     // Trocas de perfil não aplicadas pelo transmissor
+    uint64_t ultimo_us;
+} adr_no_t;
+
+/**
+ * @brief Recomendação lida de um ACK estendido.
+ */
+typedef struct {
+    modem_config_t modem;
+    uint8_t tx_power;
+    int8_t folga_x4;
+} adr_recomendacao_t;
+
+/**
+ * @brief Estado do lado transmissor (ver adr_transmissor_resultado).
+ */
+typedef struct {
+    modem_config_t modem_inicial;   // Configuração planejada, usada no recuo
+    uint8_t tx_power_inicial;
+    uint8_t falhas;         // Envios seguidos sem ACK
+    uint32_t trocas;        // Recomendações aplicadas
+    uint32_t recuos;        // Voltas à configuração inicial por falta de ACK
+} adr_transmissor_t;
+
+/**
+ * @brief Zera a tabela de transmissores e anota, para cada rádio, os perfis
+ *        escutados pelos rádios na mesma frequência.
+ * @param radios Rádios já inicializados com lora_init.
+ */
+void adr_init(const lora_radio_t *radios, uint8_t num_radios);
+
+/**
+ * @brief Complemento do ACK (use com lora_on_ack). Atualiza a estimativa do
+ *        remetente e escreve a recomendação. Roda na ISR; só inteiros.
+ * @return Bytes escritos em `extra`.
+ */
+uint8_t adr_ack(const lora_radio_t *radio, const lora_payload_t *pacote, uint8_t *extra);
+
+/**
+ * @brief Lê a recomendação de um ACK recebido pelo transmissor.
+ * @return false se o ACK não for estendido ou trouxer valores inválidos.
+ */
+bool adr_ler_ack(const lora_payload_t *ack, adr_recomendacao_t *r);
+
+/**
+ * @brief Lado transmissor: guarda a configuração atual do rádio como a de
+ *        recuo.
+ */
+void adr_transmissor_init(adr_transmissor_t *t, const lora_radio_t *radio);
+
+/**
+ * @brief Lado transmissor: chamada após cada lora_send_to_wait. Com ACK,
+ *        aplica a recomendação que ele trouxer; após ADR_RECUO_SEM_ACK
+ *        envios seguidos sem ACK, volta à configuração de
+ *        adr_transmissor_init.
+ * @return true se a configuração do rádio mudou.
+ */
+bool adr_transmissor_resultado(adr_transmissor_t *t, lora_radio_t *radio, bool ack_ok);
+
+/**
+ * @brief Copia o estado de um transmissor de forma consistente com a ISR.
+ * @return false se o índice não existir.
+ */
+bool adr_copiar(uint8_t indice, adr_no_t *copia);
+
+/**
+ * @brief Imprime no console uma linha por transmissor.
+ */
+void adr_imprimir(void);
+
+#endif // ADR_H
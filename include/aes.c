@@ -0,0 +1,187 @@
+#include "aes.h"
+#include <string.h>
+#include <stdbool.h>
+
+static const uint8_t _sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+// T-table da primeira coluna: {2·S[x], S[x], S[x], 3·S[x]} em big-endian.
+// Montada em RAM na primeira aes128_init(); ler da flash passaria pelo XIP
+static uint32_t _te0[256];
+static bool _te0_pronta = false;
+
+static inline uint32_t ror32(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t carregar_be(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void gravar_be(uint8_t *p, uint32_t x) {
+    p[0] = x >> 24;
+    p[1] = x >> 16;
+    p[2] = x >> 8;
+    p[3] = x;
+}
+
+static void montar_tabela(void) {
+    for (int i = 0; i < 256; ++i) {
+        uint32_t s = _sbox[i];
+        uint32_t s2 = ((s << 1) ^ ((s & 0x80) ? 0x1b : 0)) & 0xff; // xtime
+        _te0[i] = (s2 << 24) | (s << 16) | (s << 8) | (s2 ^ s);
+    }
+    _te0_pronta = true;
+}
+
+void aes128_init(aes128_t *aes, const uint8_t chave[AES_BLOCO]) {
+    static const uint8_t rcon[10] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+
+    if (!_te0_pronta) {
+        montar_tabela();
+    }
+
+    uint32_t *w = aes->rk;
+    for (int i = 0; i < 4; ++i) {
+        w[i] = carregar_be(chave + 4 * i);
+    }
+    for (int i = 4; i < 44; ++i) {
+        uint32_t t = w[i - 1];
+        if ((i & 3) == 0) {
+            // RotWord, SubWord e Rcon
+            t = ((uint32_t)_sbox[(t >> 16) & 0xff] << 24) | ((uint32_t)_sbox[(t >> 8) & 0xff] << 16) |
+                ((uint32_t)_sbox[t & 0xff] << 8) | _sbox[t >> 24];
+            t ^= (uint32_t)rcon[i / 4 - 1] << 24;
+        }
+        w[i] = w[i - 4] ^ t;
+    }
+}
+
+void aes128_cifrar_bloco(const aes128_t *aes, const uint8_t in[AES_BLOCO], uint8_t out[AES_BLOCO]) {
+    const uint32_t *rk = aes->rk;
+    uint32_t s0 = carregar_be(in) ^ rk[0];
+    uint32_t s1 = carregar_be(in + 4) ^ rk[1];
+    uint32_t s2 = carregar_be(in + 8) ^ rk[2];
+    uint32_t s3 = carregar_be(in + 12) ^ rk[3];
+
+    // Rodadas 1 a 9: SubBytes, ShiftRows e MixColumns de uma vez pela T-table
+    for (int r = 1; r < 10; ++r) {
+        rk += 4;
+        uint32_t t0 = _te0[s0 >> 24] ^ ror32(_te0[(s1 >> 16) & 0xff], 8) ^
+                      ror32(_te0[(s2 >> 8) & 0xff], 16) ^ ror32(_te0[s3 & 0xff], 24) ^ rk[0];
+        uint32_t t1 = _te0[s1 >> 24] ^ ror32(_te0[(s2 >> 16) & 0xff], 8) ^
+                      ror32(_te0[(s3 >> 8) & 0xff], 16) ^ ror32(_te0[s0 & 0xff], 24) ^ rk[1];
+        uint32_t t2 = _te0[s2 >> 24] ^ ror32(_te0[(s3 >> 16) & 0xff], 8) ^
+                      ror32(_te0[(s0 >> 8) & 0xff], 16) ^ ror32(_te0[s1 & 0xff], 24) ^ rk[2];
+        uint32_t t3 = _te0[s3 >> 24] ^ ror32(_te0[(s0 >> 16) & 0xff], 8) ^
+                      ror32(_te0[(s1 >> 8) & 0xff], 16) ^ ror32(_te0[s2 & 0xff], 24) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    // Última rodada, sem MixColumns
+    rk += 4;
+#define AES_FINAL(a, b, c, d) \
+    (((uint32_t)_sbox[(a) >> 24] << 24) | ((uint32_t)_sbox[((b) >> 16) & 0xff] << 16) | \
+     ((uint32_t)_sbox[((c) >> 8) & 0xff] << 8) | _sbox[(d) & 0xff])
+    gravar_be(out, AES_FINAL(s0, s1, s2, s3) ^ rk[0]);
+    gravar_be(out + 4, AES_FINAL(s1, s2, s3, s0) ^ rk[1]);
+    gravar_be(out + 8, AES_FINAL(s2, s3, s0, s1) ^ rk[2]);
+    gravar_be(out + 12, AES_FINAL(s3, s0, s1, s2) ^ rk[3]);
+#undef AES_FINAL
+}
+
+void aes128_ctr(const aes128_t *aes, const uint8_t iv[AES_BLOCO], uint8_t *dados, size_t len) {
+    uint8_t contador[AES_BLOCO];
+    uint8_t fluxo[AES_BLOCO];
+    memcpy(contador, iv, AES_BLOCO);
+    uint32_t n = carregar_be(contador + 12);
+
+    while (len > 0) {
+        aes128_cifrar_bloco(aes, contador, fluxo);
+        size_t k = len < AES_BLOCO ? len : AES_BLOCO;
+        for (size_t i = 0; i < k; ++i) {
+            dados[i] ^= fluxo[i];
+        }
+        dados += k;
+        len -= k;
+        gravar_be(contador + 12, ++n);
+    }
+}
+
+// ============================================================================
+// --- CMAC (RFC 4493) ---
+// ============================================================================
+
+/**
+ * @brief Dobra no GF(2^128): deslocamento de 1 bit com redução por 0x87.
+ */
+static void dobrar(uint8_t b[AES_BLOCO]) {
+    uint8_t vai = b[0] >> 7;
+    for (int i = 0; i < AES_BLOCO - 1; ++i) {
+        b[i] = (b[i] << 1) | (b[i + 1] >> 7);
+    }
+    b[AES_BLOCO - 1] = (b[AES_BLOCO - 1] << 1) ^ (vai ? 0x87 : 0);
+}
+
+void aes_cmac_iniciar(aes_cmac_t *cmac, const aes128_t *aes) {
+    cmac->aes = aes;
+    memset(cmac->x, 0, AES_BLOCO);
+    cmac->n = 0;
+}
+
+void aes_cmac_atualizar(aes_cmac_t *cmac, const uint8_t *dados, size_t len) {
+    while (len > 0) {
+        // Um bloco cheio só é processado quando chega mais dado: o último
+        // bloco recebe a subchave em aes_cmac_finalizar()
+        if (cmac->n == AES_BLOCO) {
+            for (int i = 0; i < AES_BLOCO; ++i) {
+                cmac->x[i] ^= cmac->bloco[i];
+            }
+            aes128_cifrar_bloco(cmac->aes, cmac->x, cmac->x);
+            cmac->n = 0;
+        }
+        size_t k = AES_BLOCO - cmac->n;
+        if (k > len) {
+            k = len;
+        }
+        memcpy(cmac->bloco + cmac->n, dados, k);
+        cmac->n += k;
+        dados += k;
+        len -= k;
+    }
+}
+
+void aes_cmac_finalizar(aes_cmac_t *cmac, uint8_t mac[AES_BLOCO]) {
+    uint8_t k[AES_BLOCO] = {0};
+    aes128_cifrar_bloco(cmac->aes, k, k);
+    dobrar(k); // K1
+
+    if (cmac->n < AES_BLOCO) {
+        dobrar(k); // K2, com preenchimento 10..0
+        cmac->bloco[cmac->n] = 0x80;
+        memset(cmac->bloco + cmac->n + 1, 0, AES_BLOCO - cmac->n - 1);
+    }
+    for (int i = 0; i < AES_BLOCO; ++i) {
+        cmac->x[i] ^= cmac->bloco[i] ^ k[i];
+    }
+    aes128_cifrar_bloco(cmac->aes, cmac->x, mac);
+}
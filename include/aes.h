@@ -0,0 +1,56 @@
+#ifndef AES_H
+#define AES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// --- AES-128 (só cifragem), CTR e CMAC ---
+//
+// Implementação por T-table em palavras de 32 bits: cada rodada são 16
+// consultas a uma tabela de 1 KB em RAM (as outras três colunas saem por
+// rotação, que o Cortex-M0+ faz em uma instrução) e XORs de palavra. CTR e
+// CMAC só usam a cifragem, então a decifragem não existe aqui.
+// ============================================================================
+
+#define AES_BLOCO 16
+
+/**
+ * @brief Chave expandida (11 chaves de rodada).
+ */
+typedef struct {
+    uint32_t rk[44];
+} aes128_t;
+
+/**
+ * @brief Estado de um cálculo de CMAC (RFC 4493) em partes.
+ */
+typedef struct {
+    const aes128_t *aes;
+    uint8_t x[AES_BLOCO];       // Encadeamento
+    uint8_t bloco[AES_BLOCO];   // Bytes ainda não processados
+    uint8_t n;                  // Quantos bytes em `bloco`
+} aes_cmac_t;
+
+/**
+ * @brief Expande a chave. Na primeira chamada também monta a T-table.
+ */
+void aes128_init(aes128_t *aes, const uint8_t chave[AES_BLOCO]);
+
+/**
+ * @brief Cifra um bloco; `in` e `out` podem ser o mesmo buffer.
+ */
+void aes128_cifrar_bloco(const aes128_t *aes, const uint8_t in[AES_BLOCO], uint8_t out[AES_BLOCO]);
+
+/**
+ * @brief Cifra ou decifra `len` bytes no próprio buffer em modo CTR.
+ * @param iv Bloco contador inicial; os 4 últimos bytes (big-endian) são
+ *           incrementados a cada bloco.
+ */
+void aes128_ctr(const aes128_t *aes, const uint8_t iv[AES_BLOCO], uint8_t *dados, size_t len);
+
+void aes_cmac_iniciar(aes_cmac_t *cmac, const aes128_t *aes);
+void aes_cmac_atualizar(aes_cmac_t *cmac, const uint8_t *dados, size_t len);
+void aes_cmac_finalizar(aes_cmac_t *cmac, uint8_t mac[AES_BLOCO]);
+
+#endif // AES_H
@@ -0,0 +1,250 @@
+#include "agenda.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "config.h"
+#include "caminho_quente.h"
+
+#if (AGENDA_RODA_FATIAS & (AGENDA_RODA_FATIAS - 1)) != 0
+#error "AGENDA_RODA_FATIAS deve ser potência de 2"
+#endif
+
+typedef struct agenda_tarefa {
+    const char *nome;
+    agenda_fn_t fn;
+    uint32_t eventos;
+    uint32_t periodo_ms;
+
+    // --- Roda de temporização ---
+    uint32_t prazo;                 // Tick (ms) do próximo disparo pelo relógio
+    bool na_roda;
+    bool pronta;                    // Prazo vencido, ainda não executada
+    struct agenda_tarefa *seguinte; // Próxima tarefa na mesma fatia
+
+    // --- Contabilidade da janela atual ---
+    uint32_t execucoes;
+    uint64_t us_total;
+    uint32_t us_max;
+} agenda_tarefa_t;
+
+static agenda_tarefa_t _tarefas[AGENDA_MAX_TAREFAS];
+static int _num_tarefas = 0;
+
+// Eventos sinalizados e ainda não entregues (escritos por ISRs)
+static volatile uint32_t _eventos = 0;
+
+static agenda_tarefa_t *_roda[AGENDA_RODA_FATIAS];
+static uint32_t _roda_tick = 0;     // Último tick processado
+
+// Alarme que acorda o núcleo no próximo prazo da roda
+static volatile alarm_id_t _alarme = 0;
+static uint32_t _alarme_prazo;
+
+static void (*_ao_dormir)(void) = NULL;
+
+// Janela de medição
+static uint64_t _janela_inicio_us = 0;
+static uint64_t _ocioso_us = 0;
+static uint32_t _despertares = 0;
+
+static inline uint32_t tick_agora(void) {
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+// --- Roda de temporização ---
+
+static void roda_inserir(agenda_tarefa_t *t, uint32_t prazo) {
+    uint32_t fatia = prazo & (AGENDA_RODA_FATIAS - 1);
+    t->prazo = prazo;
+    t->seguinte = _roda[fatia];
+    _roda[fatia] = t;
+    t->na_roda = true;
+}
+
+static void roda_remover(agenda_tarefa_t *t) {
+    agenda_tarefa_t **p = &_roda[t->prazo & (AGENDA_RODA_FATIAS - 1)];
+    while (*p != t) {
+        p = &(*p)->seguinte;
+    }
+    *p = t->seguinte;
+    t->na_roda = false;
+}
+
+/**
+ * @brief Processa os ticks desde a última chamada até `agora`, marcando como
+ *        prontas as tarefas vencidas e rearmando as periódicas. Um atraso
+ *        maior que uma volta percorre cada fatia uma vez só.
+ */
+static void roda_avancar(uint32_t agora) {
+    uint32_t passos = agora - _roda_tick;
+    if (passos > AGENDA_RODA_FATIAS) {
+        passos = AGENDA_RODA_FATIAS;
+    }
+    for (uint32_t i = 1; i <= passos; ++i) {
+        agenda_tarefa_t **p = &_roda[(agora - passos + i) & (AGENDA_RODA_FATIAS - 1)];
+        while (*p) {
+            agenda_tarefa_t *t = *p;
+            if ((int32_t)(t->prazo - agora) > 0) {
+                p = &t->seguinte; // Volta futura
+                continue;
+            }
+            *p = t->seguinte;
+            t->na_roda = false;
+            t->pronta = true;
+            if (t->periodo_ms) {
+                // Mantém a fase; atrasada demais, recomeça a partir de agora
+                uint32_t prazo = t->prazo + t->periodo_ms;
+                roda_inserir(t, (int32_t)(prazo - agora) > 0 ? prazo : agora + t->periodo_ms);
+            }
+        }
+    }
+    _roda_tick = agora;
+}
+
+/**
+ * @brief Próximo prazo na roda, procurando no máximo uma volta à frente.
+ *        Sem nenhum, devolve o fim da volta (o núcleo acorda para girá-la).
+ */
+static uint32_t roda_proximo(uint32_t agora) {
+    for (uint32_t i = 1; i <= AGENDA_RODA_FATIAS; ++i) {
+        for (agenda_tarefa_t *t = _roda[(agora + i) & (AGENDA_RODA_FATIAS - 1)]; t; t = t->seguinte) {
+            if (t->prazo - agora == i) {
+                return t->prazo;
+            }
+        }
+    }
+    return agora + AGENDA_RODA_FATIAS;
+}
+
+// --- Alarme ---
+
+static int64_t alarme_callback(alarm_id_t id, void *user_data) {
+    _alarme = 0;
+    __sev();
+    return 0;
+}
+
+static void alarme_armar(uint32_t prazo) {
+    if (_alarme > 0) {
+        if (_alarme_prazo == prazo) {
+            return;
+        }
+        cancel_alarm(_alarme);
+    }
+    _alarme_prazo = prazo;
+    _alarme = add_alarm_at(from_us_since_boot((uint64_t)prazo * 1000), alarme_callback, NULL, true);
+}
+
+// --- API ---
+
+int agenda_registrar(const char *nome, agenda_fn_t fn, uint32_t eventos, uint32_t periodo_ms) {
+    if (_num_tarefas >= AGENDA_MAX_TAREFAS) {
+        return -1;
+    }
+    agenda_tarefa_t *t = &_tarefas[_num_tarefas];
+    *t = (agenda_tarefa_t){ .nome = nome, .fn = fn, .eventos = eventos, .periodo_ms = periodo_ms };
+    if (_num_tarefas == 0) {
+        _roda_tick = tick_agora();
+        _janela_inicio_us = time_us_64();
+    }
+    if (periodo_ms) {
+        roda_inserir(t, _roda_tick + periodo_ms);
+    }
+    return _num_tarefas++;
+}
+
+void CAMINHO_QUENTE(agenda_sinalizar)(uint32_t eventos) {
+    uint32_t estado = save_and_disable_interrupts();
+    _eventos |= eventos;
+    restore_interrupts(estado);
+    __sev();
+}
+
+void agenda_acordar_em(int tarefa, uint32_t ms) {
+    agenda_tarefa_t *t = &_tarefas[tarefa];
+    uint32_t prazo = tick_agora() + (ms ? ms : 1);
+    // O tick atual pode ainda não ter sido processado pela roda
+    if ((int32_t)(prazo - _roda_tick) <= 0) {
+        prazo = _roda_tick + 1;
+    }
+    if (t->na_roda) {
+        if ((int32_t)(t->prazo - prazo) <= 0) {
+            return;
+        }
+        roda_remover(t);
+    }
+    roda_inserir(t, prazo);
+}
+
+void agenda_ao_dormir(void (*fn)(void)) {
+    _ao_dormir = fn;
+}
+
+static void executar(agenda_tarefa_t *t) {
+    uint64_t inicio = time_us_64();
+    t->fn();
+    uint32_t duracao = (uint32_t)(time_us_64() - inicio);
+    t->execucoes++;
+    t->us_total += duracao;
+    if (duracao > t->us_max) {
+        t->us_max = duracao;
+    }
+}
+
+void agenda_executar(void) {
+    while (1) {
+        uint32_t estado = save_and_disable_interrupts();
+        uint32_t eventos = _eventos;
+        _eventos = 0;
+        restore_interrupts(estado);
+
+        roda_avancar(tick_agora());
+
+        bool rodou = false;
+        for (int i = 0; i < _num_tarefas; ++i) {
+            agenda_tarefa_t *t = &_tarefas[i];
+            if (t->pronta || (t->eventos & eventos)) {
+                t->pronta = false;
+                executar(t);
+                rodou = true;
+            }
+        }
+        if (rodou) {
+            continue; // As tarefas podem ter sinalizado eventos ou vencido prazos
+        }
+
+        // Nada pronto: dorme até uma interrupção ou o próximo prazo
+        alarme_armar(roda_proximo(_roda_tick));
+        if (_ao_dormir) {
+            _ao_dormir();
+        }
+        uint64_t inicio = time_us_64();
+        if (_eventos == 0) {
+            __wfe();
+        }
+        _ocioso_us += time_us_64() - inicio;
+        _despertares++;
+    }
+}
+
+void agenda_imprimir(void) {
+    uint64_t agora = time_us_64();
+    uint64_t janela = agora - _janela_inicio_us;
+    if (janela == 0) {
+        return;
+    }
+    printf("Agenda: janela de %llu ms, ociosa %.1f%%, %lu despertares\n",
+           (unsigned long long)(janela / 1000), 100.0f * _ocioso_us / janela, (unsigned long)_despertares);
+    for (int i = 0; i < _num_tarefas; ++i) {
+        agenda_tarefa_t *t = &_tarefas[i];
+        printf("  %-10s %7lu execucoes, %8llu us (%5.2f%%), max %lu us\n", t->nome,
+               (unsigned long)t->execucoes, (unsigned long long)t->us_total,
+               100.0f * t->us_total / janela, (unsigned long)t->us_max);
+        t->execucoes = 0;
+        t->us_total = 0;
+        t->us_max = 0;
+    }
+    _janela_inicio_us = agora;
+    _ocioso_us = 0;
+    _despertares = 0;
+}
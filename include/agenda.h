@@ -0,0 +1,67 @@
+#ifndef AGENDA_H
+#define AGENDA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// --- Agenda cooperativa do loop principal ---
+//
+// Tarefas curtas que rodam até o fim, disparadas de dois jeitos:
+//   - eventos: bits sinalizados por ISRs, alarmes ou outras tarefas com
+//     agenda_sinalizar(); a tarefa roda se algum bit da sua máscara chegou;
+//   - relógio: uma roda de AGENDA_RODA_FATIAS fatias de 1 ms guarda os
+//     prazos das tarefas periódicas e dos despertares avulsos
+//     (agenda_acordar_em); prazos além de uma volta ficam na fatia até a
+//     volta certa.
+//
+// As tarefas prontas rodam na ordem de registro (a primeira tem
+// prioridade). Sem nada pronto, um alarme de hardware é armado para o
+// próximo prazo da roda e o núcleo dorme em __wfe até uma interrupção;
+// agenda_sinalizar() executa __sev, então um evento sinalizado entre a
+// última verificação e o __wfe não se perde.
+//
+// O tempo de cada tarefa e o tempo dormindo são somados por janela e
+// impressos por agenda_imprimir().
+// ============================================================================
+
+typedef void (*agenda_fn_t)(void);
+
+/**
+ * @brief Registra uma tarefa.
+ * @param nome Nome curto, usado no relatório.
+ * @param eventos Máscara de eventos que disparam a tarefa (0 = nenhum).
+ * @param periodo_ms Período de disparo pelo relógio (0 = sem período).
+ * @return Identificador da tarefa, ou -1 sem espaço (AGENDA_MAX_TAREFAS).
+ */
+int agenda_registrar(const char *nome, agenda_fn_t fn, uint32_t eventos, uint32_t periodo_ms);
+
+/**
+ * @brief Sinaliza eventos. Nunca bloqueia; pode ser chamada de ISRs.
+ */
+void agenda_sinalizar(uint32_t eventos);
+
+/**
+ * @brief Dispara a tarefa daqui a `ms` (no mínimo 1 ms), a menos que ela já
+ *        tenha um prazo anterior. Uma tarefa periódica retoma o período a
+ *        partir desse disparo. Só no contexto das tarefas.
+ */
+void agenda_acordar_em(int tarefa, uint32_t ms);
+
+/**
+ * @brief Função chamada logo antes de cada __wfe (NULL desliga).
+ */
+void agenda_ao_dormir(void (*fn)(void));
+
+/**
+ * @brief Executa as tarefas para sempre.
+ */
+void agenda_executar(void);
+
+/**
+ * @brief Imprime a ociosidade e o tempo de CPU de cada tarefa desde a
+ *        impressão anterior e começa uma nova janela.
+ */
+void agenda_imprimir(void);
+
+#endif // AGENDA_H
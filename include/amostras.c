@@ -0,0 +1,103 @@
+#include "amostras.h"
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t dezigzag(uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+/**
+ * @brief Lê um varint de até 5 bytes.
+ * @return false se o buffer acabar ou o varint for longo demais.
+ */
+static bool ler_varint(amostras_leitor_t *l, uint32_t *valor) {
+    uint32_t v = 0;
+    for (unsigned desloc = 0; desloc < 35; desloc += 7) {
+        if (l->p >= l->fim) {
+            return false;
+        }
+        uint8_t b = *l->p++;
+        v |= (uint32_t)(b & 0x7F) << desloc;
+        if (!(b & 0x80)) {
+            *valor = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static size_t gravar_varint(uint32_t v, uint8_t *saida, size_t livre) {
+    size_t n = 0;
+    do {
+        if (n >= livre) {
+            return 0;
+        }
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        saida[n++] = v ? (b | 0x80) : b;
+    } while (v);
+    return n;
+}
+
+bool amostras_iniciar(amostras_leitor_t *leitor, const uint8_t *dados, size_t len) {
+    if (len < 2 || dados[0] != AMOSTRAS_MAGICO || dados[1] == 0 || dados[1] > AMOSTRAS_MAX) {
+        return false;
+    }
+    leitor->p = dados + 2;
+    leitor->fim = dados + len;
+    leitor->restantes = dados[1];
+    leitor->erro = false;
+    leitor->anterior = (amostra_t){0, 0, 0};
+    return true;
+}
+
+bool amostras_proxima(amostras_leitor_t *leitor, amostra_t *amostra) {
+    if (leitor->restantes == 0 || leitor->erro) {
+        return false;
+    }
+
+    uint32_t t, h, p;
+    if (!ler_varint(leitor, &t) || !ler_varint(leitor, &h) || !ler_varint(leitor, &p)) {
+        leitor->erro = true;
+        return false;
+    }
+
+    // A primeira leitura é absoluta; como `anterior` começa zerada, a soma
+    // vale para as duas
+    leitor->anterior.temp_x10 += dezigzag(t);
+    leitor->anterior.umid_x10 += dezigzag(h);
+    leitor->anterior.pres_x10 += dezigzag(p);
+    leitor->restantes--;
+    *amostra = leitor->anterior;
+    return true;
+}
+
+size_t amostras_codificar(const amostra_t *amostras, uint8_t n, uint8_t *saida, size_t capacidade) {
+    if (n == 0 || n > AMOSTRAS_MAX || capacidade < 2) {
+        return 0;
+    }
+    saida[0] = AMOSTRAS_MAGICO;
+    saida[1] = n;
+
+    size_t pos = 2;
+    amostra_t anterior = {0, 0, 0};
+    for (uint8_t i = 0; i < n; ++i) {
+        const amostra_t *a = &amostras[i];
+        uint32_t campos[3] = {
+            zigzag(a->temp_x10 - anterior.temp_x10),
+            zigzag(a->umid_x10 - anterior.umid_x10),
+            zigzag(a->pres_x10 - anterior.pres_x10),
+        };
+        for (int k = 0; k < 3; ++k) {
+            size_t w = gravar_varint(campos[k], saida + pos, capacidade - pos);
+            if (w == 0) {
+                return 0;
+            }
+            pos += w;
+        }
+        anterior = *a;
+    }
+    return pos;
+}
@@ -0,0 +1,68 @@
+#ifndef AMOSTRAS_H
+#define AMOSTRAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// ============================================================================
+// --- Quadros compactos com várias leituras de T/H/P ---
+//
+//     AMOSTRAS_MAGICO | n (1..AMOSTRAS_MAX) | n leituras
+//
+// Cada leitura são três varints (LEB128) com zigzag, em décimos de °C,
+// décimos de % e décimos de hPa, na ordem T, H, P. A primeira leitura é
+// absoluta e as seguintes são a diferença para a anterior, o que deixa a
+// maioria dos campos com 1 byte. O byte mágico não é ASCII imprimível,
+// então o formato de texto "T:%f,H:%f,P:%f" continua aceito ao lado deste.
+// ============================================================================
+
+#define AMOSTRAS_MAGICO  0xC7
+#define AMOSTRAS_MAX     32
+
+// Maior quadro com AMOSTRAS_MAX leituras nas faixas físicas dos sensores:
+// a primeira leitura absoluta cabe em 7 bytes (T e H com 2, P ~10000 com 3)
+// e as diferenças até ±819,1 em 2 bytes por campo
+#define AMOSTRAS_BYTES_MAX  (2 + 7 + (AMOSTRAS_MAX - 1) * 6)
+
+/**
+ * @brief Uma leitura em décimos.
+ */
+typedef struct {
+    int32_t temp_x10;
+    int32_t umid_x10;
+    int32_t pres_x10;
+} amostra_t;
+
+/**
+ * @brief Decodificador incremental: lê uma amostra por vez direto do
+ *        buffer do pacote, sem cópia.
+ */
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *fim;
+    uint8_t restantes;      // Amostras ainda não lidas
+    bool erro;              // Quadro truncado ou varint inválido
+    amostra_t anterior;
+} amostras_leitor_t;
+
+/**
+ * @brief Reconhece o cabeçalho de um quadro compacto.
+ * @return false se a mensagem não é um quadro compacto (ex.: texto).
+ */
+bool amostras_iniciar(amostras_leitor_t *leitor, const uint8_t *dados, size_t len);
+
+/**
+ * @brief Decodifica a próxima amostra.
+ * @return false no fim do quadro ou em erro (ver `leitor->erro`).
+ */
+bool amostras_proxima(amostras_leitor_t *leitor, amostra_t *amostra);
+
+/**
+ * @brief Codifica `n` leituras (lado do transmissor).
+ * @param capacidade Tamanho de `saida`; 2 + 15 * n bytes sempre bastam.
+ * @return Bytes gravados, ou 0 se não couber ou n for inválido.
+ */
+size_t amostras_codificar(const amostra_t *amostras, uint8_t n, uint8_t *saida, size_t capacidade);
+
+#endif // AMOSTRAS_H
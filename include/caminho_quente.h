@@ -0,0 +1,89 @@
+#ifndef CAMINHO_QUENTE_H
+#define CAMINHO_QUENTE_H
+
+#include "pico/stdlib.h"
+
+// ============================================================================
+// --- Caminho de recepção na SRAM ---
+//
+// Com a opção RECEPTOR_RAM_HOTPATH do CMake, as funções executadas entre a
+// borda do DIO0 e a entrega do pacote (ISR, acesso aos registradores do
+// rádio e o que o callback chama) vão para a seção .time_critical, copiada
+// para a SRAM no boot, e as tabelas constantes que elas consultam vão para
+// o banco scratch X. Assim uma falta no cache do XIP (16 KB, disputado com
+// o display e a criptografia no loop principal) não atrasa a leitura do
+// FIFO. Sem a opção as macros não alteram nada.
+//
+// Uso:
+//     void CAMINHO_QUENTE(funcao)(int x) { ... }
+//     static const int TABELA_QUENTE("grupo") tabela[] = { ... };
+// ============================================================================
+
+#ifndef CAMINHO_QUENTE_RAM
+#define CAMINHO_QUENTE_RAM 0
+#endif
+
+#if CAMINHO_QUENTE_RAM
+#define CAMINHO_QUENTE(funcao)  __time_critical_func(funcao)
+#define TABELA_QUENTE(grupo)    __scratch_x(grupo)
+#else
+#define CAMINHO_QUENTE(funcao)  funcao
+#define TABELA_QUENTE(grupo)
+#endif
+
+// ============================================================================
+// --- Chamadas do SDK que ficam na flash ---
+//
+// time_us_64() e gpio_set_irq_enabled() não são __not_in_flash_func: no
+// caminho quente uma chamada a elas é uma busca no XIP como qualquer
+// outra. Com a opção, as versões abaixo leem e escrevem os registradores
+// direto e são expandidas dentro de quem as chama; sem ela, são as do SDK.
+// ============================================================================
+
+#if CAMINHO_QUENTE_RAM
+#include "hardware/structs/timer.h"
+#include "hardware/structs/io_bank0.h"
+
+/**
+ * @brief time_us_64() pelos registradores crus do timer (sem a trava de
+ *        TIMELR/TIMEHR), relendo a parte alta se ela virar no meio.
+ */
+__force_inline static uint64_t caminho_quente_agora_us(void) {
+    uint32_t alto = timer_hw->timerawh;
+    uint32_t baixo;
+    for (;;) {
+        baixo = timer_hw->timerawl;
+        uint32_t alto2 = timer_hw->timerawh;
+        if (alto2 == alto) {
+            break;
+        }
+        alto = alto2;
+    }
+    return ((uint64_t)alto << 32) | baixo;
+}
+
+/**
+ * @brief gpio_set_irq_enabled(pino, GPIO_IRQ_LEVEL_HIGH, habilitar) no
+ *        núcleo atual. Eventos de nível não ficam retidos, então o
+ *        reconhecimento que o SDK faz antes não é necessário.
+ */
+__force_inline static void caminho_quente_gpio_irq(uint pino, bool habilitar) {
+    io_bank0_irq_ctrl_hw_t *ctrl = get_core_num() ? &io_bank0_hw->proc1_irq_ctrl : &io_bank0_hw->proc0_irq_ctrl;
+    uint32_t evento = GPIO_IRQ_LEVEL_HIGH << (4 * (pino % 8));
+    if (habilitar) {
+        hw_set_bits(&ctrl->inte[pino / 8], evento);
+    } else {
+        hw_clear_bits(&ctrl->inte[pino / 8], evento);
+    }
+}
+#else
+static inline uint64_t caminho_quente_agora_us(void) {
+    return time_us_64();
+}
+
+static inline void caminho_quente_gpio_irq(uint pino, bool habilitar) {
+    gpio_set_irq_enabled(pino, GPIO_IRQ_LEVEL_HIGH, habilitar);
+}
+#endif
+
+#endif // CAMINHO_QUENTE_H
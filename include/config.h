@@ -5,15 +5,124 @@
 #define I2C_PORT           i2c1
 #define I2C_SDA_PIN        14
 #define I2C_SCL_PIN        15
-#define I2C_BAUDRATE       (400 * 1000)
+// Fast-mode Plus (1 MHz): acima do que o datasheet do SSD1306 garante, mas
+// aceito pela maioria dos módulos; exige pull-ups externos fortes (~2,2 kΩ)
+#ifndef I2C_FAST_MODE_PLUS
+#define I2C_FAST_MODE_PLUS 0
+#endif
+#define I2C_BAUDRATE       (I2C_FAST_MODE_PLUS ? 1000 * 1000 : 400 * 1000)
 #define DISPLAY_I2C_ADDR   0x3C
 #define DISPLAY_WIDTH      128
 #define DISPLAY_HEIGHT     64
+#define DISPLAY_MAX_FPS    10    // Taxa máxima de atualização da tela (quadros/s)
+#define DISPLAY_QUADRO_US  11400 // Período de quadro do SSD1306 (clock 0x80, ~88 Hz): mede os passos de rolagem
+
+// --- PAINEL (DASHBOARD) ---
+#define DASHBOARD_PAGINA_MS           4000 // Tempo de exibição de cada página
+#define MAX_NOS                       8    // Transmissores acompanhados simultaneamente
+#define HISTORICO_COLUNAS             112  // Colunas (buckets) de cada gráfico
+#define HISTORICO_AMOSTRAS_POR_COLUNA 4    // Amostras resumidas em cada coluna do histórico
+
+// --- SAÍDA DE LOG / TELEMETRIA ---
+#define LOG_SAIDA_BINARIA  0     // 1 = quadros binários COBS, 0 = linhas de texto
+#define LOG_RING_TAMANHO   32    // Registros por fila (potência de 2)
+#define LOG_SAIDA_MAX      128   // Maior registro serializado, em bytes
+#define LOG_DRAIN_BYTES    64    // Bytes enviados ao stdio por passada do loop
+#define LOG_METRICAS_MS    5000  // Período do registro de métricas
+#define CONSOLE_MAX_COMANDOS 16  // Comandos de uma tecla registráveis no console
+
+// --- AGENDA DE TAREFAS DO LOOP PRINCIPAL (ver agenda.h) ---
+#define AGENDA_MAX_TAREFAS   12    // Tarefas registráveis
+#define AGENDA_RODA_FATIAS   64    // Fatias de 1 ms da roda de temporização (potência de 2)
+#define AGENDA_CONSOLE_MS    100   // Consulta do console caso o aviso de caractere não chegue
+#define AGENDA_PAINEL_MS     100   // Verificação da troca de página do painel
+#define AGENDA_LOG_MS        50    // Escoamento do log, para registros feitos em interrupção
+#define AGENDA_FLASH_MS      10    // Passo do log na flash (gravação, apagamento e dump)
+#define AGENDA_GATEWAY_MS    5     // Passo do envio de lotes no modo gateway
+#define AGENDA_FRAG_MS       100   // SACKs adiados e expiração das remontagens
+
+// --- LOG PERSISTENTE NA FLASH (ver flash_log.h) ---
+#define FLASH_LOG_SETORES          32    // Setores de 4 KB no fim da flash, 128 registros cada
+#define FLASH_LOG_ESPERA_MAX_MS    2000  // Página cheia é gravada mesmo com rádio ocupado após este tempo
+#define FLASH_LOG_DUMP_POR_PASSADA 8     // Registros impressos por passada do loop no dump
+
+// --- ESTATÍSTICAS DO ENLACE ---
+#define LINK_EWMA_SHIFT    3     // Alfa das médias móveis = 1/2^N (RSSI, SNR e perda)
+#define LINK_PERCENTIL     10    // Percentil estimado (P²) para RSSI e SNR, em %
+#define LINK_SALTO_MAX     64    // Saltos de header_id maiores indicam reinício do transmissor
+
+// --- TAXA DE DADOS ADAPTATIVA NOS ACKS (ver adr.h) ---
+// O ADR só vale com LORA_ACKS: as recomendações vão nos ACKs, e cada ACK
+// deixa o rádio surdo pelo tempo no ar dele. Com um rádio só (o padrão), o
+// único perfil oferecido é o dele e o ADR ajusta apenas a potência; trocar
+// de SF exige outros rádios nesses perfis na mesma frequência
+#define LORA_ACKS          0     // Confirma os pacotes endereçados a este nó
+#define ADR_HABILITADO     1     // Recomenda perfil de modem e potência nos ACKs
+#define ADR_MARGEM_DB      10    // Margem exigida sobre o piso de demodulação
+#define ADR_HISTERESE_DB   3     // Folga adicional exigida para melhorar (faixa morta)
+#define ADR_CONFIRMACOES   4     // Avaliações seguidas com essa folga antes de melhorar
+#define ADR_AMOSTRAS_MIN   4     // Pacotes após cada troca antes de reavaliar
+#define ADR_EWMA_SHIFT     2     // Alfa da SNR estimada = 1/2^N
+#define ADR_POTENCIA_MIN   5     // Menor potência recomendada, em dBm
+#define ADR_POTENCIA_MAX   LORA_TX_POWER
+#define ADR_RECUO_SEM_ACK  3     // Transmissor: envios seguidos sem ACK antes do recuo
+
+// --- TDMA SINCRONIZADO POR BEACON (ver tdma.h) ---
+#ifndef TDMA_HABILITADO
+#define TDMA_HABILITADO    0     // Os transmissores precisam seguir os beacons
+#endif
+#define TDMA_SLOTS         20    // Slots por superquadro, incluindo o do beacon
+#define TDMA_SLOTS_LIVRES  3     // Últimos slots do superquadro, de contenção
+#define TDMA_SLOT_MS       150   // Cabe um pacote de dados e o ACK no perfil padrão
+#define TDMA_GUARDA_US     2000  // Folga no início do slot (deriva dos relógios e carga do FIFO)
+#define TDMA_EXPIRA        8     // Superquadros seguidos sem o dono até liberar o slot
+#define TDMA_TENTATIVAS    5     // Tentativas do beacon com o rádio ocupado...
+#define TDMA_REPETE_US     1000  // ...separadas por este intervalo
+
+// --- TRANSFERÊNCIAS FRAGMENTADAS (ver fragmentos.h) ---
+#define FRAG_HABILITADO    1     // Remonta transferências maiores que um quadro
+#define FRAG_DADOS         224   // Dados por fragmento; cabe com contador e MIC de até 16 bytes
+#define FRAG_MAX_BYTES     4096  // Maior transferência remontada
+#define FRAG_SLOTS         2     // Remontagens simultâneas, uma por remetente
+#define FRAG_JANELA        8     // Fragmentos por janela antes do pedido de SACK (até 32)
+#define FRAG_TIMEOUT_MS    10000 // Remontagem sem fragmentos novos é descartada
+#define FRAG_ESPERA_MS     1000  // Transmissor: espera pelo SACK de cada janela
+#define FRAG_TENTATIVAS    5     // Transmissor: janelas seguidas sem progresso antes de desistir
+
+// --- SEGURANÇA DOS PACOTES (AES-128 CTR + CMAC, ver seguranca.h) ---
+// Chave pré-compartilhada com os transmissores: 16 bytes separados por
+// vírgula, fora do repositório. Vem de include/seg_chave.h (ignorado pelo
+// git) ou do CMake: -DRECEPTOR_SEG_CHAVE="0x..,0x..,...". Sem ela, ou com a
+// chave de teste da RFC 4493, seguranca.c não compila.
+#if !defined(SEG_CHAVE) && __has_include("seg_chave.h")
+#include "seg_chave.h"
+#endif
+#define SEG_MIC_BYTES 4    // MIC truncado enviado em cada pacote (4 a 16)
+#define SEG_EXIGIR    0    // 1 = descarta pacotes sem FLAGS_SECURE
+
+// --- MODO GATEWAY (ENCAMINHAMENTO PARA O HOST) ---
+#ifndef GATEWAY_HABILITADO
+#define GATEWAY_HABILITADO 0     // Definido pelo CMake com -DRECEPTOR_GATEWAY=ON
+#endif
+#define GATEWAY_FILA_QUADROS    16   // Quadros entre a ISR e o loop (potência de 2)
+#define GATEWAY_LOTE_MAX        512  // Tamanho de cada buffer de lote, em bytes
+#define GATEWAY_LOTE_LIMIAR     384  // Fecha o lote ao atingir este tamanho
+#define GATEWAY_LOTE_MS         50   // ...ou quando o primeiro quadro tiver esta idade
+#define GATEWAY_ORCAMENTO_BYTES 64   // Bytes por passada quando não há USB CDC
 
 // --- CONFIGURAÇÃO GPIO PARA O LED RGB ---
 #define LED_RED_PIN        13 
 #define LED_GREEN_PIN      11 
 #define LED_BLUE_PIN       12 
+#define LED_PISCA_MS       100   // Duração da piscada a cada pacote (cor pelo RSSI)
+#define LED_FADE_MS        160   // Apagamento gradual ao fim da piscada
+#define LED_PWM_TOP        4095  // Resolução do PWM dos LEDs (12 bits, ~30 kHz)
+#define LED_SEQ_HZ         50    // Quadros por segundo do sequenciador do LED
+#define LED_SEQ_SLICE      7     // Slice de PWM usada só como relógio dos quadros (seus pinos 14/15 ficam com o I2C)
+#define LED_RSSI_MIN       -120  // RSSI (dBm) mostrado em vermelho...
+#define LED_RSSI_MAX       -40   // ...e em verde; valores intermediários em degradê
+#define LED_RSSI_NIVEIS    8     // Degraus do degradê (um padrão pronto por degrau)
+#define LED_CODIGO_MAX     4     // Máximo de piscadas de um código de erro
 
 
 // ==========================================================
@@ -24,11 +133,60 @@
 #define LORA_MISO_PIN       16
 #define LORA_CS_PIN         17
 #define LORA_INTERRUPT_PIN  8  // DIO0
+#define LORA_HEADER_PIN     0  // DIO3 em ValidHeader para o filtro de tamanho (0 = não conectado)
 #define LORA_RESET_PIN      20
 
+// --- Transporte SPI do rádio ---
+// LORA_TRANSPORT_PIO faz CS, endereço e dados numa só transação em PIO + DMA
+// e exige CS = SCK - 1 (vale para os pinos acima, mas não para o rádio 2)
+#define LORA_SPI_HZ         10000000 // Limitado a LORA_SPI_MAX_HZ (lora.h)
+#ifndef LORA_TRANSPORT
+#define LORA_TRANSPORT      LORA_TRANSPORT_SPI
+#endif
+
+// --- Rádios adicionais (até LORA_MAX_RADIOS em lora.h) ---
+// Com 2 rádios, o segundo escuta outro canal/SF no spi1; pacotes dos dois
+// chegam ao loop pela mesma fila. Os pinos evitam o I2C (14/15) e o LED (11-13).
+#ifndef LORA_NUM_RADIOS
+#define LORA_NUM_RADIOS     1
+#endif
+#define LORA2_SPI_PORT      spi1
+#define LORA2_SCK_PIN       26
+#define LORA2_MOSI_PIN      27
+#define LORA2_MISO_PIN      28
+#define LORA2_CS_PIN        22
+#define LORA2_INTERRUPT_PIN 21 // DIO0
+#define LORA2_HEADER_PIN    0  // DIO3 (0 = não conectado)
+#define LORA2_RESET_PIN     0  // Não conectado
+#define LORA2_FREQUENCY     916.8
+#define LORA2_MODEM         BW125_CR48_SF4096
+#define LORA2_TRANSPORT     LORA_TRANSPORT_SPI
+
 // --- Parâmetros da Comunicação LoRa (Devem ser iguais aos do transmissor) ---
 #define LORA_FREQUENCY      915.0 // <<< Parâmetro centralizado
 #define LORA_TX_POWER       20    // <<< Parâmetro centralizado
+#define LORA_SYNC_WORD      LORA_SYNC_WORD_DEFAULT // Troque em todos os nós para isolar a rede
+
+// --- Filtro de tamanho no cabeçalho PHY (só com LORA_HEADER_PIN) ---
+// Quadros desta rede, com os 4 bytes de cabeçalho e, se cifrados, contador
+// (4) e MIC: ACK (até LORA_ACK_EXTRA_MAX de complemento), telemetria em
+// texto (de "T:0,H:0,P:0" a ~30 B) e compacta (de uma leitura com campos de
+// 1 byte a AMOSTRAS_BYTES_MAX, de amostras.h). O formato compacto tem
+// qualquer tamanho entre os extremos, então as faixas juntas cobrem de 4 a
+// LORA_TAM_COMPACTO_MAX sem buracos: o filtro recusa os quadros maiores que
+// o maior válido (de outra rede na mesma palavra de sincronismo), que são
+// os que mais tempo no ar desperdiçam, e não os do meio da faixa
+#define LORA_TAM_SEGURO         (4 + SEG_MIC_BYTES)
+#define LORA_TAM_ACK_MAX        (4 + LORA_ACK_EXTRA_MAX)
+#define LORA_TAM_TEXTO_MIN      (4 + 11)
+#define LORA_TAM_TEXTO_MAX      (4 + 30 + LORA_TAM_SEGURO)
+#define LORA_TAM_COMPACTO_MIN   (4 + 2 + 3)
+#define LORA_TAM_COMPACTO_MAX   (4 + AMOSTRAS_BYTES_MAX + LORA_TAM_SEGURO)
+
+// --- Monitor de saúde do rádio ---
+#define LORA_HEALTH_PERIOD_MS       250     // Intervalo entre verificações
+#define LORA_HEALTH_MODEM_MARGEM_MS 500     // Folga sobre o tempo no ar de um quadro de 255 B no perfil do rádio
+#define LORA_HEALTH_NO_RX_MS        120000  // Silêncio que dispara um rearme (0 = desativado)
 
 // --- Endereços LoRa ---
 #define LORA_ADDRESS_TRANSMITTER 1
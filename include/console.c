@@ -0,0 +1,44 @@
+#include "console.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "config.h"
+
+typedef struct {
+    char tecla;
+    const char *descricao;
+    console_cmd_fn_t fn;
+} console_cmd_t;
+
+static console_cmd_t _comandos[CONSOLE_MAX_COMANDOS];
+static int _num_comandos = 0;
+
+static void console_ajuda(void) {
+    printf("--- Comandos ---\n");
+    for (int i = 0; i < _num_comandos; ++i) {
+        printf(" %c  %s\n", _comandos[i].tecla, _comandos[i].descricao);
+    }
+}
+
+bool console_registrar(char tecla, const char *descricao, console_cmd_fn_t fn) {
+    if (_num_comandos >= CONSOLE_MAX_COMANDOS) {
+        return false;
+    }
+    _comandos[_num_comandos++] = (console_cmd_t){ tecla, descricao, fn };
+    return true;
+}
+
+void console_poll(void) {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == '?') {
+            console_ajuda();
+            continue;
+        }
+        for (int i = 0; i < _num_comandos; ++i) {
+            if (_comandos[i].tecla == c) {
+                _comandos[i].fn();
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Função executada por um comando do console.
+ */
+typedef void (*console_cmd_fn_t)(void);
+
+/**
+ * @brief Registra um comando de uma tecla no console serial.
+ *
+ * @param tecla Caractere que dispara o comando.
+ * @param descricao Texto exibido na ajuda ('?').
+ * @param fn Função executada quando a tecla é recebida.
+ * @return false se a tabela de comandos estiver cheia.
+ */
+bool console_registrar(char tecla, const char *descricao, console_cmd_fn_t fn);
+
+/**
+ * @brief Lê os caracteres disponíveis no stdio, sem esperar, e executa os
+ *        comandos correspondentes. Deve ser chamada pelo loop principal.
+ */
+void console_poll(void);
+
+#endif // CONSOLE_H
@@ -0,0 +1,11 @@
+#include "crc.h"
+
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *dados, size_t len) {
+    while (len--) {
+        crc ^= (uint16_t)(*dados++) << 8;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,15 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief CRC-16/CCITT-FALSE (polinômio 0x1021, valor inicial 0xFFFF).
+ *
+ * @param crc Valor inicial; use 0xFFFF, ou o resultado anterior para
+ *            continuar o cálculo sobre um bloco seguinte.
+ */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *dados, size_t len);
+
+#endif // CRC_H
@@ -0,0 +1,374 @@
+#include "dashboard.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "pico/stdlib.h"
+
+#include "display.h"
+#include "node_table.h"
+#include "historico.h"
+#include "link_stats.h"
+#include "rolagem.h"
+#include "config.h"
+
+// ============================================================================
+// --- Geometria e Estado ---
+// ============================================================================
+
+// Os gráficos ficam alinhados à direita; as colunas à esquerda levam rótulos
+#define GRAFICO_X1  (DISPLAY_WIDTH - 1)
+#define GRAFICO_X0  (DISPLAY_WIDTH - HISTORICO_COLUNAS)
+
+/**
+ * @brief Estado de um gráfico desenhado em uma faixa de páginas.
+ */
+typedef struct {
+    const historico_t *hist;  // Histórico exibido
+    uint8_t p0, p1;           // Faixa de páginas ocupada
+    int16_t escala_min;       // Valor no rodapé da faixa
+    int16_t escala_max;       // Valor no topo da faixa
+    uint32_t desenhados;      // Valor de hist->total no último desenho
+    rolagem_t *rolagem;       // Rolagem por hardware (NULL: deslocamento no buffer)
+    bool rolar;               // Uma coluna nova espera o passo de rolagem
+    bool redesenhar;          // Passo de rolagem incerto: próximo desenho é completo
+} grafico_t;
+
+static ssd1306_t *_ssd = NULL;
+
+// Históricos do enlace, um bucket por pacote (SNR em quartos de dB)
+static historico_t _hist_rssi;
+static historico_t _hist_snr;
+static int _ultimo_rssi = 0;
+static float _ultimo_snr = 0.0f;
+static uint8_t _ultimo_remetente = 0;
+
+// Páginas 0..N-1 são os nós, N é o enlace e N+1 é o histórico
+static uint8_t _pagina = 0;
+static uint8_t _nos_na_rotacao = 0;
+static bool _pagina_valida = false;  // false: o próximo desenho é completo
+static uint64_t _inicio_pagina_us = 0;
+
+// Nó exibido na página de histórico (avança a cada volta da rotação)
+static uint8_t _indice_historico = 0;
+static const node_info_t *_no_historico = NULL;
+
+// O gráfico de RSSI rola pelo próprio display; as páginas 1..3 não têm rótulo
+static rolagem_t _rolagem_rssi;
+static grafico_t _grafico_rssi = { .hist = &_hist_rssi, .p0 = 1, .p1 = 3, .rolagem = &_rolagem_rssi };
+static grafico_t _grafico_snr  = { .hist = &_hist_snr,  .p0 = 5, .p1 = 7 };
+static grafico_t _grafico_temp = { .p0 = 1, .p1 = 2 };
+static grafico_t _grafico_umid = { .p0 = 3, .p1 = 4 };
+static grafico_t _grafico_pres = { .p0 = 5, .p1 = 6 };
+
+// Quadro pedido durante um passo de rolagem: sai quando o passo terminar
+static bool _quadro_adiado = false;
+
+// ============================================================================
+// --- Gráficos ---
+// ============================================================================
+
+static uint8_t grafico_y(const grafico_t *g, int16_t valor) {
+    int32_t topo = g->p0 * 8;
+    int32_t base = g->p1 * 8 + 7;
+    int32_t y = base - (int32_t)(valor - g->escala_min) * (base - topo) / (g->escala_max - g->escala_min);
+    if (y < topo) y = topo;
+    if (y > base) y = base;
+    return (uint8_t)y;
+}
+
+/**
+ * @brief Desenha o bucket `i` na coluna `x`: uma barra do mínimo ao máximo
+ *        e um segmento ligando o ponto médio ao do bucket anterior.
+ */
+static void grafico_coluna(const grafico_t *g, uint16_t i, uint8_t x) {
+    const historico_bucket_t *b = historico_bucket(g->hist, i);
+    uint8_t y_medio = grafico_y(g, (b->min + b->max) / 2);
+
+    ssd1306_vline(_ssd, x, grafico_y(g, b->max), grafico_y(g, b->min), true);
+    if (i > 0 && x > GRAFICO_X0) {
+        const historico_bucket_t *a = historico_bucket(g->hist, i - 1);
+        ssd1306_line(_ssd, x - 1, grafico_y(g, (a->min + a->max) / 2), x, y_medio, true);
+    }
+}
+
+/**
+ * @brief Redesenha o gráfico inteiro, recalculando a escala.
+ */
+static void grafico_completo(grafico_t *g) {
+    int16_t min, max;
+
+    ssd1306_clear_region(_ssd, GRAFICO_X0, GRAFICO_X1, g->p0, g->p1);
+    g->desenhados = g->hist->total;
+    g->rolar = false;
+    if (!historico_faixa(g->hist, &min, &max)) {
+        return;
+    }
+
+    // Folga de 1/8 da faixa para que variações pequenas não forcem nova escala
+    int16_t folga = (max - min) / 8 + 1;
+    g->escala_min = min - folga;
+    g->escala_max = max + folga;
+
+    uint16_t n = g->hist->quantidade;
+    for (uint16_t i = 0; i < n; ++i) {
+        grafico_coluna(g, i, GRAFICO_X1 - (n - 1) + i);
+    }
+}
+
+/**
+ * @brief Acrescenta ao gráfico os buckets fechados desde o último desenho.
+ *
+ * Cada bucket novo desloca a área uma coluna para a esquerda e desenha
+ * apenas a coluna da direita. Se um valor sair da escala atual, o gráfico
+ * é redesenhado por completo.
+ * @return true se algo mudou no buffer.
+ */
+static bool grafico_atualizar(grafico_t *g, bool completo) {
+    uint32_t novos = g->hist->total - g->desenhados;
+    uint16_t n = g->hist->quantidade;
+
+    if (g->redesenhar) {
+        g->redesenhar = false;
+        completo = true;
+    }
+
+    if (!completo && novos == 0) {
+        return false;
+    }
+    if (novos > 8) {
+        completo = true; // Mais barato redesenhar do que deslocar várias vezes
+    }
+    for (uint32_t k = 0; !completo && k < novos; ++k) {
+        const historico_bucket_t *b = historico_bucket(g->hist, n - 1 - k);
+        completo = b->min < g->escala_min || b->max > g->escala_max;
+    }
+
+    if (completo) {
+        grafico_completo(g);
+        return true;
+    }
+
+    // Uma coluna só: o display desloca a faixa e apenas a coluna nova vai
+    // pelo I2C, no fim do passo (grafico_rolagem_fim). O passo começa depois
+    // dos demais envios do quadro, em grafico_iniciar_rolagem()
+    if (g->rolagem && novos == 1) {
+        g->rolar = true;
+        return false;
+    }
+
+    for (uint32_t k = novos; k > 0; --k) {
+        ssd1306_shift_left(_ssd, GRAFICO_X0, GRAFICO_X1, g->p0, g->p1);
+        grafico_coluna(g, n - k, GRAFICO_X1);
+    }
+    g->desenhados = g->hist->total;
+    return true;
+}
+
+static void grafico_iniciar_rolagem(grafico_t *g) {
+    if (g->rolar) {
+        g->rolar = false;
+        rolagem_iniciar(g->rolagem);
+    }
+}
+
+/**
+ * @brief Fim do passo de rolagem: desenha no espelho a coluna que estava
+ *        pendente quando o passo começou.
+ */
+static void grafico_rolagem_fim(void *ctx, bool incerto) {
+    grafico_t *g = ctx;
+    uint16_t n = g->hist->quantidade;
+    uint32_t depois = g->hist->total - (g->desenhados + 1); // Buckets fechados durante o passo
+
+    if (incerto || depois >= n) {
+        g->redesenhar = true;
+        return;
+    }
+    grafico_coluna(g, n - 1 - depois, GRAFICO_X1);
+    g->desenhados++;
+}
+
+// ============================================================================
+// --- Páginas ---
+// ============================================================================
+
+/**
+ * @brief Reescreve uma linha de texto de 8 pixels de altura.
+ */
+static void escrever_linha(uint8_t pagina, const char *texto) {
+    ssd1306_clear_region(_ssd, 0, DISPLAY_WIDTH - 1, pagina, pagina);
+    ssd1306_draw_string(_ssd, texto, 0, pagina * 8);
+}
+
+static void pagina_no(const node_info_t *no) {
+    if (!_pagina_valida) {
+        display_layout_invalidate();
+    }
+    // A tela de telemetria já redesenha apenas os dígitos que mudaram
+    display_update_data(_ssd, no->endereco, no->temperatura, no->umidade,
+                        no->pressao, no->rssi, no->pacotes);
+}
+
+static void pagina_enlace(void) {
+    char linha[20];
+    bool completo = !_pagina_valida;
+
+    if (completo) {
+        ssd1306_fill(_ssd, false);
+        ssd1306_draw_string(_ssd, "S", 0, 48);
+    }
+
+    // Valor atual, média móvel e perda recente do último transmissor ouvido
+    link_stats_t s;
+    link_resumo_t rssi = {0}, snr = {0};
+    uint32_t per = 0;
+    if (link_stats_copiar_no(_ultimo_remetente, &s)) {
+        link_stats_resumir(&s.rssi, 1.0f, &rssi);
+        link_stats_resumir(&s.snr, 4.0f, &snr);
+        per = (s.per_ewma_q16 * 100 + 32768) >> 16;
+    }
+    snprintf(linha, sizeof(linha), "RSSI %d ~%.0f", _ultimo_rssi, rssi.ewma);
+    escrever_linha(0, linha);
+    snprintf(linha, sizeof(linha), "SNR %.1f P%lu%%", _ultimo_snr, (unsigned long)per);
+    escrever_linha(4, linha);
+
+    bool rssi_mudou = grafico_atualizar(&_grafico_rssi, completo);
+    bool snr_mudou = grafico_atualizar(&_grafico_snr, completo);
+
+    if (completo) {
+        ssd1306_send_data(_ssd);
+        return;
+    }
+    ssd1306_send_region(_ssd, 0, DISPLAY_WIDTH - 1, 0, 0);
+    ssd1306_send_region(_ssd, 0, DISPLAY_WIDTH - 1, 4, 4);
+    if (rssi_mudou) ssd1306_send_region(_ssd, GRAFICO_X0, GRAFICO_X1, _grafico_rssi.p0, _grafico_rssi.p1);
+    if (snr_mudou)  ssd1306_send_region(_ssd, GRAFICO_X0, GRAFICO_X1, _grafico_snr.p0, _grafico_snr.p1);
+    grafico_iniciar_rolagem(&_grafico_rssi); // Por último: nada mais é escrito durante o passo
+}
+
+static void pagina_historico(const node_info_t *no) {
+    char linha[20];
+    bool completo = !_pagina_valida || no != _no_historico;
+    grafico_t *graficos[] = { &_grafico_temp, &_grafico_umid, &_grafico_pres };
+
+    if (completo) {
+        _no_historico = no;
+        _grafico_temp.hist = &no->hist_temp;
+        _grafico_umid.hist = &no->hist_umid;
+        _grafico_pres.hist = &no->hist_pres;
+
+        ssd1306_fill(_ssd, false);
+        snprintf(linha, sizeof(linha), "Historico @%u", no->endereco);
+        ssd1306_draw_string(_ssd, linha, 0, 0);
+        ssd1306_draw_string(_ssd, "T", 0, 8);
+        ssd1306_draw_string(_ssd, "H", 0, 24);
+        ssd1306_draw_string(_ssd, "P", 0, 40);
+    }
+
+    snprintf(linha, sizeof(linha), "%.1f %.0f %.1f", no->temperatura, no->umidade, no->pressao);
+    escrever_linha(7, linha);
+
+    bool mudou[3];
+    for (int i = 0; i < 3; ++i) {
+        mudou[i] = grafico_atualizar(graficos[i], completo);
+    }
+
+    if (completo) {
+        ssd1306_send_data(_ssd);
+        return;
+    }
+    ssd1306_send_region(_ssd, 0, DISPLAY_WIDTH - 1, 7, 7);
+    for (int i = 0; i < 3; ++i) {
+        if (mudou[i]) ssd1306_send_region(_ssd, GRAFICO_X0, GRAFICO_X1, graficos[i]->p0, graficos[i]->p1);
+    }
+}
+
+// ============================================================================
+// --- Funções Públicas ---
+// ============================================================================
+
+void dashboard_init(ssd1306_t *ssd) {
+    _ssd = ssd;
+    rolagem_init(&_rolagem_rssi, ssd, GRAFICO_X0, _grafico_rssi.p0, _grafico_rssi.p1,
+                 grafico_rolagem_fim, &_grafico_rssi);
+    historico_init(&_hist_rssi, 1);
+    historico_init(&_hist_snr, 1);
+    _pagina = 0;
+    _pagina_valida = false;
+    _inicio_pagina_us = time_us_64();
+}
+
+void dashboard_registrar_pacote(uint8_t remetente, float temp, float hum, float pres, int rssi, float snr) {
+    node_table_update(remetente, temp, hum, pres, rssi, snr, time_us_64());
+    historico_adicionar(&_hist_rssi, (int16_t)rssi);
+    historico_adicionar(&_hist_snr, (int16_t)lroundf(snr * 4.0f));
+    _ultimo_rssi = rssi;
+    _ultimo_snr = snr;
+    _ultimo_remetente = remetente;
+}
+
+void dashboard_registrar_amostra(uint8_t remetente, float temp, float hum, float pres) {
+    node_table_amostra(remetente, temp, hum, pres, time_us_64());
+}
+
+bool dashboard_poll(void) {
+    bool incerto = rolagem_poll(&_rolagem_rssi) && _grafico_rssi.redesenhar;
+    if (rolagem_ativa(&_rolagem_rssi)) {
+        return false;
+    }
+    bool pedir = incerto || _quadro_adiado;
+    _quadro_adiado = false;
+    return pedir;
+}
+
+const rolagem_t *dashboard_rolagem(void) {
+    return &_rolagem_rssi;
+}
+
+bool dashboard_rotacao_pendente(void) {
+    return node_table_count() > 0 &&
+           time_us_64() - _inicio_pagina_us >= (uint64_t)DASHBOARD_PAGINA_MS * 1000;
+}
+
+void dashboard_render(void *ctx) {
+    // Nada é escrito no display com a rolagem ligada: antes do prazo do
+    // passo o quadro fica adiado e dashboard_poll() o pede de novo
+    rolagem_poll(&_rolagem_rssi);
+    if (rolagem_ativa(&_rolagem_rssi)) {
+        _quadro_adiado = true;
+        return;
+    }
+
+    uint8_t nos = node_table_count();
+    if (nos == 0) {
+        return; // Nada recebido ainda: mantém a tela de espera
+    }
+
+    // Um nó novo muda a numeração das páginas
+    if (nos != _nos_na_rotacao) {
+        _nos_na_rotacao = nos;
+        _pagina_valida = false;
+    }
+
+    uint64_t agora = time_us_64();
+    if (agora - _inicio_pagina_us >= (uint64_t)DASHBOARD_PAGINA_MS * 1000) {
+        _pagina = (_pagina + 1) % (nos + 2);
+        _inicio_pagina_us = agora;
+        _pagina_valida = false;
+        if (_pagina == nos + 1) {
+            _indice_historico = (_indice_historico + 1) % nos;
+        }
+    }
+    if (_pagina >= nos + 2) {
+        _pagina = 0;
+    }
+
+    if (_pagina < nos) {
+        pagina_no(node_table_get(_pagina));
+    } else if (_pagina == nos) {
+        pagina_enlace();
+    } else {
+        pagina_historico(node_table_get(_indice_historico % nos));
+    }
+    _pagina_valida = true;
+}
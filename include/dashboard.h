@@ -0,0 +1,60 @@
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/ssd1306/ssd1306.h"
+#include "rolagem.h"
+
+/**
+ * @brief Inicializa o painel de telas rotativas.
+ *
+ * O painel alterna entre uma página por transmissor, uma página de
+ * qualidade do enlace (gráficos de RSSI e SNR) e uma página de histórico
+ * de temperatura, umidade e pressão.
+ * @param ssd Ponteiro para a instância do display.
+ */
+void dashboard_init(ssd1306_t *ssd);
+
+/**
+ * @brief Registra um pacote decodificado na tabela de nós e nos históricos.
+ *        Deve ser chamada fora do contexto de interrupção.
+ */
+void dashboard_registrar_pacote(uint8_t remetente, float temp, float hum, float pres, int rssi, float snr);
+
+/**
+ * @brief Registra nos históricos do nó uma leitura intermediária de um quadro
+ *        com várias amostras; a última vai por dashboard_registrar_pacote().
+ */
+void dashboard_registrar_amostra(uint8_t remetente, float temp, float hum, float pres);
+
+/**
+ * @brief Conclui no tempo certo o passo de rolagem por hardware do gráfico
+ *        de RSSI. Deve ser chamada até rolagem_prazo_us() do passo; nunca
+ *        espera.
+ * @return true se o painel precisa de um quadro novo (passo incerto, ou um
+ *         quadro adiado por dashboard_render durante o passo).
+ */
+bool dashboard_poll(void);
+
+/**
+ * @brief Contadores da rolagem por hardware do gráfico de RSSI.
+ */
+const rolagem_t *dashboard_rolagem(void);
+
+/**
+ * @brief Indica se já é hora de trocar de página (mesmo sem pacotes novos).
+ */
+bool dashboard_rotacao_pendente(void);
+
+/**
+ * @brief Desenha a página atual. Os gráficos são atualizados de forma
+ *        incremental: a área é deslocada uma coluna (no gráfico de RSSI,
+ *        pelo próprio display) e só a coluna nova é desenhada. Compatível
+ *        com display_render_fn_t. Com um passo de rolagem em andamento não
+ *        desenha nada: o quadro é adiado até dashboard_poll().
+ * @param ctx Não utilizado.
+ */
+void dashboard_render(void *ctx);
+
+#endif // DASHBOARD_H
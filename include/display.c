@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 
@@ -7,6 +8,7 @@
 #include "display.h"
 #include "config.h"
 
+
 /**
  * @brief Inicializa o objeto do display SSD1306.
  * A inicialização do hardware I2C é feita separadamente no main.
@@ -19,6 +21,7 @@ void display_init(ssd1306_t *ssd) {
     ssd1306_config(ssd);
 
     // Limpa o buffer interno e atualiza a tela
+    display_layout_invalidate();
     ssd1306_fill(ssd, false);
     ssd1306_send_data(ssd);
     printf("Display inicializado.\n");
@@ -28,6 +31,7 @@ void display_init(ssd1306_t *ssd) {
  * @brief Exibe uma tela de boas-vindas no momento da inicialização.
  */
 void display_startup_screen(ssd1306_t *ssd) {
+    display_layout_invalidate();
     ssd1306_fill(ssd, false);
     const char *line1 = "Receptor LoRa";
     const char *line2 = "Atividade 14";
@@ -48,6 +52,7 @@ void display_startup_screen(ssd1306_t *ssd) {
  * @brief Exibe uma tela indicando que o sistema está pronto e esperando pacotes.
  */
 void display_wait_screen(ssd1306_t *ssd) {
+    display_layout_invalidate();
     ssd1306_fill(ssd, false);
     const char *line1 = "Aguardando...";
     
@@ -59,33 +64,176 @@ void display_wait_screen(ssd1306_t *ssd) {
     ssd1306_send_data(ssd);
 }
 
+// ============================================================================
+// --- Layout retido da tela de telemetria ---
+// ============================================================================
+
+// Coluna (em pixels) onde começa o texto de cada linha
+#define MARGEM_X 2
+
+// Posição em pixels do n-ésimo caractere 8x8 a partir da margem
+#define COL(n) (MARGEM_X + (n) * 8)
+
+// Rótulo fixo (fonte 8x8), desenhado apenas uma vez quando a tela de
+// telemetria é montada
+typedef struct {
+    uint8_t x;          // Em pixels
+    uint8_t pagina;     // Página do SSD1306 (linha de 8 pixels)
+    const char *texto;
+} display_rotulo_t;
+
+// Campo numérico de largura fixa. Guarda o texto atualmente na tela para
+// redesenhar somente os dígitos que mudaram.
+typedef struct {
+    uint8_t x;                      // Em pixels
+    uint8_t pagina;                 // Página do topo do campo
+    uint8_t largura;                // Em caracteres
+    bool alinhar_esquerda;
+    const ssd1306_font_t *fonte;
+    char texto[8];                  // Conteúdo atual do campo (sem terminador)
+} display_campo_t;
+
+// Índices dos campos da tela de telemetria
+enum {
+    CAMPO_TEMP,
+    CAMPO_UMIDADE,
+    CAMPO_PRESSAO,
+    CAMPO_RSSI,
+    CAMPO_PACOTES,
+    CAMPO_NO,
+    NUM_CAMPOS
+};
+
+// Páginas 0-2: temperatura em dígitos de 24 px e umidade em dígitos de 16 px
+// Páginas 4 a 6: "P: 1012.3 hPa" / "RSSI: -58 @1" / "Pacotes: #123"
+static const display_rotulo_t _rotulos[] = {
+    { 72, 0, "C" },      { 88, 0, "Umid" },  { 120, 2, "%" },
+    { COL(0), 4, "P: " },     { COL(9), 4, " hPa" },
+    { COL(0), 5, "RSSI: " },  { COL(11), 5, "@" },
+    { COL(0), 6, "Pacotes: #" },
+};
+
+static display_campo_t _campos[NUM_CAMPOS] = {
+    [CAMPO_TEMP]    = { 0,       0, 5, false, &font_digitos24 },
+    [CAMPO_UMIDADE] = { 88,      1, 3, false, &font_digitos16 },
+    [CAMPO_PRESSAO] = { COL(3),  4, 6, false, &font_8x8 },
+    [CAMPO_RSSI]    = { COL(6),  5, 4, true,  &font_8x8 },
+    [CAMPO_PACOTES] = { COL(10), 6, 5, true,  &font_8x8 },
+    [CAMPO_NO]      = { COL(12), 5, 3, true,  &font_8x8 },
+};
+
+// Display para o qual os rótulos já foram desenhados (NULL = layout inválido)
+static ssd1306_t *_layout_ssd = NULL;
+
+// Faixa de colunas alteradas desde o último envio ao display
+static uint8_t _sujo_x0, _sujo_x1;
+
+static void marcar_sujo(uint8_t x0, uint8_t x1) {
+    if (x0 < _sujo_x0) _sujo_x0 = x0;
+    if (x1 > _sujo_x1) _sujo_x1 = x1;
+}
+
+/**
+ * @brief Escreve um inteiro com ponto decimal fixo em `out` (sem terminador).
+ * @return O número de caracteres escritos.
+ */
+static uint8_t formatar_fixo(char *out, int32_t valor, uint8_t casas) {
+    char tmp[12];
+    uint8_t n = 0;
+    bool negativo = valor < 0;
+    uint32_t v = negativo ? -(uint32_t)valor : (uint32_t)valor;
+
+    // Gera os dígitos de trás para frente
+    do {
+        if (casas > 0 && n == casas) tmp[n++] = '.';
+        tmp[n++] = '0' + (v % 10);
+        v /= 10;
+    } while (v > 0 || n <= casas);
+    if (negativo) tmp[n++] = '-';
+
+    for (uint8_t i = 0; i < n; ++i) {
+        out[i] = tmp[n - 1 - i];
+    }
+    return n;
+}
+
+/**
+ * @brief Atualiza um campo, copiando para o buffer apenas os glifos que mudaram.
+ */
+static void campo_atualizar(ssd1306_t *ssd, display_campo_t *campo, int32_t valor, uint8_t casas) {
+    char numero[12];
+    char novo[sizeof(campo->texto)];
+    uint8_t n = formatar_fixo(numero, valor, casas);
+
+    memset(novo, ' ', campo->largura);
+    if (n > campo->largura) {
+        memset(novo, '-', campo->largura); // Valor não cabe; '-' existe em todas as fontes
+    } else if (campo->alinhar_esquerda) {
+        memcpy(novo, numero, n);
+    } else {
+        memcpy(novo + campo->largura - n, numero, n);
+    }
+
+    for (uint8_t i = 0; i < campo->largura; ++i) {
+        if (novo[i] == campo->texto[i]) continue;
+        uint8_t x = campo->x + i * campo->fonte->width;
+        ssd1306_draw_font_char(ssd, campo->fonte, novo[i], x, campo->pagina);
+        campo->texto[i] = novo[i];
+        marcar_sujo(x, x + campo->fonte->width - 1);
+    }
+}
+
+/**
+ * @brief Descarta o layout retido; a próxima chamada a display_update_data
+ *        redesenha a tela de telemetria inteira.
+ */
+void display_layout_invalidate(void) {
+    _layout_ssd = NULL;
+}
+
+/**
+ * @brief Monta a tela de telemetria: limpa o buffer e desenha os rótulos fixos.
+ */
+static void layout_montar(ssd1306_t *ssd) {
+    ssd1306_fill(ssd, false);
+    for (size_t i = 0; i < sizeof(_rotulos) / sizeof(_rotulos[0]); ++i) {
+        const display_rotulo_t *r = &_rotulos[i];
+        ssd1306_draw_string(ssd, r->texto, r->x, r->pagina * 8);
+    }
+
+    // Força o redesenho de todos os campos na primeira atualização
+    for (int i = 0; i < NUM_CAMPOS; ++i) {
+        memset(_campos[i].texto, 0, sizeof(_campos[i].texto));
+    }
+
+    _layout_ssd = ssd;
+    marcar_sujo(0, ssd->width - 1);
+}
+
 /**
  * @brief Atualiza a tela com os dados de telemetria recebidos.
+ *
+ * Os rótulos são desenhados uma única vez; nas chamadas seguintes apenas os
+ * dígitos alterados são copiados para o buffer e somente as colunas afetadas
+ * são enviadas pelo I2C.
  */
-void display_update_data(ssd1306_t *ssd, float temp, float hum, float pres, int rssi, uint32_t packets) {
-    char buffer[32]; // Buffer para formatar as strings
-    ssd1306_fill(ssd, false); // Limpa o buffer antes de desenhar o novo conteúdo
-
-    // Linha 1: Temperatura e Umidade
-    // Formata a string "T:25.1C H:45%"
-    snprintf(buffer, sizeof(buffer), "T:%.1fC H:%.0f%%", temp, hum);
-    ssd1306_draw_string(ssd, buffer, 2, 0);
-
-    // Linha 2: Pressão
-    // Formata a string "P: 1012.3 hPa"
-    snprintf(buffer, sizeof(buffer), "P: %.1f hPa", pres);
-    ssd1306_draw_string(ssd, buffer, 2, 16);
-
-    // Linha 3: Força do sinal (RSSI)
-    // Formata a string "Sinal (RSSI): -58"
-    snprintf(buffer, sizeof(buffer), "RSSI: %d", rssi);
-    ssd1306_draw_string(ssd, buffer, 2, 32);
-    
-    // Linha 4: Contador de pacotes recebidos
-    // Formata a string "Pacotes: #123"
-    snprintf(buffer, sizeof(buffer), "Pacotes: #%lu", packets);
-    ssd1306_draw_string(ssd, buffer, 2, 48);
+void display_update_data(ssd1306_t *ssd, uint8_t node, float temp, float hum, float pres, int rssi, uint32_t packets) {
+    _sujo_x0 = 0xFF;
+    _sujo_x1 = 0;
 
-    // Envia todo o buffer de uma vez para o display
-    ssd1306_send_data(ssd);
-}
\ No newline at end of file
+    if (_layout_ssd != ssd) {
+        layout_montar(ssd);
+    }
+
+    campo_atualizar(ssd, &_campos[CAMPO_TEMP],    lroundf(temp * 10.0f), 1);
+    campo_atualizar(ssd, &_campos[CAMPO_UMIDADE], lroundf(hum), 0);
+    campo_atualizar(ssd, &_campos[CAMPO_PRESSAO], lroundf(pres * 10.0f), 1);
+    campo_atualizar(ssd, &_campos[CAMPO_RSSI],    rssi, 0);
+    campo_atualizar(ssd, &_campos[CAMPO_PACOTES], packets % 100000, 0);
+    campo_atualizar(ssd, &_campos[CAMPO_NO],      node, 0);
+
+    // Envia apenas a faixa de colunas que mudou
+    if (_sujo_x0 <= _sujo_x1) {
+        ssd1306_send_columns(ssd, _sujo_x0, _sujo_x1);
+    }
+}
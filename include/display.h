@@ -2,7 +2,6 @@
 #define DISPLAY_H
 
 #include "lib/ssd1306/ssd1306.h"
-#include "lib/ssd1306/font.h"
 #include <stdint.h>
 
 /**
@@ -27,12 +26,19 @@ void display_wait_screen(ssd1306_t *ssd);
  * @brief Atualiza a tela com os dados recebidos via LoRa.
  *
  * @param ssd Ponteiro para a instância ssd1306_t.
+ * @param node Endereço do transmissor dos dados.
  * @param temp Temperatura recebida.
  * @param hum Umidade recebida.
  * @param pres Pressão recebida (em hPa).
  * @param rssi RSSI (força do sinal) do último pacote.
  * @param packets Contagem total de pacotes recebidos.
  */
-void display_update_data(ssd1306_t *ssd, float temp, float hum, float pres, int rssi, uint32_t packets);
+void display_update_data(ssd1306_t *ssd, uint8_t node, float temp, float hum, float pres, int rssi, uint32_t packets);
+
+/**
+ * @brief Força o redesenho completo da tela de telemetria na próxima
+ *        atualização. Deve ser chamada por quem desenhar outra coisa na tela.
+ */
+void display_layout_invalidate(void);
 
 #endif // DISPLAY_Hs
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "display_scheduler.h"
+#include "pico/stdlib.h"
+
+void display_scheduler_init(display_scheduler_t *sched, uint32_t max_hz, display_render_fn_t render, void *ctx) {
+    sched->render = render;
+    sched->ctx = ctx;
+    sched->intervalo_us = max_hz > 0 ? 1000000 / max_hz : 0;
+    sched->ultimo_quadro_us = 0;
+    sched->pendente = false;
+
+    sched->quadros_desenhados = 0;
+    sched->quadros_descartados = 0;
+    sched->render_ultimo_us = 0;
+    sched->render_max_us = 0;
+    sched->render_total_us = 0;
+}
+
+void display_scheduler_request(display_scheduler_t *sched) {
+    // O quadro anterior ainda não saiu: será substituído pelo estado novo
+    if (sched->pendente) {
+        sched->quadros_descartados++;
+    }
+    sched->pendente = true;
+}
+
+uint64_t display_scheduler_prazo_us(const display_scheduler_t *sched) {
+    if (!sched->pendente) {
+        return 0;
+    }
+    return sched->quadros_desenhados > 0 ? sched->ultimo_quadro_us + sched->intervalo_us : 1;
+}
+
+bool display_scheduler_poll(display_scheduler_t *sched) {
+    if (!sched->pendente) {
+        return false;
+    }
+
+    uint64_t agora = time_us_64();
+    if (sched->quadros_desenhados > 0 && agora - sched->ultimo_quadro_us < sched->intervalo_us) {
+        return false; // Ainda dentro do intervalo mínimo entre quadros
+    }
+
+    // Limpa a flag antes de desenhar: um pedido feito durante o desenho
+    // gera um novo quadro no próximo intervalo
+    sched->pendente = false;
+    sched->ultimo_quadro_us = agora;
+
+    sched->render(sched->ctx);
+
+    uint32_t duracao = (uint32_t)(time_us_64() - agora);
+    sched->render_ultimo_us = duracao;
+    sched->render_total_us += duracao;
+    if (duracao > sched->render_max_us) {
+        sched->render_max_us = duracao;
+    }
+    sched->quadros_desenhados++;
+    return true;
+}
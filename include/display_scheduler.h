@@ -0,0 +1,68 @@
+#ifndef DISPLAY_SCHEDULER_H
+#define DISPLAY_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Função que desenha o estado mais recente na tela.
+ * @param ctx Ponteiro de contexto registrado em display_scheduler_init.
+ */
+typedef void (*display_render_fn_t)(void *ctx);
+
+/**
+ * @brief Escalonador de quadros do display.
+ *
+ * Desacopla a taxa de atualização da tela da taxa de chegada de pacotes:
+ * pedidos feitos entre dois quadros são coalescidos e apenas o estado mais
+ * recente é desenhado, respeitando uma taxa máxima de quadros.
+ */
+typedef struct {
+    display_render_fn_t render;  // Função de desenho
+    void *ctx;                   // Contexto repassado à função de desenho
+    uint32_t intervalo_us;       // Intervalo mínimo entre quadros
+    uint64_t ultimo_quadro_us;   // Instante do último quadro desenhado
+    volatile bool pendente;      // Há estado novo ainda não desenhado
+
+    // --- Contadores ---
+    uint32_t quadros_desenhados;  // Quadros efetivamente enviados ao display
+    uint32_t quadros_descartados; // Pedidos coalescidos (nunca desenhados)
+    uint32_t render_ultimo_us;    // Duração do último quadro
+    uint32_t render_max_us;       // Maior duração observada
+    uint64_t render_total_us;     // Soma das durações (para a média)
+} display_scheduler_t;
+
+/**
+ * @brief Inicializa o escalonador.
+ *
+ * @param sched Ponteiro para a instância do escalonador.
+ * @param max_hz Taxa máxima de quadros por segundo.
+ * @param render Função chamada para desenhar o estado mais recente.
+ * @param ctx Contexto repassado à função de desenho.
+ */
+void display_scheduler_init(display_scheduler_t *sched, uint32_t max_hz, display_render_fn_t render, void *ctx);
+
+/**
+ * @brief Sinaliza que há um novo estado a ser exibido. Nunca bloqueia.
+ *
+ * Se o quadro anterior ainda não foi desenhado, ele é descartado e contado
+ * em `quadros_descartados`.
+ */
+void display_scheduler_request(display_scheduler_t *sched);
+
+/**
+ * @brief Instante a partir do qual o quadro pendente pode ser desenhado.
+ * @return 0 se não há quadro pendente.
+ */
+uint64_t display_scheduler_prazo_us(const display_scheduler_t *sched);
+
+/**
+ * @brief Desenha o estado pendente caso o intervalo mínimo já tenha passado.
+ *
+ * Deve ser chamada de novo até display_scheduler_prazo_us() enquanto houver
+ * quadro pendente.
+ * @return true se um quadro foi desenhado nesta chamada.
+ */
+bool display_scheduler_poll(display_scheduler_t *sched);
+
+#endif // DISPLAY_SCHEDULER_H
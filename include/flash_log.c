@@ -0,0 +1,361 @@
+#include "flash_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "config.h"
+#include "crc.h"
+
+/**
+ * @brief Registro gravado na flash (little-endian, 32 bytes). Os campos já
+ *        estão alinhados naturalmente, então não há preenchimento.
+ */
+typedef struct {
+    uint32_t seq;           // Crescente entre boots; 0xFFFFFFFF = apagado
+    uint32_t tempo_ms;      // Desde o boot que gravou
+    uint16_t reinicio;
+    uint8_t remetente;
+    uint8_t radio;
+    int16_t rssi;
+    int16_t snr_x4;
+    int16_t temp_x10;
+    int16_t umid;
+    int16_t pres_x10;
+    uint8_t reservado[8];   // 0xFF
+    uint16_t crc;           // CRC-16 dos 30 bytes anteriores
+} flash_log_reg_t;
+
+_Static_assert(sizeof(flash_log_reg_t) == 32, "registro da flash deve ter 32 bytes");
+
+#define REGS_POR_PAGINA  (FLASH_PAGE_SIZE / sizeof(flash_log_reg_t))
+#define REGS_POR_SETOR   (FLASH_SECTOR_SIZE / sizeof(flash_log_reg_t))
+#define LOG_REGS         (FLASH_LOG_SETORES * REGS_POR_SETOR)
+#define LOG_OFFSET       (PICO_FLASH_SIZE_BYTES - FLASH_LOG_SETORES * FLASH_SECTOR_SIZE)
+#define SEM_SETOR        (-1)
+
+extern char __flash_binary_end;
+
+static bool _ativo = false;
+static bool (*_radio_ocioso)(void);
+static flash_log_stats_t _stats;
+
+static uint32_t _seq;                   // Sequência do próximo registro
+static uint32_t _pagina_slot;           // Primeiro slot da página em RAM
+static flash_log_reg_t _pagina[REGS_POR_PAGINA];
+static uint8_t _na_pagina;              // Registros já na página em RAM
+static uint64_t _cheia_desde_us;
+static int32_t _setor_pronto;           // Setor já apagado à frente da escrita
+static int32_t _apagar_setor;           // Apagamento antecipado pendente
+
+// Dump em andamento
+static bool _dump_ativo = false;
+static uint32_t _dump_slot;
+static uint32_t _dump_restantes;
+
+// ============================================================================
+// --- Funções Auxiliares ---
+// ============================================================================
+
+static const flash_log_reg_t *reg_flash(uint32_t slot) {
+    return (const flash_log_reg_t *)(uintptr_t)(XIP_BASE + LOG_OFFSET) + slot;
+}
+
+static bool reg_valido(const flash_log_reg_t *r) {
+    return r->seq != 0xFFFFFFFFu &&
+           crc16_ccitt(0xFFFF, (const uint8_t *)r, offsetof(flash_log_reg_t, crc)) == r->crc;
+}
+
+static bool regiao_apagada(uint32_t offset, uint32_t bytes) {
+    const uint32_t *p = (const uint32_t *)(uintptr_t)(XIP_BASE + LOG_OFFSET + offset);
+    for (uint32_t i = 0; i < bytes / 4; ++i) {
+        if (p[i] != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool setor_apagado(uint32_t setor) {
+    return regiao_apagada(setor * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+}
+
+/**
+ * @brief Sequência do primeiro registro do setor, ou false se ele não é válido.
+ */
+static bool cabeca_setor(uint32_t setor, uint32_t *seq) {
+    const flash_log_reg_t *r = reg_flash(setor * REGS_POR_SETOR);
+    if (!reg_valido(r)) {
+        return false;
+    }
+    *seq = r->seq;
+    return true;
+}
+
+/**
+ * @brief Busca binária do último setor escrito.
+ *
+ * Na ordem física, os setores são: a parte mais nova do anel (sequências
+ * crescentes a partir do setor 0), setores apagados e a parte mais antiga
+ * (crescente, mas toda menor que o setor 0). O último setor com cabeça
+ * válida e >= a do setor 0 é o mais novo.
+ * @return false se o log está vazio.
+ */
+static bool buscar_setor_mais_novo(uint32_t *setor) {
+    uint32_t base;
+    if (!cabeca_setor(0, &base)) {
+        // Setor 0 apagado: log vazio, ou a escrita parou no fim da região e o
+        // setor 0 foi apagado com antecedência
+        uint32_t seq;
+        if (cabeca_setor(FLASH_LOG_SETORES - 1, &seq)) {
+            *setor = FLASH_LOG_SETORES - 1;
+            return true;
+        }
+        return false;
+    }
+
+    uint32_t lo = 0, hi = FLASH_LOG_SETORES - 1; // Invariante: lo satisfaz
+    while (lo < hi) {
+        uint32_t meio = (lo + hi + 1) / 2;
+        uint32_t seq;
+        if (cabeca_setor(meio, &seq) && seq >= base) {
+            lo = meio;
+        } else {
+            hi = meio - 1;
+        }
+    }
+    *setor = lo;
+    return true;
+}
+
+/**
+ * @brief Último registro válido de um setor cujo primeiro registro é válido.
+ *
+ * Depois de um boot a escrita recomeça na página seguinte, então pode haver
+ * slots vazios no fim de uma página, mas o primeiro slot de toda página
+ * gravada é válido: a busca binária é feita pelas páginas e o final da
+ * última é percorrido em sequência.
+ */
+static uint32_t buscar_ultimo_slot(uint32_t setor) {
+    uint32_t lo = 0, hi = REGS_POR_SETOR / REGS_POR_PAGINA - 1;
+    uint32_t base = setor * REGS_POR_SETOR;
+    while (lo < hi) {
+        uint32_t meio = (lo + hi + 1) / 2;
+        if (reg_valido(reg_flash(base + meio * REGS_POR_PAGINA))) {
+            lo = meio;
+        } else {
+            hi = meio - 1;
+        }
+    }
+    uint32_t slot = base + lo * REGS_POR_PAGINA;
+    for (uint32_t i = 1; i < REGS_POR_PAGINA; ++i) {
+        if (reg_valido(reg_flash(base + lo * REGS_POR_PAGINA + i))) {
+            slot = base + lo * REGS_POR_PAGINA + i;
+        }
+    }
+    return slot;
+}
+
+static void apagar_setor(uint32_t setor) {
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_erase(LOG_OFFSET + setor * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    restore_interrupts(irq);
+    _stats.apagamentos++;
+    _setor_pronto = setor;
+    if (_apagar_setor == (int32_t)setor) {
+        _apagar_setor = SEM_SETOR;
+    }
+}
+
+static void gravar_pagina(void) {
+    uint32_t setor = _pagina_slot / REGS_POR_SETOR;
+    bool inicio_setor = _pagina_slot % REGS_POR_SETOR == 0;
+
+    if (inicio_setor && _setor_pronto != (int32_t)setor) {
+        apagar_setor(setor); // O antecipado não aconteceu a tempo
+    }
+
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_program(LOG_OFFSET + _pagina_slot * sizeof(flash_log_reg_t),
+                        (const uint8_t *)_pagina, FLASH_PAGE_SIZE);
+    restore_interrupts(irq);
+    _stats.paginas++;
+    _stats.gravados += _na_pagina;
+
+    if (inicio_setor) {
+        // Começou a usar este setor: o próximo é apagado com antecedência
+        _setor_pronto = SEM_SETOR;
+        _apagar_setor = (setor + 1) % FLASH_LOG_SETORES;
+    }
+
+    _pagina_slot = (_pagina_slot + REGS_POR_PAGINA) % LOG_REGS;
+    _na_pagina = 0;
+    memset(_pagina, 0xFF, sizeof(_pagina));
+}
+
+static void imprimir_reg(const flash_log_reg_t *r) {
+    printf("#%lu boot %u t=%lu ms radio %u de @%u RSSI %d SNR %.2f T %.1f H %d P %.1f\n",
+           (unsigned long)r->seq, r->reinicio, (unsigned long)r->tempo_ms, r->radio, r->remetente,
+           r->rssi, r->snr_x4 / 4.0f, r->temp_x10 / 10.0f, r->umid, r->pres_x10 / 10.0f);
+}
+
+static void avancar_dump(void) {
+    for (int i = 0; i < FLASH_LOG_DUMP_POR_PASSADA && _dump_restantes > 0; ++i) {
+        const flash_log_reg_t *r = reg_flash(_dump_slot);
+        if (reg_valido(r)) {
+            imprimir_reg(r);
+        }
+        _dump_slot = (_dump_slot + 1) % LOG_REGS;
+        _dump_restantes--;
+    }
+    if (_dump_restantes == 0) {
+        // Por último, os registros que ainda estão na RAM
+        for (uint8_t i = 0; i < _na_pagina; ++i) {
+            imprimir_reg(&_pagina[i]);
+        }
+        printf("Fim do log.\n");
+        _dump_ativo = false;
+    }
+}
+
+// ============================================================================
+// --- Funções Públicas ---
+// ============================================================================
+
+bool flash_log_init(bool (*radio_ocioso)(void)) {
+    memset(&_stats, 0, sizeof(_stats));
+    memset(_pagina, 0xFF, sizeof(_pagina));
+    _na_pagina = 0;
+    _radio_ocioso = radio_ocioso;
+    _apagar_setor = SEM_SETOR;
+    _setor_pronto = SEM_SETOR;
+    _dump_ativo = false;
+
+    _ativo = (uintptr_t)&__flash_binary_end <= XIP_BASE + LOG_OFFSET;
+    if (!_ativo) {
+        return false;
+    }
+
+    uint32_t setor;
+    if (!buscar_setor_mais_novo(&setor)) {
+        _seq = 0;
+        _stats.reinicio = 0;
+        _pagina_slot = 0;
+    } else {
+        const flash_log_reg_t *ultimo = reg_flash(buscar_ultimo_slot(setor));
+        _seq = ultimo->seq + 1;
+        _stats.reinicio = ultimo->reinicio + 1;
+        // Retoma na página seguinte à do último registro válido; uma página
+        // interrompida no meio da programação nunca é reprogramada
+        uint32_t slot = (uint32_t)(ultimo - reg_flash(0)) + 1;
+        _pagina_slot = ((slot + REGS_POR_PAGINA - 1) / REGS_POR_PAGINA * REGS_POR_PAGINA) % LOG_REGS;
+
+        // Página seguinte com restos de uma programação interrompida antes do
+        // primeiro registro: pulá-la deixaria uma página sem o primeiro slot
+        // válido entre duas gravadas, o que quebra a busca binária no setor.
+        // O resto do setor é abandonado e a escrita segue no próximo.
+        if (_pagina_slot % REGS_POR_SETOR != 0 &&
+            !regiao_apagada(_pagina_slot * sizeof(flash_log_reg_t), FLASH_PAGE_SIZE)) {
+            _pagina_slot = (_pagina_slot / REGS_POR_SETOR + 1) % FLASH_LOG_SETORES * REGS_POR_SETOR;
+        }
+    }
+
+    // O setor seguinte ao da escrita deve estar apagado antes de ser usado
+    uint32_t atual = _pagina_slot / REGS_POR_SETOR;
+    uint32_t proximo = _pagina_slot % REGS_POR_SETOR == 0 ? atual : (atual + 1) % FLASH_LOG_SETORES;
+    if (setor_apagado(proximo)) {
+        _setor_pronto = proximo;
+    } else {
+        _apagar_setor = proximo;
+    }
+    return true;
+}
+
+void flash_log_registrar(const log_pacote_t *pacote, uint8_t radio) {
+    if (!_ativo) {
+        return;
+    }
+    if (_na_pagina == REGS_POR_PAGINA) {
+        _stats.descartados++; // Página ainda esperando o rádio ficar ocioso
+        return;
+    }
+
+    flash_log_reg_t *r = &_pagina[_na_pagina++];
+    r->seq = _seq++;
+    r->tempo_ms = (uint32_t)(time_us_64() / 1000);
+    r->reinicio = _stats.reinicio;
+    r->remetente = pacote->remetente;
+    r->radio = radio;
+    r->rssi = pacote->rssi;
+    r->snr_x4 = pacote->snr_x4;
+    r->temp_x10 = pacote->temp_x10;
+    r->umid = pacote->umid;
+    r->pres_x10 = pacote->pres_x10;
+    memset(r->reservado, 0xFF, sizeof(r->reservado));
+    r->crc = crc16_ccitt(0xFFFF, (const uint8_t *)r, offsetof(flash_log_reg_t, crc));
+
+    if (_na_pagina == REGS_POR_PAGINA) {
+        _cheia_desde_us = time_us_64();
+    }
+}
+
+void flash_log_poll(void) {
+    if (!_ativo) {
+        return;
+    }
+
+    // Uma linha do dump no meio de um registro do log o corromperia
+    if (_dump_ativo && !log_ring_transmitindo()) {
+        avancar_dump();
+    }
+
+    // O apagamento antecipado é o do setor mais antigo, o primeiro do dump:
+    // espera o dump terminar
+    bool cheia = _na_pagina == REGS_POR_PAGINA;
+    if (!cheia && (_apagar_setor == SEM_SETOR || _dump_ativo)) {
+        return;
+    }
+
+    // Uma operação por passada; o apagamento antecipado só com o rádio ocioso
+    bool vencida = cheia && time_us_64() - _cheia_desde_us >= FLASH_LOG_ESPERA_MAX_MS * 1000ull;
+    if (_radio_ocioso != NULL && !_radio_ocioso()) {
+        if (!vencida) {
+            _stats.adiamentos++;
+            return;
+        }
+        _stats.forcados++;
+    }
+
+    if (cheia) {
+        gravar_pagina();
+    } else {
+        apagar_setor(_apagar_setor);
+    }
+}
+
+void flash_log_dump(void) {
+    if (!_ativo) {
+        printf("Log na flash desativado (regiao sobreposta ao programa).\n");
+        return;
+    }
+    printf("Log na flash: %u setores, boot %u, %lu gravados, %lu paginas, %lu apagamentos\n",
+           FLASH_LOG_SETORES, _stats.reinicio, (unsigned long)_stats.gravados,
+           (unsigned long)_stats.paginas, (unsigned long)_stats.apagamentos);
+    printf("Log na flash: %lu descartados, %lu forcados, %lu adiamentos\n",
+           (unsigned long)_stats.descartados, (unsigned long)_stats.forcados,
+           (unsigned long)_stats.adiamentos);
+
+    // Do setor seguinte ao da escrita (o mais antigo) até a posição atual
+    uint32_t inicio = (_pagina_slot / REGS_POR_SETOR + 1) % FLASH_LOG_SETORES * REGS_POR_SETOR;
+    _dump_slot = inicio;
+    _dump_restantes = (_pagina_slot + LOG_REGS - inicio) % LOG_REGS;
+    if (_dump_restantes == 0) {
+        _dump_restantes = LOG_REGS;
+    }
+    _dump_ativo = true;
+}
+
+flash_log_stats_t flash_log_stats(void) {
+    return _stats;
+}
@@ -0,0 +1,75 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "log_ring.h"
+
+// ============================================================================
+// --- Log persistente de telemetria na flash ---
+//
+// Anel de registros de 32 bytes nos últimos FLASH_LOG_SETORES setores da
+// flash. Os registros se acumulam em RAM e vão para a flash uma página
+// (256 B, 8 registros) por vez; cada setor (4 KB, 128 registros) é apagado
+// uma vez por volta do anel, com antecedência, num momento em que os rádios
+// estão ociosos.
+//
+// Cada registro tem número de sequência e CRC. Uma gravação interrompida
+// deixa no máximo uma página com CRC inválido, que é ignorada; no boot a
+// posição de escrita é encontrada por busca binária (primeiro entre os
+// setores, depois dentro do último) e retomada na página seguinte, ou no
+// setor seguinte se ela guarda restos da gravação interrompida. O
+// apagamento antecipado espera o fim de um dump em andamento.
+// tools/simular_flash_log.c exercita tudo isso com cortes de energia.
+//
+// Programar e apagar a flash suspende a execução a partir dela, então as
+// interrupções ficam desligadas durante a operação (~1 ms por página,
+// ~50 ms por setor). Por isso as operações só rodam no loop principal,
+// quando `radio_ocioso` confirma que nenhum pacote está chegando, ou
+// depois de FLASH_LOG_ESPERA_MAX_MS com uma página cheia esperando.
+// ============================================================================
+
+/**
+ * @brief Contadores do log persistente.
+ */
+typedef struct {
+    uint32_t gravados;          // Registros gravados na flash desde o boot
+    uint32_t paginas;           // Páginas programadas
+    uint32_t apagamentos;       // Setores apagados
+    uint32_t descartados;       // Registros perdidos com a página da RAM cheia
+    uint32_t forcados;          // Operações feitas com o rádio ocupado, após a espera máxima
+    uint32_t adiamentos;        // Passadas em que a operação esperou o rádio
+    uint16_t reinicio;          // Número deste boot (registrado em cada registro)
+} flash_log_stats_t;
+
+/**
+ * @brief Localiza o fim do log na flash e prepara a próxima página.
+ * @param radio_ocioso Consultada antes de cada operação na flash; NULL
+ *                     permite qualquer momento.
+ * @return false se a região do log se sobrepõe à imagem do programa
+ *         (o log fica desativado).
+ */
+bool flash_log_init(bool (*radio_ocioso)(void));
+
+/**
+ * @brief Acrescenta um pacote decodificado à página em RAM. Só no loop principal.
+ */
+void flash_log_registrar(const log_pacote_t *pacote, uint8_t radio);
+
+/**
+ * @brief Executa no máximo uma operação pendente na flash (gravar a página
+ *        cheia ou apagar o próximo setor) e avança o dump em andamento
+ *        (que espera o registro do log em envio terminar).
+ *        Deve ser chamada a cada passada do loop principal.
+ */
+void flash_log_poll(void);
+
+/**
+ * @brief Imprime os contadores e começa a enviar todos os registros, do mais
+ *        antigo ao mais novo, aos poucos em flash_log_poll().
+ */
+void flash_log_dump(void);
+
+flash_log_stats_t flash_log_stats(void);
+
+#endif // FLASH_LOG_H
@@ -0,0 +1,364 @@
+#include "fragmentos.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+
+#define FRAG_CABECALHO  2       // Transferência e índice
+#define FRAG_MAX        255     // Fragmentos por transferência (a base do SACK é um u8)
+#define SACK_BYTES      6
+
+typedef enum {
+    REMONTAGEM_LIVRE,
+    REMONTAGEM_RECEBENDO,
+    REMONTAGEM_CONCLUIDA,   // Mantida até expirar, para responder a pedidos de SACK repetidos
+} remontagem_estado_t;
+
+/**
+ * @brief Remontagem de uma transferência de um remetente.
+ */
+typedef struct {
+    uint8_t estado;
+    uint8_t remetente;
+    uint8_t transferencia;
+    uint8_t radio;          // Rádio do último fragmento, por onde sai o SACK
+    uint16_t total;         // Fragmentos da transferência (0 = último ainda não chegou)
+    uint16_t recebidos;
+    uint16_t tamanho;       // Bytes, conhecido com o último fragmento
+    bool sack_pendente;
+    uint32_t mapa[8];       // Bit i = fragmento i recebido
+    uint64_t ultimo_us;
+    uint8_t dados[FRAG_MAX_BYTES];
+} remontagem_t;
+
+static remontagem_t _remontagens[FRAG_SLOTS];
+static lora_radio_t *_radios = NULL;
+static uint8_t _num_radios = 0;
+static void (*_ao_completar)(uint8_t remetente, const uint8_t *dados, size_t tamanho) = NULL;
+static fragmentos_stats_t _stats;
+
+// Última transferência enviada por este nó. Sorteada no boot: recomeçando
+// do zero depois de um reset, a primeira transferência teria o número de
+// uma remontagem ainda concluída no receptor e seria tomada por duplicada.
+static uint8_t _transferencia;
+
+static inline bool bit_ligado(const uint32_t *mapa, uint16_t i) {
+    return mapa[i >> 5] & (1u << (i & 31));
+}
+
+static inline void ligar_bit(uint32_t *mapa, uint16_t i) {
+    mapa[i >> 5] |= 1u << (i & 31);
+}
+
+// ============================================================================
+// --- Lado receptor ---
+// ============================================================================
+
+/**
+ * @brief Remontagem do remetente; sem uma, a primeira livre ou, na falta,
+ *        a concluída mais antiga.
+ */
+static remontagem_t *remontagem_de(uint8_t remetente) {
+    remontagem_t *livre = NULL;
+    remontagem_t *concluida = NULL;
+    for (int i = 0; i < FRAG_SLOTS; ++i) {
+        remontagem_t *r = &_remontagens[i];
+        if (r->estado == REMONTAGEM_LIVRE) {
+            if (!livre) {
+                livre = r;
+            }
+        } else if (r->remetente == remetente) {
+            return r;
+        } else if (r->estado == REMONTAGEM_CONCLUIDA && (!concluida || r->ultimo_us < concluida->ultimo_us)) {
+            concluida = r;
+        }
+    }
+    if (!livre && concluida) {
+        concluida->estado = REMONTAGEM_LIVRE;
+        livre = concluida;
+    }
+    return livre;
+}
+
+/**
+ * @brief Transmite o SACK da remontagem; com o rádio ocupado fica pendente
+ *        para fragmentos_servico.
+ */
+static void enviar_sack(remontagem_t *r) {
+    if (r->radio >= _num_radios) {
+        r->sack_pendente = false;
+        return;
+    }
+    uint16_t base = 0;
+    while (base < FRAG_MAX && bit_ligado(r->mapa, base)) {
+        base++;
+    }
+    if (r->estado == REMONTAGEM_CONCLUIDA) {
+        base = r->total;
+    }
+    uint32_t mapa = 0;
+    for (uint16_t b = 0; b < 32 && base + b < FRAG_MAX; ++b) {
+        if (bit_ligado(r->mapa, base + b)) {
+            mapa |= 1u << b;
+        }
+    }
+    uint8_t msg[SACK_BYTES] = {
+        r->transferencia, (uint8_t)base,
+        (uint8_t)mapa, (uint8_t)(mapa >> 8), (uint8_t)(mapa >> 16), (uint8_t)(mapa >> 24),
+    };
+    if (lora_send_async(&_radios[r->radio], msg, sizeof(msg), r->remetente, FLAGS_ACK | FLAGS_FRAGMENT)) {
+        r->sack_pendente = false;
+        _stats.sacks++;
+    } else {
+        r->sack_pendente = true;
+        _stats.sacks_adiados++;
+    }
+}
+
+void fragmentos_init(lora_radio_t *radios, uint8_t num_radios) {
+    memset(_remontagens, 0, sizeof(_remontagens));
+    memset(&_stats, 0, sizeof(_stats));
+    _radios = radios;
+    _num_radios = num_radios;
+    _transferencia = (uint8_t)get_rand_32();
+}
+
+void fragmentos_ao_completar(void (*callback)(uint8_t remetente, const uint8_t *dados, size_t tamanho)) {
+    _ao_completar = callback;
+}
+
+bool fragmentos_receber(const lora_payload_t *pacote, uint64_t agora_us) {
+    if (!(pacote->header_flags & FLAGS_FRAGMENT)) {
+        return false;
+    }
+    if (pacote->length < FRAG_CABECALHO) {
+        _stats.invalidos++;
+        return true;
+    }
+    uint8_t transferencia = pacote->message[0];
+    uint8_t indice = pacote->message[1];
+    uint16_t n = pacote->length - FRAG_CABECALHO;
+    bool ultimo = pacote->header_flags & FLAGS_LAST_FRAGMENT;
+
+    // Todos os fragmentos menos o último têm FRAG_DADOS: o índice dá a posição
+    uint32_t posicao = (uint32_t)indice * FRAG_DADOS;
+    if (indice >= FRAG_MAX || n > FRAG_DADOS || (!ultimo && n != FRAG_DADOS) || posicao + n > FRAG_MAX_BYTES) {
+        _stats.invalidos++;
+        return true;
+    }
+
+    remontagem_t *r = remontagem_de(pacote->header_from);
+    if (!r) {
+        _stats.sem_slot++;
+        return true;
+    }
+    if (r->estado != REMONTAGEM_LIVRE && r->transferencia != transferencia) {
+        if (r->estado == REMONTAGEM_RECEBENDO) {
+            _stats.substituidas++;
+        }
+        r->estado = REMONTAGEM_LIVRE;
+    }
+    if (r->estado == REMONTAGEM_LIVRE) {
+        memset(r->mapa, 0, sizeof(r->mapa));
+        r->estado = REMONTAGEM_RECEBENDO;
+        r->remetente = pacote->header_from;
+        r->transferencia = transferencia;
+        r->total = 0;
+        r->recebidos = 0;
+        r->tamanho = 0;
+    }
+    if (r->total && indice >= r->total) {
+        _stats.invalidos++; // Além do último: de outra transferência com o mesmo número
+        return true;
+    }
+    r->radio = pacote->radio;
+    if (r->estado == REMONTAGEM_RECEBENDO) {
+        r->ultimo_us = agora_us; // Concluída expira a partir da conclusão, mesmo com duplicados chegando
+    }
+
+    if (bit_ligado(r->mapa, indice)) {
+        _stats.duplicados++;
+    } else {
+        memcpy(r->dados + posicao, pacote->message + FRAG_CABECALHO, n);
+        ligar_bit(r->mapa, indice);
+        r->recebidos++;
+        _stats.fragmentos++;
+    }
+    if (ultimo) {
+        r->total = indice + 1;
+        r->tamanho = (uint16_t)(posicao + n);
+    }
+
+    if (r->estado == REMONTAGEM_RECEBENDO && r->total && r->recebidos == r->total) {
+        r->estado = REMONTAGEM_CONCLUIDA;
+        _stats.concluidas++;
+        _stats.bytes += r->tamanho;
+        if (_ao_completar) {
+            _ao_completar(r->remetente, r->dados, r->tamanho);
+        }
+    }
+    if (pacote->header_flags & FLAGS_SACK_REQUEST) {
+        enviar_sack(r);
+    }
+    return true;
+}
+
+void fragmentos_servico(uint64_t agora_us) {
+    for (int i = 0; i < FRAG_SLOTS; ++i) {
+        remontagem_t *r = &_remontagens[i];
+        if (r->estado == REMONTAGEM_LIVRE) {
+            continue;
+        }
+        if (agora_us - r->ultimo_us > (uint64_t)FRAG_TIMEOUT_MS * 1000) {
+            if (r->estado == REMONTAGEM_RECEBENDO) {
+                _stats.expiradas++;
+            }
+            r->estado = REMONTAGEM_LIVRE;
+            r->sack_pendente = false;
+        } else if (r->sack_pendente) {
+            enviar_sack(r);
+        }
+    }
+}
+
+fragmentos_stats_t fragmentos_stats(void) {
+    return _stats;
+}
+
+void fragmentos_imprimir(void) {
+    fragmentos_stats_t s = _stats;
+    printf("Fragmentos: %lu novos, %lu duplicados, %lu invalidos, %lu sem remontagem livre\n",
+           (unsigned long)s.fragmentos, (unsigned long)s.duplicados,
+           (unsigned long)s.invalidos, (unsigned long)s.sem_slot);
+    printf("Transferencias: %lu concluidas (%lu bytes), %lu substituidas, %lu expiradas; "
+           "%lu SACKs (%lu adiados)\n",
+           (unsigned long)s.concluidas, (unsigned long)s.bytes, (unsigned long)s.substituidas,
+           (unsigned long)s.expiradas, (unsigned long)s.sacks, (unsigned long)s.sacks_adiados);
+    uint64_t agora = time_us_64();
+    for (int i = 0; i < FRAG_SLOTS; ++i) {
+        const remontagem_t *r = &_remontagens[i];
+        if (r->estado == REMONTAGEM_LIVRE) {
+            continue;
+        }
+        printf("@%-3u transferencia %3u: %u/%u fragmentos%s, ultimo ha %llu ms\n",
+               r->remetente, r->transferencia, r->recebidos, r->total,
+               r->estado == REMONTAGEM_CONCLUIDA ? " (concluida)" : r->total ? "" : " (ultimo pendente)",
+               (unsigned long long)((agora - r->ultimo_us) / 1000));
+    }
+}
+
+// ============================================================================
+// --- Lado transmissor ---
+// ============================================================================
+
+/**
+ * @brief Transmite um fragmento assim que o canal estiver livre e espera o
+ *        TxDone; o rádio volta sozinho à recepção contínua.
+ * @return false se o canal não liberar até `prazo_us`.
+ */
+static bool enviar_fragmento(lora_radio_t *radio, uint8_t destino, const uint8_t *msg, size_t len,
+                             uint8_t flags, uint64_t prazo_us) {
+    radio->last_header_id++;
+    while (!lora_send_async(radio, msg, len, destino, flags)) {
+        if (time_us_64() > prazo_us) {
+            return false;
+        }
+    }
+    uint64_t inicio_tx = time_us_64();
+    while (radio->current_mode == MODE_TX) {
+        if (time_us_64() - inicio_tx > 500000) { // Mesmo limite de lora_send_to_wait
+            break;
+        }
+    }
+    return true;
+}
+
+bool fragmentos_enviar(lora_radio_t *radio, uint8_t destino, const uint8_t *dados, size_t tamanho,
+                       fragmentos_envio_t *envio) {
+    fragmentos_envio_t e = {0};
+    if (tamanho == 0 || tamanho > (size_t)FRAG_MAX * FRAG_DADOS || destino == BROADCAST_ADDRESS) {
+        return false;
+    }
+    uint16_t total = (tamanho + FRAG_DADOS - 1) / FRAG_DADOS;
+    uint8_t transferencia = ++_transferencia;
+    uint32_t confirmados[8] = {0};
+    uint16_t base = 0;
+    uint8_t sem_progresso = 0;
+    bool ok = false;
+    uint64_t inicio = time_us_64();
+    e.fragmentos = total;
+
+    while (sem_progresso < FRAG_TENTATIVAS) {
+        // Fragmentos não confirmados da janela; o último deles pede o SACK
+        uint16_t fim = base + FRAG_JANELA < total ? base + FRAG_JANELA : total;
+        uint16_t pedido = fim - 1;
+        while (bit_ligado(confirmados, pedido)) {
+            pedido--; // Para em `base`, que nunca está confirmado
+        }
+        radio->ack_received = false;
+        uint64_t prazo = time_us_64() + (uint64_t)FRAG_ESPERA_MS * 1000;
+        for (uint16_t i = base; i <= pedido; ++i) {
+            if (bit_ligado(confirmados, i)) {
+                continue;
+            }
+            uint8_t msg[FRAG_CABECALHO + FRAG_DADOS];
+            size_t n = i == total - 1 ? tamanho - (size_t)i * FRAG_DADOS : FRAG_DADOS;
+            msg[0] = transferencia;
+            msg[1] = (uint8_t)i;
+            memcpy(msg + FRAG_CABECALHO, dados + (size_t)i * FRAG_DADOS, n);
+            uint8_t flags = FLAGS_FRAGMENT | (i == total - 1 ? FLAGS_LAST_FRAGMENT : 0) |
+                            (i == pedido ? FLAGS_SACK_REQUEST : 0);
+            if (enviar_fragmento(radio, destino, msg, FRAG_CABECALHO + n, flags, prazo)) {
+                e.enviados++;
+            }
+        }
+
+        // Espera o SACK desta transferência
+        bool sack = false;
+        uint64_t inicio_espera = time_us_64();
+        while (time_us_64() - inicio_espera < (uint64_t)FRAG_ESPERA_MS * 1000) {
+            if (radio->ack_received) {
+                const lora_payload_t *a = &radio->last_ack_payload;
+                if ((a->header_flags & FLAGS_FRAGMENT) && a->header_from == destino &&
+                    a->length >= SACK_BYTES && a->message[0] == transferencia) {
+                    sack = true;
+                    break;
+                }
+                radio->ack_received = false; // ACK de outra coisa: continua esperando
+            }
+        }
+        if (!sack) {
+            e.esperas++;
+            sem_progresso++;
+            continue;
+        }
+        e.sacks++;
+
+        const uint8_t *m = radio->last_ack_payload.message;
+        uint16_t base_rx = m[1];
+        uint32_t mapa = m[2] | (uint32_t)m[3] << 8 | (uint32_t)m[4] << 16 | (uint32_t)m[5] << 24;
+        bool progresso = false;
+        for (uint16_t i = 0; i < total; ++i) {
+            bool chegou = i < base_rx || (i - base_rx < 32 && (mapa & (1u << (i - base_rx))));
+            if (chegou && !bit_ligado(confirmados, i)) {
+                ligar_bit(confirmados, i);
+                progresso = true;
+            }
+        }
+        while (base < total && bit_ligado(confirmados, base)) {
+            base++;
+        }
+        if (base == total) {
+            ok = true;
+            break;
+        }
+        sem_progresso = progresso ? 0 : sem_progresso + 1;
+    }
+
+    lora_set_mode_rx_continuous(radio); // Retorna ao modo de escuta
+    e.duracao_ms = (uint32_t)((time_us_64() - inicio) / 1000);
+    if (envio) {
+        *envio = e;
+    }
+    return ok;
+}
@@ -0,0 +1,115 @@
+#ifndef FRAGMENTOS_H
+#define FRAGMENTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "lora.h"
+#include "config.h"
+
+// ============================================================================
+// --- Transferências maiores que um quadro (fragmentação e remontagem) ---
+//
+// A transferência é dividida em fragmentos de FRAG_DADOS bytes (o último
+// pode ser menor), cada um num quadro com FLAGS_FRAGMENT e a mensagem:
+//
+//     transferência (u8) | índice (u8) | dados
+//
+// O byte de flags não tem bits livres para o índice (ACK, SECURE e BEACON
+// já usam os altos), então só as marcas ficam nele: FLAGS_LAST_FRAGMENT no
+// último da transferência e FLAGS_SACK_REQUEST no último de cada janela.
+// São até 255 fragmentos; o receptor aceita até FRAG_MAX_BYTES.
+//
+// O transmissor envia os fragmentos ainda não confirmados de uma janela de
+// FRAG_JANELA e espera o SACK, um ACK (FLAGS_ACK | FLAGS_FRAGMENT) com:
+//
+//     transferência | base (u8) | mapa (u32, little-endian)
+//
+// `base` é o primeiro fragmento que falta (todos os anteriores chegaram) e
+// o bit i do mapa indica o fragmento base + i. Com a transferência
+// completa, base é o número de fragmentos. Um SACK perdido é pedido de
+// novo pelo mesmo fragmento depois de FRAG_ESPERA_MS.
+//
+// O receptor guarda uma remontagem por remetente, num conjunto fixo de
+// FRAG_SLOTS; uma transferência nova do mesmo remetente substitui a
+// anterior. Remontagens sem fragmentos novos por FRAG_TIMEOUT_MS são
+// descartadas; as concluídas, FRAG_TIMEOUT_MS depois da conclusão (os
+// duplicados não as prolongam). Tudo roda no loop principal (fila de recepção), depois de
+// seguranca_abrir: fragmentos cifrados são aceitos como os demais quadros.
+// Fragmentos não recebem o ACK automático do driver.
+// ============================================================================
+
+/**
+ * @brief Contadores do lado receptor.
+ */
+typedef struct {
+    uint32_t fragmentos;    // Fragmentos novos guardados
+    uint32_t duplicados;    // Já recebidos (SACK perdido ou retransmissão)
+    uint32_t invalidos;     // Curtos, fora de FRAG_MAX_BYTES ou de tamanho errado
+    uint32_t sem_slot;      // Descartados: todas as remontagens ocupadas
+    uint32_t concluidas;
+    uint32_t substituidas;  // Incompletas trocadas por uma transferência nova do remetente
+    uint32_t expiradas;     // Incompletas descartadas por FRAG_TIMEOUT_MS
+    uint32_t sacks;         // SACKs transmitidos
+    uint32_t sacks_adiados; // Rádio ocupado: SACK tentado de novo em fragmentos_servico
+    uint32_t bytes;         // Bytes entregues em transferências concluídas
+} fragmentos_stats_t;
+
+/**
+ * @brief Resultado de um envio (lado transmissor).
+ */
+typedef struct {
+    uint16_t fragmentos;    // Fragmentos da transferência
+    uint16_t enviados;      // Quadros transmitidos, com as retransmissões
+    uint16_t sacks;         // SACKs recebidos
+    uint16_t esperas;       // Janelas sem SACK dentro de FRAG_ESPERA_MS
+    uint32_t duracao_ms;
+} fragmentos_envio_t;
+
+/**
+ * @brief Zera as remontagens, guarda os rádios pelos quais os SACKs saem (o
+ *        índice é lora_payload_t.radio) e sorteia o número da próxima
+ *        transferência enviada. Chamar também nos nós que só transmitem.
+ */
+void fragmentos_init(lora_radio_t *radios, uint8_t num_radios);
+
+/**
+ * @brief Define a função chamada com cada transferência remontada. O buffer
+ *        só vale durante a chamada.
+ */
+void fragmentos_ao_completar(void (*callback)(uint8_t remetente, const uint8_t *dados, size_t tamanho));
+
+/**
+ * @brief Trata um pacote retirado da fila de recepção.
+ * @return false se o pacote não é um fragmento (segue o processamento normal).
+ */
+bool fragmentos_receber(const lora_payload_t *pacote, uint64_t agora_us);
+
+/**
+ * @brief Reenvia os SACKs adiados e descarta as remontagens expiradas.
+ *        Chamar periodicamente do loop principal.
+ */
+void fragmentos_servico(uint64_t agora_us);
+
+/**
+ * @brief Copia os contadores do lado receptor.
+ */
+fragmentos_stats_t fragmentos_stats(void);
+
+/**
+ * @brief Imprime no console os contadores e as remontagens em andamento.
+ */
+void fragmentos_imprimir(void);
+
+/**
+ * @brief Lado transmissor: envia `tamanho` bytes a `destino` em fragmentos,
+ *        com janelas e SACKs. Bloqueia até a confirmação completa, como
+ *        lora_send_to_wait; o rádio volta à recepção contínua no fim.
+ * @param envio Preenchido com os contadores do envio (pode ser NULL).
+ * @return false se a transferência não couber em 255 fragmentos ou se
+ *         FRAG_TENTATIVAS janelas seguidas terminarem sem progresso.
+ */
+bool fragmentos_enviar(lora_radio_t *radio, uint8_t destino, const uint8_t *dados, size_t tamanho,
+                       fragmentos_envio_t *envio);
+
+#endif // FRAGMENTOS_H
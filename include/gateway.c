@@ -0,0 +1,232 @@
+#include "gateway.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "config.h"
+#include "crc.h"
+#include "log_ring.h"
+#include "caminho_quente.h"
+
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#endif
+
+#define LOTE_MAGICO_0     0xA5
+#define LOTE_MAGICO_1     0x5A
+#define LOTE_CABECALHO    15  // magico(2) + seq(2) + quadros(1) + tam(2) + base(8)
+#define REGISTRO_FIXO     11  // tam(1) + de/para/id/flags(4) + rssi(2) + snr(1) + dt(4)
+
+#if (GATEWAY_FILA_QUADROS & (GATEWAY_FILA_QUADROS - 1)) != 0
+#error "GATEWAY_FILA_QUADROS deve ser potência de 2"
+#endif
+
+#if GATEWAY_LOTE_MAX < LOTE_CABECALHO + REGISTRO_FIXO + 251 + 2
+#error "GATEWAY_LOTE_MAX precisa comportar ao menos um quadro completo"
+#endif
+
+// ============================================================================
+// --- Fila ISR -> loop principal ---
+// ============================================================================
+
+typedef struct {
+    uint64_t timestamp_us;
+    uint8_t de, para, id, flags;
+    int16_t rssi;
+    int8_t snr_x4;
+    uint8_t tamanho;
+    uint8_t dados[251];
+} gateway_quadro_t;
+
+static gateway_quadro_t _fila[GATEWAY_FILA_QUADROS];
+static volatile uint32_t _cabeca = 0;  // Escrito apenas pela ISR
+static volatile uint32_t _cauda = 0;   // Escrito apenas pelo loop principal
+
+// ============================================================================
+// --- Lotes (buffer duplo: um em montagem, outro em envio) ---
+// ============================================================================
+
+typedef struct {
+    uint8_t dados[GATEWAY_LOTE_MAX];
+    uint16_t tamanho;     // Bytes válidos (inclui cabeçalho e, se fechado, o CRC)
+    uint16_t enviados;    // Bytes já entregues ao stdio
+    uint8_t quadros;
+    uint64_t base_us;     // Timestamp do primeiro quadro
+    uint64_t aberto_us;   // Instante em que o primeiro quadro entrou no lote
+} gateway_lote_t;
+
+static gateway_lote_t _lotes[2];
+static gateway_lote_t *_montagem = &_lotes[0];
+static gateway_lote_t *_envio = NULL;  // NULL = nenhum lote em envio
+static uint16_t _seq_lote = 0;
+
+static gateway_stats_t _stats;
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+    return p;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    p = put_u16(p, v & 0xFFFF);
+    return put_u16(p, v >> 16);
+}
+
+static void lote_abrir(gateway_lote_t *lote) {
+    lote->tamanho = LOTE_CABECALHO;
+    lote->enviados = 0;
+    lote->quadros = 0;
+}
+
+/**
+ * @brief Acrescenta um quadro ao lote em montagem.
+ * @return false se o quadro não couber (o lote deve ser fechado antes).
+ */
+static bool lote_acrescentar(gateway_lote_t *lote, const gateway_quadro_t *q) {
+    if (lote->tamanho + REGISTRO_FIXO + q->tamanho + 2 > GATEWAY_LOTE_MAX || lote->quadros == 0xFF) {
+        return false;
+    }
+    if (lote->quadros == 0) {
+        lote->base_us = q->timestamp_us;
+        lote->aberto_us = time_us_64();
+    }
+
+    uint8_t *p = &lote->dados[lote->tamanho];
+    *p++ = q->tamanho;
+    *p++ = q->de;
+    *p++ = q->para;
+    *p++ = q->id;
+    *p++ = q->flags;
+    p = put_u16(p, q->rssi);
+    *p++ = (uint8_t)q->snr_x4;
+    p = put_u32(p, (uint32_t)(q->timestamp_us - lote->base_us));
+    memcpy(p, q->dados, q->tamanho);
+
+    lote->tamanho += REGISTRO_FIXO + q->tamanho;
+    lote->quadros++;
+    return true;
+}
+
+/**
+ * @brief Preenche o cabeçalho e o CRC do lote.
+ */
+static void lote_fechar(gateway_lote_t *lote) {
+    uint8_t *p = lote->dados;
+    *p++ = LOTE_MAGICO_0;
+    *p++ = LOTE_MAGICO_1;
+    p = put_u16(p, _seq_lote++);
+    *p++ = lote->quadros;
+    p = put_u16(p, lote->tamanho - LOTE_CABECALHO);
+    p = put_u32(p, (uint32_t)lote->base_us);
+    put_u32(p, (uint32_t)(lote->base_us >> 32));
+
+    uint16_t crc = crc16_ccitt(0xFFFF, &lote->dados[2], lote->tamanho - 2);
+    put_u16(&lote->dados[lote->tamanho], crc);
+    lote->tamanho += 2;
+}
+
+/**
+ * @brief Quantos bytes o enlace com o host aceita agora sem bloquear.
+ */
+static uint32_t enlace_espaco(void) {
+#if LIB_PICO_STDIO_USB
+    if (!stdio_usb_connected()) {
+        return 0;
+    }
+    return tud_cdc_write_available();
+#else
+    return GATEWAY_ORCAMENTO_BYTES;
+#endif
+}
+
+// ============================================================================
+// --- Funções Públicas ---
+// ============================================================================
+
+void gateway_init(void) {
+    _cabeca = _cauda = 0;
+    _montagem = &_lotes[0];
+    _envio = NULL;
+    lote_abrir(_montagem);
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void CAMINHO_QUENTE(gateway_encaminhar)(const lora_payload_t *payload) {
+    _stats.quadros_recebidos++;
+
+    uint32_t ocupacao = _cabeca - _cauda;
+    if (ocupacao >= GATEWAY_FILA_QUADROS) {
+        _stats.quadros_descartados++; // O host não está dando conta
+        return;
+    }
+    if (ocupacao + 1 > _stats.fila_max) {
+        _stats.fila_max = ocupacao + 1;
+    }
+
+    gateway_quadro_t *q = &_fila[_cabeca & (GATEWAY_FILA_QUADROS - 1)];
+    q->timestamp_us = payload->rx_timestamp_us;
+    q->de = payload->header_from;
+    q->para = payload->header_to;
+    q->id = payload->header_id;
+    q->flags = payload->header_flags;
+    q->rssi = (int16_t)payload->rssi;
+    q->snr_x4 = payload->snr_x4;
+    q->tamanho = payload->length;
+    memcpy(q->dados, payload->message, payload->length);
+
+    __dmb(); // Conteúdo visível antes do índice
+    _cabeca++;
+}
+
+void gateway_poll(void) {
+    // 1. Move quadros da fila para o lote em montagem
+    while (_cauda != _cabeca) {
+        __dmb();
+        const gateway_quadro_t *q = &_fila[_cauda & (GATEWAY_FILA_QUADROS - 1)];
+        if (!lote_acrescentar(_montagem, q)) {
+            break; // Lote cheio: precisa ser fechado primeiro
+        }
+        __dmb();
+        _cauda++;
+        _stats.quadros_encaminhados++;
+    }
+
+    // 2. Fecha o lote por tamanho (ou quadro que não coube) ou por idade
+    if (_montagem->quadros > 0 && _envio == NULL) {
+        bool por_tamanho = _montagem->tamanho >= GATEWAY_LOTE_LIMIAR || _cauda != _cabeca;
+        bool por_tempo = time_us_64() - _montagem->aberto_us >= GATEWAY_LOTE_MS * 1000ull;
+        if (por_tamanho || por_tempo) {
+            lote_fechar(_montagem);
+            if (por_tamanho) _stats.lotes_por_tamanho++; else _stats.lotes_por_tempo++;
+            _envio = _montagem;
+            _montagem = (_montagem == &_lotes[0]) ? &_lotes[1] : &_lotes[0];
+            lote_abrir(_montagem);
+        }
+    }
+
+    // 3. Envia o que o enlace aceitar, sem intercalar com o canal de log
+    if (_envio == NULL || (_envio->enviados == 0 && log_ring_transmitindo())) {
+        return;
+    }
+    uint32_t espaco = enlace_espaco();
+    if (espaco == 0) {
+        _stats.esperas_enlace++;
+        return;
+    }
+    uint32_t n = _envio->tamanho - _envio->enviados;
+    if (n > espaco) n = espaco;
+    stdio_put_string((const char *)&_envio->dados[_envio->enviados], n, false, false);
+    _envio->enviados += n;
+    _stats.bytes_enviados += n;
+    if (_envio->enviados == _envio->tamanho) {
+        _envio = NULL;
+    }
+}
+
+bool gateway_transmitindo(void) {
+    return _envio != NULL && _envio->enviados > 0;
+}
+
+gateway_stats_t gateway_stats(void) {
+    return _stats;
+}
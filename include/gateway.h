@@ -0,0 +1,65 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora.h"
+
+// ============================================================================
+// --- Modo gateway: encaminhamento em lotes para o host ---
+//
+// Todo quadro recebido é enfileirado pela ISR e agrupado pelo loop principal
+// em lotes binários, enviados quando atingem GATEWAY_LOTE_LIMIAR bytes ou
+// GATEWAY_LOTE_MS de idade. Formato (little-endian):
+//
+//   Lote:    [0xA5 0x5A][seq u16][quadros u8][tam_corpo u16][base_us u64]
+//            [registro...][crc16 u16]       (CRC sobre seq..último registro)
+//   Registro:[tam_payload u8][de u8][para u8][id u8][flags u8][rssi i16]
+//            [snr_x4 i8][dt_us u32][payload...]
+//
+// `dt_us` é relativo a `base_us`, o instante do primeiro quadro do lote.
+// Use tools/consumidor_gateway.py para validar o fluxo no host.
+// ============================================================================
+
+/**
+ * @brief Contadores do encaminhamento, incluindo a contrapressão do enlace.
+ */
+typedef struct {
+    uint32_t quadros_recebidos;    // Quadros entregues pela ISR
+    uint32_t quadros_descartados;  // Perdidos com a fila cheia (host lento)
+    uint32_t quadros_encaminhados; // Quadros já colocados em lotes
+    uint32_t lotes_por_tamanho;    // Lotes fechados pelo limiar de bytes
+    uint32_t lotes_por_tempo;      // Lotes fechados pelo limiar de tempo
+    uint32_t bytes_enviados;       // Bytes entregues ao stdio
+    uint32_t esperas_enlace;       // Passadas em que o enlace não tinha espaço
+    uint32_t fila_max;             // Maior ocupação observada da fila
+} gateway_stats_t;
+
+/**
+ * @brief Zera a fila, os lotes e os contadores.
+ */
+void gateway_init(void);
+
+/**
+ * @brief Enfileira um quadro para encaminhamento. Chamada pela ISR; nunca bloqueia.
+ */
+void gateway_encaminhar(const lora_payload_t *payload);
+
+/**
+ * @brief Monta lotes a partir da fila e envia o que o enlace aceitar sem
+ *        bloquear. Deve ser chamada a cada passada do loop principal.
+ */
+void gateway_poll(void);
+
+/**
+ * @brief Indica se há um lote parcialmente enviado. Enquanto isso, nenhuma
+ *        outra saída deve escrever no stdio para não intercalar bytes.
+ */
+bool gateway_transmitindo(void);
+
+/**
+ * @brief Retorna uma cópia dos contadores.
+ */
+gateway_stats_t gateway_stats(void);
+
+#endif // GATEWAY_H
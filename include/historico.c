@@ -0,0 +1,52 @@
+#include "historico.h"
+
+void historico_init(historico_t *hist, uint16_t amostras_por_bucket) {
+    hist->proximo = 0;
+    hist->quantidade = 0;
+    hist->total = 0;
+    hist->amostras_por_bucket = amostras_por_bucket > 0 ? amostras_por_bucket : 1;
+    hist->amostras_atual = 0;
+}
+
+bool historico_adicionar(historico_t *hist, int16_t valor) {
+    if (hist->amostras_atual == 0) {
+        hist->atual.min = valor;
+        hist->atual.max = valor;
+    } else {
+        if (valor < hist->atual.min) hist->atual.min = valor;
+        if (valor > hist->atual.max) hist->atual.max = valor;
+    }
+
+    if (++hist->amostras_atual < hist->amostras_por_bucket) {
+        return false;
+    }
+
+    // Fecha o bucket e sobrescreve o mais antigo quando o buffer está cheio
+    hist->buckets[hist->proximo] = hist->atual;
+    hist->proximo = (hist->proximo + 1) % HISTORICO_COLUNAS;
+    if (hist->quantidade < HISTORICO_COLUNAS) {
+        hist->quantidade++;
+    }
+    hist->total++;
+    hist->amostras_atual = 0;
+    return true;
+}
+
+const historico_bucket_t *historico_bucket(const historico_t *hist, uint16_t i) {
+    uint16_t inicio = (hist->proximo + HISTORICO_COLUNAS - hist->quantidade) % HISTORICO_COLUNAS;
+    return &hist->buckets[(inicio + i) % HISTORICO_COLUNAS];
+}
+
+bool historico_faixa(const historico_t *hist, int16_t *min, int16_t *max) {
+    if (hist->quantidade == 0) {
+        return false;
+    }
+    *min = INT16_MAX;
+    *max = INT16_MIN;
+    for (uint16_t i = 0; i < hist->quantidade; ++i) {
+        const historico_bucket_t *b = historico_bucket(hist, i);
+        if (b->min < *min) *min = b->min;
+        if (b->max > *max) *max = b->max;
+    }
+    return true;
+}
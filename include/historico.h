@@ -0,0 +1,61 @@
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+/**
+ * @brief Uma coluna do histórico: menor e maior amostra do intervalo.
+ *
+ * Os valores são inteiros em ponto fixo; a escala depende da métrica
+ * (ex.: temperatura em décimos de grau, SNR em quartos de dB).
+ */
+typedef struct {
+    int16_t min;
+    int16_t max;
+} historico_bucket_t;
+
+/**
+ * @brief Buffer circular de amostras subamostradas de uma métrica.
+ *
+ * Cada `amostras_por_bucket` amostras são resumidas em um bucket com o
+ * mínimo e o máximo do intervalo. Apenas os últimos HISTORICO_COLUNAS
+ * buckets são mantidos.
+ */
+typedef struct {
+    historico_bucket_t buckets[HISTORICO_COLUNAS];
+    uint16_t proximo;             // Posição onde o próximo bucket será gravado
+    uint16_t quantidade;          // Buckets válidos no buffer
+    uint32_t total;               // Buckets fechados desde a inicialização
+    uint16_t amostras_por_bucket; // Fator de subamostragem
+    historico_bucket_t atual;     // Bucket em formação
+    uint16_t amostras_atual;      // Amostras já acumuladas no bucket em formação
+} historico_t;
+
+/**
+ * @brief Inicializa (ou zera) um histórico.
+ * @param hist Ponteiro para o histórico.
+ * @param amostras_por_bucket Quantas amostras formam um bucket (mínimo 1).
+ */
+void historico_init(historico_t *hist, uint16_t amostras_por_bucket);
+
+/**
+ * @brief Acrescenta uma amostra ao bucket em formação.
+ * @return true se a amostra fechou um bucket novo.
+ */
+bool historico_adicionar(historico_t *hist, int16_t valor);
+
+/**
+ * @brief Retorna o i-ésimo bucket fechado, onde 0 é o mais antigo.
+ *        O índice deve ser menor que `hist->quantidade`.
+ */
+const historico_bucket_t *historico_bucket(const historico_t *hist, uint16_t i);
+
+/**
+ * @brief Calcula o menor mínimo e o maior máximo entre os buckets guardados.
+ * @return false se o histórico ainda está vazio.
+ */
+bool historico_faixa(const historico_t *hist, int16_t *min, int16_t *max);
+
+#endif // HISTORICO_H
@@ -0,0 +1,124 @@
+#include "latencia.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// Buckets em potências de 2 de microssegundos: o bucket i conta amostras em
+// [2^i, 2^(i+1)) us. O último acumula tudo acima de ~8 s.
+#define LAT_BUCKETS 24
+
+typedef struct {
+    uint32_t contagem;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t soma_us;
+    uint32_t buckets[LAT_BUCKETS];
+} latencia_hist_t;
+
+static const char *const _nomes[LAT_NUM_ETAPAS] = {
+    [LAT_IRQ_FILA]            = "irq->fila",
+    [LAT_FILA_DECODIFICADO]   = "fila->decod",
+    [LAT_DECODIFICADO_RENDER] = "decod->render",
+    [LAT_RENDER_FLUSH]        = "render->flush",
+    [LAT_RADIO_TELA]          = "radio->tela",
+};
+
+static latencia_hist_t _hist[LAT_NUM_ETAPAS];
+
+// Pacote mais recente ainda não exibido, e o que está sendo desenhado
+static bool _pendente = false;
+static uint64_t _pendente_irq, _pendente_decodificado;
+static bool _em_render = false;
+static uint64_t _render_irq, _render_inicio;
+
+static void hist_adicionar(latencia_etapa_t etapa, uint64_t inicio, uint64_t fim) {
+    latencia_hist_t *h = &_hist[etapa];
+    uint32_t us = fim > inicio ? (uint32_t)(fim - inicio) : 0;
+
+    // Índice do bucket = posição do bit mais significativo
+    int b = us > 0 ? 31 - __builtin_clz(us) : 0;
+    if (b >= LAT_BUCKETS) b = LAT_BUCKETS - 1;
+
+    if (h->contagem == 0 || us < h->min_us) h->min_us = us;
+    if (us > h->max_us) h->max_us = us;
+    h->soma_us += us;
+    h->contagem++;
+    h->buckets[b]++;
+}
+
+/**
+ * @brief Limite superior (em us) do bucket que contém o percentil `pct`.
+ */
+static uint32_t hist_percentil(const latencia_hist_t *h, uint32_t pct) {
+    uint32_t alvo = (h->contagem * pct + 99) / 100;
+    uint32_t acumulado = 0;
+    for (int b = 0; b < LAT_BUCKETS; ++b) {
+        acumulado += h->buckets[b];
+        if (acumulado >= alvo) {
+            return (2u << b) - 1;
+        }
+    }
+    return h->max_us;
+}
+
+void latencia_init(void) {
+    for (int i = 0; i < LAT_NUM_ETAPAS; ++i) {
+        _hist[i] = (latencia_hist_t){0};
+    }
+    _pendente = false;
+    _em_render = false;
+}
+
+void latencia_pacote_decodificado(uint64_t t_irq, uint64_t t_fila, uint64_t t_decodificado) {
+    hist_adicionar(LAT_IRQ_FILA, t_irq, t_fila);
+    hist_adicionar(LAT_FILA_DECODIFICADO, t_fila, t_decodificado);
+
+    _pendente = true;
+    _pendente_irq = t_irq;
+    _pendente_decodificado = t_decodificado;
+}
+
+void latencia_render_inicio(void) {
+    // Quadros sem pacote novo (ex.: troca de página) não entram na conta
+    _em_render = _pendente;
+    if (!_pendente) return;
+
+    _pendente = false;
+    _render_irq = _pendente_irq;
+    _render_inicio = time_us_64();
+    hist_adicionar(LAT_DECODIFICADO_RENDER, _pendente_decodificado, _render_inicio);
+}
+
+void latencia_render_fim(void) {
+    if (!_em_render) return;
+
+    uint64_t agora = time_us_64();
+    hist_adicionar(LAT_RENDER_FLUSH, _render_inicio, agora);
+    hist_adicionar(LAT_RADIO_TELA, _render_irq, agora);
+    _em_render = false;
+}
+
+void latencia_imprimir(void) {
+    printf("--- Latencias (us) ---\n");
+    printf("%-14s %8s %8s %8s %8s %8s %8s\n", "etapa", "n", "min", "media", "p50<=", "p99<=", "max");
+    for (int i = 0; i < LAT_NUM_ETAPAS; ++i) {
+        const latencia_hist_t *h = &_hist[i];
+        if (h->contagem == 0) {
+            printf("%-14s %8u\n", _nomes[i], 0u);
+            continue;
+        }
+        printf("%-14s %8lu %8lu %8lu %8lu %8lu %8lu\n", _nomes[i],
+               (unsigned long)h->contagem, (unsigned long)h->min_us,
+               (unsigned long)(h->soma_us / h->contagem),
+               (unsigned long)hist_percentil(h, 50), (unsigned long)hist_percentil(h, 99),
+               (unsigned long)h->max_us);
+    }
+
+    // Histograma ponta a ponta
+    const latencia_hist_t *e2e = &_hist[LAT_RADIO_TELA];
+    for (int b = 0; b < LAT_BUCKETS; ++b) {
+        if (e2e->buckets[b] > 0) {
+            printf("  radio->tela < %8lu us: %lu\n", (unsigned long)(2u << b), (unsigned long)e2e->buckets[b]);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef LATENCIA_H
+#define LATENCIA_H
+
+#include <stdint.h>
+
+/**
+ * @brief Trechos medidos entre a borda de DIO0 e a tela atualizada.
+ */
+typedef enum {
+    LAT_IRQ_FILA,             // Borda de DIO0 -> pacote copiado pelo loop principal
+    LAT_FILA_DECODIFICADO,    // Cópia -> texto decodificado
+    LAT_DECODIFICADO_RENDER,  // Decodificado -> início do quadro (espera no escalonador)
+    LAT_RENDER_FLUSH,         // Início do quadro -> buffer enviado pelo I2C
+    LAT_RADIO_TELA,           // Ponta a ponta: borda de DIO0 -> tela atualizada
+    LAT_NUM_ETAPAS
+} latencia_etapa_t;
+
+/**
+ * @brief Zera todos os histogramas.
+ */
+void latencia_init(void);
+
+/**
+ * @brief Registra um pacote decodificado e os instantes de cada etapa até aqui.
+ *
+ * O pacote fica pendente até o próximo quadro do display. Se outro pacote
+ * chegar antes, o anterior nunca aparece na tela e só entra nos
+ * histogramas das duas primeiras etapas.
+ * @param t_irq Instante da interrupção (lora_payload_t.rx_timestamp_us).
+ * @param t_fila Instante em que o loop principal copiou o pacote.
+ * @param t_decodificado Instante em que a decodificação terminou.
+ */
+void latencia_pacote_decodificado(uint64_t t_irq, uint64_t t_fila, uint64_t t_decodificado);
+
+/**
+ * @brief Marca o início de um quadro do display.
+ */
+void latencia_render_inicio(void);
+
+/**
+ * @brief Marca o fim do envio do quadro ao display.
+ */
+void latencia_render_fim(void);
+
+/**
+ * @brief Imprime no console os histogramas de todas as etapas.
+ */
+void latencia_imprimir(void);
+
+#endif // LATENCIA_H
@@ -1,76 +1,334 @@
 #include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include <stdio.h>
 #include "led_rgb.h"
 #include "config.h"
 
+// Slice e canal (A = bits 0-15 do CC, B = bits 16-31) de cada pino
+#define LED_SLICE(pino) (((pino) >> 1) & 7u)
+
+// Os três pinos precisam caber em duas slices: uma palavra de CC por slice
+#if LED_SLICE(LED_RED_PIN) != LED_SLICE(LED_GREEN_PIN) && LED_SLICE(LED_RED_PIN) != LED_SLICE(LED_BLUE_PIN) \
+    && LED_SLICE(LED_GREEN_PIN) != LED_SLICE(LED_BLUE_PIN)
+#error "LED_RED_PIN, LED_GREEN_PIN e LED_BLUE_PIN ocupam três slices de PWM"
+#endif
+
+// Duração em quadros do sequenciador
+#define QUADROS_MS(ms) (((ms) * LED_SEQ_HZ + 999) / 1000)
+
+#define PISCA_QUADROS   QUADROS_MS(LED_PISCA_MS)
+#define FADE_QUADROS    QUADROS_MS(LED_FADE_MS)
+#define PACOTE_QUADROS  (PISCA_QUADROS + FADE_QUADROS)
+#define CODIGO_ACESO    QUADROS_MS(200)
+#define CODIGO_APAGADO  QUADROS_MS(300)
+#define CODIGO_PAUSA    QUADROS_MS(1000)
+#define CODIGO_QUADROS  (LED_CODIGO_MAX * (CODIGO_ACESO + CODIGO_APAGADO) + CODIGO_PAUSA)
+
 /**
- * @brief Inicializa os pinos GPIO definidos em config.h para serem saídas
- *        e controlar o LED RGB.
+ * @brief Padrão do sequenciador.
+ *
+ * Os seis primeiros campos são copiados pelo DMA, nesta ordem, a partir do
+ * TRANS_COUNT do alias 3 do canal de dados 0: TRANS_COUNT e READ_ADDR_TRIG
+ * do canal 0 e, logo em seguida no mapa de registradores, READ_ADDR,
+ * WRITE_ADDR, TRANS_COUNT e CTRL_TRIG do canal 1. Por isso os dois canais de
+ * dados são consecutivos.
  */
-void rgb_led_init() {
-    // Inicializa cada pino de cor
-    gpio_init(LED_RED_PIN);
-    gpio_init(LED_GREEN_PIN);
-    gpio_init(LED_BLUE_PIN);
-
-    // Define a direção de cada pino como saída (OUTPUT)
-    gpio_set_dir(LED_RED_PIN, GPIO_OUT);
-    gpio_set_dir(LED_GREEN_PIN, GPIO_OUT);
-    gpio_set_dir(LED_BLUE_PIN, GPIO_OUT);
-    
-    // Garante que o LED comece desligado
-    rgb_led_set_color(COR_LED_DESLIGADO);
+typedef struct {
+    uint32_t quadros;
+    const uint32_t *palavras0;      // CC da slice 0, um por quadro
+    const uint32_t *palavras1;      // CC da slice 1, um por quadro
+    volatile uint32_t *destino1;
+    uint32_t quadros1;
+    uint32_t ctrl1;
+    bool avulso;                    // Toca uma volta e devolve o LED ao fundo
+} led_padrao_t;
+
+#define PADRAO_PALAVRAS 6
+
+// Quadros dos padrões: n palavras da slice 0 seguidas de n da slice 1
+static uint32_t _cores_q[NUM_CORES_LED][2];
+static uint32_t _pacote_q[LED_RSSI_NIVEIS][2 * PACOTE_QUADROS];
+static uint32_t _codigo_q[2 * CODIGO_QUADROS];
+
+static led_padrao_t _cores[NUM_CORES_LED];
+static led_padrao_t _pacote[LED_RSSI_NIVEIS];
+static led_padrao_t _codigo;
+
+// Padrão carregado pelo DMA ao fim de cada volta e padrão de fundo, para
+// onde o LED volta depois de um padrão avulso
+static const led_padrao_t *volatile _proximo;
+static const led_padrao_t *volatile _fundo;
+
+// Slices dos pinos do LED e canais de DMA (dados 0 e 1 consecutivos)
+static uint _slice[2];
+static int _dados = -1;
+static int _ctrl_ponteiro = -1, _ctrl_padrao = -1;
+static uint32_t _ctrl1;
+
+/**
+ * @brief Nível de PWM de uma intensidade de 0 a 255, com correção gama
+ *        (quadrática) para o degradê parecer linear ao olho.
+ */
+static uint32_t nivel(uint8_t v) {
+    return (uint32_t)v * v * LED_PWM_TOP / (255u * 255u);
+}
+
+static void pino_nivel(uint pino, uint8_t v, uint32_t palavras[2]) {
+    int k = LED_SLICE(pino) == _slice[0] ? 0 : 1;
+    palavras[k] |= nivel(v) << (16 * (pino & 1));
 }
 
 /**
- * @brief Define a cor do LED RGB com base na enumeração CorLed.
- * 
- * Esta implementação assume um LED RGB do tipo "Catodo Comum",
- * onde um nível lógico ALTO (1) acende o pino da cor.
- * 
- * @param cor A cor desejada do tipo CorLed.
+ * @brief Escreve o quadro `i` de um padrão de `n` quadros com a cor (r, g, b).
  */
-void rgb_led_set_color(CorLed cor) {
-    // Inicializa o estado de cada pino como DESLIGADO (nível lógico 0)
-    bool r = false;
-    bool g = false;
-    bool b = false;
-
-    // Define quais pinos devem ser ligados com base na cor escolhida
-    switch (cor) {
-        case COR_LED_VERMELHO:
-            r = true;
-            break;
+static void quadro(uint32_t *q, uint32_t n, uint32_t i, uint8_t r, uint8_t g, uint8_t b) {
+    uint32_t palavras[2] = {0, 0};
+    pino_nivel(LED_RED_PIN, r, palavras);
+    pino_nivel(LED_GREEN_PIN, g, palavras);
+    pino_nivel(LED_BLUE_PIN, b, palavras);
+    q[i] = palavras[0];
+    q[n + i] = palavras[1];
+}
 
-        case COR_LED_VERDE:
-            g = true;
-            break;
+static void rgb(CorLed cor, uint8_t *r, uint8_t *g, uint8_t *b) {
+    *r = (cor == COR_LED_VERMELHO || cor == COR_LED_AMARELO || cor == COR_LED_MAGENTA) ? 255 : 0;
+    *g = (cor == COR_LED_VERDE || cor == COR_LED_AMARELO || cor == COR_LED_CIANO) ? 255 : 0;
+    *b = (cor == COR_LED_AZUL || cor == COR_LED_CIANO || cor == COR_LED_MAGENTA) ? 255 : 0;
+}
 
-        case COR_LED_AZUL:
-            b = true;
-            break;
+static void padrao_init(led_padrao_t *p, const uint32_t *palavras, uint32_t n, bool avulso) {
+    p->quadros = n;
+    p->palavras0 = palavras;
+    p->palavras1 = palavras + n;
+    p->destino1 = &pwm_hw->slice[_slice[1]].cc;
+    p->quadros1 = n;
+    p->ctrl1 = _ctrl1;
+    p->avulso = avulso;
+}
 
-        case COR_LED_AMARELO: // Vermelho + Verde
-            r = true;
-            g = true;
-            break;
+/**
+ * @brief Fim de uma volta do sequenciador com um padrão avulso pendente:
+ *        quando o avulso for o carregado, aponta a volta seguinte para o fundo.
+ */
+static void led_dma_irq(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    dma_hw->ints1 = 1u << _ctrl_padrao;
 
-        case COR_LED_CIANO: // Verde + Azul
-            g = true;
-            b = true;
-            break;
+    // O canal de controle deixa o endereço de leitura logo após o padrão copiado
+    const led_padrao_t *carregado =
+        (const led_padrao_t *)(dma_hw->ch[_ctrl_padrao].read_addr - PADRAO_PALAVRAS * sizeof(uint32_t));
+    if (carregado->avulso) {
+        if (_proximo == carregado) {
+            _proximo = _fundo;
+        }
+        if (!_proximo->avulso) {
+            hw_clear_bits(&dma_hw->inte1, 1u << _ctrl_padrao);
+        }
+    }
+    restore_interrupts(estado);
+}
 
-        case COR_LED_MAGENTA: // Vermelho + Azul
-            r = true;
-            b = true;
-            break;
-            
-        case COR_LED_DESLIGADO:
-            // Todos já são 'false', nada a fazer.
+/**
+ * @brief Liga os pinos às slices de PWM e configura a slice que marca os quadros.
+ */
+static void pwm_iniciar(void) {
+    _slice[0] = LED_SLICE(LED_RED_PIN);
+    _slice[1] = LED_SLICE(LED_GREEN_PIN) != _slice[0] ? LED_SLICE(LED_GREEN_PIN) : LED_SLICE(LED_BLUE_PIN);
+
+    pwm_config c = pwm_get_default_config();
+    pwm_config_set_wrap(&c, LED_PWM_TOP);
+    for (int k = 0; k < 2; ++k) {
+        pwm_init(_slice[k], &c, false);
+        pwm_hw->slice[_slice[k]].cc = 0;
+    }
+    gpio_set_function(LED_RED_PIN, GPIO_FUNC_PWM);
+    gpio_set_function(LED_GREEN_PIN, GPIO_FUNC_PWM);
+    gpio_set_function(LED_BLUE_PIN, GPIO_FUNC_PWM);
+
+    // Relógio dos quadros: clk_sys / (div * (top + 1)) = LED_SEQ_HZ
+    uint32_t ciclos = clock_get_hz(clk_sys) / LED_SEQ_HZ;
+    uint32_t div = (ciclos + 65535) / 65536;
+    pwm_config r = pwm_get_default_config();
+    pwm_config_set_clkdiv_int(&r, div);
+    pwm_config_set_wrap(&r, ciclos / div - 1);
+    pwm_init(LED_SEQ_SLICE, &r, false);
+
+    // Liga as três juntas sem mexer nas outras slices
+    hw_set_bits(&pwm_hw->en, (1u << _slice[0]) | (1u << _slice[1]) | (1u << LED_SEQ_SLICE));
+}
+
+/**
+ * @brief Reserva dois canais de DMA consecutivos para os dados e dois de controle.
+ */
+static bool dma_reservar(void) {
+    for (uint k = 0; k + 1 < NUM_DMA_CHANNELS; ++k) {
+        if (!dma_channel_is_claimed(k) && !dma_channel_is_claimed(k + 1)) {
+            dma_channel_claim(k);
+            dma_channel_claim(k + 1);
+            _dados = k;
             break;
+        }
+    }
+    _ctrl_ponteiro = dma_claim_unused_channel(false);
+    _ctrl_padrao = dma_claim_unused_channel(false);
+    if (_dados < 0 || _ctrl_ponteiro < 0 || _ctrl_padrao < 0) {
+        if (_dados >= 0) {
+            dma_channel_unclaim(_dados);
+            dma_channel_unclaim(_dados + 1);
+            _dados = -1;
+        }
+        if (_ctrl_ponteiro >= 0) dma_channel_unclaim(_ctrl_ponteiro);
+        if (_ctrl_padrao >= 0) dma_channel_unclaim(_ctrl_padrao);
+        return false;
     }
+    return true;
+}
+
+/**
+ * @brief Encadeia os quatro canais:
+ *   dados 0 e 1 -> um CC por quadro, no ritmo de LED_SEQ_SLICE;
+ *   dados 1 termina -> ponteiro copia _proximo para o READ_ADDR_TRIG do
+ *   canal de padrão -> padrão copia os 6 primeiros campos do padrão para os
+ *   registradores dos canais de dados, o que os dispara de novo.
+ */
+static void dma_iniciar(void) {
+    uint dreq = pwm_get_dreq(LED_SEQ_SLICE);
+
+    dma_channel_config c0 = dma_channel_get_default_config(_dados);
+    channel_config_set_transfer_data_size(&c0, DMA_SIZE_32);
+    channel_config_set_read_increment(&c0, true);
+    channel_config_set_write_increment(&c0, false);
+    channel_config_set_dreq(&c0, dreq);
+    dma_channel_configure(_dados, &c0, &pwm_hw->slice[_slice[0]].cc, NULL, 0, false);
+
+    // O CTRL do canal 1 vai em cada padrão (é escrito pelo CTRL_TRIG)
+    dma_channel_config c1 = dma_channel_get_default_config(_dados + 1);
+    channel_config_set_transfer_data_size(&c1, DMA_SIZE_32);
+    channel_config_set_read_increment(&c1, true);
+    channel_config_set_write_increment(&c1, false);
+    channel_config_set_dreq(&c1, dreq);
+    channel_config_set_chain_to(&c1, _ctrl_ponteiro);
+    _ctrl1 = channel_config_get_ctrl_value(&c1);
+
+    dma_channel_config cp = dma_channel_get_default_config(_ctrl_ponteiro);
+    channel_config_set_transfer_data_size(&cp, DMA_SIZE_32);
+    channel_config_set_read_increment(&cp, false);
+    channel_config_set_write_increment(&cp, false);
+    dma_channel_configure(_ctrl_ponteiro, &cp, &dma_hw->ch[_ctrl_padrao].al3_read_addr_trig,
+                          &_proximo, 1, false);
+
+    dma_channel_config cc = dma_channel_get_default_config(_ctrl_padrao);
+    channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+    channel_config_set_read_increment(&cc, true);
+    channel_config_set_write_increment(&cc, true);
+    dma_channel_configure(_ctrl_padrao, &cc, &dma_hw->ch[_dados].al3_transfer_count,
+                          NULL, PADRAO_PALAVRAS, false);
+
+    // A interrupção só fica habilitada enquanto houver um padrão avulso
+    irq_set_exclusive_handler(DMA_IRQ_1, led_dma_irq);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+/**
+ * @brief Monta os padrões fixos: uma cor por padrão de fundo (um quadro) e
+ *        uma piscada com apagamento por degrau do degradê de RSSI.
+ */
+static void padroes_montar(void) {
+    for (int cor = 0; cor < NUM_CORES_LED; ++cor) {
+        uint8_t r, g, b;
+        rgb((CorLed)cor, &r, &g, &b);
+        quadro(_cores_q[cor], 1, 0, r, g, b);
+        padrao_init(&_cores[cor], _cores_q[cor], 1, false);
+    }
+
+    for (int k = 0; k < LED_RSSI_NIVEIS; ++k) {
+        // Matiz de 0 (vermelho) a 120 graus (verde), passando pelo amarelo
+        uint32_t matiz = LED_RSSI_NIVEIS > 1 ? 120u * k / (LED_RSSI_NIVEIS - 1) : 120u;
+        uint8_t r = matiz <= 60 ? 255 : 255 * (120 - matiz) / 60;
+        uint8_t g = matiz >= 60 ? 255 : 255 * matiz / 60;
+        for (uint32_t i = 0; i < PACOTE_QUADROS; ++i) {
+            uint32_t a = i < PISCA_QUADROS ? 255 : 255 * (PACOTE_QUADROS - i) / (FADE_QUADROS + 1);
+            quadro(_pacote_q[k], PACOTE_QUADROS, i, r * a / 255, g * a / 255, 0);
+        }
+        padrao_init(&_pacote[k], _pacote_q[k], PACOTE_QUADROS, true);
+    }
+}
+
+/**
+ * @brief Inicializa o PWM dos pinos definidos em config.h e o sequenciador.
+ */
+void rgb_led_init() {
+    pwm_iniciar();
+    if (!dma_reservar()) {
+        printf("LED: sem canais de DMA livres; sequenciador desativado.\n");
+        return;
+    }
+    dma_iniciar();
+    padroes_montar();
+
+    _fundo = _proximo = &_cores[COR_LED_DESLIGADO];
+    dma_channel_start(_ctrl_ponteiro);
+    printf("LED: PWM nas slices %u/%u, quadros de %u Hz na slice %u, DMA %d-%d/%d/%d.\n",
+           _slice[0], _slice[1], LED_SEQ_HZ, LED_SEQ_SLICE, _dados, _dados + 1, _ctrl_ponteiro, _ctrl_padrao);
+}
+
+/**
+ * @brief Troca o fundo. Se um padrão avulso estiver pendente, ele toca antes
+ *        e a interrupção do fim da volta aplica o novo fundo.
+ */
+static void fundo_definir(const led_padrao_t *padrao) {
+    if (_dados < 0) return;
+    uint32_t estado = save_and_disable_interrupts();
+    _fundo = padrao;
+    if (!_proximo->avulso) {
+        _proximo = padrao;
+    }
+    restore_interrupts(estado);
+}
+
+void rgb_led_set_color(CorLed cor) {
+    if (cor >= NUM_CORES_LED) cor = COR_LED_DESLIGADO;
+    fundo_definir(&_cores[cor]);
+}
+
+void rgb_led_pacote(int rssi) {
+    if (_dados < 0) return;
+    int k = (rssi - LED_RSSI_MIN) * (LED_RSSI_NIVEIS - 1) / (LED_RSSI_MAX - LED_RSSI_MIN);
+    if (k < 0) k = 0;
+    if (k > LED_RSSI_NIVEIS - 1) k = LED_RSSI_NIVEIS - 1;
+
+    _proximo = &_pacote[k];
+    hw_set_bits(&dma_hw->inte1, 1u << _ctrl_padrao);
+}
 
-    // Aplica o estado lógico aos pinos GPIO físicos
-    gpio_put(LED_RED_PIN, r);
-    gpio_put(LED_GREEN_PIN, g);
-    gpio_put(LED_BLUE_PIN, b);
+/**
+ * @brief Monta o código de piscadas no buffer próprio e o torna o fundo.
+ *
+ * O buffer pode estar tocando; para não misturar o código antigo com o novo,
+ * o fundo passa para o LED apagado durante a montagem e a volta atual
+ * (no máximo CODIGO_QUADROS) termina antes de o buffer ser reescrito.
+ */
+void rgb_led_codigo(CorLed cor, uint8_t piscadas) {
+    if (_dados < 0) return;
+    if (piscadas < 1) piscadas = 1;
+    if (piscadas > LED_CODIGO_MAX) piscadas = LED_CODIGO_MAX;
+    if (_fundo == &_codigo) {
+        fundo_definir(&_cores[COR_LED_DESLIGADO]);
+        sleep_ms(CODIGO_QUADROS * 1000 / LED_SEQ_HZ + 1000 / LED_SEQ_HZ);
+    }
+
+    uint8_t r, g, b;
+    rgb(cor, &r, &g, &b);
+    uint32_t n = piscadas * (CODIGO_ACESO + CODIGO_APAGADO) + CODIGO_PAUSA;
+    for (uint32_t i = 0; i < n; ++i) {
+        bool aceso = i < piscadas * (CODIGO_ACESO + CODIGO_APAGADO)
+                     && i % (CODIGO_ACESO + CODIGO_APAGADO) < CODIGO_ACESO;
+        quadro(_codigo_q, n, i, aceso ? r : 0, aceso ? g : 0, aceso ? b : 0);
+    }
+    padrao_init(&_codigo, _codigo_q, n, false);
+    fundo_definir(&_codigo);
 }
\ No newline at end of file
@@ -2,6 +2,21 @@
 #define RGB_LED_H
 
 #include <stdbool.h>
+#include <stdint.h>
+
+// ============================================================================
+// --- LED RGB por PWM com sequenciador em DMA ---
+//
+// Os três pinos do LED são saídas de PWM. Cada padrão é uma sequência de
+// quadros (um valor de comparação por slice de PWM) que o DMA copia para os
+// registradores CC, um quadro a cada LED_SEQ_HZ, no ritmo de uma slice de PWM
+// usada só como relógio. Ao fim de cada volta, canais de controle recarregam
+// os canais de dados com o padrão apontado por uma variável, sem a CPU.
+//
+// Trocar de padrão é só trocar esse ponteiro: O(1), sem bloquear, seguro na
+// ISR. O novo padrão começa no fim da volta do atual; como os padrões de
+// fundo têm um quadro só, isso leva no máximo 1/LED_SEQ_HZ.
+// ============================================================================
 
 // Enum para as cores, facilitando o uso
 typedef enum {
@@ -11,18 +26,36 @@ typedef enum {
     COR_LED_AZUL,
     COR_LED_AMARELO,
     COR_LED_CIANO,
-    COR_LED_MAGENTA
+    COR_LED_MAGENTA,
+    NUM_CORES_LED
 } CorLed;
 
 /**
- * @brief Inicializa os pinos GPIO para o LED RGB.
+ * @brief Configura o PWM dos pinos do LED, monta os padrões e inicia o
+ *        sequenciador com o LED apagado.
  */
 void rgb_led_init();
 
 /**
- * @brief Define a cor do LED RGB.
+ * @brief Define a cor fixa de fundo do LED. O(1).
  * @param cor A cor desejada da enumeração CorLed.
  */
 void rgb_led_set_color(CorLed cor);
 
+/**
+ * @brief Acende o LED por LED_PISCA_MS numa cor entre vermelho (sinal fraco)
+ *        e verde (sinal forte) e apaga em LED_FADE_MS, voltando ao fundo.
+ *        O(1) e sem bloqueio; pode ser chamada da ISR.
+ * @param rssi RSSI do pacote em dBm.
+ */
+void rgb_led_pacote(int rssi);
+
+/**
+ * @brief Troca o fundo por um código de piscadas repetido: `piscadas`
+ *        piscadas na cor dada e uma pausa. Monta o padrão na hora, então é
+ *        para o loop principal (erros fatais), não para a ISR.
+ * @param piscadas De 1 a LED_CODIGO_MAX.
+ */
+void rgb_led_codigo(CorLed cor, uint8_t piscadas);
+
 #endif // RGB_LED_H
\ No newline at end of file
@@ -1,5 +1,46 @@
 #include "ssd1306.h"
-#include "font.h"
+#include <string.h>
+
+// Sequência de inicialização, enviada em uma transação só
+static const uint8_t ssd1306_init_sequence[] = {
+  SET_DISP | 0x00,
+  SET_MEM_ADDR, 0x01,
+  SET_DISP_START_LINE | 0x00,
+  SET_SEG_REMAP | 0x01,
+  SET_MUX_RATIO, HEIGHT - 1,
+  SET_COM_OUT_DIR | 0x08,
+  SET_DISP_OFFSET, 0x00,
+  SET_COM_PIN_CFG, 0x12,
+  SET_DISP_CLK_DIV, 0x80,
+  SET_PRECHARGE, 0xF1,
+  SET_VCOM_DESEL, 0x30,
+  SET_CONTRAST, 0xFF,
+  SET_ENTIRE_ON,
+  SET_NORM_INV,
+  SET_CHARGE_PUMP, 0x14,
+  SET_DISP | 0x01,
+};
+
+static void ssd1306_write(ssd1306_t *ssd, const uint8_t *buf, size_t len) {
+  i2c_write_blocking(ssd->i2c_port, ssd->address, buf, len, false);
+  ssd->i2c_transactions++;
+  ssd->i2c_bytes += len;
+}
+
+// Escreve a janela de colunas x0..x1 e páginas p0..p1 nos
+// SSD1306_WINDOW_PREFIX bytes antes de `control`, que recebe o 0x40 dos
+// dados. Cada comando vai com Co=1, então janela e dados seguem juntos.
+// Retorna o início da transação.
+static uint8_t *ssd1306_window_prefix(uint8_t *control, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  const uint8_t window[6] = {SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1};
+  uint8_t *start = control - SSD1306_WINDOW_PREFIX;
+  for (uint8_t i = 0; i < 6; ++i) {
+    start[2 * i] = 0x80;
+    start[2 * i + 1] = window[i];
+  }
+  *control = 0x40;
+  return start;
+}
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -8,64 +49,115 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->ram_buffer = (uint8_t *)calloc(SSD1306_WINDOW_PREFIX + ssd->bufsize, sizeof(uint8_t)) + SSD1306_WINDOW_PREFIX;
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->i2c_transactions = 0;
+  ssd->i2c_bytes = 0;
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  ssd1306_command_list(ssd, ssd1306_init_sequence, sizeof(ssd1306_init_sequence));
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
-    false
-  );
+  ssd1306_write(ssd, ssd->port_buffer, 2);
+}
+
+// Envia uma sequência de comandos (com seus argumentos) após um único byte
+// de controle 0x00. Listas maiores que SSD1306_COMMAND_LIST_MAX seguem em
+// mais de uma transação.
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t len) {
+  uint8_t buf[1 + SSD1306_COMMAND_LIST_MAX];
+  buf[0] = 0x00;
+  while (len > 0) {
+    size_t n = len < SSD1306_COMMAND_LIST_MAX ? len : SSD1306_COMMAND_LIST_MAX;
+    memcpy(&buf[1], commands, n);
+    ssd1306_write(ssd, buf, n + 1);
+    commands += n;
+    len -= n;
+  }
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  uint8_t *start = ssd1306_window_prefix(ssd->ram_buffer, 0, ssd->width - 1, 0, ssd->pages - 1);
+  ssd1306_write(ssd, start, SSD1306_WINDOW_PREFIX + ssd->bufsize);
+}
+
+// Inicia a rolagem horizontal contínua das páginas p0..p1 (todas as
+// colunas, com a coluna que sai por um lado voltando pelo outro). A rolagem
+// move o conteúdo da GDDRAM; enquanto ela estiver ativa, não se deve
+// escrever na GDDRAM.
+void ssd1306_scroll_horizontal(ssd1306_t *ssd, bool left, uint8_t p0, uint8_t p1, ssd1306_scroll_interval_t interval) {
+  const uint8_t commands[] = {
+    SET_SCROLL_OFF, // A configuração só é aceita com a rolagem parada
+    left ? SET_HSCROLL_LEFT : SET_HSCROLL_RIGHT, 0x00, p0, interval, p1, 0x00, 0xFF,
+    SET_SCROLL_ON,
+  };
+  ssd1306_command_list(ssd, commands, sizeof(commands));
+}
+
+void ssd1306_scroll_stop(ssd1306_t *ssd) {
+  ssd1306_command(ssd, SET_SCROLL_OFF);
+}
+
+// Envia apenas as colunas x0..x1 (todas as páginas). Como o buffer está em
+// endereçamento vertical, essas colunas são contíguas na RAM.
+void ssd1306_send_columns(ssd1306_t *ssd, uint8_t x0, uint8_t x1) {
+  // A janela e o byte de controle 0x40 precisam vir logo antes dos dados:
+  // usa temporariamente os bytes das colunas anteriores (ou a folga antes
+  // do buffer) para isso
+  uint8_t *controle = &ssd->ram_buffer[x0 * ssd->pages];
+  uint8_t salvo[SSD1306_WINDOW_PREFIX + 1];
+  memcpy(salvo, controle - SSD1306_WINDOW_PREFIX, sizeof(salvo));
+  uint8_t *inicio = ssd1306_window_prefix(controle, x0, x1, 0, ssd->pages - 1);
+  ssd1306_write(ssd, inicio, SSD1306_WINDOW_PREFIX + 1 + (x1 - x0 + 1) * ssd->pages);
+  memcpy(inicio, salvo, sizeof(salvo));
+}
+
+// Envia o retângulo de colunas x0..x1 e páginas p0..p1. As colunas são
+// copiadas em blocos para um buffer local, já que dentro de uma faixa de
+// páginas elas não são contíguas na RAM.
+void ssd1306_send_region(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  if (p0 == 0 && p1 == ssd->pages - 1) {
+    ssd1306_send_columns(ssd, x0, x1);
+    return;
+  }
+
+  // O ponteiro de escrita do display continua de onde parou entre
+  // transações, então o retângulo pode ser enviado em vários blocos; só o
+  // primeiro leva a janela
+  uint8_t bloco[SSD1306_WINDOW_PREFIX + 1 + 16 * 8];
+  uint8_t *controle = &bloco[SSD1306_WINDOW_PREFIX];
+  uint8_t *inicio = ssd1306_window_prefix(controle, x0, x1, p0, p1);
+  uint8_t altura = p1 - p0 + 1;
+  size_t n = 1;
+  for (uint8_t x = x0; x <= x1; ++x) {
+    memcpy(&controle[n], &ssd->ram_buffer[x * ssd->pages + p0 + 1], altura);
+    n += altura;
+    if (x == x1 || SSD1306_WINDOW_PREFIX + n + altura > sizeof(bloco)) {
+      ssd1306_write(ssd, inicio, controle + n - inicio);
+      inicio = controle;
+      n = 1;
+    }
+  }
+}
+
+// Apaga o retângulo de colunas x0..x1 e páginas p0..p1 no buffer
+void ssd1306_clear_region(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  for (uint8_t x = x0; x <= x1; ++x)
+    memset(&ssd->ram_buffer[x * ssd->pages + p0 + 1], 0, p1 - p0 + 1);
+}
+
+// Desloca o retângulo uma coluna para a esquerda no buffer, liberando a coluna x1
+void ssd1306_shift_left(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  uint8_t altura = p1 - p0 + 1;
+  for (uint8_t x = x0; x < x1; ++x) {
+    uint8_t *dst = &ssd->ram_buffer[x * ssd->pages + p0 + 1];
+    memcpy(dst, dst + ssd->pages, altura);
+  }
+  ssd1306_clear_region(ssd, x1, x1, p0, p1);
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
@@ -153,11 +245,54 @@ void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value
     ssd1306_pixel(ssd, x, y, value);
 }
 
+// Retorna o glifo de um caractere. A fonte já está em ordem coluna a coluna,
+// com o bit 0 no topo, que é exatamente o formato de página do SSD1306.
+const uint8_t *ssd1306_glyph(char c)
+{
+  if (c < ' ' || c > '~')
+    c = ' ';
+  return &font_8x8.glyphs[(c - ' ') * 8];
+}
+
+// Copia um glifo 8x8 direto para a página indicada, sem passar pixel a pixel
+void ssd1306_draw_glyph(ssd1306_t *ssd, const uint8_t *glyph, uint8_t x, uint8_t page)
+{
+  uint8_t *dst = &ssd->ram_buffer[x * ssd->pages + page + 1];
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    *dst = glyph[i];
+    dst += ssd->pages;
+  }
+}
+
+// Copia um glifo de qualquer fonte a partir da página indicada, `pages`
+// bytes por coluna. Caractere fora da fonte limpa a célula.
+void ssd1306_draw_font_char(ssd1306_t *ssd, const ssd1306_font_t *font, char c, uint8_t x, uint8_t page)
+{
+  uint8_t *dst = &ssd->ram_buffer[x * ssd->pages + page + 1];
+  if (c < font->first || c > font->last)
+  {
+    for (uint8_t i = 0; i < font->width; ++i, dst += ssd->pages)
+      memset(dst, 0, font->pages);
+    return;
+  }
+  const uint8_t *src = &font->glyphs[(c - font->first) * font->width * font->pages];
+  for (uint8_t i = 0; i < font->width; ++i, dst += ssd->pages, src += font->pages)
+    memcpy(dst, src, font->pages);
+}
+
 // Função para desenhar um caractere
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
 {
   uint16_t index = 0;
 
+  // Caminho rápido: caractere alinhado a uma página e inteiro dentro da tela
+  if ((y & 0b111) == 0 && x + 8 <= ssd->width && y < ssd->height)
+  {
+    ssd1306_draw_glyph(ssd, ssd1306_glyph(c), x, y >> 3);
+    return;
+  }
+
   // Verifica o caractere e calcula o índice correspondente na fonte
   if (c >= ' ' && c <= '~') // Verifica se o caractere está na faixa ASCII válida
   {
@@ -172,7 +307,7 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
   // Desenha o caractere na tela
   for (uint8_t i = 0; i < 8; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
+    uint8_t line = font_8x8.glyphs[index + i]; // Acessa a linha correspondente do caractere na fonte
     for (uint8_t j = 0; j < 8; ++j)
     {
       ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
@@ -187,12 +322,12 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
   {
     ssd1306_draw_char(ssd, *str++, x, y);
     x += 8;
-    if (x + 8 >= ssd->width)
+    if (x + 8 > ssd->width) // O próximo caractere não cabe inteiro na linha
     {
       x = 0;
       y += 8;
     }
-    if (y + 8 >= ssd->height)
+    if (y + 8 > ssd->height) // Nem a próxima linha na tela (a última, y = 56, cabe)
     {
       break;
     }
@@ -1,6 +1,10 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "font.h"
 
 #define WIDTH 128
 #define HEIGHT 64
@@ -22,16 +26,44 @@ typedef enum {
   SET_DISP_CLK_DIV = 0xD5,
   SET_PRECHARGE = 0xD9,
   SET_VCOM_DESEL = 0xDB,
-  SET_CHARGE_PUMP = 0x8D
+  SET_CHARGE_PUMP = 0x8D,
+  SET_HSCROLL_RIGHT = 0x26,
+  SET_HSCROLL_LEFT = 0x27,
+  SET_VHSCROLL_RIGHT = 0x29,
+  SET_VHSCROLL_LEFT = 0x2A,
+  SET_SCROLL_OFF = 0x2E,
+  SET_SCROLL_ON = 0x2F,
+  SET_VSCROLL_AREA = 0xA3
 } ssd1306_command_t;
 
+// Intervalo entre passos da rolagem, em quadros (terceiro argumento de 0x26/0x27)
+typedef enum {
+  SSD1306_SCROLL_2_FRAMES = 0x07,
+  SSD1306_SCROLL_3_FRAMES = 0x04,
+  SSD1306_SCROLL_4_FRAMES = 0x05,
+  SSD1306_SCROLL_5_FRAMES = 0x00,
+  SSD1306_SCROLL_25_FRAMES = 0x06,
+  SSD1306_SCROLL_64_FRAMES = 0x01,
+  SSD1306_SCROLL_128_FRAMES = 0x02,
+  SSD1306_SCROLL_256_FRAMES = 0x03
+} ssd1306_scroll_interval_t;
+
+// Comandos com Co=1 (0x80 + byte) que definem a janela de colunas e páginas
+// antes dos dados, na mesma transação: 6 comandos, 12 bytes
+#define SSD1306_WINDOW_PREFIX 12
+
+// Maior lista de comandos enviada em uma única transação
+#define SSD1306_COMMAND_LIST_MAX 32
+
 typedef struct {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
-  uint8_t *ram_buffer;
+  uint8_t *ram_buffer;    // ram_buffer[0] = 0x40; SSD1306_WINDOW_PREFIX bytes livres antes
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint32_t i2c_transactions; // Transações I2C desde o init
+  uint32_t i2c_bytes;        // Bytes enviados, incluindo os de controle
 } ssd1306_t;
 
 // === Protótipos de Funções ===
@@ -39,7 +71,10 @@ typedef struct {
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t len);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_scroll_horizontal(ssd1306_t *ssd, bool left, uint8_t p0, uint8_t p1, ssd1306_scroll_interval_t interval);
+void ssd1306_scroll_stop(ssd1306_t *ssd);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -48,4 +83,13 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+const uint8_t *ssd1306_glyph(char c);
+void ssd1306_draw_glyph(ssd1306_t *ssd, const uint8_t *glyph, uint8_t x, uint8_t page);
+void ssd1306_draw_font_char(ssd1306_t *ssd, const ssd1306_font_t *font, char c, uint8_t x, uint8_t page);
+void ssd1306_send_columns(ssd1306_t *ssd, uint8_t x0, uint8_t x1);
+void ssd1306_send_region(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+void ssd1306_clear_region(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+void ssd1306_shift_left(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+
+#endif // SSD1306_H
@@ -0,0 +1,314 @@
+#include "link_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "pico/stdlib.h"
+#include "config.h"
+#include "seqlock.h"
+#include "caminho_quente.h"
+
+#define UM_Q16  65536
+
+// Incrementos das posições desejadas dos marcadores do P²: 0, p/2, p, (1+p)/2, 1
+#define P2_P_Q16  ((int32_t)LINK_PERCENTIL * UM_Q16 / 100)
+static const int32_t TABELA_QUENTE("link_p2_incremento") _p2_incremento_q16[5] = {
+    0, P2_P_Q16 / 2, P2_P_Q16, (UM_Q16 + P2_P_Q16) / 2, UM_Q16
+};
+
+/**
+ * @brief Entrada da tabela, publicada pela ISR através de um seqlock.
+ */
+typedef struct {
+    seqlock_t lock;
+    link_stats_t s;
+} link_entrada_t;
+
+static link_entrada_t _tabela[MAX_NOS];
+static volatile uint8_t _num_nos = 0;
+
+// ============================================================================
+// --- Métricas (contexto de ISR: apenas inteiros) ---
+// ============================================================================
+
+static void CAMINHO_QUENTE(p2_inicial)(link_metrica_t *m, int32_t x_q16) {
+    // As 5 primeiras amostras ficam ordenadas nos marcadores
+    int i = m->amostras - 1;
+    while (i > 0 && m->p2_altura_q16[i - 1] > x_q16) {
+        m->p2_altura_q16[i] = m->p2_altura_q16[i - 1];
+        --i;
+    }
+    m->p2_altura_q16[i] = x_q16;
+
+    if (m->amostras == 5) {
+        for (int k = 0; k < 5; ++k) {
+            m->p2_posicao[k] = k + 1;
+        }
+        m->p2_desejada_q16[0] = UM_Q16;
+        m->p2_desejada_q16[1] = UM_Q16 + 2 * P2_P_Q16;
+        m->p2_desejada_q16[2] = UM_Q16 + 4 * P2_P_Q16;
+        m->p2_desejada_q16[3] = 3 * UM_Q16 + 2 * P2_P_Q16;
+        m->p2_desejada_q16[4] = 5 * UM_Q16;
+    }
+}
+
+/**
+ * @brief Ajusta o marcador i uma posição na direção s (+1/-1), pela fórmula
+ *        parabólica; se ela sair do intervalo dos vizinhos, usa a linear.
+ */
+static void CAMINHO_QUENTE(p2_ajustar)(link_metrica_t *m, int i, int32_t s) {
+    int32_t *q = m->p2_altura_q16;
+    int32_t *n = m->p2_posicao;
+
+    int64_t t1 = (int64_t)(n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]);
+    int64_t t2 = (int64_t)(n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]);
+    int32_t qp = q[i] + (int32_t)(s * (t1 + t2) / (n[i + 1] - n[i - 1]));
+
+    if (q[i - 1] < qp && qp < q[i + 1]) {
+        q[i] = qp;
+    } else {
+        q[i] += s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+    }
+    n[i] += s;
+}
+
+static void CAMINHO_QUENTE(p2_atualizar)(link_metrica_t *m, int32_t x_q16) {
+    int32_t *q = m->p2_altura_q16;
+    int k;
+
+    if (x_q16 < q[0]) {
+        q[0] = x_q16;
+        k = 0;
+    } else if (x_q16 >= q[4]) {
+        q[4] = x_q16;
+        k = 3;
+    } else {
+        for (k = 0; k < 3 && x_q16 >= q[k + 1]; ++k) {
+        }
+    }
+
+    for (int i = k + 1; i < 5; ++i) {
+        m->p2_posicao[i]++;
+    }
+    for (int i = 0; i < 5; ++i) {
+        m->p2_desejada_q16[i] += _p2_incremento_q16[i];
+    }
+
+    for (int i = 1; i <= 3; ++i) {
+        int64_t d = m->p2_desejada_q16[i] - (int64_t)m->p2_posicao[i] * UM_Q16;
+        int32_t *n = m->p2_posicao;
+        if (d >= UM_Q16 && n[i + 1] - n[i] > 1) {
+            p2_ajustar(m, i, 1);
+        } else if (d <= -UM_Q16 && n[i - 1] - n[i] < -1) {
+            p2_ajustar(m, i, -1);
+        }
+    }
+}
+
+static void CAMINHO_QUENTE(metrica_adicionar)(link_metrica_t *m, int16_t x) {
+    // Multiplicação, não deslocamento: RSSI e SNR são negativos
+    int32_t x_q8 = (int32_t)x * 256;
+    int32_t x_q16 = (int32_t)x * UM_Q16;
+
+    m->amostras++;
+    if (m->amostras == 1) {
+        m->min = m->max = x;
+        m->ewma_q8 = x_q8;
+        m->media_q16 = x_q16;
+        m->m2_q16 = 0;
+    } else {
+        if (x < m->min) m->min = x;
+        if (x > m->max) m->max = x;
+        m->ewma_q8 += (x_q8 - m->ewma_q8) >> LINK_EWMA_SHIFT;
+
+        // Welford: a média é atualizada antes do segundo fator. A divisão
+        // arredonda: truncada, ela puxava a média sempre contra a tendência
+        int32_t delta = x_q16 - m->media_q16;
+        int32_t n = (int32_t)m->amostras;
+        m->media_q16 += delta >= 0 ? (delta + n / 2) / n : -((n / 2 - delta) / n);
+        m->m2_q16 += ((int64_t)delta * (x_q16 - m->media_q16)) >> 16;
+    }
+
+    if (m->amostras <= 5) {
+        p2_inicial(m, x_q16);
+    } else {
+        p2_atualizar(m, x_q16);
+    }
+}
+
+/**
+ * @brief (1 - alfa)^k em Q16, por exponenciação rápida (no máximo 8 passos).
+ */
+static uint32_t CAMINHO_QUENTE(decaimento_q16)(uint32_t k) {
+    uint64_t base = UM_Q16 - (UM_Q16 >> LINK_EWMA_SHIFT);
+    uint64_t r = UM_Q16;
+    while (k) {
+        if (k & 1) r = (r * base) >> 16;
+        base = (base * base) >> 16;
+        k >>= 1;
+    }
+    return (uint32_t)r;
+}
+
+/**
+ * @brief Atualiza a perda a partir do salto de header_id.
+ * @return false se o pacote é um duplicado.
+ */
+static bool CAMINHO_QUENTE(per_atualizar)(link_stats_t *s, uint8_t header_id) {
+    uint8_t salto = (uint8_t)(header_id - s->ultimo_id);
+    s->ultimo_id = header_id;
+
+    if (salto == 0) {
+        s->duplicados++; // Retransmissão do mesmo pacote
+        return false;
+    }
+    if (salto > LINK_SALTO_MAX) {
+        return true; // Transmissor reiniciou ou ficou muito tempo fora: ressincroniza
+    }
+
+    // salto - 1 perdas seguidas de um sucesso, aplicados à EWMA de uma vez:
+    // após k perdas, e = 1 - (1-a)^k * (1 - e); após o sucesso, e *= (1-a)
+    uint32_t perdidos = salto - 1;
+    uint32_t e = s->per_ewma_q16;
+    if (perdidos > 0) {
+        s->perdidos += perdidos;
+        e = UM_Q16 - (uint32_t)(((uint64_t)decaimento_q16(perdidos) * (UM_Q16 - e)) >> 16);
+    }
+    s->per_ewma_q16 = e - (e >> LINK_EWMA_SHIFT);
+    return true;
+}
+
+// ============================================================================
+// --- Funções Públicas ---
+// ============================================================================
+
+void link_stats_init(void) {
+    memset(_tabela, 0, sizeof(_tabela));
+    _num_nos = 0;
+}
+
+void CAMINHO_QUENTE(link_stats_registrar)(uint8_t remetente, uint8_t header_id, int16_t rssi, int8_t snr_x4, uint64_t agora_us) {
+    link_entrada_t *e = NULL;
+    bool novo = false;
+
+    for (uint8_t i = 0; i < _num_nos; ++i) {
+        if (_tabela[i].s.endereco == remetente) {
+            e = &_tabela[i];
+            break;
+        }
+    }
+    if (e == NULL) {
+        novo = true;
+        if (_num_nos < MAX_NOS) {
+            e = &_tabela[_num_nos];
+        } else {
+            // Tabela cheia: reaproveita o transmissor ouvido há mais tempo
+            e = &_tabela[0];
+            for (uint8_t i = 1; i < MAX_NOS; ++i) {
+                if (_tabela[i].s.ultimo_us < e->s.ultimo_us) {
+                    e = &_tabela[i];
+                }
+            }
+        }
+    }
+
+    seqlock_write_begin(&e->lock);
+
+    link_stats_t *s = &e->s;
+    bool conta = true;
+    if (novo) {
+        memset(s, 0, sizeof(*s));
+        s->endereco = remetente;
+        s->ultimo_id = header_id;
+    } else {
+        conta = per_atualizar(s, header_id);
+    }
+    s->recebidos++;
+    s->ultimo_us = agora_us;
+    if (conta) {
+        metrica_adicionar(&s->rssi, rssi);
+        metrica_adicionar(&s->snr, snr_x4);
+    }
+
+    seqlock_write_end(&e->lock);
+
+    if (novo && _num_nos < MAX_NOS) {
+        _num_nos++; // Só depois da entrada pronta
+    }
+}
+
+uint8_t link_stats_count(void) {
+    return _num_nos;
+}
+
+bool link_stats_copiar(uint8_t indice, link_stats_t *copia) {
+    if (indice >= _num_nos) {
+        return false;
+    }
+    const link_entrada_t *e = &_tabela[indice];
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&e->lock);
+        *copia = e->s;
+    } while (seqlock_read_retry(&e->lock, seq));
+    return true;
+}
+
+bool link_stats_copiar_no(uint8_t endereco, link_stats_t *copia) {
+    for (uint8_t i = 0; i < _num_nos; ++i) {
+        if (link_stats_copiar(i, copia) && copia->endereco == endereco) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void link_stats_resumir(const link_metrica_t *m, float escala, link_resumo_t *resumo) {
+    memset(resumo, 0, sizeof(*resumo));
+    if (m->amostras == 0) {
+        return;
+    }
+    resumo->ewma = m->ewma_q8 / (256.0f * escala);
+    resumo->media = m->media_q16 / (65536.0f * escala);
+    resumo->desvio = m->amostras > 1 ? sqrtf((float)m->m2_q16 / 65536.0f / (m->amostras - 1)) / escala : 0.0f;
+    resumo->min = m->min / escala;
+    resumo->max = m->max / escala;
+
+    // Interpola entre os marcadores (as amostras ordenadas, até 5) na
+    // posição do percentil. O marcador do meio só chega a ela depois de
+    // algumas dezenas de amostras; até lá ele ainda é a mediana
+    static const int32_t posicao_inicial[5] = {1, 2, 3, 4, 5};
+    const int32_t *n = m->amostras >= 5 ? m->p2_posicao : posicao_inicial;
+    uint32_t marcadores = m->amostras < 5 ? m->amostras : 5;
+    float alvo = 1.0f + (m->amostras - 1) * (LINK_PERCENTIL / 100.0f);
+    uint32_t i = 0;
+    while (i + 2 < marcadores && n[i + 1] <= alvo) {
+        ++i;
+    }
+    float q = m->p2_altura_q16[i];
+    if (i + 1 < marcadores && alvo > n[i]) {
+        q += (m->p2_altura_q16[i + 1] - q) * (alvo - n[i]) / (n[i + 1] - n[i]);
+    }
+    resumo->percentil = q / (65536.0f * escala);
+}
+
+float link_stats_per(const link_stats_t *s) {
+    uint32_t esperados = s->recebidos - s->duplicados + s->perdidos;
+    return esperados ? 100.0f * s->perdidos / esperados : 0.0f;
+}
+
+void link_stats_imprimir(void) {
+    link_stats_t s;
+    link_resumo_t rssi, snr;
+
+    printf("No  pacotes perdas  PER%%  recente | RSSI ewma  media desvio  p%d   min  max | SNR ewma  media  p%d\n",
+           LINK_PERCENTIL, LINK_PERCENTIL);
+    for (uint8_t i = 0; link_stats_copiar(i, &s); ++i) {
+        link_stats_resumir(&s.rssi, 1.0f, &rssi);
+        link_stats_resumir(&s.snr, 4.0f, &snr);
+        printf("@%-3u %7lu %6lu %5.1f %6.1f%% | %9.1f %6.1f %6.1f %5.1f %4.0f %4.0f | %8.1f %6.1f %5.1f\n",
+               s.endereco, (unsigned long)s.recebidos, (unsigned long)s.perdidos,
+               link_stats_per(&s), s.per_ewma_q16 * 100.0f / UM_Q16,
+               rssi.ewma, rssi.media, rssi.desvio, rssi.percentil, rssi.min, rssi.max,
+               snr.ewma, snr.media, snr.percentil);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// --- Estatísticas do enlace por transmissor ---
+//
+// Alimentadas pela ISR de recepção a cada pacote, com memória e tempo de
+// atualização constantes e apenas aritmética inteira. As leituras feitas
+// pelo loop principal (display, console) usam cópias consistentes.
+// ============================================================================
+
+/**
+ * @brief Agregados de uma métrica (RSSI em dBm ou SNR em quartos de dB).
+ *
+ * Valores em ponto fixo: Q8 (x256) para a EWMA, Q16 (x65536) para a média
+ * e a soma dos quadrados de Welford e para as alturas dos marcadores do P²
+ * (em Q8 os ajustes menores que 1/256 se perdiam e o marcador parava).
+ */
+typedef struct {
+    uint32_t amostras;
+    int16_t min;
+    int16_t max;
+    int32_t ewma_q8;        // Média móvel exponencial, alfa = 1/2^LINK_EWMA_SHIFT
+    int32_t media_q16;      // Média de Welford
+    int64_t m2_q16;         // Soma dos quadrados dos desvios (Welford)
+    // Estimador P² (Jain & Chlamtac) do percentil LINK_PERCENTIL
+    int32_t p2_altura_q16[5];
+    int32_t p2_posicao[5];
+    int64_t p2_desejada_q16[5];     // Cresce p*amostras em Q16: passaria de 32 bits em 32768 amostras
+} link_metrica_t;
+
+/**
+ * @brief Estatísticas de um transmissor.
+ */
+typedef struct {
+    uint8_t endereco;       // Endereço LoRa (header_from)
+    uint8_t ultimo_id;      // header_id do último pacote
+    uint32_t recebidos;     // Pacotes recebidos (incluindo duplicados)
+    uint32_t perdidos;      // Pacotes inferidos como perdidos pelas lacunas de header_id
+    uint32_t duplicados;    // Pacotes com o mesmo header_id do anterior
+    uint32_t per_ewma_q16;  // Taxa de perda recente, 65536 = 100%
+    uint64_t ultimo_us;     // Instante do último pacote
+    link_metrica_t rssi;    // dBm
+    link_metrica_t snr;     // Quartos de dB
+} link_stats_t;
+
+/**
+ * @brief Resumo de uma métrica já convertido para a unidade final.
+ */
+typedef struct {
+    float ewma;
+    float media;
+    float desvio;           // Desvio padrão amostral
+    float percentil;        // Estimativa do percentil LINK_PERCENTIL
+    float min;
+    float max;
+} link_resumo_t;
+
+/**
+ * @brief Zera a tabela de transmissores.
+ */
+void link_stats_init(void);
+
+/**
+ * @brief Registra um pacote recebido. Chamada pela ISR; sem ponto flutuante.
+ *
+ * Com a tabela cheia, a entrada do transmissor ouvido há mais tempo é
+ * reaproveitada.
+ */
+void link_stats_registrar(uint8_t remetente, uint8_t header_id, int16_t rssi, int8_t snr_x4, uint64_t agora_us);
+
+/**
+ * @brief Número de transmissores na tabela.
+ */
+uint8_t link_stats_count(void);
+
+/**
+ * @brief Copia a entrada na posição `indice` de forma consistente com a ISR.
+ * @return false se o índice não existir.
+ */
+bool link_stats_copiar(uint8_t indice, link_stats_t *copia);
+
+/**
+ * @brief Copia a entrada de um transmissor pelo endereço.
+ * @return false se o transmissor nunca foi ouvido.
+ */
+bool link_stats_copiar_no(uint8_t endereco, link_stats_t *copia);
+
+/**
+ * @brief Converte os agregados de uma métrica para a unidade final.
+ * @param escala Divisor da unidade bruta (1 para RSSI, 4 para SNR).
+ */
+void link_stats_resumir(const link_metrica_t *m, float escala, link_resumo_t *resumo);
+
+/**
+ * @brief Taxa de perda acumulada desde que o transmissor foi ouvido, em %.
+ */
+float link_stats_per(const link_stats_t *s);
+
+/**
+ * @brief Imprime no console uma linha por transmissor.
+ */
+void link_stats_imprimir(void);
+
+#endif // LINK_STATS_H
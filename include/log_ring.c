@@ -0,0 +1,318 @@
+#include "log_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "config.h"
+#include "crc.h"
+
+// ============================================================================
+// --- Filas sem trava ---
+// ============================================================================
+
+/**
+ * @brief Registro de tamanho fixo guardado nas filas.
+ */
+typedef struct {
+    uint8_t tipo;
+    uint32_t tempo_us;
+    union {
+        struct {
+            const char *fmt;
+            int args[3];
+        } texto;
+        log_pacote_t pacote;
+        log_metricas_t metricas;
+    };
+} log_registro_t;
+
+/**
+ * @brief Fila circular de um único produtor e um único consumidor.
+ *
+ * O produtor só escreve `cabeca` e o consumidor só escreve `cauda`, então
+ * nenhum dos lados precisa desabilitar interrupções.
+ */
+typedef struct {
+    log_registro_t registros[LOG_RING_TAMANHO];
+    volatile uint32_t cabeca;  // Próxima posição a ser escrita
+    volatile uint32_t cauda;   // Próxima posição a ser lida
+} log_fila_t;
+
+// Uma fila por contexto produtor: interrupções (todas com a mesma prioridade
+// no SDK, portanto sem aninhamento) e loop principal
+static log_fila_t _fila_isr;
+static log_fila_t _fila_main;
+
+static volatile uint32_t _descartados = 0;
+
+// Registro serializado aguardando envio (pode sair em várias chamadas)
+static uint8_t _saida[LOG_SAIDA_MAX];
+static uint16_t _saida_tamanho = 0;
+static uint16_t _saida_pos = 0;
+
+#if (LOG_RING_TAMANHO & (LOG_RING_TAMANHO - 1)) != 0
+#error "LOG_RING_TAMANHO deve ser potência de 2"
+#endif
+
+static log_fila_t *fila_do_contexto(void) {
+    return __get_current_exception() ? &_fila_isr : &_fila_main;
+}
+
+/**
+ * @brief Reserva o próximo registro livre da fila do contexto atual.
+ * @return NULL se a fila estiver cheia.
+ */
+static log_registro_t *reservar(log_fila_t *fila) {
+    if (fila->cabeca - fila->cauda >= LOG_RING_TAMANHO) {
+        _descartados++;
+        return NULL;
+    }
+    return &fila->registros[fila->cabeca & (LOG_RING_TAMANHO - 1)];
+}
+
+/**
+ * @brief Publica o registro reservado: a barreira garante que o conteúdo
+ *        esteja visível antes do índice.
+ */
+static void publicar(log_fila_t *fila) {
+    __dmb();
+    fila->cabeca++;
+}
+
+// ============================================================================
+// --- Produtores ---
+// ============================================================================
+
+void log_ring_init(void) {
+    _fila_isr.cabeca = _fila_isr.cauda = 0;
+    _fila_main.cabeca = _fila_main.cauda = 0;
+    _descartados = 0;
+    _saida_tamanho = _saida_pos = 0;
+
+#if LOG_SAIDA_BINARIA
+    // Delimitador inicial: separa o texto do boot do primeiro quadro
+    stdio_putchar_raw(0x00);
+#endif
+}
+
+void log_ring_texto(const char *fmt, int a0, int a1, int a2) {
+    log_fila_t *fila = fila_do_contexto();
+    log_registro_t *r = reservar(fila);
+    if (r == NULL) return;
+
+    r->tipo = LOG_REG_TEXTO;
+    r->tempo_us = time_us_32();
+    r->texto.fmt = fmt;
+    r->texto.args[0] = a0;
+    r->texto.args[1] = a1;
+    r->texto.args[2] = a2;
+    publicar(fila);
+}
+
+void log_ring_pacote(const log_pacote_t *pacote) {
+    log_fila_t *fila = fila_do_contexto();
+    log_registro_t *r = reservar(fila);
+    if (r == NULL) return;
+
+    r->tipo = LOG_REG_PACOTE;
+    r->tempo_us = time_us_32();
+    r->pacote = *pacote;
+    publicar(fila);
+}
+
+void log_ring_metricas(const log_metricas_t *metricas) {
+    log_fila_t *fila = fila_do_contexto();
+    log_registro_t *r = reservar(fila);
+    if (r == NULL) return;
+
+    r->tipo = LOG_REG_METRICAS;
+    r->tempo_us = time_us_32();
+    r->metricas = *metricas;
+    publicar(fila);
+}
+
+uint32_t log_ring_descartados(void) {
+    return _descartados;
+}
+
+// ============================================================================
+// --- Consumidor ---
+// ============================================================================
+
+/**
+ * @brief Retira o registro mais antigo entre as duas filas.
+ * @return false se ambas estiverem vazias.
+ */
+static bool retirar(log_registro_t *out) {
+    bool tem_isr = _fila_isr.cabeca != _fila_isr.cauda;
+    bool tem_main = _fila_main.cabeca != _fila_main.cauda;
+    log_fila_t *fila;
+
+    if (tem_isr && tem_main) {
+        const log_registro_t *a = &_fila_isr.registros[_fila_isr.cauda & (LOG_RING_TAMANHO - 1)];
+        const log_registro_t *b = &_fila_main.registros[_fila_main.cauda & (LOG_RING_TAMANHO - 1)];
+        fila = (int32_t)(a->tempo_us - b->tempo_us) <= 0 ? &_fila_isr : &_fila_main;
+    } else if (tem_isr) {
+        fila = &_fila_isr;
+    } else if (tem_main) {
+        fila = &_fila_main;
+    } else {
+        return false;
+    }
+
+    __dmb(); // Lê o conteúdo só depois de ter visto o índice
+    *out = fila->registros[fila->cauda & (LOG_RING_TAMANHO - 1)];
+    __dmb();
+    fila->cauda++;
+    return true;
+}
+
+#if LOG_SAIDA_BINARIA
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+    return p;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    p = put_u16(p, v & 0xFFFF);
+    return put_u16(p, v >> 16);
+}
+
+/**
+ * @brief Codifica `len` bytes com COBS em `out` e acrescenta o delimitador 0x00.
+ * @return Tamanho do quadro codificado.
+ */
+static uint16_t cobs_codificar(const uint8_t *in, uint16_t len, uint8_t *out) {
+    uint16_t pos_codigo = 0;
+    uint16_t o = 1;
+    uint8_t codigo = 1;
+
+    for (uint16_t i = 0; i < len; ++i) {
+        if (in[i] == 0) {
+            out[pos_codigo] = codigo;
+            pos_codigo = o++;
+            codigo = 1;
+        } else {
+            out[o++] = in[i];
+            if (++codigo == 0xFF) {
+                out[pos_codigo] = codigo;
+                pos_codigo = o++;
+                codigo = 1;
+            }
+        }
+    }
+    out[pos_codigo] = codigo;
+    out[o++] = 0x00;
+    return o;
+}
+
+/**
+ * @brief Serializa o registro como quadro binário COBS.
+ */
+static uint16_t serializar(const log_registro_t *r, uint8_t *out) {
+    uint8_t bruto[LOG_SAIDA_MAX - LOG_SAIDA_MAX / 254 - 2];
+    uint8_t *p = bruto;
+
+    *p++ = r->tipo;
+    p = put_u32(p, r->tempo_us / 1000);
+
+    switch (r->tipo) {
+        case LOG_REG_TEXTO: {
+            // A formatação adiada acontece aqui, fora do caminho crítico
+            size_t max = sizeof(bruto) - (p - bruto) - 2;
+            int n = snprintf((char *)p, max, r->texto.fmt,
+                             r->texto.args[0], r->texto.args[1], r->texto.args[2]);
+            p += (n < 0) ? 0 : ((size_t)n >= max ? max - 1 : (size_t)n);
+            break;
+        }
+        case LOG_REG_PACOTE:
+            p = put_u32(p, r->pacote.seq);
+            *p++ = r->pacote.remetente;
+            p = put_u16(p, r->pacote.rssi);
+            p = put_u16(p, r->pacote.snr_x4);
+            p = put_u16(p, r->pacote.temp_x10);
+            p = put_u16(p, r->pacote.umid);
+            p = put_u16(p, r->pacote.pres_x10);
+            break;
+        case LOG_REG_METRICAS:
+            p = put_u32(p, r->metricas.pacotes);
+            p = put_u32(p, r->metricas.quadros_desenhados);
+            p = put_u32(p, r->metricas.quadros_descartados);
+            p = put_u32(p, r->metricas.render_max_us);
+            p = put_u32(p, r->metricas.log_descartados);
+            break;
+    }
+
+    p = put_u16(p, crc16_ccitt(0xFFFF, bruto, p - bruto));
+    return cobs_codificar(bruto, p - bruto, out);
+}
+
+#else // Saída em texto
+
+/**
+ * @brief Formata o registro como uma linha de texto legível.
+ */
+static uint16_t serializar(const log_registro_t *r, uint8_t *out) {
+    char *s = (char *)out;
+    int n = 0;
+    int temp = r->pacote.temp_x10;
+
+    switch (r->tipo) {
+        case LOG_REG_TEXTO:
+            n = snprintf(s, LOG_SAIDA_MAX - 1, r->texto.fmt,
+                         r->texto.args[0], r->texto.args[1], r->texto.args[2]);
+            break;
+        case LOG_REG_PACOTE:
+            n = snprintf(s, LOG_SAIDA_MAX - 1, "Pacote #%lu @%u | T:%s%d.%d, H:%d, P:%d.%d | RSSI: %d",
+                         (unsigned long)r->pacote.seq, r->pacote.remetente,
+                         temp < 0 ? "-" : "", abs(temp) / 10, abs(temp) % 10,
+                         r->pacote.umid,
+                         r->pacote.pres_x10 / 10, abs(r->pacote.pres_x10 % 10),
+                         r->pacote.rssi);
+            break;
+        case LOG_REG_METRICAS:
+            n = snprintf(s, LOG_SAIDA_MAX - 1, "Metricas | pacotes:%lu quadros:%lu descartados:%lu render_max:%luus log_perdidos:%lu",
+                         (unsigned long)r->metricas.pacotes,
+                         (unsigned long)r->metricas.quadros_desenhados,
+                         (unsigned long)r->metricas.quadros_descartados,
+                         (unsigned long)r->metricas.render_max_us,
+                         (unsigned long)r->metricas.log_descartados);
+            break;
+    }
+
+    if (n < 0) n = 0;
+    if (n > LOG_SAIDA_MAX - 2) n = LOG_SAIDA_MAX - 2;
+    s[n++] = '\n';
+    return n;
+}
+
+#endif // LOG_SAIDA_BINARIA
+
+bool log_ring_vazio(void) {
+    return _fila_isr.cabeca == _fila_isr.cauda && _fila_main.cabeca == _fila_main.cauda;
+}
+
+bool log_ring_transmitindo(void) {
+    return _saida_pos != _saida_tamanho;
+}
+
+void log_ring_drain(uint32_t orcamento_bytes) {
+    while (orcamento_bytes > 0) {
+        if (_saida_pos == _saida_tamanho) {
+            log_registro_t r;
+            if (!retirar(&r)) {
+                return;
+            }
+            _saida_tamanho = serializar(&r, _saida);
+            _saida_pos = 0;
+        }
+
+        uint32_t n = _saida_tamanho - _saida_pos;
+        if (n > orcamento_bytes) n = orcamento_bytes;
+        stdio_put_string((const char *)&_saida[_saida_pos], n, false, false);
+        _saida_pos += n;
+        orcamento_bytes -= n;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================================================================
+// --- Canal de saída estruturado ---
+//
+// Produtores (ISR ou loop principal) apenas gravam registros de tamanho fixo
+// em filas circulares sem trava; a formatação e a escrita no stdio ficam
+// para log_ring_drain(), chamada pelo loop principal quando houver tempo.
+//
+// No modo binário (LOG_SAIDA_BINARIA = 1) cada registro vira um quadro COBS
+// terminado em 0x00:
+//   [tipo u8][tempo_ms u32][campos do tipo...][crc16 u16]   (little-endian)
+// Use tools/decodificar_log.py para converter o fluxo em CSV ou JSON.
+// ============================================================================
+
+// --- Tipos de registro ---
+#define LOG_REG_TEXTO     0x01
+#define LOG_REG_PACOTE    0x02
+#define LOG_REG_METRICAS  0x03
+
+/**
+ * @brief Dados de um pacote de telemetria decodificado, em ponto fixo.
+ */
+typedef struct {
+    uint32_t seq;          // Contador de pacotes válidos
+    uint8_t remetente;     // header_from
+    int16_t rssi;          // dBm
+    int16_t snr_x4;        // Quartos de dB
+    int16_t temp_x10;      // Décimos de °C
+    int16_t umid;          // %
+    int16_t pres_x10;      // Décimos de hPa
+} log_pacote_t;
+
+/**
+ * @brief Contadores periódicos de desempenho.
+ */
+typedef struct {
+    uint32_t pacotes;              // Pacotes válidos recebidos
+    uint32_t quadros_desenhados;   // Quadros enviados ao display
+    uint32_t quadros_descartados;  // Quadros coalescidos pelo escalonador
+    uint32_t render_max_us;        // Maior tempo de desenho de um quadro
+    uint32_t log_descartados;      // Registros perdidos por fila cheia
+} log_metricas_t;
+
+/**
+ * @brief Zera as filas e os contadores.
+ */
+void log_ring_init(void);
+
+/**
+ * @brief Registra uma mensagem de texto com formatação adiada.
+ *
+ * Apenas o ponteiro para `fmt` e os argumentos são guardados; a string é
+ * montada depois, em log_ring_drain(). Por isso `fmt` deve ser um literal
+ * (ou ter duração estática) e aceitar até três argumentos `int`.
+ * Pode ser chamada de dentro de interrupções.
+ */
+void log_ring_texto(const char *fmt, int a0, int a1, int a2);
+
+/**
+ * @brief Registra um pacote decodificado. Pode ser chamada de interrupções.
+ */
+void log_ring_pacote(const log_pacote_t *pacote);
+
+/**
+ * @brief Registra um conjunto de métricas. Pode ser chamada de interrupções.
+ */
+void log_ring_metricas(const log_metricas_t *metricas);
+
+/**
+ * @brief Formata e envia registros pendentes ao stdio.
+ *
+ * Escreve no máximo `orcamento_bytes` por chamada; um registro que não
+ * couber continua na chamada seguinte. Deve ser chamada só do loop principal.
+ */
+void log_ring_drain(uint32_t orcamento_bytes);
+
+/**
+ * @brief Indica se há um registro parcialmente enviado. Enquanto isso,
+ *        nenhuma outra saída deve escrever no stdio.
+ */
+bool log_ring_transmitindo(void);
+
+/**
+ * @brief Indica se as duas filas estão vazias (o registro em envio não conta).
+ */
+bool log_ring_vazio(void);
+
+/**
+ * @brief Número de registros descartados porque a fila estava cheia.
+ */
+uint32_t log_ring_descartados(void);
+
+#endif // LOG_RING_H
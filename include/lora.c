@@ -3,124 +3,287 @@
 #include <string.h>
 #include <math.h>
 #include "hardware/gpio.h"
+#include "hardware/structs/systick.h"
 #include "pico/time.h"
+#include "caminho_quente.h"
 
 // ============================================================================
-// --- Variáveis Estáticas (Privadas) ---
+// --- Transportes SPI ---
 // ============================================================================
 
-// Armazena a configuração passada durante a inicialização
-static lora_config_t _lora_config;
+/**
+ * @brief Operações de um transporte. Cada chamada é uma transação: o CS fica
+ *        ativo durante o byte de endereço (já com o bit de escrita) e os
+ *        `len` bytes seguintes.
+ */
+struct lora_transport {
+    const char *name;
+    void (*write)(lora_radio_t *radio, uint8_t addr, const uint8_t *data, size_t len);
+    void (*read)(lora_radio_t *radio, uint8_t addr, uint8_t *data, size_t len);
+};
+
+static void lora_hw_spi_write(lora_radio_t *radio, uint8_t addr, const uint8_t *data, size_t len);
+static void lora_hw_spi_read(lora_radio_t *radio, uint8_t addr, uint8_t *data, size_t len);
+static void lora_pio_write(lora_radio_t *radio, uint8_t addr, const uint8_t *data, size_t len);
+static void lora_pio_read(lora_radio_t *radio, uint8_t addr, uint8_t *data, size_t len);
 
-// Ponteiro para a função de callback do usuário para pacotes recebidos
-static void (*_on_receive_callback)(lora_payload_t*);
+// Consultadas a cada acesso a registrador, inclusive na ISR
+static const struct lora_transport TABELA_QUENTE("lora_transport_spi") _transport_spi = {"spi", lora_hw_spi_write, lora_hw_spi_read};
+static const struct lora_transport TABELA_QUENTE("lora_transport_pio") _transport_pio = {"pio", lora_pio_write, lora_pio_read};
 
-// Rastreia o modo de operação atual do rádio
-static uint8_t _current_mode = MODE_STDBY;
+// ============================================================================
+// --- Variáveis Estáticas (Privadas) ---
+// ============================================================================
 
-// ID do último pacote enviado, usado para correspondência de ACK
-static uint8_t _last_header_id = 0;
+// Rádios registrados, consultados pelo despachante da interrupção de GPIO
+static lora_radio_t *_radios[LORA_MAX_RADIOS];
+static uint8_t _num_radios = 0;
 
-// Flag volátil para indicar o recebimento de um ACK, usado em lora_send_to_wait
-static volatile bool _ack_received = false;
+// Transações SPI em andamento por barramento (spi0/spi1). Rádios no mesmo
+// barramento compartilham o contador: o monitor de saúde não interrompe uma
+// transação do loop principal, seja qual for o rádio. A ISR do GPIO não o
+// consulta: durante as transações do loop ela fica mascarada
+// (lora_bus_irq_mask).
+static volatile uint8_t _spi_busy[2];
 
-// Buffer para o último ACK recebido, para verificação do ID
-static lora_payload_t _last_ack_payload;
+// Fila agregada de pacotes recebidos por todos os rádios. As ISRs de todos
+// os rádios têm a mesma prioridade e nunca se interrompem, então há um
+// único produtor por vez e um único consumidor (o loop principal).
+static lora_payload_t _rx_queue[LORA_RX_QUEUE_LEN];
+static volatile uint32_t _rx_head = 0;
+static volatile uint32_t _rx_tail = 0;
+static volatile uint32_t _rx_dropped = 0;
 
 
 // ============================================================================
 // --- Protótipos de Funções Estáticas (Privadas) ---
 // ============================================================================
 
-static void lora_spi_write_reg(uint8_t reg, const uint8_t *data, size_t len);
-static void lora_spi_read_reg(uint8_t reg, uint8_t *data, size_t len);
-static uint8_t lora_spi_read_single_reg(uint8_t reg);
-
-static void lora_set_modem_config(modem_config_t modem);
-static void lora_set_frequency(float freq_mhz);
-static void lora_set_tx_power(uint8_t tx_power);
-static void lora_send_ack(uint8_t to, uint8_t id);
-
-static void gpio_irq_handler(uint gpio, uint32_t events);
+static void lora_spi_write_reg(lora_radio_t *radio, uint8_t reg, const uint8_t *data, size_t len);
+static void lora_spi_read_reg(lora_radio_t *radio, uint8_t reg, uint8_t *data, size_t len);
+static uint8_t lora_spi_read_single_reg(lora_radio_t *radio, uint8_t reg);
+
+static void lora_set_modem_config(lora_radio_t *radio, modem_config_t modem);
+static void lora_set_frequency(lora_radio_t *radio, float freq_mhz);
+static void lora_set_tx_power(lora_radio_t *radio, uint8_t tx_power);
+static void lora_send_ack(lora_radio_t *radio, const lora_payload_t *pacote);
+static bool lora_transmit(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to, uint8_t flags);
+static void lora_enter_lora_mode(lora_radio_t *radio);
+static bool lora_configure_radio(lora_radio_t *radio);
+static void lora_rearm_rx(lora_radio_t *radio);
+static bool lora_health_check(repeating_timer_t *rt);
+
+static void lora_service_irq(lora_radio_t *radio, uint32_t ciclo_entrada);
+static void lora_service_header(lora_radio_t *radio);
+static inline uint32_t lora_ciclos(void);
+static void lora_gpio_dispatch(uint gpio, uint32_t events);
+static void lora_bus_irq_mask(const lora_radio_t *radio, bool mascarar);
+static bool lora_bus_acquire(lora_radio_t *radio);
+static void lora_bus_release(lora_radio_t *radio, bool mascarou);
 
 // ============================================================================
 // --- Implementação das Funções Públicas ---
 // ============================================================================
 
-bool lora_init(lora_config_t *config) {
-    _lora_config = *config;
+bool lora_init(lora_radio_t *radio, lora_config_t *config) {
+    // Registra o rádio no despachante (uma vez só, mesmo se reinicializado)
+    bool registrado = false;
+    for (uint8_t i = 0; i < _num_radios; ++i) {
+        registrado |= _radios[i] == radio;
+    }
+    if (!registrado) {
+        if (_num_radios >= LORA_MAX_RADIOS) {
+            return false;
+        }
+        memset(radio, 0, sizeof(*radio));
+        radio->index = _num_radios;
+        radio->current_mode = MODE_STDBY;
+    }
+    if (registrado && radio->transport == &_transport_pio) {
+        lora_pio_spi_deinit(&radio->pio_spi); // Reinicialização: libera a máquina de estados
+    }
+    radio->config = *config;
 
-    // 1. Inicializa SPI
-    spi_init(_lora_config.spi_port, 5000000); // Inicializa em 5 MHz
-    gpio_set_function(_lora_config.interrupt_pin, GPIO_FUNC_SIO); // O pino de interrupção é um GPIO normal para o SDK
-    spi_set_format(_lora_config.spi_port, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    uint32_t spi_hz = config->spi_hz ? config->spi_hz : LORA_SPI_DEFAULT_HZ;
+    if (spi_hz > LORA_SPI_MAX_HZ) {
+        spi_hz = LORA_SPI_MAX_HZ;
+    }
 
-    // 2. Inicializa pinos GPIO
-    gpio_init(_lora_config.cs_pin);
-    gpio_set_dir(_lora_config.cs_pin, GPIO_OUT);
-    gpio_put(_lora_config.cs_pin, 1); // Desativar CS
+    // 1. e 2. Inicializa o transporte e os pinos do barramento
+    if (radio->config.transport == LORA_TRANSPORT_PIO) {
+        if (!lora_pio_spi_init(&radio->pio_spi, LORA_PIO_INSTANCE, radio->config.sck_pin, radio->config.mosi_pin,
+                               radio->config.miso_pin, radio->config.cs_pin, spi_hz)) {
+            radio->transport = NULL;
+            return false;
+        }
+        radio->spi_hz = radio->pio_spi.hz;
+        radio->transport = &_transport_pio;
+    } else {
+        // O periférico só é inicializado se nenhum outro rádio usa o barramento
+        // (reiniciá-lo agora atrapalharia uma transação da ISR desse rádio);
+        // o clock fica o do primeiro rádio
+        bool barramento_em_uso = false;
+        for (uint8_t i = 0; i < _num_radios; ++i) {
+            barramento_em_uso |= _radios[i] != radio && _radios[i]->config.spi_port == radio->config.spi_port;
+        }
+        if (!barramento_em_uso) {
+            radio->spi_hz = spi_init(radio->config.spi_port, spi_hz);
+            spi_set_format(radio->config.spi_port, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+        } else {
+            radio->spi_hz = spi_get_baudrate(radio->config.spi_port);
+        }
+        gpio_set_function(radio->config.sck_pin, GPIO_FUNC_SPI);
+        gpio_set_function(radio->config.mosi_pin, GPIO_FUNC_SPI);
+        gpio_set_function(radio->config.miso_pin, GPIO_FUNC_SPI);
+
+        gpio_init(radio->config.cs_pin);
+        gpio_set_dir(radio->config.cs_pin, GPIO_OUT);
+        gpio_put(radio->config.cs_pin, 1); // Desativar CS
+        radio->transport = &_transport_spi;
+    }
+    gpio_set_function(radio->config.interrupt_pin, GPIO_FUNC_SIO); // O pino de interrupção é um GPIO normal para o SDK
+    if (radio->config.header_pin != 0) {
+        gpio_set_function(radio->config.header_pin, GPIO_FUNC_SIO);
+    }
 
     // Se um pino de reset for fornecido, execute o ciclo de reset
-    if (_lora_config.reset_pin != 0) { // Assume 0 como "não conectado"
-        gpio_init(_lora_config.reset_pin);
-        gpio_set_dir(_lora_config.reset_pin, GPIO_OUT);
-        gpio_put(_lora_config.reset_pin, 0);
+    if (radio->config.reset_pin != 0) { // Assume 0 como "não conectado"
+        gpio_init(radio->config.reset_pin);
+        gpio_set_dir(radio->config.reset_pin, GPIO_OUT);
+        gpio_put(radio->config.reset_pin, 0);
         sleep_ms(10);
-        gpio_put(_lora_config.reset_pin, 1);
+        gpio_put(radio->config.reset_pin, 1);
         sleep_ms(10);
     }
 
-    // 3. Configura o chip LoRa
-    // Entra no modo SLEEP e LoRa
-    lora_sleep();
-    uint8_t op_mode_lora = LONG_RANGE_MODE | MODE_SLEEP;
-    lora_spi_write_reg(REG_01_OP_MODE, &op_mode_lora, 1);
+    // 3. e 4. Configura o chip LoRa e aplica as configurações específicas
+    lora_enter_lora_mode(radio);
     sleep_ms(10);
-
-    // Verifica se o modo foi definido corretamente
-    if (lora_spi_read_single_reg(REG_01_OP_MODE) != op_mode_lora) {
+    if (!lora_configure_radio(radio)) {
         return false;
     }
-
-    // Define os endereços base do FIFO
-    uint8_t fifo_addr = 0x00;
-    lora_spi_write_reg(REG_0E_FIFO_TX_BASE_ADDR, &fifo_addr, 1);
-    lora_spi_write_reg(REG_0F_FIFO_RX_BASE_ADDR, &fifo_addr, 1);
-
-    lora_set_mode_idle();
-
-    // 4. Aplica configurações específicas
-    lora_set_modem_config(_lora_config.modem);
-    lora_set_frequency(_lora_config.freq);
-    lora_set_tx_power(_lora_config.tx_power);
+    radio->rssi_offset = radio->config.freq >= 779.0f ? -157 : -164;
     
-    // Define o comprimento do preâmbulo para 8
-    uint8_t preamble_msb = 0x00;
-    uint8_t preamble_lsb = 0x08;
-    lora_spi_write_reg(REG_20_PREAMBLE_MSB, &preamble_msb, 1);
-    lora_spi_write_reg(REG_21_PREAMBLE_LSB, &preamble_lsb, 1);
-    
-    // 5. Configura a interrupção do GPIO
+    // 5. Configura a interrupção do GPIO. O callback de GPIO do SDK é um só
+    //    por núcleo; o despachante encontra o rádio pelo pino.
+    if (!registrado) {
+        _radios[_num_radios++] = radio;
+    }
+    // SysTick livre como contador de ciclos para a medida de latência da
+    // ISR (o SDK não o usa; sem a interrupção de recarga)
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
     gpio_set_irq_enabled_with_callback(
-        _lora_config.interrupt_pin,
-        GPIO_IRQ_EDGE_RISE,
+        radio->config.interrupt_pin,
+        GPIO_IRQ_LEVEL_HIGH, // Nível: um evento pendente nunca depende de uma borda nova
         true,
-        &gpio_irq_handler
+        &lora_gpio_dispatch
     );
+    radio->irq_pins = LORA_IRQ_PIN_DIO0;
+    radio->irq_empty_streak = 0;
+    if (radio->config.header_pin != 0) {
+        gpio_set_irq_enabled(radio->config.header_pin, GPIO_IRQ_LEVEL_HIGH, true);
+        radio->irq_pins |= LORA_IRQ_PIN_HEADER;
+    }
     
-    lora_set_mode_rx_continuous();
+    lora_set_mode_rx_continuous(radio);
 
     return true;
 }
 
-void lora_on_receive(void (*callback)(lora_payload_t*)) {
-    _on_receive_callback = callback;
+void lora_on_receive(lora_radio_t *radio, void (*callback)(lora_payload_t*)) {
+    radio->on_receive = callback;
+}
+
+void lora_on_crc_error(lora_radio_t *radio, void (*callback)(uint8_t radio, uint64_t t_us)) {
+    radio->on_crc_error = callback;
+}
+
+void lora_accept_length(lora_radio_t *radio, uint8_t min, uint8_t max) {
+    for (uint32_t n = min; n <= max; ++n) {
+        radio->rx_lengths[n >> 5] |= 1u << (n & 31);
+    }
+    radio->rx_length_filter = true;
+}
+
+void lora_on_ack(lora_radio_t *radio,
+                 uint8_t (*callback)(const lora_radio_t *radio, const lora_payload_t *pacote, uint8_t *extra)) {
+    radio->ack_extra = callback;
+}
+
+void lora_reconfigure(lora_radio_t *radio, modem_config_t modem, uint8_t tx_power) {
+    bool recebendo = radio->current_mode == MODE_RXCONTINUOUS;
+    lora_set_mode_idle(radio);
+    radio->config.modem = modem;
+    radio->config.tx_power = tx_power;
+    lora_set_modem_config(radio, modem);
+    lora_set_tx_power(radio, tx_power);
+    if (recebendo) {
+        lora_set_mode_rx_continuous(radio);
+    }
+}
+
+bool lora_send(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to) {
+    // Um ACK ou beacon já no ar termina antes: o TxDone o tira de MODE_TX
+    uint64_t inicio = time_us_64();
+    uint32_t prazo_us = lora_airtime_us(radio, LORA_MAX_PAYLOAD + 4);
+    while (!lora_transmit(radio, data, length, header_to, 0)) {
+        if (length > LORA_MAX_PAYLOAD || time_us_64() - inicio > prazo_us) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool lora_send_async(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to, uint8_t flags) {
+    if (length > LORA_MAX_PAYLOAD || _spi_busy[spi_get_index(radio->config.spi_port)] ||
+        radio->current_mode == MODE_TX) {
+        return false;
+    }
+    if (radio->current_mode == MODE_RXCONTINUOUS && !lora_rx_idle(radio)) {
+        return false; // Não derruba um pacote em recepção
+    }
+    radio->rx_after_tx = true;
+    return lora_transmit(radio, data, length, header_to, flags);
+}
+
+uint32_t lora_airtime_us(const lora_radio_t *radio, size_t length) {
+    // SF, largura de banda (kHz x 4), taxa de código (1 = 4/5 ... 4 = 4/8) e
+    // otimização para taxa baixa de cada perfil, como em lora_set_modem_config
+    static const struct { uint8_t sf; uint16_t bw_x4; uint8_t cr, ldro; } perfis[] = {
+        [BW125_CR45_SF128]   = { 7, 500, 1, 0 },
+        [BW500_CR45_SF128]   = { 7, 2000, 1, 0 },
+        [BW31_25_CR48_SF512] = { 9, 125, 4, 0 },
+        [BW125_CR48_SF4096]  = { 12, 500, 4, 1 },
+    };
+    modem_config_t modem = radio->config.modem;
+    if (modem >= sizeof(perfis) / sizeof(perfis[0])) {
+        modem = BW125_CR45_SF128;
+    }
+    uint32_t sf = perfis[modem].sf;
+    uint32_t tsym_us = (1000u << sf) * 4 / perfis[modem].bw_x4;
+    int32_t bits = 8 * (int32_t)length - 4 * (int32_t)sf + 28 + 16;
+    int32_t divisor = 4 * ((int32_t)sf - 2 * perfis[modem].ldro);
+    uint32_t simbolos = 8 + (bits > 0 ? (uint32_t)((bits + divisor - 1) / divisor) * (perfis[modem].cr + 4) : 0);
+    return tsym_us * (8 * 4 + 17) / 4 + simbolos * tsym_us; // Preâmbulo: 8 + 4,25 símbolos
 }
 
-void lora_send(const uint8_t *data, size_t length, uint8_t header_to) {
-    lora_set_mode_idle();
+static bool lora_transmit(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to, uint8_t flags) {
+    if (length > LORA_MAX_PAYLOAD) {
+        return false; // Não cabe no FIFO (nem em `payload`)
+    }
+
+    // As cinco transações são uma sequência só: no loop principal a ISR (que
+    // transmitiria um ACK) fica mascarada até o fim, e o alarme do TDMA
+    // encontra o barramento ocupado. Um ACK que começou antes não é abortado
+    bool mascarou = lora_bus_acquire(radio);
+    if (radio->current_mode == MODE_TX) {
+        lora_bus_release(radio, mascarou);
+        return false;
+    }
+    lora_set_mode_idle(radio);
     
-    uint8_t header[4] = {header_to, _lora_config.this_address, _last_header_id, 0};
+    uint8_t header[4] = {header_to, radio->config.this_address, radio->last_header_id, flags};
     uint8_t payload[255];
     
     memcpy(payload, header, 4);
@@ -130,231 +293,743 @@ void lora_send(const uint8_t *data, size_t length, uint8_t header_to) {
     
     // Posiciona o ponteiro do FIFO para a base de TX
     uint8_t fifo_tx_base = 0x00;
-    lora_spi_write_reg(REG_0D_FIFO_ADDR_PTR, &fifo_tx_base, 1);
+    lora_spi_write_reg(radio, REG_0D_FIFO_ADDR_PTR, &fifo_tx_base, 1);
 
     // Escreve o payload no FIFO
-    lora_spi_write_reg(REG_00_FIFO, payload, payload_len);
+    lora_spi_write_reg(radio, REG_00_FIFO, payload, payload_len);
     
     // Define o tamanho do payload
-    lora_spi_write_reg(REG_22_PAYLOAD_LENGTH, (uint8_t*)&payload_len, 1);
+    lora_spi_write_reg(radio, REG_22_PAYLOAD_LENGTH, (uint8_t*)&payload_len, 1);
     
     // Inicia a transmissão
-    lora_set_mode_tx();
+    lora_set_mode_tx(radio);
+    lora_bus_release(radio, mascarou);
+    return true;
 }
 
-bool lora_send_to_wait(const uint8_t *data, size_t length, uint8_t header_to, int retries, uint32_t retry_timeout_ms) {
+bool lora_send_to_wait(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to, int retries, uint32_t retry_timeout_ms) {
     if (header_to == BROADCAST_ADDRESS) {
         return false; // Não se pode esperar ACK de broadcast
     }
+    if (length > LORA_MAX_PAYLOAD) {
+        return false;
+    }
 
-    _last_header_id = (_last_header_id + 1) & 0xFF; // Incrementa e limita a 8 bits
+    radio->last_header_id = (radio->last_header_id + 1) & 0xFF; // Incrementa e limita a 8 bits
     
     for (int i = 0; i <= retries; i++) {
-        _ack_received = false;
+        radio->ack_received = false;
         
         // Envia o pacote
-        lora_send(data, length, header_to);
+        lora_send(radio, data, length, header_to);
 
         // Espera TX completar (o modo muda para IDLE no IRQ)
         uint64_t start_tx = time_us_64();
-        while (_current_mode == MODE_TX) {
+        while (radio->current_mode == MODE_TX) {
             if (time_us_64() - start_tx > 500000) { // Timeout de 500ms para TX
                  break;
             }
         }
 
         // Entra no modo de recepção para esperar o ACK
-        lora_set_mode_rx_continuous();
+        lora_set_mode_rx_continuous(radio);
 
         uint64_t start_time = time_us_64();
         while ((time_us_64() - start_time) / 1000 < retry_timeout_ms) {
-            if (_ack_received) {
+            if (radio->ack_received) {
                 // Verifica se o ID do ACK corresponde ao pacote enviado
-                if (_last_ack_payload.header_id == _last_header_id) {
-                    lora_set_mode_rx_continuous();
+                if (radio->last_ack_payload.header_id == radio->last_header_id) {
+                    lora_set_mode_rx_continuous(radio);
                     return true;
                 }
-                _ack_received = false; // ID incorreto, continue esperando
+                radio->ack_received = false; // ID incorreto, continue esperando
             }
         }
     }
     
-    lora_set_mode_rx_continuous(); // Retorna ao modo de escuta
+    lora_set_mode_rx_continuous(radio); // Retorna ao modo de escuta
     return false;
 }
 
-void lora_set_mode_idle() {
-    if (_current_mode != MODE_STDBY) {
+void CAMINHO_QUENTE(lora_set_mode_idle)(lora_radio_t *radio) {
+    if (radio->current_mode != MODE_STDBY) {
         uint8_t mode = LONG_RANGE_MODE | MODE_STDBY;
-        lora_spi_write_reg(REG_01_OP_MODE, &mode, 1);
-        _current_mode = MODE_STDBY;
+        lora_spi_write_reg(radio, REG_01_OP_MODE, &mode, 1);
+        radio->current_mode = MODE_STDBY;
     }
 }
 
-void lora_set_mode_rx_continuous() {
-    if (_current_mode != MODE_RXCONTINUOUS) {
+void CAMINHO_QUENTE(lora_set_mode_rx_continuous)(lora_radio_t *radio) {
+    if (radio->current_mode != MODE_RXCONTINUOUS) {
         uint8_t mode = LONG_RANGE_MODE | MODE_RXCONTINUOUS;
-        lora_spi_write_reg(REG_01_OP_MODE, &mode, 1);
-        uint8_t dio_mapping = 0x00; // DIO0 em RxDone
-        lora_spi_write_reg(REG_40_DIO_MAPPING1, &dio_mapping, 1);
-        _current_mode = MODE_RXCONTINUOUS;
+        lora_spi_write_reg(radio, REG_01_OP_MODE, &mode, 1);
+        // DIO0 em RxDone; DIO3 em ValidHeader se estiver ligado (senão CadDone)
+        uint8_t dio_mapping = radio->config.header_pin != 0 ? 0x01 : 0x00;
+        lora_spi_write_reg(radio, REG_40_DIO_MAPPING1, &dio_mapping, 1);
+        radio->current_mode = MODE_RXCONTINUOUS;
     }
 }
 
-void lora_set_mode_tx() {
-    if (_current_mode != MODE_TX) {
+void CAMINHO_QUENTE(lora_set_mode_tx)(lora_radio_t *radio) {
+    if (radio->current_mode != MODE_TX) {
         uint8_t mode = LONG_RANGE_MODE | MODE_TX;
-        lora_spi_write_reg(REG_01_OP_MODE, &mode, 1);
+        lora_spi_write_reg(radio, REG_01_OP_MODE, &mode, 1);
         uint8_t dio_mapping = 0x40; // DIO0 em TxDone
-        lora_spi_write_reg(REG_40_DIO_MAPPING1, &dio_mapping, 1);
-        _current_mode = MODE_TX;
+        lora_spi_write_reg(radio, REG_40_DIO_MAPPING1, &dio_mapping, 1);
+        radio->current_mode = MODE_TX;
     }
 }
 
-void lora_sleep() {
-    if (_current_mode != MODE_SLEEP) {
+void lora_sleep(lora_radio_t *radio) {
+    if (radio->current_mode != MODE_SLEEP) {
         uint8_t mode = LONG_RANGE_MODE | MODE_SLEEP;
-        lora_spi_write_reg(REG_01_OP_MODE, &mode, 1);
-        _current_mode = MODE_SLEEP;
+        lora_spi_write_reg(radio, REG_01_OP_MODE, &mode, 1);
+        radio->current_mode = MODE_SLEEP;
+    }
+}
+
+void lora_close(lora_radio_t *radio) {
+    lora_health_stop(radio);
+    radio->irq_pins = 0;
+    gpio_set_irq_enabled(radio->config.interrupt_pin, GPIO_IRQ_LEVEL_HIGH, false);
+    if (radio->config.header_pin != 0) {
+        gpio_set_irq_enabled(radio->config.header_pin, GPIO_IRQ_LEVEL_HIGH, false);
+    }
+
+    if (radio->transport == &_transport_pio) {
+        lora_pio_spi_deinit(&radio->pio_spi);
+        radio->transport = NULL;
+        return;
+    }
+
+    // O barramento só é desligado quando nenhum outro rádio o usa
+    bool compartilhado = false;
+    for (uint8_t i = 0; i < _num_radios; ++i) {
+        compartilhado |= _radios[i] != radio && _radios[i]->config.spi_port == radio->config.spi_port;
+    }
+    if (!compartilhado) {
+        spi_deinit(radio->config.spi_port);
     }
 }
 
-void lora_close() {
-    spi_deinit(_lora_config.spi_port);
+const char *lora_transport_name(lora_radio_t *radio) {
+    return radio->transport ? radio->transport->name : "-";
+}
+
+void lora_spi_benchmark(lora_radio_t *radio, uint32_t iterations, uint32_t *single_us, uint32_t *burst_us) {
+    uint8_t regs[32];
+
+    uint64_t inicio = time_us_64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        (void)lora_spi_read_single_reg(radio, REG_01_OP_MODE);
+    }
+    *single_us = (uint32_t)(time_us_64() - inicio);
+
+    // A partir de RegOpMode o endereço é incrementado a cada byte; o FIFO
+    // (0x00), cujo ponteiro andaria, fica de fora
+    inicio = time_us_64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        lora_spi_read_reg(radio, REG_01_OP_MODE, regs, sizeof(regs));
+    }
+    *burst_us = (uint32_t)(time_us_64() - inicio);
+}
+
+bool lora_rx_queue_pop(lora_payload_t *payload) {
+    if (_rx_tail == _rx_head) {
+        return false;
+    }
+    __dmb(); // Conteúdo lido depois do índice
+    *payload = _rx_queue[_rx_tail & (LORA_RX_QUEUE_LEN - 1)];
+    __dmb(); // Cópia terminada antes de liberar a posição
+    _rx_tail++;
+    return true;
+}
+
+uint32_t lora_rx_queue_dropped(void) {
+    return _rx_dropped;
+}
+
+bool lora_health_start(lora_radio_t *radio, uint32_t period_ms, uint32_t modem_margin_ms, uint32_t no_rx_timeout_ms) {
+    lora_health_stop(radio);
+    memset(&radio->health, 0, sizeof(radio->health));
+    radio->health_period_ms = period_ms;
+    radio->health_modem_margin_ms = modem_margin_ms;
+    radio->health_reconfigure = false;
+    radio->health_no_rx_us = no_rx_timeout_ms * 1000u;
+    radio->health_dio0_high = 0;
+    radio->health_modem_busy_ticks = 0;
+    radio->last_rx_us = time_us_64();
+    radio->health_running = add_repeating_timer_ms(period_ms, lora_health_check, radio, &radio->health_timer);
+    return radio->health_running;
+}
+
+void lora_health_stop(lora_radio_t *radio) {
+    if (radio->health_running) {
+        cancel_repeating_timer(&radio->health_timer);
+        radio->health_running = false;
+    }
+}
+
+lora_health_t lora_health_stats(lora_radio_t *radio) {
+    return radio->health;
+}
+
+lora_irq_stats_t lora_irq_stats(lora_radio_t *radio) {
+    return radio->irq_stats;
+}
+
+void lora_irq_latency_reset(lora_radio_t *radio) {
+    uint32_t estado = save_and_disable_interrupts();
+    radio->irq_stats.fifo_samples = 0;
+    radio->irq_stats.fifo_cycles_min = 0;
+    radio->irq_stats.fifo_cycles_max = 0;
+    radio->irq_stats.fifo_cycles_sum = 0;
+    radio->irq_stats.fifo_cycles_sq_sum = 0;
+    restore_interrupts(estado);
+}
+
+bool lora_rx_idle(lora_radio_t *radio) {
+    if (gpio_get(radio->config.interrupt_pin)) {
+        return false; // Evento esperando a ISR
+    }
+    uint8_t modem_stat = lora_spi_read_single_reg(radio, REG_18_MODEM_STAT);
+    return !(modem_stat & (MODEM_STATUS_SIGNAL_DETECTED | MODEM_STATUS_SIGNAL_SYNCED | MODEM_STATUS_RX_ONGOING));
 }
 
 // ============================================================================
 // --- Implementação das Funções Estáticas (Privadas) ---
 // ============================================================================
 
-static void lora_send_ack(uint8_t to, uint8_t id) {
-    lora_set_mode_idle();
+/**
+ * @brief Coloca o chip em SLEEP no modo LoRa, o primeiro passo da
+ *        configuração. Usada na inicialização e quando o rádio é encontrado
+ *        resetado; a configuração vem 10 ms depois (lora_configure_radio).
+ */
+static void lora_enter_lora_mode(lora_radio_t *radio) {
+    // O bit LoRa só pode mudar em SLEEP
+    uint8_t op_mode_lora = LONG_RANGE_MODE | MODE_SLEEP;
+    lora_spi_write_reg(radio, REG_01_OP_MODE, &op_mode_lora, 1);
+    radio->current_mode = MODE_SLEEP;
+}
+
+/**
+ * @brief Grava toda a configuração de rádio, com o chip já em SLEEP e LoRa
+ *        (lora_enter_lora_mode) há pelo menos 10 ms.
+ */
+static bool lora_configure_radio(lora_radio_t *radio) {
+    // Verifica se o modo foi definido corretamente
+    if (lora_spi_read_single_reg(radio, REG_01_OP_MODE) != (LONG_RANGE_MODE | MODE_SLEEP)) {
+        return false;
+    }
+
+    // Define os endereços base do FIFO
+    uint8_t fifo_addr = 0x00;
+    lora_spi_write_reg(radio, REG_0E_FIFO_TX_BASE_ADDR, &fifo_addr, 1);
+    lora_spi_write_reg(radio, REG_0F_FIFO_RX_BASE_ADDR, &fifo_addr, 1);
+
+    lora_set_mode_idle(radio);
+
+    lora_set_modem_config(radio, radio->config.modem);
+    lora_set_frequency(radio, radio->config.freq);
+    lora_set_tx_power(radio, radio->config.tx_power);
+
+    // Sync word da rede: quadros de outras redes no canal são rejeitados pelo
+    // próprio modem, antes de qualquer interrupção
+    uint8_t sync_word = radio->config.sync_word ? radio->config.sync_word : LORA_SYNC_WORD_DEFAULT;
+    lora_spi_write_reg(radio, REG_39_SYNC_WORD, &sync_word, 1);
+    
+    // Define o comprimento do preâmbulo para 8
+    uint8_t preamble_msb = 0x00;
+    uint8_t preamble_lsb = 0x08;
+    lora_spi_write_reg(radio, REG_20_PREAMBLE_MSB, &preamble_msb, 1);
+    lora_spi_write_reg(radio, REG_21_PREAMBLE_LSB, &preamble_lsb, 1);
+    return true;
+}
+
+/**
+ * @brief Recuperação mínima da recepção: standby, limpa os flags, volta o
+ *        FIFO ao início e reentra em RX contínuo (remapeando o DIO0).
+ */
+static void CAMINHO_QUENTE(lora_rearm_rx)(lora_radio_t *radio) {
+    uint8_t mode = LONG_RANGE_MODE | MODE_STDBY;
+    lora_spi_write_reg(radio, REG_01_OP_MODE, &mode, 1);
+    radio->current_mode = MODE_STDBY;
+
+    uint8_t clear = IRQ_FLAGS_CLEAR;
+    lora_spi_write_reg(radio, REG_12_IRQ_FLAGS, &clear, 1);
+
+    uint8_t fifo_addr = 0x00;
+    lora_spi_write_reg(radio, REG_0F_FIFO_RX_BASE_ADDR, &fifo_addr, 1);
+    lora_spi_write_reg(radio, REG_0D_FIFO_ADDR_PTR, &fifo_addr, 1);
+
+    lora_set_mode_rx_continuous(radio);
+}
+
+/**
+ * @brief Verificação periódica do monitor de saúde (contexto do alarme).
+ *
+ * Tem a mesma prioridade da ISR do GPIO, então nunca a interrompe; só
+ * precisa evitar transações SPI do loop principal em andamento.
+ */
+static bool lora_health_check(repeating_timer_t *rt) {
+    lora_radio_t *radio = rt->user_data;
+    radio->health.checks++;
+    bool ocupado = _spi_busy[spi_get_index(radio->config.spi_port)];
+
+    // DIO0 mascarado pela ISR (alto sem eventos): em RX rearma, o que também
+    // refaz o mapeamento, e devolve a interrupção em qualquer modo (um TxDone
+    // real ficaria sem atendimento). Se continuar preso, a ISR mascara de novo.
+    if (!(radio->irq_pins & LORA_IRQ_PIN_DIO0) && !ocupado) {
+        radio->health.dio0_unmasks++;
+        radio->health.last_incident_us = time_us_64();
+        if (radio->current_mode == MODE_RXCONTINUOUS) {
+            lora_rearm_rx(radio);
+        }
+        radio->irq_pins |= LORA_IRQ_PIN_DIO0;
+        gpio_set_irq_enabled(radio->config.interrupt_pin, GPIO_IRQ_LEVEL_HIGH, true);
+        return true;
+    }
+
+    if (radio->current_mode != MODE_RXCONTINUOUS && !radio->health_reconfigure) {
+        return true; // TX/standby são controlados por quem chamou lora_send
+    }
+    if (ocupado) {
+        radio->health.checks_skipped++;
+        return true;
+    }
+    uint64_t now = time_us_64();
+
+    // 0. Chip resetado na verificação anterior: já está em SLEEP e LoRa há
+    //    um período inteiro, grava a configuração e volta ao RX contínuo.
+    //    A espera de 10 ms do lora_init não cabe num alarme.
+    if (radio->health_reconfigure) {
+        if (lora_configure_radio(radio)) {
+            radio->health_reconfigure = false;
+            lora_rearm_rx(radio);
+        } else {
+            lora_enter_lora_mode(radio); // Chip não responde; tenta de novo
+        }
+        return true;
+    }
+
+    // 1. DIO0 alto em duas verificações seguidas: a interrupção não está
+    //    sendo atendida (desabilitada por alguém ou perdida). Atende o
+    //    pacote pendente pelo mesmo caminho da ISR.
+    if (gpio_get(radio->config.interrupt_pin)) {
+        if (++radio->health_dio0_high < 2) {
+            return true;
+        }
+        radio->health_dio0_high = 0;
+        radio->health.missed_irqs++;
+        radio->health.last_incident_us = now;
+        if (lora_spi_read_single_reg(radio, REG_12_IRQ_FLAGS) & IRQ_FLAG_RX_DONE) {
+            lora_service_irq(radio, lora_ciclos());
+        } else {
+            lora_rearm_rx(radio); // DIO0 alto sem RxDone: mapeamento perdido
+        }
+        return true;
+    }
+    radio->health_dio0_high = 0;
+
+    // 2. Modo de operação: sem o bit LoRa o chip foi resetado e perdeu toda
+    //    a configuração; com ele, basta voltar ao RX contínuo
+    uint8_t op_mode = lora_spi_read_single_reg(radio, REG_01_OP_MODE);
+    if (op_mode != (LONG_RANGE_MODE | MODE_RXCONTINUOUS)) {
+        radio->health.last_incident_us = now;
+        if (!(op_mode & LONG_RANGE_MODE)) {
+            radio->health.radio_resets++;
+            lora_enter_lora_mode(radio);
+            radio->health_reconfigure = true; // Termina na próxima verificação
+            return true;
+        }
+        radio->health.mode_rearms++;
+        lora_rearm_rx(radio);
+        return true;
+    }
+
+    // 3. Modem preso com sinal detectado por mais tempo que o maior quadro
+    //    possível no perfil atual (que o ADR pode ter trocado), mais a folga
+    uint8_t modem_stat = lora_spi_read_single_reg(radio, REG_18_MODEM_STAT);
+    if (modem_stat & (MODEM_STATUS_SIGNAL_DETECTED | MODEM_STATUS_SIGNAL_SYNCED | MODEM_STATUS_RX_ONGOING)) {
+        uint32_t limite_ms = lora_airtime_us(radio, 4 + LORA_MAX_PAYLOAD) / 1000 + radio->health_modem_margin_ms;
+        if (++radio->health_modem_busy_ticks * radio->health_period_ms >= limite_ms) {
+            radio->health_modem_busy_ticks = 0;
+            radio->health.modem_stalls++;
+            radio->health.last_incident_us = now;
+            lora_rearm_rx(radio);
+        }
+        return true;
+    }
+    radio->health_modem_busy_ticks = 0;
+
+    // 4. Silêncio prolongado: rearma por precaução (o transmissor pode
+    //    apenas estar desligado, então o prazo recomeça)
+    if (radio->health_no_rx_us && now - radio->last_rx_us > radio->health_no_rx_us) {
+        radio->last_rx_us = now;
+        radio->health.rx_timeouts++;
+        radio->health.last_incident_us = now;
+        lora_rearm_rx(radio);
+    }
+    return true;
+}
+
+static void CAMINHO_QUENTE(lora_send_ack)(lora_radio_t *radio, const lora_payload_t *pacote) {
+    lora_set_mode_idle(radio);
     
-    // Payload do ACK: para, de, id, flag de ACK
-    uint8_t payload[4] = {to, _lora_config.this_address, id, FLAGS_ACK};
+    // Payload do ACK: para, de, id, flag de ACK e o complemento opcional
+    uint8_t payload[4 + LORA_ACK_EXTRA_MAX] = {pacote->header_from, radio->config.this_address, pacote->header_id, FLAGS_ACK};
+    uint8_t len = 4;
+    if (radio->ack_extra) {
+        len += radio->ack_extra(radio, pacote, payload + 4);
+    }
     
     // Posiciona ponteiro do FIFO
     uint8_t fifo_tx_base = 0x00;
-    lora_spi_write_reg(REG_0D_FIFO_ADDR_PTR, &fifo_tx_base, 1);
+    lora_spi_write_reg(radio, REG_0D_FIFO_ADDR_PTR, &fifo_tx_base, 1);
 
     // Escreve payload no FIFO
-    lora_spi_write_reg(REG_00_FIFO, payload, 4);
+    lora_spi_write_reg(radio, REG_00_FIFO, payload, len);
 
     // Define tamanho do payload
-    uint8_t len = 4;
-    lora_spi_write_reg(REG_22_PAYLOAD_LENGTH, &len, 1);
+    lora_spi_write_reg(radio, REG_22_PAYLOAD_LENGTH, &len, 1);
     
     // Inicia transmissão
-    lora_set_mode_tx();
+    radio->rx_after_tx = true;
+    lora_set_mode_tx(radio);
 }
 
 
 /**
- * @brief Manipulador de interrupção principal. Chamado sempre que o pino DIO0 sobe.
+ * @brief Trata um RxDone: lê o pacote do FIFO, filtra pelo endereço e o
+ *        entrega ao callback (ou ao lora_send_to_wait, se for um ACK).
+ * @param ciclo_inicio Valor de lora_ciclos() na entrada da ISR (ou ao fim
+ *                     do evento anterior), para medir até o início do FIFO.
  */
-static void gpio_irq_handler(uint gpio, uint32_t events) {
-    uint8_t irq_flags = lora_spi_read_single_reg(REG_12_IRQ_FLAGS);
+static void CAMINHO_QUENTE(lora_handle_rx_done)(lora_radio_t *radio, uint64_t t_irq, uint32_t ciclo_inicio) {
+    radio->last_rx_us = t_irq;
+    uint8_t packet_len = lora_spi_read_single_reg(radio, REG_13_RX_NB_BYTES);
+    uint8_t rx_current_addr = lora_spi_read_single_reg(radio, REG_10_FIFO_RX_CURRENT_ADDR);
+    
+    // Posiciona o ponteiro do FIFO no início do pacote recebido
+    lora_spi_write_reg(radio, REG_0D_FIFO_ADDR_PTR, &rx_current_addr, 1);
+
+    // Até aqui o trabalho é sempre o mesmo; a variação é busca de código
+    // e disputa do barramento
+    lora_irq_stats_t *st = &radio->irq_stats;
+    uint32_t ciclos = (ciclo_inicio - lora_ciclos()) & 0x00FFFFFF;
+    st->fifo_samples++;
+    st->fifo_cycles_sum += ciclos;
+    st->fifo_cycles_sq_sum += (uint64_t)ciclos * ciclos;
+    if (ciclos < st->fifo_cycles_min || st->fifo_samples == 1) {
+        st->fifo_cycles_min = ciclos;
+    }
+    if (ciclos > st->fifo_cycles_max) {
+        st->fifo_cycles_max = ciclos;
+    }
 
-    // Limpa os flags de IRQ imediatamente para evitar reentrância
-    lora_spi_write_reg(REG_12_IRQ_FLAGS, &irq_flags, 1);
+    uint8_t packet[255];
+    lora_spi_read_reg(radio, REG_00_FIFO, packet, packet_len);
 
-    if (_current_mode == MODE_RXCONTINUOUS && (irq_flags & IRQ_FLAG_RX_DONE)) {
-        // --- Pacote Recebido ---
-        uint8_t packet_len = lora_spi_read_single_reg(REG_13_RX_NB_BYTES);
-        uint8_t rx_current_addr = lora_spi_read_single_reg(REG_10_FIFO_RX_CURRENT_ADDR);
-        
-        // Posiciona o ponteiro do FIFO no início do pacote recebido
-        lora_spi_write_reg(REG_0D_FIFO_ADDR_PTR, &rx_current_addr, 1);
+    if (packet_len < 4) return; // Pacote inválido
 
-        uint8_t packet[255];
-        lora_spi_read_reg(REG_00_FIFO, packet, packet_len);
+    // Extrai RSSI e SNR apenas com aritmética inteira
+    int8_t snr_val = lora_spi_read_single_reg(radio, REG_19_PKT_SNR_VALUE);
+    int16_t rssi_val = lora_spi_read_single_reg(radio, REG_1A_PKT_RSSI_VALUE);
 
-        if (packet_len < 4) return; // Pacote inválido
+    int16_t rssi;
+    if (snr_val < 0) {
+        rssi = rssi_val + (snr_val - 2) / 4; // rssi + snr, arredondado
+    } else {
+        rssi = (rssi_val * 16 + 7) / 15;
+    }
+    rssi += radio->rssi_offset;
+
+    lora_payload_t p;
+    p.header_to = packet[0];
+    p.header_from = packet[1];
+    p.header_id = packet[2];
+    p.header_flags = packet[3];
+    p.length = packet_len > 4 ? packet_len - 4 : 0;
+    p.rssi = rssi;
+    p.snr_x4 = snr_val;
+    p.rx_timestamp_us = t_irq;
+    p.radio = radio->index;
+
+    if (p.length > 0) {
+        memcpy(p.message, packet + 4, p.length);
+    }
+    p.message[p.length] = '\0'; // Permite tratar a mensagem como string
 
-        // Extrai RSSI e SNR
-        int8_t snr_val = lora_spi_read_single_reg(REG_19_PKT_SNR_VALUE);
-        int16_t rssi_val = lora_spi_read_single_reg(REG_1A_PKT_RSSI_VALUE);
+    // --- Lógica de Filtragem e ACK ---
+    
+    // Ignora se o pacote não é para este nó, a menos que receive_all esteja ativado
+    if (p.header_to != radio->config.this_address && p.header_to != BROADCAST_ADDRESS && !radio->config.receive_all) {
+        radio->irq_stats.address_rejects++;
+        return;
+    }
+    radio->irq_stats.accepted++;
+    
+    // Verifica se é um ACK
+    if (p.header_to == radio->config.this_address && (p.header_flags & FLAGS_ACK)) {
+        radio->last_ack_payload = p;
+        radio->ack_received = true;
+    } else { // É uma mensagem normal
+         // Se os ACKs estiverem ativados, envia uma confirmação (fragmentos
+        // são confirmados em bloco pelo SACK da camada de fragmentação)
+        if (radio->config.acks && p.header_to == radio->config.this_address && !(p.header_flags & FLAGS_FRAGMENT)) {
+            lora_send_ack(radio, &p);
+        }
 
-        float snr = snr_val / 4.0;
-        float rssi;
-        if (snr < 0) {
-            rssi = rssi_val + snr;
-        } else {
-            rssi = rssi_val * 16.0 / 15.0;
+        // Chama o callback do usuário, se registrado
+        if (radio->on_receive) {
+            radio->on_receive(&p);
         }
 
-        if (_lora_config.freq >= 779.0) {
-            rssi -= 157;
+        // Entrega também na fila agregada de todos os rádios
+        if (radio->config.queue_rx) {
+            if (_rx_head - _rx_tail >= LORA_RX_QUEUE_LEN) {
+                _rx_dropped++; // Loop principal atrasado: descarta o mais novo
+            } else {
+                _rx_queue[_rx_head & (LORA_RX_QUEUE_LEN - 1)] = p;
+                __dmb(); // Conteúdo visível antes do índice
+                _rx_head++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Manipulador de interrupção principal, disparado por nível enquanto
+ *        o DIO0 estiver alto.
+ *
+ * Atende todos os eventos pendentes em REG_12_IRQ_FLAGS antes de sair, até
+ * LORA_IRQ_MAX_EVENTS por entrada. Se o limite for atingido com eventos
+ * ainda pendentes, o DIO0 continua alto e a interrupção entra de novo,
+ * dando chance às demais interrupções no meio de uma rajada.
+ *
+ * Por ser disparada por nível, um DIO0 preso em alto sem RxDone nem TxDone
+ * (mapeamento perdido, pino em curto) faria a ISR entrar sem parar. Depois
+ * de LORA_IRQ_MAX_VAZIAS entradas vazias seguidas o pino é mascarado; o
+ * monitor de saúde rearma o rádio e o devolve na próxima verificação.
+ */
+static void CAMINHO_QUENTE(lora_service_irq)(lora_radio_t *radio, uint32_t ciclo_entrada) {
+    // Marca o instante da entrada antes de qualquer acesso ao SPI
+    uint64_t t_evento = caminho_quente_agora_us();
+    uint32_t ciclo_evento = ciclo_entrada;
+    uint8_t atendidos = 0;
+
+    radio->irq_stats.entries++;
+    while (atendidos < LORA_IRQ_MAX_EVENTS) {
+        uint8_t irq_flags = lora_spi_read_single_reg(radio, REG_12_IRQ_FLAGS);
+        if (!(irq_flags & (IRQ_FLAG_RX_DONE | IRQ_FLAG_TX_DONE))) {
+            break;
+        }
+
+        // Limpa apenas os flags lidos: um evento que chegue agora continua pendente
+        lora_spi_write_reg(radio, REG_12_IRQ_FLAGS, &irq_flags, 1);
+        atendidos++;
+
+        if (radio->current_mode == MODE_RXCONTINUOUS && (irq_flags & IRQ_FLAG_RX_DONE)) {
+            // --- Pacote Recebido ---
+            if (irq_flags & IRQ_FLAG_PAYLOAD_CRC_ERROR) {
+                radio->irq_stats.crc_errors++; // Payload corrompido: descarta
+                if (radio->on_crc_error) {
+                    radio->on_crc_error(radio->index, t_evento);
+                }
+            } else {
+                lora_handle_rx_done(radio, t_evento, ciclo_evento);
+            }
+        } else if (radio->current_mode == MODE_TX && (irq_flags & IRQ_FLAG_TX_DONE)) {
+            // --- Transmissão Completa ---
+            lora_set_mode_idle(radio); // Retorna ao modo de espera seguro
+            if (radio->rx_after_tx) {
+                // ACK da ISR ou envio assíncrono: volta a ouvir sem esperar o loop
+                radio->rx_after_tx = false;
+                lora_set_mode_rx_continuous(radio);
+            }
         } else {
-            rssi -= 164;
+            radio->irq_stats.stale_events++; // Flag de um modo que já foi deixado
         }
 
-        lora_payload_t p;
-        p.header_to = packet[0];
-        p.header_from = packet[1];
-        p.header_id = packet[2];
-        p.header_flags = packet[3];
-        p.length = packet_len > 4 ? packet_len - 4 : 0;
-        p.rssi = (int)round(rssi);
-        p.snr = snr;
-
-        if (p.length > 0) {
-            memcpy(p.message, packet + 4, p.length);
+        // Eventos seguintes já estavam esperando: o instante é o da leitura
+        t_evento = caminho_quente_agora_us();
+        ciclo_evento = lora_ciclos();
+    }
+
+    if (atendidos == 0) {
+        radio->irq_stats.empty_entries++;
+        if (++radio->irq_empty_streak >= LORA_IRQ_MAX_VAZIAS) {
+            radio->irq_empty_streak = 0;
+            radio->irq_pins &= ~LORA_IRQ_PIN_DIO0;
+            caminho_quente_gpio_irq(radio->config.interrupt_pin, false);
+            radio->irq_stats.dio0_masks++;
         }
+    } else {
+        radio->irq_empty_streak = 0;
+        if (atendidos == LORA_IRQ_MAX_EVENTS) {
+            radio->irq_stats.bound_hits++;
+        }
+    }
+    radio->irq_stats.events += atendidos;
+    radio->irq_stats.events_per_entry[atendidos]++;
+}
 
-        // --- Lógica de Filtragem e ACK ---
-        
-        // Ignora se o pacote não é para este nó, a menos que receive_all esteja ativado
-        if (p.header_to != _lora_config.this_address && p.header_to != BROADCAST_ADDRESS && !_lora_config.receive_all) {
+/**
+ * @brief Interrupção do DIO3 (ValidHeader): o cabeçalho PHY acabou de ser
+ *        recebido e o tamanho do payload já está em REG_13_RX_NB_BYTES.
+ *
+ * Um tamanho fora de lora_accept_length não pode ser um quadro desta rede:
+ * a recepção é abortada e o modem volta a procurar preâmbulos, em vez de
+ * receber o payload inteiro e passar pelo RxDone só para ser descartado.
+ */
+static void CAMINHO_QUENTE(lora_service_header)(lora_radio_t *radio) {
+    uint8_t irq_flags = lora_spi_read_single_reg(radio, REG_12_IRQ_FLAGS);
+    if (!(irq_flags & IRQ_FLAG_VALID_HEADER)) {
+        return; // Já limpo pelo atendimento de um RxDone
+    }
+    uint8_t clear = IRQ_FLAG_VALID_HEADER; // Só este flag: o RxDone é do DIO0
+    lora_spi_write_reg(radio, REG_12_IRQ_FLAGS, &clear, 1);
+    radio->irq_stats.valid_headers++;
+
+    // Um RxDone ainda pendente (DIO3 atendido antes do DIO0, ou os dois
+    // acumulados com as interrupções desligadas) é de um pacote bom que o
+    // rearme apagaria; o tamanho lido também seria o dele. Fica para o DIO0
+    if (!radio->rx_length_filter || radio->current_mode != MODE_RXCONTINUOUS ||
+        (irq_flags & IRQ_FLAG_RX_DONE)) {
+        return;
+    }
+    uint8_t tamanho = lora_spi_read_single_reg(radio, REG_13_RX_NB_BYTES);
+    if (!(radio->rx_lengths[tamanho >> 5] & (1u << (tamanho & 31)))) {
+        radio->irq_stats.length_rejects++;
+        lora_rearm_rx(radio);
+    }
+}
+
+/**
+ * @brief Callback de GPIO do SDK: encaminha a interrupção ao rádio do pino
+ *        (DIO0 ou DIO3).
+ */
+static void CAMINHO_QUENTE(lora_gpio_dispatch)(uint gpio, uint32_t events) {
+    uint32_t ciclo_entrada = lora_ciclos();
+    for (uint8_t i = 0; i < _num_radios; ++i) {
+        if (_radios[i]->config.interrupt_pin == gpio) {
+            lora_service_irq(_radios[i], ciclo_entrada);
             return;
         }
-        
-        // Verifica se é um ACK
-        if (p.header_to == _lora_config.this_address && (p.header_flags & FLAGS_ACK)) {
-            _last_ack_payload = p;
-            _ack_received = true;
-        } else { // É uma mensagem normal
-             // Se os ACKs estiverem ativados, envia uma confirmação
-            if (_lora_config.acks && p.header_to == _lora_config.this_address) {
-                lora_send_ack(p.header_from, p.header_id);
-            }
+        if (_radios[i]->config.header_pin == gpio && gpio != 0) {
+            lora_service_header(_radios[i]);
+            return;
+        }
+    }
+}
 
-            // Chama o callback do usuário, se registrado
-            if (_on_receive_callback) {
-                _on_receive_callback(&p);
-            }
+
+/**
+ * @brief Contador de ciclos do SysTick (24 bits, decrescente, clk_sys).
+ */
+static inline uint32_t lora_ciclos(void) {
+    return systick_hw->cvr;
+}
+
+/**
+ * @brief Mascara (ou restaura) as interrupções de GPIO de todos os rádios
+ *        do barramento de `radio`.
+ *
+ * Chamada em volta de cada transação (ou sequência, como uma transmissão)
+ * do loop principal: a ISR de qualquer
+ * rádio do barramento começaria a sua com o CS do outro ainda baixo (o
+ * outro chip receberia os bytes) ou reprogramaria a máquina de estados e o
+ * DMA do PIO no meio da transferência. As interrupções são por nível, então
+ * um evento que chega com o pino mascarado só espera o fim da transação.
+ * Os alarmes (monitor de saúde, TDMA) têm a prioridade da ISR do GPIO e não
+ * são interrompidos por ela; nesses contextos e na própria ISR não há
+ * máscara. Restaura só os pinos de irq_pins.
+ */
+static void CAMINHO_QUENTE(lora_bus_irq_mask)(const lora_radio_t *radio, bool mascarar) {
+    for (uint8_t i = 0; i < _num_radios; ++i) {
+        const lora_radio_t *r = _radios[i];
+        if (r->config.spi_port != radio->config.spi_port) {
+            continue;
         }
-    } else if (_current_mode == MODE_TX && (irq_flags & IRQ_FLAG_TX_DONE)) {
-        // --- Transmissão Completa ---
-        lora_set_mode_idle(); // Retorna ao modo de espera seguro
+        uint8_t pinos = mascarar ? 0 : r->irq_pins;
+        if (r->irq_pins & LORA_IRQ_PIN_DIO0) {
+            caminho_quente_gpio_irq(r->config.interrupt_pin, pinos & LORA_IRQ_PIN_DIO0);
+        }
+        if (r->irq_pins & LORA_IRQ_PIN_HEADER) {
+            caminho_quente_gpio_irq(r->config.header_pin, pinos & LORA_IRQ_PIN_HEADER);
+        }
+    }
+}
+
+/**
+ * @brief Marca o barramento de `radio` ocupado; no loop principal (fora de
+ *        exceção), a mais externa de sequências aninhadas também mascara a
+ *        ISR do GPIO.
+ *
+ * O contador vem antes da máscara para que um alarme que dispare entre os
+ * dois já encontre o barramento ocupado. Uma exceção que o interrompa
+ * termina antes de o loop voltar, então no loop o contador só passa de zero
+ * pelas sequências do próprio loop.
+ * @return Se mascarou (repassar a lora_bus_release).
+ */
+static bool CAMINHO_QUENTE(lora_bus_acquire)(lora_radio_t *radio) {
+    volatile uint8_t *busy = &_spi_busy[spi_get_index(radio->config.spi_port)];
+    bool mascarar = (*busy)++ == 0 && __get_current_exception() == 0;
+    if (mascarar) {
+        lora_bus_irq_mask(radio, true);
+    }
+    return mascarar;
+}
+
+static void CAMINHO_QUENTE(lora_bus_release)(lora_radio_t *radio, bool mascarou) {
+    if (mascarou) {
+        lora_bus_irq_mask(radio, false);
     }
+    _spi_busy[spi_get_index(radio->config.spi_port)]--;
 }
 
+static void CAMINHO_QUENTE(lora_spi_write_reg)(lora_radio_t *radio, uint8_t reg, const uint8_t *data, size_t len) {
+    bool mascarou = lora_bus_acquire(radio);
+    radio->transport->write(radio, reg | 0x80, data, len);
+    lora_bus_release(radio, mascarou);
+}
+
+static void CAMINHO_QUENTE(lora_spi_read_reg)(lora_radio_t *radio, uint8_t reg, uint8_t *data, size_t len) {
+    bool mascarou = lora_bus_acquire(radio);
+    radio->transport->read(radio, reg & 0x7F, data, len);
+    lora_bus_release(radio, mascarou);
+}
+
+static void CAMINHO_QUENTE(lora_hw_spi_write)(lora_radio_t *radio, uint8_t addr, const uint8_t *data, size_t len) {
+    gpio_put(radio->config.cs_pin, 0); // Ativar CS
+    spi_write_blocking(radio->config.spi_port, &addr, 1);
+    spi_write_blocking(radio->config.spi_port, data, len);
+    gpio_put(radio->config.cs_pin, 1); // Desativar CS
+}
+
+static void CAMINHO_QUENTE(lora_hw_spi_read)(lora_radio_t *radio, uint8_t addr, uint8_t *data, size_t len) {
+    gpio_put(radio->config.cs_pin, 0); // Ativar CS
+    spi_write_blocking(radio->config.spi_port, &addr, 1);
+    spi_read_blocking(radio->config.spi_port, 0x00, data, len);
+    gpio_put(radio->config.cs_pin, 1); // Desativar CS
+}
 
-static void lora_spi_write_reg(uint8_t reg, const uint8_t *data, size_t len) {
-    gpio_put(_lora_config.cs_pin, 0); // Ativar CS
-    uint8_t reg_with_write_bit = reg | 0x80;
-    spi_write_blocking(_lora_config.spi_port, &reg_with_write_bit, 1);
-    spi_write_blocking(_lora_config.spi_port, data, len);
-    gpio_put(_lora_config.cs_pin, 1); // Desativar CS
+static void CAMINHO_QUENTE(lora_pio_write)(lora_radio_t *radio, uint8_t addr, const uint8_t *data, size_t len) {
+    lora_pio_spi_transfer(&radio->pio_spi, addr, data, NULL, len);
 }
 
-static void lora_spi_read_reg(uint8_t reg, uint8_t *data, size_t len) {
-    gpio_put(_lora_config.cs_pin, 0); // Ativar CS
-    uint8_t reg_without_write_bit = reg & 0x7F;
-    spi_write_blocking(_lora_config.spi_port, &reg_without_write_bit, 1);
-    spi_read_blocking(_lora_config.spi_port, 0x00, data, len);
-    gpio_put(_lora_config.cs_pin, 1); // Desativar CS
+static void CAMINHO_QUENTE(lora_pio_read)(lora_radio_t *radio, uint8_t addr, uint8_t *data, size_t len) {
+    lora_pio_spi_transfer(&radio->pio_spi, addr, NULL, data, len);
 }
 
-static uint8_t lora_spi_read_single_reg(uint8_t reg) {
+static uint8_t CAMINHO_QUENTE(lora_spi_read_single_reg)(lora_radio_t *radio, uint8_t reg) {
     uint8_t value;
-    lora_spi_read_reg(reg, &value, 1);
+    lora_spi_read_reg(radio, reg, &value, 1);
     return value;
 }
 
 
-static void lora_set_modem_config(modem_config_t modem) {
+static void lora_set_modem_config(lora_radio_t *radio, modem_config_t modem) {
     uint8_t config1, config2, config3;
 
     switch (modem) {
@@ -369,23 +1044,23 @@ static void lora_set_modem_config(modem_config_t modem) {
         default: // Padrão
             config1 = 0x72; config2 = 0x74; config3 = 0x04; break;
     }
-    lora_spi_write_reg(REG_1D_MODEM_CONFIG1, &config1, 1);
-    lora_spi_write_reg(REG_1E_MODEM_CONFIG2, &config2, 1);
-    lora_spi_write_reg(REG_26_MODEM_CONFIG3, &config3, 1);
+    lora_spi_write_reg(radio, REG_1D_MODEM_CONFIG1, &config1, 1);
+    lora_spi_write_reg(radio, REG_1E_MODEM_CONFIG2, &config2, 1);
+    lora_spi_write_reg(radio, REG_26_MODEM_CONFIG3, &config3, 1);
 }
 
-static void lora_set_frequency(float freq_mhz) {
+static void lora_set_frequency(lora_radio_t *radio, float freq_mhz) {
     uint32_t frf = (uint32_t)((freq_mhz * 1000000.0) / FSTEP);
     uint8_t frf_bytes[3];
     frf_bytes[0] = (uint8_t)((frf >> 16) & 0xFF); // MSB
     frf_bytes[1] = (uint8_t)((frf >> 8) & 0xFF);  // MID
     frf_bytes[2] = (uint8_t)(frf & 0xFF);         // LSB
-    lora_spi_write_reg(REG_06_FRF_MSB, &frf_bytes[0], 1);
-    lora_spi_write_reg(REG_07_FRF_MID, &frf_bytes[1], 1);
-    lora_spi_write_reg(REG_08_FRF_LSB, &frf_bytes[2], 1);
+    lora_spi_write_reg(radio, REG_06_FRF_MSB, &frf_bytes[0], 1);
+    lora_spi_write_reg(radio, REG_07_FRF_MID, &frf_bytes[1], 1);
+    lora_spi_write_reg(radio, REG_08_FRF_LSB, &frf_bytes[2], 1);
 }
 
-static void lora_set_tx_power(uint8_t tx_power) {
+static void lora_set_tx_power(lora_radio_t *radio, uint8_t tx_power) {
     if (tx_power < 5) tx_power = 5;
     if (tx_power > 23) tx_power = 23;
     
@@ -401,6 +1076,6 @@ static void lora_set_tx_power(uint8_t tx_power) {
         pa_config_val = PA_SELECT | (tx_power - 2); // Usa PA_BOOST
     }
 
-    lora_spi_write_reg(REG_4D_PA_DAC, &pa_dac_val, 1);
-    lora_spi_write_reg(REG_09_PA_CONFIG, &pa_config_val, 1);
+    lora_spi_write_reg(radio, REG_4D_PA_DAC, &pa_dac_val, 1);
+    lora_spi_write_reg(radio, REG_09_PA_CONFIG, &pa_config_val, 1);
 }
\ No newline at end of file
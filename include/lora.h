@@ -3,6 +3,7 @@
 
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
+#include "lora_pio_spi.h"
 
 // ============================================================================
 // --- Constantes e Registradores (Portado de Python) ---
@@ -21,6 +22,7 @@
 #define REG_10_FIFO_RX_CURRENT_ADDR 0x10
 #define REG_12_IRQ_FLAGS            0x12
 #define REG_13_RX_NB_BYTES          0x13
+#define REG_18_MODEM_STAT           0x18
 #define REG_19_PKT_SNR_VALUE        0x19
 #define REG_1A_PKT_RSSI_VALUE       0x1a
 #define REG_1D_MODEM_CONFIG1        0x1d
@@ -29,6 +31,7 @@
 #define REG_21_PREAMBLE_LSB         0x21
 #define REG_22_PAYLOAD_LENGTH       0x22
 #define REG_26_MODEM_CONFIG3        0x26
+#define REG_39_SYNC_WORD            0x39
 #define REG_40_DIO_MAPPING1         0x40
 #define REG_4D_PA_DAC               0x4d
 
@@ -41,20 +44,41 @@
 #define MODE_CAD                    0x07
 
 // --- Flags de IRQ (Interrupt ReQuest) ---
+#define IRQ_FLAG_RX_TIMEOUT         0x80
 #define IRQ_FLAG_RX_DONE            0x40
+#define IRQ_FLAG_PAYLOAD_CRC_ERROR  0x20
+#define IRQ_FLAG_VALID_HEADER       0x10
 #define IRQ_FLAG_TX_DONE            0x08
 #define IRQ_FLAG_CAD_DONE           0x04
 #define IRQ_FLAG_CAD_DETECTED       0x01
 #define IRQ_FLAGS_CLEAR             0xff // Usado para limpar todos os flags
 
+// --- Status do Modem (REG_18_MODEM_STAT) ---
+#define MODEM_STATUS_SIGNAL_DETECTED 0x01
+#define MODEM_STATUS_SIGNAL_SYNCED   0x02
+#define MODEM_STATUS_RX_ONGOING      0x04
+
 // --- PA (Power Amplifier) Config ---
 #define PA_SELECT                   0x80 // Seleciona o pino PA_BOOST
 #define PA_DAC_ENABLE               0x07
 #define PA_DAC_DISABLE              0x04
 
+// --- Sync word (REG_39_SYNC_WORD) ---
+// Quadros com outra sync word são ignorados pelo modem, sem interrupção.
+// 0x34 é reservado à LoRaWAN pública.
+#define LORA_SYNC_WORD_DEFAULT      0x12
+
 // --- Endereçamento e Flags ---
 #define BROADCAST_ADDRESS           255
 #define FLAGS_ACK                   0x80
+#define FLAGS_SECURE                0x40 // Mensagem cifrada e autenticada (seguranca.h)
+#define FLAGS_BEACON                0x20 // Beacon de sincronização do TDMA (tdma.h)
+#define FLAGS_FRAGMENT              0x10 // Fragmento de uma transferência longa (fragmentos.h)
+#define FLAGS_LAST_FRAGMENT         0x08 // ...o último da transferência
+#define FLAGS_SACK_REQUEST          0x04 // ...o último da janela: o destino responde com um SACK
+
+// Dados por quadro: o FIFO de 255 bytes menos o cabeçalho de 4
+#define LORA_MAX_PAYLOAD            251
 
 // --- Constantes Físicas ---
 #define FXOSC                       32000000.0
@@ -68,14 +92,16 @@
  * @brief Estrutura para armazenar dados de um pacote LoRa recebido.
  */
 typedef struct {
-    uint8_t message[252];   // Buffer para a mensagem (Payload max 255 - 4 bytes de header)
+    uint8_t message[LORA_MAX_PAYLOAD + 1]; // Mensagem e um '\0' (payload max 255 - 4 bytes de header)
     uint8_t length;         // Comprimento da mensagem recebida
     uint8_t header_to;      // Endereço do destinatário
     uint8_t header_from;    // Endereço do remetente
     uint8_t header_id;      // ID da mensagem
     uint8_t header_flags;   // Flags da mensagem
-    int rssi;               // Received Signal Strength Indicator
-    float snr;              // Signal-to-Noise Ratio
+    int rssi;               // Received Signal Strength Indicator, em dBm
+    int8_t snr_x4;          // Signal-to-Noise Ratio, em quartos de dB (valor bruto do registrador)
+    uint64_t rx_timestamp_us; // Instante (time_us_64) da entrada na interrupção de RxDone
+    uint8_t radio;          // Índice do rádio que recebeu (ordem de lora_init)
 } lora_payload_t;
 
 /**
@@ -88,70 +114,227 @@ typedef enum {
     BW125_CR48_SF4096, // Longo alcance, muito lento
 } modem_config_t;
 
+/**
+ * @brief Caminho das transações SPI até o rádio.
+ */
+typedef enum {
+    LORA_TRANSPORT_SPI,    // Periférico SPI do RP2040, CS por GPIO
+    LORA_TRANSPORT_PIO,    // Máquina de estados PIO + DMA, CS por side-set (CS = SCK - 1)
+} lora_transport_kind_t;
+
+// Clock SPI máximo do SX127x (datasheet, seção 2.5.6) e o usado se spi_hz = 0
+#define LORA_SPI_MAX_HZ             10000000
+#define LORA_SPI_DEFAULT_HZ         5000000
+
 /**
  * @brief Estrutura de configuração para inicializar o módulo LoRa.
  */
 typedef struct {
-    spi_inst_t *spi_port;  // Instância do SPI (ex: spi0, spi1)
+    spi_inst_t *spi_port;  // Instância do SPI (ex: spi0, spi1); no transporte PIO só identifica o barramento
+    uint sck_pin;          // Pinos do barramento, configurados pelo driver
+    uint mosi_pin;
+    uint miso_pin;
+    uint32_t spi_hz;       // Clock SPI, limitado a LORA_SPI_MAX_HZ (0 = LORA_SPI_DEFAULT_HZ)
+    lora_transport_kind_t transport;
     uint interrupt_pin;    // Pino de interrupção (DIO0)
+    uint header_pin;       // Pino do DIO3 em ValidHeader (opcional, 0 = não conectado)
     uint cs_pin;           // Pino Chip Select (NSS)
     uint reset_pin;        // Pino de Reset (opcional, pode ser setado para um valor inválido se não usado)
     float freq;            // Frequência em MHz (ex: 868.0, 915.0)
+    uint8_t sync_word;     // Sync word da rede, igual em todos os nós (0 = LORA_SYNC_WORD_DEFAULT)
     uint8_t tx_power;      // Potência de transmissão em dBm (entre 5 e 23)
     uint8_t this_address;  // Endereço deste nó LoRa (0-254)
     modem_config_t modem;  // Configuração do modem a ser usada
     bool receive_all;      // Se true, recebe pacotes de todos os endereços
     bool acks;             // Se true, habilita envio automático de ACKs
+    bool queue_rx;         // Se true, os pacotes também vão para a fila agregada (lora_rx_queue_pop)
 } lora_config_t;
 
 
+// Bytes que o complemento do ACK (lora_on_ack) pode acrescentar
+#define LORA_ACK_EXTRA_MAX          8
+
+// Eventos (RxDone/TxDone) atendidos no máximo por entrada na interrupção
+#define LORA_IRQ_MAX_EVENTS         4
+
+// Entradas vazias seguidas (DIO0 alto sem RxDone/TxDone) antes de a ISR
+// mascarar o pino; o monitor de saúde rearma o rádio e o devolve
+#define LORA_IRQ_MAX_VAZIAS         8
+
+struct lora_transport; // Operações do transporte, privadas de lora.c
+
+// Bloco PIO usado pelo transporte LORA_TRANSPORT_PIO
+#ifndef LORA_PIO_INSTANCE
+#define LORA_PIO_INSTANCE           pio0
+#endif
+
+// Rádios simultâneos e tamanho da fila agregada de recepção (potência de 2)
+#define LORA_MAX_RADIOS             4
+#define LORA_RX_QUEUE_LEN           8
+
+/**
+ * @brief Contadores de atendimento da interrupção do DIO0.
+ */
+typedef struct {
+    uint32_t entries;           // Entradas na interrupção
+    uint32_t events;            // Eventos atendidos no total
+    uint32_t empty_entries;     // Entradas sem nenhum evento pendente
+    uint32_t bound_hits;        // Entradas que pararam em LORA_IRQ_MAX_EVENTS
+    uint32_t dio0_masks;        // DIO0 mascarado após LORA_IRQ_MAX_VAZIAS entradas vazias seguidas
+    uint32_t stale_events;      // Flags de um modo que já havia sido deixado
+    uint32_t crc_errors;        // Pacotes descartados por erro de CRC no payload
+    // Filtragem (quadros de outra sync word nem chegam a interromper)
+    uint32_t valid_headers;     // Cabeçalhos PHY válidos (DIO3, só com header_pin)
+    uint32_t length_rejects;    // Abortados no cabeçalho: tamanho fora de lora_accept_length
+    uint32_t address_rejects;   // Lidos do FIFO e descartados pelo endereço de destino
+    uint32_t accepted;          // Entregues (ACKs, callback e fila)
+    uint32_t events_per_entry[LORA_IRQ_MAX_EVENTS + 1]; // Histograma: eventos por entrada
+    // Ciclos de clk_sys da entrada da ISR até o início da leitura do FIFO
+    uint32_t fifo_samples;
+    uint32_t fifo_cycles_min;
+    uint32_t fifo_cycles_max;
+    uint64_t fifo_cycles_sum;
+    uint64_t fifo_cycles_sq_sum;
+} lora_irq_stats_t;
+
+/**
+ * @brief Contadores do monitor de saúde do rádio (ver lora_health_start).
+ */
+typedef struct {
+    uint32_t checks;            // Verificações executadas
+    uint32_t checks_skipped;    // Adiadas porque o SPI estava em uso pelo loop principal
+    uint32_t missed_irqs;       // DIO0 alto sem borda nova: pacote atendido pelo monitor
+    uint32_t mode_rearms;       // Rádio fora de RX contínuo: rearmado
+    uint32_t radio_resets;      // Rádio perdeu o modo LoRa (reset/brown-out): reconfigurado
+    uint32_t modem_stalls;      // Modem preso recebendo por tempo demais: rearmado
+    uint32_t rx_timeouts;       // Tempo sem pacotes excedido: rearmado
+    uint32_t dio0_unmasks;      // DIO0 mascarado pela ISR: rearmado e devolvido
+    uint64_t last_incident_us;  // Instante do último incidente (0 = nenhum)
+} lora_health_t;
+
+// Bits de lora_radio_t.irq_pins
+#define LORA_IRQ_PIN_DIO0   0x01
+#define LORA_IRQ_PIN_HEADER 0x02
+
+/**
+ * @brief Estado de um módulo SX127x. Um por rádio; os campos são privados
+ *        do driver e só devem ser acessados pelas funções lora_*.
+ *
+ * Vários rádios podem dividir o mesmo barramento SPI com pinos CS e DIO0
+ * próprios, cada um em seu canal ou fator de espalhamento.
+ */
+typedef struct lora_radio {
+    lora_config_t config;
+    uint8_t index;                          // Ordem de registro (lora_payload_t.radio)
+    const struct lora_transport *transport; // Escolhido por config.transport em lora_init
+    lora_pio_spi_t pio_spi;                 // Estado do transporte PIO
+    uint32_t spi_hz;                        // Clock SPI efetivo
+    void (*on_receive)(lora_payload_t*);    // Callback de pacotes recebidos (ISR)
+    void (*on_crc_error)(uint8_t radio, uint64_t t_us); // Pacotes descartados por CRC (ISR)
+    uint32_t rx_lengths[8];                 // Tamanhos de quadro aceitos (bit n = n bytes)
+    bool rx_length_filter;                  // Aborta no ValidHeader os tamanhos fora de rx_lengths
+    volatile uint8_t irq_pins;              // Interrupções habilitadas (LORA_IRQ_PIN_*), restauradas depois das transações do loop
+    // Complemento dos ACKs enviados pela ISR (ver lora_on_ack)
+    uint8_t (*ack_extra)(const struct lora_radio *radio, const lora_payload_t *pacote, uint8_t *extra);
+    volatile uint8_t current_mode;          // Modo de operação atual do rádio
+    uint8_t last_header_id;                 // ID do último pacote enviado, para os ACKs
+    volatile bool ack_received;             // ACK recebido, usado em lora_send_to_wait
+    lora_payload_t last_ack_payload;        // Último ACK recebido, para verificação do ID
+    int16_t rssi_offset;                    // Deslocamento do RSSI para a banda (datasheet, seção 5.5.5)
+    volatile bool rx_after_tx;              // A TX em andamento veio de uma interrupção (ACK, lora_send_async)
+    volatile uint64_t last_rx_us;           // Último RxDone atendido
+    lora_irq_stats_t irq_stats;
+    uint8_t irq_empty_streak;               // Entradas vazias seguidas na ISR do DIO0
+    // Monitor de saúde
+    repeating_timer_t health_timer;
+    bool health_running;
+    lora_health_t health;
+    uint32_t health_period_ms;
+    uint32_t health_modem_margin_ms;
+    bool health_reconfigure;                // Chip resetado: configuração na próxima verificação
+    uint32_t health_no_rx_us;
+    uint8_t health_dio0_high;               // Verificações seguidas com DIO0 alto
+    uint32_t health_modem_busy_ticks;       // Verificações seguidas com o modem ocupado
+} lora_radio_t;
+
 // ============================================================================
 // --- Protótipos das Funções Públicas ---
 // ============================================================================
 
 /**
- * @brief Inicializa o módulo LoRa e o hardware SPI do RP2040.
+ * @brief Inicializa um módulo LoRa e o transporte SPI escolhido em
+ *        `config->transport`, com os pinos e o clock da configuração.
  *
+ * O rádio é registrado no despachante de interrupções de GPIO, que
+ * encaminha cada DIO0 ao seu rádio. Até LORA_MAX_RADIOS rádios.
+ *
+ * @param radio Estado do rádio, mantido pelo chamador durante toda a execução.
  * @param config Ponteiro para a estrutura de configuração LoRa.
  * @return true se a inicialização for bem-sucedida, false caso contrário.
  */
-bool lora_init(lora_config_t *config);
+bool lora_init(lora_radio_t *radio, lora_config_t *config);
 
 /**
  * @brief Define o modo de operação do rádio para modo Idle (Standby).
  */
-void lora_set_mode_idle(void);
+void lora_set_mode_idle(lora_radio_t *radio);
 
 /**
  * @brief Define o modo de operação do rádio para recepção contínua.
  *        O rádio fica ouvindo por pacotes indefinidamente.
  */
-void lora_set_mode_rx_continuous(void);
+void lora_set_mode_rx_continuous(lora_radio_t *radio);
 
 /**
  * @brief Define o modo de operação do rádio para transmissão.
  */
-void lora_set_mode_tx(void);
+void lora_set_mode_tx(lora_radio_t *radio);
 
 /**
  * @brief Coloca o rádio no modo de baixo consumo (Sleep).
  */
-void lora_sleep(void);
+void lora_sleep(lora_radio_t *radio);
 
 /**
  * @brief Envia um pacote de dados LoRa.
  *
- * Esta é uma função de envio básica que não espera por ACK.
+ * Esta é uma função de envio básica que não espera por ACK. Se um ACK ou
+ * beacon estiver no ar, espera o fim dele (só do loop principal).
  *
+ * @param radio Rádio usado no envio.
  * @param data Ponteiro para o buffer de dados a ser enviado.
- * @param length O comprimento dos dados a serem enviados.
+ * @param length O comprimento dos dados a serem enviados (até LORA_MAX_PAYLOAD;
+ *               acima disso use fragmentos_enviar).
  * @param header_to O endereço do nó de destino (use BROADCAST_ADDRESS para todos).
+ * @return false, sem transmitir, se `length` passar de LORA_MAX_PAYLOAD ou
+ *         se a transmissão anterior não terminar no tempo de um pacote máximo.
  */
-void lora_send(const uint8_t *data, size_t length, uint8_t header_to);
+bool lora_send(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to);
+
+/**
+ * @brief Envia um pacote a partir de uma interrupção (ex.: alarme de
+ *        hardware) e volta à recepção contínua no TxDone, sem o loop.
+ *
+ * Não envia se o loop principal estiver no meio de uma transação SPI do
+ * barramento, se houver transmissão em andamento ou se o modem estiver
+ * recebendo um pacote.
+ * @param flags Byte de flags do cabeçalho (ex.: FLAGS_BEACON).
+ * @return true se a transmissão começou (nunca com `length` acima de
+ *         LORA_MAX_PAYLOAD).
+ */
+bool lora_send_async(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to, uint8_t flags);
+
+/**
+ * @brief Tempo no ar de um pacote de `length` bytes (cabeçalho incluído)
+ *        no perfil de modem atual do rádio, em microssegundos (Semtech
+ *        AN1200.13: preâmbulo de 8 símbolos, cabeçalho explícito, CRC).
+ */
+uint32_t lora_airtime_us(const lora_radio_t *radio, size_t length);
 
 /**
  * @brief Envia um pacote e aguarda por um Acknowledgement (ACK).
  *
+ * @param radio Rádio usado no envio.
  * @param data Ponteiro para o buffer de dados a ser enviado.
  * @param length O comprimento dos dados a serem enviados.
  * @param header_to O endereço do nó de destino.
@@ -159,20 +342,138 @@ void lora_send(const uint8_t *data, size_t length, uint8_t header_to);
  * @param retry_timeout_ms O timeout em milissegundos para esperar por um ACK.
  * @return true se o ACK foi recebido, false caso contrário.
  */
-bool lora_send_to_wait(const uint8_t *data, size_t length, uint8_t header_to, int retries, uint32_t retry_timeout_ms);
+bool lora_send_to_wait(lora_radio_t *radio, const uint8_t *data, size_t length, uint8_t header_to, int retries, uint32_t retry_timeout_ms);
 
 /**
  * @brief Define uma função de callback para ser chamada quando um pacote é recebido.
  *
+ * O callback roda no contexto da interrupção. Vários rádios podem usar o
+ * mesmo callback; `lora_payload_t.radio` indica a origem.
+ *
+ * @param radio Rádio cujos pacotes serão entregues.
  * @param callback A função a ser chamada. O parâmetro da função é um ponteiro
  *                 para a estrutura `lora_payload_t` com os dados recebidos.
  */
-void lora_on_receive(void (*callback)(lora_payload_t*));
+void lora_on_receive(lora_radio_t *radio, void (*callback)(lora_payload_t*));
+
+/**
+ * @brief Define uma função que acrescenta bytes aos ACKs automáticos
+ *        (config.acks), depois do cabeçalho de 4 bytes.
+ *
+ * Roda na ISR, entre a leitura do pacote e a transmissão do ACK, então
+ * deve ser curta. Escreve até LORA_ACK_EXTRA_MAX bytes em `extra` e
+ * retorna quantos escreveu (0 = ACK simples). NULL desliga.
+ */
+void lora_on_ack(lora_radio_t *radio,
+                 uint8_t (*callback)(const lora_radio_t *radio, const lora_payload_t *pacote, uint8_t *extra));
+
+/**
+ * @brief Define uma função chamada na ISR a cada pacote descartado por erro
+ *        de CRC, com o instante da interrupção (colisões aparecem assim).
+ */
+void lora_on_crc_error(lora_radio_t *radio, void (*callback)(uint8_t radio, uint64_t t_us));
+
+/**
+ * @brief Aceita quadros de `min` a `max` bytes (com o cabeçalho de 4 bytes).
+ *
+ * Na primeira chamada liga o filtro de tamanho: com config.header_pin
+ * ligado ao DIO3, a interrupção de ValidHeader lê o tamanho do cabeçalho
+ * PHY e aborta a recepção de quadros de outro tamanho antes do payload,
+ * sem RxDone nem leitura do FIFO. Chamadas seguintes somam faixas. Sem
+ * header_pin não tem efeito.
+ */
+void lora_accept_length(lora_radio_t *radio, uint8_t min, uint8_t max);
+
+/**
+ * @brief Troca o perfil de modem e a potência de transmissão sem
+ *        reinicializar o rádio. Se estava em recepção, volta a ela.
+ *        Só do loop principal, fora de uma transmissão.
+ */
+void lora_reconfigure(lora_radio_t *radio, modem_config_t modem, uint8_t tx_power);
+
+/**
+ * @brief Retira o pacote mais antigo da fila agregada de recepção.
+ *
+ * Recebe os pacotes de todos os rádios com `queue_rx` habilitado, na ordem
+ * de chegada. Deve ser chamada por um único consumidor (o loop principal).
+ * @return false se a fila estiver vazia.
+ */
+bool lora_rx_queue_pop(lora_payload_t *payload);
+
+/**
+ * @brief Pacotes descartados por falta de espaço na fila agregada.
+ */
+uint32_t lora_rx_queue_dropped(void);
+
+/**
+ * @brief Inicia o monitor de saúde do rádio em um timer repetitivo.
+ *
+ * A cada `period_ms` verifica, fora da ISR do DIO0, se o rádio continua em
+ * recepção: DIO0 preso em nível alto, modo de operação alterado, modem
+ * ocupado por mais que o tempo no ar de um quadro máximo no perfil atual
+ * mais `modem_margin_ms` e nenhum pacote há mais de `no_rx_timeout_ms`
+ * (0 desativa). Cada caso é recuperado com a menor sequência possível e
+ * contado em lora_health_t; um chip resetado é reconfigurado em duas
+ * verificações, sem esperas no alarme. Também devolve o DIO0 que a ISR
+ * mascarou por estar alto sem eventos.
+ * @return false se o timer não pôde ser criado.
+ */
+bool lora_health_start(lora_radio_t *radio, uint32_t period_ms, uint32_t modem_margin_ms, uint32_t no_rx_timeout_ms);
+
+/**
+ * @brief Para o monitor de saúde.
+ */
+void lora_health_stop(lora_radio_t *radio);
+
+/**
+ * @brief Retorna uma cópia dos contadores do monitor de saúde.
+ */
+lora_health_t lora_health_stats(lora_radio_t *radio);
+
+/**
+ * @brief Retorna uma cópia dos contadores de atendimento da interrupção.
+ */
+lora_irq_stats_t lora_irq_stats(lora_radio_t *radio);
+
+/**
+ * @brief Zera a medida de latência até o FIFO (campos fifo_* de
+ *        lora_irq_stats_t), para comparar condições diferentes.
+ */
+void lora_irq_latency_reset(lora_radio_t *radio);
 
+/**
+ * @brief Indica se o rádio está ocioso na recepção: nenhum evento pendente
+ *        no DIO0 e o modem sem preâmbulo detectado nem pacote em curso.
+ *
+ * Usada pelo loop principal antes de operações que bloqueiam as
+ * interrupções por muito tempo (ex.: apagar um setor da flash), para que
+ * elas não caiam no meio de um pacote.
+ */
+bool lora_rx_idle(lora_radio_t *radio);
+
+/**
+ * @brief Nome do transporte em uso ("spi" ou "pio").
+ */
+const char *lora_transport_name(lora_radio_t *radio);
+
+/**
+ * @brief Mede o transporte em uso com leituras de registradores de
+ *        configuração (não alteram o estado do rádio).
+ *
+ * Deve ser chamada do loop principal. Como toda transação do loop, cada
+ * iteração mascara as interrupções dos rádios do barramento, e o tempo
+ * inclui a máscara; uma ISR pendente é atendida entre duas iterações e
+ * pode alongar a medida, então convém repeti-la.
+ * @param iterations Número de transações de cada tipo.
+ * @param single_us Tempo total das leituras de um registrador.
+ * @param burst_us Tempo total das rajadas de 32 registradores.
+ */
+void lora_spi_benchmark(lora_radio_t *radio, uint32_t iterations, uint32_t *single_us, uint32_t *burst_us);
 
 /**
- * @brief Desinicializa a interface SPI.
+ * @brief Desinicializa o rádio. O barramento SPI só é desligado se nenhum
+ *        outro rádio o estiver usando.
  */
-void lora_close(void);
+void lora_close(lora_radio_t *radio);
 
 #endif // LORA_H
\ No newline at end of file
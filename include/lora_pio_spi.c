@@ -0,0 +1,135 @@
+#include "lora_pio_spi.h"
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "lora_pio_spi.pio.h"
+#include "caminho_quente.h"
+
+// Offset do programa em cada bloco PIO; carregado uma vez e compartilhado
+// pelas máquinas de estados de todos os rádios daquele bloco
+static int _offset[2] = {-1, -1};
+
+bool lora_pio_spi_init(lora_pio_spi_t *spi, PIO pio, uint sck_pin, uint mosi_pin, uint miso_pin, uint cs_pin, uint32_t hz) {
+    if (cs_pin + 1 != sck_pin || hz == 0) {
+        return false; // O side-set exige CS e SCK consecutivos
+    }
+
+    uint bloco = pio_get_index(pio);
+    if (_offset[bloco] < 0) {
+        if (!pio_can_add_program(pio, &lora_spi_cs_program)) {
+            return false;
+        }
+        _offset[bloco] = pio_add_program(pio, &lora_spi_cs_program);
+    }
+
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) {
+        return false;
+    }
+    int dma_tx = dma_claim_unused_channel(false);
+    int dma_rx = dma_claim_unused_channel(false);
+    if (dma_tx < 0 || dma_rx < 0) {
+        if (dma_tx >= 0) dma_channel_unclaim(dma_tx);
+        if (dma_rx >= 0) dma_channel_unclaim(dma_rx);
+        pio_sm_unclaim(pio, sm);
+        return false;
+    }
+
+    spi->pio = pio;
+    spi->sm = sm;
+    spi->dma_tx = dma_tx;
+    spi->dma_rx = dma_rx;
+
+    // 4 ciclos da máquina por bit
+    float div = (float)clock_get_hz(clk_sys) / (4.0f * hz);
+    if (div < 1.0f) {
+        div = 1.0f;
+    }
+    spi->hz = (uint32_t)(clock_get_hz(clk_sys) / (4.0f * div));
+
+    pio_sm_config c = lora_spi_cs_program_get_default_config(_offset[bloco]);
+    sm_config_set_out_pins(&c, mosi_pin, 1);
+    sm_config_set_in_pins(&c, miso_pin);
+    sm_config_set_sideset_pins(&c, cs_pin);
+    // MSB primeiro, autopull/autopush de 8 bits
+    sm_config_set_out_shift(&c, false, true, 8);
+    sm_config_set_in_shift(&c, false, true, 8);
+    sm_config_set_clkdiv(&c, div);
+
+    // CS alto, SCK e MOSI baixos antes de entregar os pinos ao PIO
+    uint32_t saidas = (1u << cs_pin) | (1u << sck_pin) | (1u << mosi_pin);
+    pio_sm_set_pins_with_mask(pio, sm, 1u << cs_pin, saidas);
+    pio_sm_set_pindirs_with_mask(pio, sm, saidas, saidas | (1u << miso_pin));
+    pio_gpio_init(pio, cs_pin);
+    pio_gpio_init(pio, sck_pin);
+    pio_gpio_init(pio, mosi_pin);
+    pio_gpio_init(pio, miso_pin);
+
+    pio_sm_init(pio, sm, _offset[bloco] + lora_spi_cs_offset_entry_point, &c);
+    // Contadores de bits; o side-set mantém o CS alto durante o exec
+    pio_sm_exec(pio, sm, pio_encode_set(pio_x, 6) | pio_encode_sideset(2, 0b01));
+    pio_sm_exec(pio, sm, pio_encode_set(pio_y, 6) | pio_encode_sideset(2, 0b01));
+    pio_sm_set_enabled(pio, sm, true);
+
+    // Acessos de 8 bits à FIFO: o barramento replica o byte nas 4 faixas,
+    // então ele chega aos bits 31..24 que o shift para a esquerda envia primeiro
+    dma_channel_config ct = dma_channel_get_default_config(dma_tx);
+    channel_config_set_transfer_data_size(&ct, DMA_SIZE_8);
+    channel_config_set_write_increment(&ct, false);
+    channel_config_set_dreq(&ct, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(dma_tx, &ct, &pio->txf[sm], NULL, 0, false);
+
+    dma_channel_config cr = dma_channel_get_default_config(dma_rx);
+    channel_config_set_transfer_data_size(&cr, DMA_SIZE_8);
+    channel_config_set_read_increment(&cr, false);
+    channel_config_set_dreq(&cr, pio_get_dreq(pio, sm, false));
+    dma_channel_configure(dma_rx, &cr, NULL, &pio->rxf[sm], 0, false);
+
+    return true;
+}
+
+void CAMINHO_QUENTE(lora_pio_spi_transfer)(lora_pio_spi_t *spi, uint8_t addr, const uint8_t *tx, uint8_t *rx, size_t len) {
+    static const uint8_t TABELA_QUENTE("lora_pio_zero") zero = 0x00; // Lido pelo DMA
+    static uint8_t descarte;
+    io_rw_8 *txfifo = (io_rw_8 *)&spi->pio->txf[spi->sm];
+    io_rw_8 *rxfifo = (io_rw_8 *)&spi->pio->rxf[spi->sm];
+
+    // Os canais ficam prontos antes do endereço entrar na FIFO: a partida é
+    // uma única escrita e a FIFO não esvazia no meio da transação
+    dma_channel_config ct = dma_channel_get_default_config(spi->dma_tx);
+    channel_config_set_transfer_data_size(&ct, DMA_SIZE_8);
+    channel_config_set_read_increment(&ct, tx != NULL);
+    channel_config_set_write_increment(&ct, false);
+    channel_config_set_dreq(&ct, pio_get_dreq(spi->pio, spi->sm, true));
+    dma_channel_configure(spi->dma_tx, &ct, txfifo, tx ? tx : &zero, len, false);
+
+    dma_channel_config cr = dma_channel_get_default_config(spi->dma_rx);
+    channel_config_set_transfer_data_size(&cr, DMA_SIZE_8);
+    channel_config_set_read_increment(&cr, false);
+    channel_config_set_write_increment(&cr, rx != NULL);
+    channel_config_set_dreq(&cr, pio_get_dreq(spi->pio, spi->sm, false));
+    dma_channel_configure(spi->dma_rx, &cr, rx ? rx : &descarte, rxfifo, len, false);
+
+    *txfifo = addr; // CS desce aqui
+    if (len > 0) {
+        dma_channel_start(spi->dma_tx);
+    }
+
+    // O byte recebido durante o endereço não interessa. Enquanto a FIFO de
+    // RX estiver cheia o autopush segura o clock, então nada se perde
+    while (pio_sm_is_rx_fifo_empty(spi->pio, spi->sm)) {
+        tight_loop_contents();
+    }
+    (void)*rxfifo;
+
+    if (len > 0) {
+        dma_channel_start(spi->dma_rx);
+        dma_channel_wait_for_finish_blocking(spi->dma_rx);
+    }
+}
+
+void lora_pio_spi_deinit(lora_pio_spi_t *spi) {
+    pio_sm_set_enabled(spi->pio, spi->sm, false);
+    pio_sm_unclaim(spi->pio, spi->sm);
+    dma_channel_unclaim(spi->dma_tx);
+    dma_channel_unclaim(spi->dma_rx);
+}
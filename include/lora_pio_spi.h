@@ -0,0 +1,51 @@
+#ifndef LORA_PIO_SPI_H
+#define LORA_PIO_SPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hardware/pio.h"
+
+// ============================================================================
+// --- Mestre SPI em PIO para o SX127x ---
+//
+// CS, byte de endereço e rajada de dados saem em uma única transação
+// sequenciada pelo hardware: o CS é side-set do programa lora_spi_cs e a
+// FIFO é alimentada por dois canais de DMA (TX e RX). O CS precisa estar no
+// pino imediatamente anterior ao SCK.
+// ============================================================================
+
+/**
+ * @brief Estado de uma máquina de estados PIO usada como mestre SPI.
+ */
+typedef struct {
+    PIO pio;
+    uint sm;
+    int dma_tx;
+    int dma_rx;
+    uint32_t hz;            // Clock SPI efetivo
+} lora_pio_spi_t;
+
+/**
+ * @brief Carrega o programa (uma vez por bloco PIO), reserva uma máquina de
+ *        estados e dois canais de DMA e configura os pinos.
+ * @param hz Clock SPI desejado; o efetivo fica em spi->hz.
+ * @return false se CS != SCK - 1 ou faltar máquina de estados, memória de
+ *         instruções ou canal de DMA.
+ */
+bool lora_pio_spi_init(lora_pio_spi_t *spi, PIO pio, uint sck_pin, uint mosi_pin, uint miso_pin, uint cs_pin, uint32_t hz);
+
+/**
+ * @brief Uma transação: `addr` seguido de `len` bytes.
+ *
+ * Com `tx` nulo envia zeros; com `rx` nulo descarta o que foi lido. Bloqueia
+ * até o último byte voltar pela FIFO de RX.
+ */
+void lora_pio_spi_transfer(lora_pio_spi_t *spi, uint8_t addr, const uint8_t *tx, uint8_t *rx, size_t len);
+
+/**
+ * @brief Para a máquina de estados e libera ela e os canais de DMA.
+ */
+void lora_pio_spi_deinit(lora_pio_spi_t *spi);
+
+#endif // LORA_PIO_SPI_H
@@ -0,0 +1,86 @@
+#include "node_table.h"
+#include <stddef.h>
+#include <math.h>
+#include "config.h"
+
+// Tabela de transmissores conhecidos, na ordem em que foram ouvidos
+static node_info_t _nos[MAX_NOS];
+static uint8_t _num_nos = 0;
+
+/**
+ * @brief Prepara uma entrada nova para o endereço dado.
+ */
+static void node_reset(node_info_t *no, uint8_t endereco) {
+    no->endereco = endereco;
+    no->pacotes = 0;
+    historico_init(&no->hist_temp, HISTORICO_AMOSTRAS_POR_COLUNA);
+    historico_init(&no->hist_umid, HISTORICO_AMOSTRAS_POR_COLUNA);
+    historico_init(&no->hist_pres, HISTORICO_AMOSTRAS_POR_COLUNA);
+}
+
+node_info_t *node_table_find(uint8_t endereco) {
+    for (uint8_t i = 0; i < _num_nos; ++i) {
+        if (_nos[i].endereco == endereco) {
+            return &_nos[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Encontra o nó ou cria sua entrada.
+ */
+static node_info_t *node_obter(uint8_t endereco) {
+    node_info_t *no = node_table_find(endereco);
+
+    if (no == NULL) {
+        if (_num_nos < MAX_NOS) {
+            no = &_nos[_num_nos++];
+        } else {
+            // Tabela cheia: reaproveita o nó ouvido há mais tempo
+            no = &_nos[0];
+            for (uint8_t i = 1; i < MAX_NOS; ++i) {
+                if (_nos[i].ultimo_pacote_us < no->ultimo_pacote_us) {
+                    no = &_nos[i];
+                }
+            }
+        }
+        node_reset(no, endereco);
+    }
+    return no;
+}
+
+/**
+ * @brief Atualiza os valores atuais e os históricos com uma leitura.
+ */
+static void node_registrar_leitura(node_info_t *no, float temp, float hum, float pres, uint64_t agora_us) {
+    no->temperatura = temp;
+    no->umidade = hum;
+    no->pressao = pres;
+    no->ultimo_pacote_us = agora_us;
+
+    historico_adicionar(&no->hist_temp, (int16_t)lroundf(temp * 10.0f));
+    historico_adicionar(&no->hist_umid, (int16_t)lroundf(hum));
+    historico_adicionar(&no->hist_pres, (int16_t)lroundf(pres * 10.0f));
+}
+
+node_info_t *node_table_update(uint8_t endereco, float temp, float hum, float pres, int rssi, float snr, uint64_t agora_us) {
+    node_info_t *no = node_obter(endereco);
+    node_registrar_leitura(no, temp, hum, pres, agora_us);
+    no->rssi = rssi;
+    no->snr = snr;
+    no->pacotes++;
+    return no;
+}
+
+void node_table_amostra(uint8_t endereco, float temp, float hum, float pres, uint64_t agora_us) {
+    node_registrar_leitura(node_obter(endereco), temp, hum, pres, agora_us);
+}
+
+uint8_t node_table_count(void) {
+    return _num_nos;
+}
+
+node_info_t *node_table_get(uint8_t indice) {
+    return indice < _num_nos ? &_nos[indice] : NULL;
+}
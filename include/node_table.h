@@ -0,0 +1,56 @@
+#ifndef NODE_TABLE_H
+#define NODE_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "historico.h"
+
+/**
+ * @brief Últimos dados e histórico de um transmissor.
+ */
+typedef struct {
+    uint8_t endereco;           // Endereço LoRa (header_from)
+    float temperatura;
+    float umidade;
+    float pressao;
+    int rssi;
+    float snr;
+    uint32_t pacotes;           // Pacotes válidos recebidos deste nó
+    uint64_t ultimo_pacote_us;  // Instante do último pacote
+    historico_t hist_temp;      // Décimos de °C
+    historico_t hist_umid;      // % inteiro
+    historico_t hist_pres;      // Décimos de hPa
+} node_info_t;
+
+/**
+ * @brief Registra uma leitura de um transmissor, criando sua entrada se necessário.
+ *
+ * Com a tabela cheia, a entrada do nó ouvido há mais tempo é reaproveitada.
+ * @return Ponteiro para a entrada do nó.
+ */
+node_info_t *node_table_update(uint8_t endereco, float temp, float hum, float pres, int rssi, float snr, uint64_t agora_us);
+
+/**
+ * @brief Acrescenta aos históricos de um nó uma leitura intermediária de um
+ *        quadro com várias amostras, sem contar um pacote nem tocar no RSSI/SNR.
+ *        A última leitura do quadro segue por node_table_update().
+ */
+void node_table_amostra(uint8_t endereco, float temp, float hum, float pres, uint64_t agora_us);
+
+/**
+ * @brief Procura um nó pelo endereço.
+ * @return Ponteiro para a entrada, ou NULL se o nó nunca foi ouvido.
+ */
+node_info_t *node_table_find(uint8_t endereco);
+
+/**
+ * @brief Número de nós na tabela.
+ */
+uint8_t node_table_count(void);
+
+/**
+ * @brief Retorna a entrada na posição `indice` (0 até node_table_count() - 1).
+ */
+node_info_t *node_table_get(uint8_t indice);
+
+#endif // NODE_TABLE_H
@@ -0,0 +1,68 @@
+#include "rolagem.h"
+#include "pico/stdlib.h"
+#include "config.h"
+
+// Primeiro passo entre 2 e 3 quadros após ligar, segundo entre 5 e 6
+#define ROLAGEM_INTERVALO  SSD1306_SCROLL_3_FRAMES
+#define ROLAGEM_ESPERA_US  (4 * DISPLAY_QUADRO_US)
+#define ROLAGEM_LIMITE_US  (9 * DISPLAY_QUADRO_US / 2)
+
+void rolagem_init(rolagem_t *r, ssd1306_t *ssd, uint8_t x0, uint8_t p0, uint8_t p1,
+                  rolagem_coluna_fn_t coluna_nova, void *ctx) {
+    r->ssd = ssd;
+    r->x0 = x0;
+    r->p0 = p0;
+    r->p1 = p1;
+    r->coluna_nova = coluna_nova;
+    r->ctx = ctx;
+    r->inicio_us = 0;
+    r->passos = 0;
+    r->incertos = 0;
+}
+
+void rolagem_iniciar(rolagem_t *r) {
+    ssd1306_scroll_horizontal(r->ssd, true, r->p0, r->p1, ROLAGEM_INTERVALO);
+    r->inicio_us = time_us_64();
+}
+
+static void rolagem_terminar(rolagem_t *r, uint64_t decorrido) {
+    ssd1306_scroll_stop(r->ssd);
+    r->inicio_us = 0;
+
+    if (decorrido > ROLAGEM_LIMITE_US) {
+        // A faixa pode ter rolado várias colunas, levando parte do gráfico
+        // para a margem: volta inteira do espelho, ainda sem a coluna nova
+        r->incertos++;
+        ssd1306_send_region(r->ssd, 0, r->ssd->width - 1, r->p0, r->p1);
+        r->coluna_nova(r->ctx, true);
+        return;
+    }
+    r->passos++;
+
+    // A GDDRAM deslocou tudo uma coluna, com a coluna 0 voltando na última;
+    // o espelho acompanha no trecho do gráfico e a margem continua vazia
+    uint8_t ultima = r->ssd->width - 1;
+    ssd1306_shift_left(r->ssd, r->x0, ultima, r->p0, r->p1);
+    r->coluna_nova(r->ctx, false);
+
+    if (r->x0 > 0) {
+        ssd1306_send_region(r->ssd, r->x0 - 1, r->x0 - 1, r->p0, r->p1);
+    }
+    ssd1306_send_region(r->ssd, ultima - 1, ultima, r->p0, r->p1);
+}
+
+uint64_t rolagem_prazo_us(const rolagem_t *r) {
+    return r->inicio_us + ROLAGEM_ESPERA_US;
+}
+
+bool rolagem_poll(rolagem_t *r) {
+    if (!rolagem_ativa(r)) {
+        return false;
+    }
+    uint64_t decorrido = time_us_64() - r->inicio_us;
+    if (decorrido < ROLAGEM_ESPERA_US) {
+        return false;
+    }
+    rolagem_terminar(r, decorrido);
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef ROLAGEM_H
+#define ROLAGEM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/ssd1306/ssd1306.h"
+
+// ============================================================================
+// --- Gráfico de faixa com rolagem por hardware ---
+//
+// O SSD1306 rola uma faixa de páginas sozinho (comandos 0x26/0x27), mas só
+// de forma contínua. Um passo de uma coluna é obtido ligando a rolagem com
+// intervalo de 3 quadros e desligando-a 4 quadros depois: entre o primeiro
+// passo (2 a 3 quadros) e o segundo (5 a 6 quadros). O loop segue livre
+// nesse meio tempo e rolagem_poll() desliga a rolagem no momento certo.
+//
+// Ao fim do passo o espelho em RAM (ram_buffer) é deslocado do mesmo jeito,
+// o callback desenha a coluna nova na borda direita e só ela (com a
+// vizinha, onde cai o segmento que liga os pontos) vai pelo I2C, além da
+// coluna da margem que recebeu a coluna mais antiga do gráfico. As outras
+// páginas não são tocadas.
+//
+// Se o passo for desligado tarde demais (loop preso numa operação da
+// flash, por exemplo), a tela pode ter rolado várias colunas: a faixa
+// volta inteira do espelho, o callback recebe `incerto` e o gráfico deve
+// ser redesenhado por inteiro.
+// ============================================================================
+
+/**
+ * @brief Desenha no espelho a coluna nova (a última da tela), ou marca o
+ *        gráfico para redesenho se `incerto`.
+ */
+typedef void (*rolagem_coluna_fn_t)(void *ctx, bool incerto);
+
+typedef struct {
+    ssd1306_t *ssd;
+    uint8_t x0;                     // Primeira coluna do gráfico; à esquerda fica margem vazia
+    uint8_t p0, p1;                 // Páginas roladas, na largura toda da tela
+    rolagem_coluna_fn_t coluna_nova;
+    void *ctx;
+    uint64_t inicio_us;             // Início do passo em andamento (0 = parado)
+    uint32_t passos;                // Passos concluídos
+    uint32_t incertos;              // Passos desligados fora da janela
+} rolagem_t;
+
+/**
+ * @brief Prepara um gráfico de faixa. Tudo nas páginas p0..p1 rola junto,
+ *        então as colunas à esquerda de x0 devem ficar vazias.
+ */
+void rolagem_init(rolagem_t *r, ssd1306_t *ssd, uint8_t x0, uint8_t p0, uint8_t p1,
+                  rolagem_coluna_fn_t coluna_nova, void *ctx);
+
+/**
+ * @brief Inicia o passo de uma coluna para a esquerda. Até o passo
+ *        terminar nada pode ser escrito no display.
+ */
+void rolagem_iniciar(rolagem_t *r);
+
+static inline bool rolagem_ativa(const rolagem_t *r) {
+    return r->inicio_us != 0;
+}
+
+/**
+ * @brief Instante em que o passo em andamento pode ser desligado.
+ */
+uint64_t rolagem_prazo_us(const rolagem_t *r);
+
+/**
+ * @brief Conclui o passo em andamento quando chega a hora. Nunca espera:
+ *        antes do prazo não faz nada, e deve ser chamada de novo em
+ *        rolagem_prazo_us().
+ * @return true se um passo terminou nesta chamada.
+ */
+bool rolagem_poll(rolagem_t *r);
+
+#endif // ROLAGEM_H
@@ -0,0 +1,330 @@
+#include "seguranca.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "config.h"
+#include "aes.h"
+
+#ifndef SEG_CHAVE
+#error "SEG_CHAVE nao definida: crie include/seg_chave.h ou use -DRECEPTOR_SEG_CHAVE (ver config.h)"
+#endif
+
+// A chave de teste da RFC 4493 / SP 800-38A é pública
+#define SEG_CHAVE_DE_TESTE(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15) \
+    ((a0) == 0x2b && (a1) == 0x7e && (a2) == 0x15 && (a3) == 0x16 && (a4) == 0x28 && (a5) == 0xae && \
+     (a6) == 0xd2 && (a7) == 0xa6 && (a8) == 0xab && (a9) == 0xf7 && (a10) == 0x15 && (a11) == 0x88 && \
+     (a12) == 0x09 && (a13) == 0xcf && (a14) == 0x4f && (a15) == 0x3c)
+#define SEG_APLICAR(m, ...) m(__VA_ARGS__)
+#if SEG_APLICAR(SEG_CHAVE_DE_TESTE, SEG_CHAVE)
+#error "SEG_CHAVE e a chave de teste publica da RFC 4493; gere uma chave propria"
+#endif
+
+#define SEG_CONTADOR_BYTES 4
+
+/**
+ * @brief Último contador aceito de um transmissor.
+ */
+typedef struct {
+    bool ocupado;
+    uint8_t endereco;
+    uint32_t contador;
+    uint64_t ultimo_us;
+} seg_contador_t;
+
+static aes128_t _k_cif;
+static aes128_t _k_mac;
+static seg_contador_t _contadores[MAX_NOS];
+static seguranca_stats_t _stats;
+
+// ============================================================================
+// --- Funções Auxiliares ---
+// ============================================================================
+
+static uint32_t ler_le32(const uint8_t *p) {
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void gravar_le32(uint8_t *p, uint32_t x) {
+    p[0] = x;
+    p[1] = x >> 8;
+    p[2] = x >> 16;
+    p[3] = x >> 24;
+}
+
+static void montar_iv(uint8_t iv[AES_BLOCO], uint8_t to, uint8_t from, const uint8_t *contador) {
+    memset(iv, 0, AES_BLOCO);
+    iv[0] = from;
+    iv[1] = to;
+    memcpy(iv + 4, contador, SEG_CONTADOR_BYTES);
+}
+
+/**
+ * @brief CMAC sobre cabeçalho | contador | texto cifrado (`corpo`).
+ */
+static void calcular_mic(uint8_t to, uint8_t from, uint8_t id, uint8_t flags,
+                         const uint8_t *corpo, size_t len, uint8_t mac[AES_BLOCO]) {
+    uint8_t cabecalho[4] = {to, from, id, flags};
+    aes_cmac_t cmac;
+    aes_cmac_iniciar(&cmac, &_k_mac);
+    aes_cmac_atualizar(&cmac, cabecalho, sizeof(cabecalho));
+    aes_cmac_atualizar(&cmac, corpo, len);
+    aes_cmac_finalizar(&cmac, mac);
+}
+
+/**
+ * @brief Comparação em tempo constante, para não revelar quantos bytes do
+ *        MIC conferem.
+ */
+static bool mic_confere(const uint8_t *a, const uint8_t *b, size_t len) {
+    uint8_t dif = 0;
+    for (size_t i = 0; i < len; ++i) {
+        dif |= a[i] ^ b[i];
+    }
+    return dif == 0;
+}
+
+static seg_contador_t *buscar_contador(uint8_t endereco) {
+    for (int i = 0; i < MAX_NOS; ++i) {
+        if (_contadores[i].ocupado && _contadores[i].endereco == endereco) {
+            return &_contadores[i];
+        }
+    }
+    return NULL;
+}
+
+static void registrar_contador(seg_contador_t *e, uint8_t endereco, uint32_t contador) {
+    if (e == NULL) {
+        // Posição livre ou, com a tabela cheia, o transmissor ouvido há mais tempo
+        e = &_contadores[0];
+        for (int i = 0; i < MAX_NOS && e->ocupado; ++i) {
+            if (!_contadores[i].ocupado || _contadores[i].ultimo_us < e->ultimo_us) {
+                e = &_contadores[i];
+            }
+        }
+        e->ocupado = true;
+        e->endereco = endereco;
+    }
+    e->contador = contador;
+    e->ultimo_us = time_us_64();
+}
+
+static bool abrir(lora_payload_t *p) {
+    if (p->length < SEG_CONTADOR_BYTES + SEG_MIC_BYTES) {
+        _stats.curtos++;
+        return false;
+    }
+    size_t n = p->length - SEG_CONTADOR_BYTES - SEG_MIC_BYTES;
+    uint8_t *cifrado = p->message + SEG_CONTADOR_BYTES;
+
+    // Autentica antes de decifrar
+    uint8_t mac[AES_BLOCO];
+    calcular_mic(p->header_to, p->header_from, p->header_id, p->header_flags,
+                 p->message, SEG_CONTADOR_BYTES + n, mac);
+    if (!mic_confere(mac, cifrado + n, SEG_MIC_BYTES)) {
+        _stats.mic_invalidos++;
+        return false;
+    }
+
+    // O contador só é confiável depois do MIC
+    uint32_t contador = ler_le32(p->message);
+    seg_contador_t *e = buscar_contador(p->header_from);
+    if (e != NULL && contador <= e->contador) {
+        _stats.repeticoes++;
+        return false;
+    }
+
+    uint8_t iv[AES_BLOCO];
+    montar_iv(iv, p->header_to, p->header_from, p->message);
+    aes128_ctr(&_k_cif, iv, cifrado, n);
+    memmove(p->message, cifrado, n);
+    p->message[n] = '\0';
+    p->length = n;
+
+    registrar_contador(e, p->header_from, contador);
+    _stats.abertos++;
+    _stats.bytes += n;
+    return true;
+}
+
+// ============================================================================
+// --- Funções Públicas ---
+// ============================================================================
+
+void seguranca_init(void) {
+    static const uint8_t chave[AES_BLOCO] = {SEG_CHAVE};
+    uint8_t sub[AES_BLOCO] = {0};
+    aes128_t mestra;
+
+    aes128_init(&mestra, chave);
+    sub[0] = 0x01;
+    aes128_cifrar_bloco(&mestra, sub, sub);
+    aes128_init(&_k_cif, sub);
+
+    memset(sub, 0, sizeof(sub));
+    sub[0] = 0x02;
+    aes128_cifrar_bloco(&mestra, sub, sub);
+    aes128_init(&_k_mac, sub);
+
+    memset(&mestra, 0, sizeof(mestra));
+    memset(sub, 0, sizeof(sub));
+    memset(_contadores, 0, sizeof(_contadores));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool seguranca_abrir(lora_payload_t *pacote) {
+    if (!(pacote->header_flags & FLAGS_SECURE)) {
+        _stats.texto_claro++;
+        if (SEG_EXIGIR) {
+            _stats.rejeitados_claro++;
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t inicio = time_us_64();
+    bool ok = abrir(pacote);
+    _stats.us += time_us_64() - inicio;
+    return ok;
+}
+
+size_t seguranca_selar(uint8_t to, uint8_t from, uint8_t id, uint8_t flags, uint32_t contador,
+                       const uint8_t *texto, size_t len, uint8_t *saida) {
+    uint8_t iv[AES_BLOCO];
+    uint8_t mac[AES_BLOCO];
+
+    gravar_le32(saida, contador);
+    memcpy(saida + SEG_CONTADOR_BYTES, texto, len);
+    montar_iv(iv, to, from, saida);
+    aes128_ctr(&_k_cif, iv, saida + SEG_CONTADOR_BYTES, len);
+    calcular_mic(to, from, id, flags | FLAGS_SECURE, saida, SEG_CONTADOR_BYTES + len, mac);
+    memcpy(saida + SEG_CONTADOR_BYTES + len, mac, SEG_MIC_BYTES);
+    return SEG_CONTADOR_BYTES + len + SEG_MIC_BYTES;
+}
+
+seguranca_stats_t seguranca_stats(void) {
+    return _stats;
+}
+
+// ============================================================================
+// --- Autoteste e Medição ---
+// ============================================================================
+
+static bool vetores_aes(void) {
+    // FIPS-197, apêndice C.1
+    static const uint8_t k1[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                   0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    static const uint8_t p1[16] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                   0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    static const uint8_t c1[16] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+                                   0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+    // SP 800-38A F.5.1 (dois blocos, cobre o incremento do contador) e RFC 4493
+    static const uint8_t k2[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                   0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+    static const uint8_t iv[16] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+                                   0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+    static const uint8_t msg[40] = {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+                                    0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+                                    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+                                    0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+                                    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11};
+    static const uint8_t ctr[32] = {0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26,
+                                    0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+                                    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff,
+                                    0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff};
+    static const uint8_t cmac0[16] = {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28,
+                                      0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46};
+    static const uint8_t cmac16[16] = {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44,
+                                       0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c};
+    static const uint8_t cmac40[16] = {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30,
+                                       0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27};
+
+    aes128_t aes;
+    aes_cmac_t cmac;
+    uint8_t buf[40];
+    bool ok = true;
+
+    aes128_init(&aes, k1);
+    aes128_cifrar_bloco(&aes, p1, buf);
+    ok &= memcmp(buf, c1, 16) == 0;
+
+    aes128_init(&aes, k2);
+    memcpy(buf, msg, 32);
+    aes128_ctr(&aes, iv, buf, 32);
+    ok &= memcmp(buf, ctr, 32) == 0;
+
+    aes_cmac_iniciar(&cmac, &aes);
+    aes_cmac_finalizar(&cmac, buf);
+    ok &= memcmp(buf, cmac0, 16) == 0;
+
+    aes_cmac_iniciar(&cmac, &aes);
+    aes_cmac_atualizar(&cmac, msg, 16);
+    aes_cmac_finalizar(&cmac, buf);
+    ok &= memcmp(buf, cmac16, 16) == 0;
+
+    // Em partes desalinhadas, como na verificação do MIC
+    aes_cmac_iniciar(&cmac, &aes);
+    aes_cmac_atualizar(&cmac, msg, 4);
+    aes_cmac_atualizar(&cmac, msg + 4, 36);
+    aes_cmac_finalizar(&cmac, buf);
+    ok &= memcmp(buf, cmac40, 16) == 0;
+
+    return ok;
+}
+
+bool seguranca_autoteste(void) {
+    bool ok = vetores_aes();
+
+    // Ida e volta sem afetar o estado real: contadores e estatísticas são
+    // restaurados no fim
+    seg_contador_t contadores[MAX_NOS];
+    seguranca_stats_t stats = _stats;
+    memcpy(contadores, _contadores, sizeof(contadores));
+    memset(_contadores, 0, sizeof(_contadores));
+
+    static const char texto[] = "T:25.1,H:45.0,P:1012.5";
+    lora_payload_t p = {
+        .header_to = 2, .header_from = 1, .header_id = 7, .header_flags = FLAGS_SECURE,
+    };
+    p.length = seguranca_selar(2, 1, 7, 0, 100, (const uint8_t *)texto, strlen(texto), p.message);
+    lora_payload_t copia = p;
+
+    ok &= abrir(&p) && p.length == strlen(texto) && strcmp((const char *)p.message, texto) == 0;
+    lora_payload_t repetido = copia;
+    ok &= !abrir(&repetido); // Mesmo contador
+    lora_payload_t adulterado = copia;
+    adulterado.message[SEG_CONTADOR_BYTES] ^= 0x01;
+    ok &= !abrir(&adulterado);
+    adulterado = copia;
+    adulterado.header_from = 3; // Cabeçalho também é autenticado
+    ok &= !abrir(&adulterado);
+
+    memcpy(_contadores, contadores, sizeof(contadores));
+    _stats = stats;
+    return ok;
+}
+
+void seguranca_benchmark(float *ctr_ciclos_byte, float *cmac_ciclos_byte) {
+    const int repeticoes = 50;
+    uint8_t buf[240];
+    uint8_t iv[AES_BLOCO] = {0};
+    uint8_t mac[AES_BLOCO];
+    float ciclos_por_us = clock_get_hz(clk_sys) / 1e6f;
+    memset(buf, 0x5a, sizeof(buf));
+
+    uint64_t inicio = time_us_64();
+    for (int i = 0; i < repeticoes; ++i) {
+        aes128_ctr(&_k_cif, iv, buf, sizeof(buf));
+    }
+    uint64_t us = time_us_64() - inicio;
+    *ctr_ciclos_byte = us * ciclos_por_us / (repeticoes * sizeof(buf));
+
+    inicio = time_us_64();
+    for (int i = 0; i < repeticoes; ++i) {
+        aes_cmac_t cmac;
+        aes_cmac_iniciar(&cmac, &_k_mac);
+        aes_cmac_atualizar(&cmac, buf, sizeof(buf));
+        aes_cmac_finalizar(&cmac, mac);
+    }
+    us = time_us_64() - inicio;
+    *cmac_ciclos_byte = us * ciclos_por_us / (repeticoes * sizeof(buf));
+}
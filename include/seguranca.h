@@ -0,0 +1,79 @@
+#ifndef SEGURANCA_H
+#define SEGURANCA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora.h"
+
+// ============================================================================
+// --- Camada de segurança dos pacotes (AES-128 CTR + CMAC) ---
+//
+// Pacotes com FLAGS_SECURE no cabeçalho trazem na mensagem:
+//
+//     contador (4, little-endian) | texto cifrado (n) | MIC (SEG_MIC_BYTES)
+//
+// Da chave pré-compartilhada SEG_CHAVE saem duas subchaves:
+// K_cif = AES(SEG_CHAVE, 01 00..00) e K_mac = AES(SEG_CHAVE, 02 00..00).
+//
+// - Cifra: AES-CTR com K_cif e bloco inicial
+//   from | to | 00 00 | contador (4, LE) | 00 x4 | 00 00 00 00 (bloco, BE)
+// - MIC: primeiros SEG_MIC_BYTES do CMAC com K_mac sobre
+//   to | from | id | flags | contador | texto cifrado
+//
+// O contador de cada transmissor precisa crescer a cada pacote; um valor
+// que não seja maior que o último aceito é tratado como repetição.
+// Tudo roda no loop principal, nunca na ISR do rádio.
+// ============================================================================
+
+/**
+ * @brief Contadores da camada de segurança.
+ */
+typedef struct {
+    uint32_t abertos;           // Pacotes autenticados e decifrados
+    uint32_t texto_claro;       // Pacotes sem FLAGS_SECURE
+    uint32_t rejeitados_claro;  // ...descartados por SEG_EXIGIR
+    uint32_t curtos;            // Menores que contador + MIC
+    uint32_t mic_invalidos;     // MIC não confere (adulterado ou chave errada)
+    uint32_t repeticoes;        // Contador não maior que o último aceito
+    uint32_t bytes;             // Bytes de texto cifrado processados
+    uint64_t us;                // Tempo gasto em seguranca_abrir(), em us
+} seguranca_stats_t;
+
+/**
+ * @brief Deriva as subchaves e zera a tabela de contadores.
+ */
+void seguranca_init(void);
+
+/**
+ * @brief Verifica e decifra um pacote no próprio buffer.
+ *
+ * Em caso de sucesso a mensagem passa a conter só o texto claro (terminado
+ * em '\0') e `length` o seu tamanho. Pacotes sem FLAGS_SECURE passam sem
+ * alteração, a menos que SEG_EXIGIR esteja ligado.
+ * @return false se o pacote deve ser descartado.
+ */
+bool seguranca_abrir(lora_payload_t *pacote);
+
+/**
+ * @brief Monta um pacote seguro (lado do transmissor; usado no autoteste).
+ * @param saida Buffer com espaço para len + 4 + SEG_MIC_BYTES bytes.
+ * @return Tamanho da mensagem montada.
+ */
+size_t seguranca_selar(uint8_t to, uint8_t from, uint8_t id, uint8_t flags, uint32_t contador,
+                       const uint8_t *texto, size_t len, uint8_t *saida);
+
+/**
+ * @brief Vetores de teste (FIPS-197, SP 800-38A, RFC 4493) e ida e volta de
+ *        um pacote, incluindo a rejeição de adulteração e repetição.
+ * @return true se todos passaram.
+ */
+bool seguranca_autoteste(void);
+
+/**
+ * @brief Mede a cifragem em ciclos por byte (CTR e CMAC sobre 240 bytes).
+ */
+void seguranca_benchmark(float *ctr_ciclos_byte, float *cmac_ciclos_byte);
+
+seguranca_stats_t seguranca_stats(void);
+
+#endif // SEGURANCA_H
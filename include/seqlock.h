@@ -0,0 +1,70 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+// ============================================================================
+// --- Seqlock: publicação sem travas de um escritor para vários leitores ---
+//
+// O escritor (ex.: a ISR do rádio) incrementa a sequência antes e depois de
+// alterar os dados; ela fica ímpar durante a escrita. O leitor copia os
+// dados e repete a cópia se a sequência mudou no meio. O escritor nunca
+// espera e o leitor nunca mascara interrupções.
+//
+// Uso no leitor:
+//     uint32_t seq;
+//     do {
+//         seq = seqlock_read_begin(&lock);
+//         copia = dados;
+//     } while (seqlock_read_retry(&lock, seq));
+//
+// As barreiras __dmb() também ordenam os acessos entre os dois núcleos, então
+// o leitor pode rodar no core 1. Um leitor que rode em contexto de maior
+// prioridade que o escritor no mesmo núcleo nunca veria a escrita terminar.
+// ============================================================================
+
+typedef struct {
+    volatile uint32_t seq;
+} seqlock_t;
+
+static inline void seqlock_init(seqlock_t *lock) {
+    lock->seq = 0;
+}
+
+static inline void seqlock_write_begin(seqlock_t *lock) {
+    lock->seq++;
+    __dmb(); // Sequência ímpar visível antes de qualquer dado novo
+}
+
+static inline void seqlock_write_end(seqlock_t *lock) {
+    __dmb(); // Dados completos antes da sequência par
+    lock->seq++;
+}
+
+/**
+ * @brief Sequência atual; muda (de dois em dois) a cada publicação.
+ */
+static inline uint32_t seqlock_sequence(const seqlock_t *lock) {
+    return lock->seq;
+}
+
+static inline uint32_t seqlock_read_begin(const seqlock_t *lock) {
+    uint32_t seq;
+    while ((seq = lock->seq) & 1) {
+        tight_loop_contents(); // Escrita em andamento no outro núcleo
+    }
+    __dmb();
+    return seq;
+}
+
+/**
+ * @return true se a cópia feita desde seqlock_read_begin() pode estar rasgada.
+ */
+static inline bool seqlock_read_retry(const seqlock_t *lock, uint32_t seq) {
+    __dmb();
+    return lock->seq != seq;
+}
+
+#endif // SEQLOCK_H
@@ -0,0 +1,297 @@
+#include "tdma.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "caminho_quente.h"
+
+#define SLOT_US         ((uint64_t)TDMA_SLOT_MS * 1000)
+#define SUPERQUADRO_US  (SLOT_US * TDMA_SLOTS)
+#define PRIMEIRO_LIVRE  (TDMA_SLOTS - TDMA_SLOTS_LIVRES)
+
+#if TDMA_SLOTS_LIVRES < 1 || PRIMEIRO_LIVRE < 2
+#error "TDMA_SLOTS deve comportar o beacon, um slot atribuído e TDMA_SLOTS_LIVRES >= 1"
+#endif
+
+// Estado compartilhado entre o alarme do beacon e a ISR de recepção. Os
+// dois têm a mesma prioridade e nunca se interrompem; o loop principal lê
+// com as interrupções mascaradas (tdma_copiar).
+static lora_radio_t *_radio = NULL;
+static alarm_id_t _alarme = 0;
+static uint64_t _disparo_us;            // Instante para o qual o alarme está agendado
+static uint64_t _nominal_us;            // Início nominal do superquadro que está sendo aberto
+static uint8_t _tentativas = 0;
+static uint64_t _inicio_us = 0;         // Início do superquadro atual (0 = nenhum beacon ainda)
+static uint16_t _seq = 0;
+
+static tdma_slot_t _slots[TDMA_SLOTS];
+static bool _visto[TDMA_SLOTS];         // Dono transmitiu no superquadro atual
+static bool _novo[TDMA_SLOTS];          // Atribuído no superquadro atual, ainda não anunciado
+static uint8_t _faltas[TDMA_SLOTS];     // Superquadros seguidos sem o dono
+static tdma_stats_t _stats;
+
+static inline void escrever_u16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static inline void escrever_u32(uint8_t *p, uint32_t v) {
+    escrever_u16(p, v);
+    escrever_u16(p + 2, v >> 16);
+}
+
+// ============================================================================
+// --- Superquadro (contexto do alarme e da ISR) ---
+// ============================================================================
+
+/**
+ * @brief Slot em que caiu o instante `t_us` (RxDone), contado a partir do
+ *        último beacon. Sem beacon, ou além do superquadro, é contenção.
+ */
+static uint8_t CAMINHO_QUENTE(slot_de)(uint64_t t_us) {
+    if (_inicio_us == 0 || t_us < _inicio_us) {
+        return TDMA_SLOTS - 1;
+    }
+    uint64_t slot = (t_us - _inicio_us) / SLOT_US;
+    return slot < TDMA_SLOTS ? slot : TDMA_SLOTS - 1;
+}
+
+static void CAMINHO_QUENTE(atribuir)(uint8_t endereco) {
+    for (uint8_t i = 1; i < PRIMEIRO_LIVRE; ++i) {
+        if (_slots[i].dono == BROADCAST_ADDRESS) {
+            _slots[i].dono = endereco;
+            _visto[i] = false;
+            _novo[i] = true;
+            _faltas[i] = 0;
+            _stats.atribuicoes++;
+            return;
+        }
+    }
+    _stats.sem_slot++;
+}
+
+/**
+ * @brief Contabiliza as ausências do superquadro que termina e libera os
+ *        slots abandonados.
+ */
+static void fechar_superquadro(void) {
+    for (uint8_t i = 1; i < PRIMEIRO_LIVRE; ++i) {
+        if (_slots[i].dono == BROADCAST_ADDRESS) {
+            continue;
+        }
+        if (_novo[i]) {
+            _novo[i] = false; // O dono ainda não conhecia o slot
+        } else if (_visto[i]) {
+            _faltas[i] = 0;
+        } else {
+            _slots[i].ausencias++;
+            if (++_faltas[i] >= TDMA_EXPIRA) {
+                _slots[i].dono = BROADCAST_ADDRESS;
+                _stats.expiracoes++;
+            }
+        }
+        _visto[i] = false;
+    }
+}
+
+static size_t montar_beacon(uint8_t *b, uint64_t inicio_us) {
+    b[0] = TDMA_VERSAO;
+    escrever_u16(&b[1], _seq);
+    escrever_u32(&b[3], (uint32_t)(inicio_us / 1000));
+    escrever_u16(&b[7], TDMA_SLOT_MS);
+    b[9] = TDMA_SLOTS;
+    b[10] = TDMA_SLOTS_LIVRES;
+    uint8_t n = 0;
+    for (uint8_t i = 1; i < PRIMEIRO_LIVRE; ++i) {
+        if (_slots[i].dono != BROADCAST_ADDRESS) {
+            b[TDMA_CABECALHO + 2 * n] = _slots[i].dono;
+            b[TDMA_CABECALHO + 2 * n + 1] = i;
+            n++;
+        }
+    }
+    b[11] = n;
+    return TDMA_CABECALHO + 2 * n;
+}
+
+/**
+ * @brief Reagenda o alarme para `alvo_us`, relativo ao disparo anterior
+ *        (sem acumular o atraso do callback).
+ */
+static int64_t reagendar(uint64_t alvo_us) {
+    int64_t passo = (int64_t)(alvo_us - _disparo_us);
+    _disparo_us = alvo_us;
+    return -passo;
+}
+
+static int64_t beacon_callback(alarm_id_t id, void *user_data) {
+    if (_tentativas == 0) {
+        fechar_superquadro();
+    }
+    uint64_t agora = time_us_64();
+    uint8_t beacon[TDMA_BEACON_MAX];
+    size_t len = montar_beacon(beacon, agora);
+
+    if (lora_send_async(_radio, beacon, len, BROADCAST_ADDRESS, FLAGS_BEACON)) {
+        _inicio_us = agora;
+        _seq++;
+        _stats.beacons++;
+        uint32_t atraso = (uint32_t)(agora - _nominal_us);
+        if (atraso > _stats.atraso_max_us) {
+            _stats.atraso_max_us = atraso;
+        }
+    } else {
+        _stats.adiados++;
+        if (++_tentativas < TDMA_TENTATIVAS) {
+            return reagendar(_disparo_us + TDMA_REPETE_US);
+        }
+        // Sem beacon neste superquadro: a contabilidade segue a grade nominal
+        _stats.perdidos++;
+        _inicio_us = _nominal_us;
+    }
+    _tentativas = 0;
+    _nominal_us += SUPERQUADRO_US;
+    return reagendar(_nominal_us);
+}
+
+// ============================================================================
+// --- API do receptor ---
+// ============================================================================
+
+bool tdma_iniciar(lora_radio_t *radio) {
+    tdma_parar();
+    if (lora_airtime_us(radio, 4 + TDMA_BEACON_MAX) + TDMA_GUARDA_US > SLOT_US) {
+        return false; // Beacon completo invadiria o slot 1
+    }
+    memset(_slots, 0, sizeof(_slots));
+    memset(_visto, 0, sizeof(_visto));
+    memset(_novo, 0, sizeof(_novo));
+    memset(_faltas, 0, sizeof(_faltas));
+    memset(&_stats, 0, sizeof(_stats));
+    for (uint8_t i = 0; i < TDMA_SLOTS; ++i) {
+        _slots[i].dono = BROADCAST_ADDRESS;
+    }
+    _inicio_us = 0;
+    _tentativas = 0;
+    _seq = 0;
+    _radio = radio;
+    _nominal_us = _disparo_us = time_us_64() + SLOT_US;
+    _alarme = add_alarm_at(from_us_since_boot(_disparo_us), beacon_callback, NULL, true);
+    if (_alarme <= 0) {
+        _radio = NULL;
+        return false;
+    }
+    return true;
+}
+
+void tdma_parar(void) {
+    if (_alarme > 0) {
+        cancel_alarm(_alarme);
+        _alarme = 0;
+    }
+    _radio = NULL;
+}
+
+void CAMINHO_QUENTE(tdma_registrar)(const lora_payload_t *pacote) {
+    if (_radio == NULL || pacote->radio != _radio->index || (pacote->header_flags & FLAGS_BEACON)) {
+        return;
+    }
+    uint8_t slot = slot_de(pacote->rx_timestamp_us);
+    tdma_slot_t *s = &_slots[slot];
+    if (slot >= PRIMEIRO_LIVRE) {
+        s->pacotes++;
+    } else if (s->dono == pacote->header_from) {
+        s->pacotes++;
+        _visto[slot] = true;
+    } else {
+        s->intrusos++;
+    }
+
+    for (uint8_t i = 1; i < PRIMEIRO_LIVRE; ++i) {
+        if (_slots[i].dono == pacote->header_from) {
+            return;
+        }
+    }
+    atribuir(pacote->header_from);
+}
+
+void CAMINHO_QUENTE(tdma_erro_crc)(uint8_t radio, uint64_t t_us) {
+    if (_radio != NULL && radio == _radio->index) {
+        _slots[slot_de(t_us)].crc++;
+    }
+}
+
+void tdma_copiar(tdma_stats_t *stats, tdma_slot_t slots[TDMA_SLOTS]) {
+    uint32_t estado = save_and_disable_interrupts();
+    *stats = _stats;
+    memcpy(slots, _slots, sizeof(_slots));
+    restore_interrupts(estado);
+}
+
+void tdma_imprimir(void) {
+    tdma_stats_t st;
+    tdma_slot_t slots[TDMA_SLOTS];
+    tdma_copiar(&st, slots);
+
+    printf("TDMA: superquadro de %lu ms (%d slots de %d ms, %d de contencao), guarda %d us\n",
+           (unsigned long)(SUPERQUADRO_US / 1000), TDMA_SLOTS, TDMA_SLOT_MS, TDMA_SLOTS_LIVRES, TDMA_GUARDA_US);
+    printf("TDMA: %lu beacons, %lu adiados, %lu perdidos, atraso max %lu us; %lu atribuicoes, "
+           "%lu expiracoes, %lu pacotes sem vaga\n",
+           (unsigned long)st.beacons, (unsigned long)st.adiados, (unsigned long)st.perdidos,
+           (unsigned long)st.atraso_max_us, (unsigned long)st.atribuicoes, (unsigned long)st.expiracoes,
+           (unsigned long)st.sem_slot);
+    printf("Slot dono   pacotes ausencias intrusos    crc\n");
+    for (uint8_t i = 0; i < TDMA_SLOTS; ++i) {
+        const tdma_slot_t *s = &slots[i];
+        char dono[8];
+        if (i == 0) {
+            snprintf(dono, sizeof(dono), "beacon");
+        } else if (i >= PRIMEIRO_LIVRE) {
+            snprintf(dono, sizeof(dono), "livre");
+        } else if (s->dono == BROADCAST_ADDRESS) {
+            snprintf(dono, sizeof(dono), "-");
+        } else {
+            snprintf(dono, sizeof(dono), "@%u", s->dono);
+        }
+        printf("%4u %-6s %7lu %9lu %8lu %6lu\n", i, dono, (unsigned long)s->pacotes,
+               (unsigned long)s->ausencias, (unsigned long)s->intrusos, (unsigned long)s->crc);
+    }
+}
+
+// ============================================================================
+// --- API do transmissor ---
+// ============================================================================
+
+bool tdma_ler_beacon(const lora_payload_t *pacote, tdma_beacon_t *b) {
+    const uint8_t *m = pacote->message;
+    if (!(pacote->header_flags & FLAGS_BEACON) || pacote->length < TDMA_CABECALHO || m[0] != TDMA_VERSAO) {
+        return false;
+    }
+    uint8_t n = m[11];
+    if (n > TDMA_SLOTS || pacote->length < TDMA_CABECALHO + 2 * n || m[10] >= m[9]) {
+        return false;
+    }
+    b->seq = m[1] | (uint16_t)m[2] << 8;
+    b->inicio_ms = m[3] | (uint32_t)m[4] << 8 | (uint32_t)m[5] << 16 | (uint32_t)m[6] << 24;
+    b->slot_ms = m[7] | (uint16_t)m[8] << 8;
+    b->slots = m[9];
+    b->livres = m[10];
+    b->num_pares = n;
+    memcpy(b->pares, &m[TDMA_CABECALHO], 2 * n);
+    return true;
+}
+
+int tdma_slot_de(const tdma_beacon_t *b, uint8_t endereco) {
+    for (uint8_t i = 0; i < b->num_pares; ++i) {
+        if (b->pares[2 * i] == endereco) {
+            return b->pares[2 * i + 1];
+        }
+    }
+    return -1;
+}
+
+uint64_t tdma_inicio_slot_us(const lora_radio_t *radio, const lora_payload_t *pacote_beacon,
+                             const tdma_beacon_t *b, uint8_t slot) {
+    // RxDone do beacon menos o tempo no ar dele = início da transmissão
+    uint64_t inicio = pacote_beacon->rx_timestamp_us - lora_airtime_us(radio, 4 + pacote_beacon->length);
+    return inicio + (uint64_t)slot * b->slot_ms * 1000 + TDMA_GUARDA_US;
+}
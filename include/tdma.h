@@ -0,0 +1,129 @@
+#ifndef TDMA_H
+#define TDMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora.h"
+#include "config.h"
+
+// ============================================================================
+// --- Superquadro TDMA sincronizado por beacon ---
+//
+// O receptor divide o tempo em superquadros de TDMA_SLOTS slots de
+// TDMA_SLOT_MS. Um alarme de hardware abre cada superquadro e transmite,
+// do próprio contexto do alarme, um beacon em broadcast (FLAGS_BEACON) com
+// o instante de início e as atribuições de slot:
+//
+//     versão, seq (u16), início (ms, u32), slot_ms (u16), slots, livres,
+//     n, n x (endereço, slot)                                 (little-endian)
+//
+// O slot 0 é do beacon; os TDMA_SLOTS_LIVRES últimos são de contenção
+// (ALOHA), usados por quem ainda não tem slot, com recuo exponencial a
+// cada tentativa sem ACK para a contenção não travar com muitos nós. Um
+// remetente novo ouvido em qualquer slot ganha o primeiro slot livre no
+// beacon seguinte e o perde após TDMA_EXPIRA superquadros seguidos sem
+// transmitir nele.
+//
+// O transmissor mede o início do superquadro pelo RxDone do beacon menos o
+// tempo no ar dele e transmite TDMA_GUARDA_US depois do início do seu slot
+// (tdma_inicio_slot_us). O atraso fixo da carga do FIFO no receptor fica
+// dentro da guarda.
+//
+// Por slot são contados os pacotes do dono, as ausências do dono, os
+// pacotes de outros remetentes (intrusos) e os erros de CRC, que indicam
+// colisões.
+// ============================================================================
+
+#define TDMA_VERSAO     1
+#define TDMA_CABECALHO  12      // Bytes do beacon antes dos pares
+#define TDMA_BEACON_MAX (TDMA_CABECALHO + 2 * TDMA_SLOTS)
+
+/**
+ * @brief Contadores de um slot.
+ */
+typedef struct {
+    uint8_t dono;           // Endereço atribuído (BROADCAST_ADDRESS = livre)
+    uint32_t pacotes;       // Pacotes do dono (em contenção: de qualquer remetente)
+    uint32_t ausencias;     // Superquadros em que o dono não transmitiu
+    uint32_t intrusos;      // Pacotes de outro remetente
+    uint32_t crc;           // Pacotes descartados por CRC (colisões prováveis)
+} tdma_slot_t;
+
+/**
+ * @brief Contadores gerais.
+ */
+typedef struct {
+    uint32_t beacons;       // Beacons transmitidos
+    uint32_t adiados;       // Tentativas adiadas (rádio ocupado)
+    uint32_t perdidos;      // Superquadros sem beacon (tentativas esgotadas)
+    uint32_t atribuicoes;
+    uint32_t expiracoes;
+    uint32_t sem_slot;      // Pacotes de remetentes sem slot por falta de vaga
+    uint32_t atraso_max_us; // Maior atraso do beacon em relação ao instante agendado
+} tdma_stats_t;
+
+/**
+ * @brief Beacon lido pelo transmissor.
+ */
+typedef struct {
+    uint16_t seq;
+    uint32_t inicio_ms;     // Início do superquadro no relógio do receptor
+    uint16_t slot_ms;
+    uint8_t slots;
+    uint8_t livres;
+    uint8_t num_pares;
+    uint8_t pares[2 * TDMA_SLOTS];
+} tdma_beacon_t;
+
+/**
+ * @brief Lado receptor: zera as atribuições e começa a transmitir beacons
+ *        pelo rádio, a partir do próximo superquadro.
+ * @return false se o beacon completo não couber no slot 0 com a guarda, ou
+ *         se o alarme não puder ser criado.
+ */
+bool tdma_iniciar(lora_radio_t *radio);
+
+/**
+ * @brief Para os beacons.
+ */
+void tdma_parar(void);
+
+/**
+ * @brief Registra um pacote recebido (chamar do callback de recepção).
+ */
+void tdma_registrar(const lora_payload_t *pacote);
+
+/**
+ * @brief Registra um erro de CRC (use com lora_on_crc_error).
+ */
+void tdma_erro_crc(uint8_t radio, uint64_t t_us);
+
+/**
+ * @brief Copia os contadores de forma consistente com as interrupções.
+ */
+void tdma_copiar(tdma_stats_t *stats, tdma_slot_t slots[TDMA_SLOTS]);
+
+/**
+ * @brief Imprime no console os contadores e a tabela de slots.
+ */
+void tdma_imprimir(void);
+
+/**
+ * @brief Lado transmissor: lê um beacon recebido.
+ * @return false se o pacote não for um beacon válido.
+ */
+bool tdma_ler_beacon(const lora_payload_t *pacote, tdma_beacon_t *b);
+
+/**
+ * @brief Slot atribuído a `endereco` no beacon, ou -1 (usar a contenção).
+ */
+int tdma_slot_de(const tdma_beacon_t *b, uint8_t endereco);
+
+/**
+ * @brief Instante (time_us_64 local) para transmitir no slot, medido a
+ *        partir da recepção do beacon pelo rádio.
+ */
+uint64_t tdma_inicio_slot_us(const lora_radio_t *radio, const lora_payload_t *pacote_beacon,
+                             const tdma_beacon_t *b, uint8_t slot);
+
+#endif // TDMA_H
@@ -1,22 +1,43 @@
 #include "pico/stdlib.h"
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 
 // Includes dos periféricos do Pico SDK
 #include "hardware/spi.h"
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/xip_ctrl.h"
 
 // Nossos próprios arquivos de cabeçalho
 #include "include/config.h"
 #include "include/lora.h"
 #include "include/display.h"
 #include "include/led_rgb.h"
+#include "include/display_scheduler.h"
+#include "include/dashboard.h"
+#include "include/log_ring.h"
+#include "include/latencia.h"
+#include "include/console.h"
+#include "include/gateway.h"
+#include "include/link_stats.h"
+#include "include/adr.h"
+#include "include/tdma.h"
+#include "include/fragmentos.h"
+#include "include/seguranca.h"
+#include "include/amostras.h"
+#include "include/flash_log.h"
+#include "include/caminho_quente.h"
+#include "include/agenda.h"
 
 // --- Variáveis Globais ---
 // Instância principal para o objeto do display
 ssd1306_t display;
 
+// Limita a taxa de quadros do display independentemente da taxa de pacotes
+display_scheduler_t display_sched;
+
 // Estrutura para armazenar um conjunto de dados recebidos
 typedef struct {
     float temperatura;
@@ -24,11 +45,28 @@ typedef struct {
     float pressao;
 } DadosRecebidos_t;
 
-// Variáveis 'volatile' para comunicação segura entre a interrupção (ISR) e o loop principal
-volatile bool novos_dados_recebidos = false;
-volatile int ultimo_rssi = 0;
-volatile uint32_t pacotes_recebidos = 0;
-DadosRecebidos_t dados_atuais = {0.0f, 0.0f, 0.0f}; // Zera os dados na inicialização
+// Rádios LoRa. Os pacotes de todos eles chegam ao loop principal pela fila
+// agregada do driver (lock-free), na ordem de recepção; a decodificação
+// acontece no loop, que nunca precisa desabilitar a interrupção do rádio.
+lora_radio_t radios[LORA_NUM_RADIOS];
+
+// Contador de pacotes válidos (só acessado pelo loop principal)
+uint32_t pacotes_recebidos = 0;
+
+// Eventos da agenda do loop principal
+enum {
+    EVENTO_RX       = 1u << 0, // Pacote na fila de recepção (ISR do rádio)
+    EVENTO_CONSOLE  = 1u << 1, // Caractere chegou no stdio
+    EVENTO_DISPLAY  = 1u << 2, // Estado novo para o painel
+    EVENTO_LOG      = 1u << 3, // Registros novos no canal de log
+    EVENTO_GATEWAY  = 1u << 4, // Quadro novo para o host (modo gateway)
+};
+
+// Tarefa do painel, que se reagenda para os prazos da rolagem e dos quadros
+int tarefa_painel_id = -1;
+
+// Console adiado por um registro do log em envio; o log o reagenda ao terminar
+bool console_adiado = false;
 
 // --- FUNÇÕES DE INICIALIZAÇÃO DE HARDWARE ---
 
@@ -36,54 +74,536 @@ DadosRecebidos_t dados_atuais = {0.0f, 0.0f, 0.0f}; // Zera os dados na iniciali
  * @brief Inicializa o barramento I2C1 para o display OLED.
  */
 void setup_i2c_display() {
-    i2c_init(I2C_PORT, I2C_BAUDRATE);
+    uint baudrate = i2c_init(I2C_PORT, I2C_BAUDRATE);
     gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA_PIN);
     gpio_pull_up(I2C_SCL_PIN);
-    printf("I2C1 (Display) inicializado nos pinos SDA=%d, SCL=%d.\n", I2C_SDA_PIN, I2C_SCL_PIN);
+#if I2C_FAST_MODE_PLUS
+    // Em 1 MHz os pull-ups fortes pedem mais corrente na descida
+    gpio_set_drive_strength(I2C_SDA_PIN, GPIO_DRIVE_STRENGTH_12MA);
+    gpio_set_drive_strength(I2C_SCL_PIN, GPIO_DRIVE_STRENGTH_12MA);
+#endif
+    printf("I2C1 (Display) inicializado nos pinos SDA=%d, SCL=%d a %u kHz.\n", I2C_SDA_PIN, I2C_SCL_PIN, baudrate / 1000);
 }
 
+// --- FUNÇÃO DE CALLBACK DO LORA ---
 /**
- * @brief Inicializa o barramento SPI0 e os pinos GPIO associados para o LoRa.
- * ESTA FUNÇÃO É A CORREÇÃO CRÍTICA.
+ * @brief É chamada AUTOMATICAMENTE pela biblioteca LoRa via interrupção
+ *        quando um pacote válido é recebido.
+ * @param payload Ponteiro para a estrutura com os dados recebidos.
  */
-void setup_spi_lora() {
-    // Inicializa o periférico SPI em si
-    spi_init(LORA_SPI_PORT, 5 * 1000 * 1000); // 5 MHz
+void CAMINHO_QUENTE(on_lora_receive)(lora_payload_t* payload) {
+    // Só o trabalho inteiro e barato fica aqui; o pacote segue para o loop
+    // pela fila agregada do driver e a decodificação (sscanf com floats)
+    // acontece fora da interrupção
+    link_stats_registrar(payload->header_from, payload->header_id,
+                         payload->rssi, payload->snr_x4, payload->rx_timestamp_us);
+#if TDMA_HABILITADO
+    tdma_registrar(payload);
+#endif
+#if GATEWAY_HABILITADO
+    // Modo gateway: todo quadro segue para o host, inclusive os que não
+    // são de telemetria ou que o loop não chegar a decodificar
+    gateway_encaminhar(payload);
+    agenda_sinalizar(EVENTO_RX | EVENTO_GATEWAY);
+#else
+    agenda_sinalizar(EVENTO_RX);
+#endif
+}
 
-    // Informa aos pinos GPIO para serem controlados pelo periférico SPI
-    gpio_set_function(LORA_SCK_PIN, GPIO_FUNC_SPI);
-    gpio_set_function(LORA_MOSI_PIN, GPIO_FUNC_SPI);
-    gpio_set_function(LORA_MISO_PIN, GPIO_FUNC_SPI);
-    
-    printf("SPI0 (LoRa) inicializado nos pinos SCK=%d, MOSI=%d, MISO=%d.\n", LORA_SCK_PIN, LORA_MOSI_PIN, LORA_MISO_PIN);
+
+// --- COMANDOS DO CONSOLE ---
+
+/**
+ * @brief Desenha o quadro pendente do painel marcando as etapas de latência.
+ */
+void renderizar_painel(void *ctx) {
+    latencia_render_inicio();
+    dashboard_render(ctx);
+    latencia_render_fim();
 }
 
+void cmd_latencias(void) {
+    latencia_imprimir();
+}
+
+void cmd_zerar_latencias(void) {
+    latencia_init();
+    printf("Latencias zeradas.\n");
+}
+
+void cmd_display(void) {
+    uint32_t quadros = display_sched.quadros_desenhados;
+    printf("Display: %lu quadros, %lu descartados, render ultimo %lu us, max %lu us, medio %lu us\n",
+           (unsigned long)quadros, (unsigned long)display_sched.quadros_descartados,
+           (unsigned long)display_sched.render_ultimo_us, (unsigned long)display_sched.render_max_us,
+           (unsigned long)(quadros ? display_sched.render_total_us / quadros : 0));
+    printf("Display: I2C %lu transacoes, %lu bytes\n",
+           (unsigned long)display.i2c_transactions, (unsigned long)display.i2c_bytes);
+    const rolagem_t *rolagem = dashboard_rolagem();
+    printf("Display: rolagem por hardware %lu passos, %lu incertos\n",
+           (unsigned long)rolagem->passos, (unsigned long)rolagem->incertos);
+}
+
+void cmd_enlace(void) {
+    link_stats_imprimir();
+}
+
+void cmd_adr(void) {
+    adr_imprimir();
+}
+
+#if FRAG_HABILITADO
+void cmd_fragmentos(void) {
+    fragmentos_imprimir();
+}
+
+void tarefa_fragmentos(void) {
+    fragmentos_servico(time_us_64());
+}
+#endif
+
+#if TDMA_HABILITADO
+void cmd_tdma(void) {
+    tdma_imprimir();
+}
+#endif
 
-// --- FUNÇÃO DE CALLBACK DO LORA ---
 /**
- * @brief É chamada AUTOMATICAMENTE pela biblioteca LoRa via interrupção
- *        quando um pacote válido é recebido.
- * @param payload Ponteiro para a estrutura com os dados recebidos.
+ * @brief Imprime os contadores de saúde e de interrupção de um rádio.
  */
-void on_lora_receive(lora_payload_t* payload) {
-    // Tenta decodificar a string no formato "T:25.1,H:45.0,P:1012.5"
-    // sscanf retorna o número de variáveis preenchidas com sucesso.
-    int items_parsed = sscanf((const char*)payload->message, "T:%f,H:%f,P:%f",
-                                &dados_atuais.temperatura,
-                                &dados_atuais.umidade,
-                                &dados_atuais.pressao);
-
-    // Só considera os dados válidos se todos os 3 valores foram encontrados
-    if (items_parsed == 3) {
-        ultimo_rssi = payload->rssi;
-        pacotes_recebidos++;
-        // Sinaliza ao loop principal que há dados novos e válidos para processar
-        novos_dados_recebidos = true; 
-    } else {
+void imprimir_radio(lora_radio_t *radio) {
+    lora_health_t h = lora_health_stats(radio);
+    printf("Radio %u: %lu verificacoes (%lu adiadas), %lu IRQs perdidas, %lu rearmes de modo\n",
+           radio->index, (unsigned long)h.checks, (unsigned long)h.checks_skipped,
+           (unsigned long)h.missed_irqs, (unsigned long)h.mode_rearms);
+    printf("Radio %u: %lu resets, %lu modem travado, %lu timeouts sem RX, ultimo incidente ha %llu ms\n",
+           radio->index, (unsigned long)h.radio_resets, (unsigned long)h.modem_stalls, (unsigned long)h.rx_timeouts,
+           h.last_incident_us ? (unsigned long long)((time_us_64() - h.last_incident_us) / 1000) : 0ull);
+    lora_irq_stats_t irq = lora_irq_stats(radio);
+    printf("Radio %u: DIO0 preso sem eventos: %lu vezes mascarado pela ISR, %lu devolvido pelo monitor\n",
+           radio->index, (unsigned long)irq.dio0_masks, (unsigned long)h.dio0_unmasks);
+
+    printf("IRQ: %lu entradas, %lu eventos, %lu vazias, %lu no limite, %lu obsoletos, %lu erros de CRC\n",
+           (unsigned long)irq.entries, (unsigned long)irq.events, (unsigned long)irq.empty_entries,
+           (unsigned long)irq.bound_hits, (unsigned long)irq.stale_events, (unsigned long)irq.crc_errors);
+    printf("Filtro: %lu cabecalhos, %lu abortados pelo tamanho, %lu descartados pelo endereco, %lu aceitos\n",
+           (unsigned long)irq.valid_headers, (unsigned long)irq.length_rejects,
+           (unsigned long)irq.address_rejects, (unsigned long)irq.accepted);
+    printf("IRQ: eventos por entrada:");
+    for (int i = 0; i <= LORA_IRQ_MAX_EVENTS; ++i) {
+        printf(" %d=%lu", i, (unsigned long)irq.events_per_entry[i]);
+    }
+    printf("\n");
+}
+
+void cmd_radio(void) {
+    for (int i = 0; i < LORA_NUM_RADIOS; ++i) {
+        imprimir_radio(&radios[i]);
+    }
+    printf("Fila de recepcao: %lu pacotes descartados\n", (unsigned long)lora_rx_queue_dropped());
+}
+
+void cmd_benchmark_spi(void) {
+    const uint32_t iteracoes = 1000;
+    for (int i = 0; i < LORA_NUM_RADIOS; ++i) {
+        uint32_t simples_us, rajada_us;
+        lora_spi_benchmark(&radios[i], iteracoes, &simples_us, &rajada_us);
+        printf("Radio %d (%s, %lu Hz): 1 registrador %lu ns, rajada de 32 %lu ns por transacao\n", i,
+               lora_transport_name(&radios[i]), (unsigned long)radios[i].spi_hz,
+               (unsigned long)(simples_us * 1000ull / iteracoes), (unsigned long)(rajada_us * 1000ull / iteracoes));
+    }
+}
+
+void cmd_seguranca(void) {
+    seguranca_stats_t s = seguranca_stats();
+    printf("Seguranca: %lu abertos (%lu bytes), %lu texto claro (%lu rejeitados)\n",
+           (unsigned long)s.abertos, (unsigned long)s.bytes,
+           (unsigned long)s.texto_claro, (unsigned long)s.rejeitados_claro);
+    printf("Seguranca: %lu MIC invalidos, %lu repeticoes, %lu curtos, %llu us no total\n",
+           (unsigned long)s.mic_invalidos, (unsigned long)s.repeticoes, (unsigned long)s.curtos,
+           (unsigned long long)s.us);
+
+    float ctr, cmac;
+    seguranca_benchmark(&ctr, &cmac);
+    printf("AES-128: CTR %.1f ciclos/byte, CMAC %.1f ciclos/byte\n", ctr, cmac);
+}
+
+// Comparação de latência: com o cache do XIP invalidado a cada passada do
+// loop, a ISR encontra o cache frio como depois de um quadro do display
+static bool xip_frio = false;
+
+void cmd_latencia_fifo(void) {
+    float ciclos_por_us = clock_get_hz(clk_sys) / 1e6f;
+    printf("Latencia ISR->FIFO, caminho na %s, cache do XIP %s:\n",
+           CAMINHO_QUENTE_RAM ? "SRAM" : "flash", xip_frio ? "invalidado" : "normal");
+    for (int i = 0; i < LORA_NUM_RADIOS; ++i) {
+        lora_irq_stats_t s = lora_irq_stats(&radios[i]);
+        if (s.fifo_samples == 0) {
+            printf("Radio %d: sem pacotes\n", i);
+            continue;
+        }
+        float media = (float)s.fifo_cycles_sum / s.fifo_samples;
+        float variancia = (float)s.fifo_cycles_sq_sum / s.fifo_samples - media * media;
+        printf("Radio %d: %lu pacotes, min %lu, media %.0f, max %lu ciclos; jitter %.2f us, desvio %.2f us\n",
+               i, (unsigned long)s.fifo_samples, (unsigned long)s.fifo_cycles_min, media,
+               (unsigned long)s.fifo_cycles_max, (s.fifo_cycles_max - s.fifo_cycles_min) / ciclos_por_us,
+               sqrtf(variancia > 0 ? variancia : 0) / ciclos_por_us);
+        lora_irq_latency_reset(&radios[i]);
+    }
+    xip_frio = !xip_frio;
+    printf("Medida zerada; agora com o cache do XIP %s.\n", xip_frio ? "invalidado" : "normal");
+}
+
+/**
+ * @brief Mede o desenho de glifos num buffer de rascunho (nada vai ao display):
+ *        pixel a pixel, como a fonte 8x8 era desenhada fora do alinhamento de
+ *        página, contra a cópia direta dos glifos pré-transpostos.
+ */
+void cmd_fontes(void) {
+    static ssd1306_t rascunho;
+    if (!rascunho.ram_buffer) {
+        ssd1306_init(&rascunho, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, DISPLAY_I2C_ADDR, I2C_PORT);
+    }
+    const uint32_t repeticoes = 2000;
+    float ciclos_por_us = clock_get_hz(clk_sys) / 1e6f;
+
+    uint64_t inicio = time_us_64();
+    for (uint32_t i = 0; i < repeticoes; ++i) {
+        ssd1306_draw_char(&rascunho, '0' + i % 10, (i % 15) * 8, 3);
+    }
+    float pixel = (time_us_64() - inicio) * ciclos_por_us / repeticoes;
+
+    inicio = time_us_64();
+    for (uint32_t i = 0; i < repeticoes; ++i) {
+        ssd1306_draw_char(&rascunho, '0' + i % 10, (i % 15) * 8, 8);
+    }
+    float copia = (time_us_64() - inicio) * ciclos_por_us / repeticoes;
+
+    printf("Fonte 8x8: pixel a pixel %.0f ciclos/glifo, copia %.0f ciclos/glifo (%.1fx)\n",
+           pixel, copia, pixel / copia);
+
+    const ssd1306_font_t *grandes[] = { &font_digitos16, &font_digitos24 };
+    for (size_t f = 0; f < sizeof(grandes) / sizeof(grandes[0]); ++f) {
+        const ssd1306_font_t *fonte = grandes[f];
+        inicio = time_us_64();
+        for (uint32_t i = 0; i < repeticoes; ++i) {
+            ssd1306_draw_font_char(&rascunho, fonte, '0' + i % 10, (i % 8) * fonte->width, 0);
+        }
+        float ciclos = (time_us_64() - inicio) * ciclos_por_us / repeticoes;
+        printf("Digitos %ux%u: copia %.0f ciclos/glifo (%.1f por coluna de 8 px)\n",
+               fonte->width, fonte->pages * 8, ciclos, ciclos / (fonte->width * fonte->pages));
+    }
+}
+
+void cmd_agenda(void) {
+    agenda_imprimir();
+}
+
+void cmd_flash_log(void) {
+    flash_log_dump();
+}
+
+/**
+ * @brief Nenhum rádio no meio de um pacote: a flash pode bloquear as interrupções.
+ */
+bool radios_ociosos(void) {
+    for (int i = 0; i < LORA_NUM_RADIOS; ++i) {
+        if (!lora_rx_idle(&radios[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void cmd_gateway(void) {
+    gateway_stats_t s = gateway_stats();
+    printf("Gateway: %lu recebidos, %lu encaminhados, %lu descartados, fila max %lu\n",
+           (unsigned long)s.quadros_recebidos, (unsigned long)s.quadros_encaminhados,
+           (unsigned long)s.quadros_descartados, (unsigned long)s.fila_max);
+    printf("Gateway: lotes %lu por tamanho / %lu por tempo, %lu bytes, %lu esperas do enlace\n",
+           (unsigned long)s.lotes_por_tamanho, (unsigned long)s.lotes_por_tempo,
+           (unsigned long)s.bytes_enviados, (unsigned long)s.esperas_enlace);
+}
+
+
+// --- PROCESSAMENTO DE PACOTES ---
+
+/**
+ * @brief Extrai a leitura mais recente de um pacote, compacto ou de texto.
+ *
+ * Num quadro compacto as leituras anteriores à última vão direto para o
+ * histórico do nó, uma por vez, conforme o decodificador avança no buffer.
+ * @return false se o pacote não está em nenhum dos formatos.
+ */
+bool decodificar_pacote(const lora_payload_t *pacote, DadosRecebidos_t *dados) {
+    amostras_leitor_t leitor;
+    if (amostras_iniciar(&leitor, pacote->message, pacote->length)) {
+        amostra_t a;
+        bool alguma = false;
+        while (amostras_proxima(&leitor, &a)) {
+            dados->temperatura = a.temp_x10 / 10.0f;
+            dados->umidade = a.umid_x10 / 10.0f;
+            dados->pressao = a.pres_x10 / 10.0f;
+            alguma = true;
+            if (leitor.restantes > 0) {
+                dashboard_registrar_amostra(pacote->header_from, dados->temperatura,
+                                            dados->umidade, dados->pressao);
+            }
+        }
+        // Truncado: as leituras já decodificadas ficam no histórico, mas o
+        // pacote não conta como válido
+        return alguma && !leitor.erro;
+    }
+
+    // Formato de texto "T:25.1,H:45.0,P:1012.5"; sscanf retorna o número
+    // de variáveis preenchidas com sucesso
+    int items_parsed = sscanf((const char*)pacote->message, "T:%f,H:%f,P:%f",
+                              &dados->temperatura,
+                              &dados->umidade,
+                              &dados->pressao);
+    return items_parsed == 3;
+}
+
+/**
+ * @brief Decodifica um pacote retirado da fila de recepção e distribui
+ *        os dados para o painel, o LED e o canal de log.
+ * @param t_fila Instante em que o pacote saiu da fila.
+ */
+void processar_pacote(const lora_payload_t *pacote, uint64_t t_fila) {
+    DadosRecebidos_t dados_copiados;
+
+    // Só considera os dados válidos se a leitura foi decodificada por inteiro
+    if (!decodificar_pacote(pacote, &dados_copiados)) {
         // Ignora pacotes malformados, mas avisa no console para debug
-        printf("WARN: Pacote LoRa recebido com formato inesperado: %.*s\n", payload->length, payload->message);
+        log_ring_texto("WARN: Pacote LoRa de #%d com formato inesperado (%d bytes)",
+                       pacote->header_from, pacote->length, 0);
+        return;
+    }
+    latencia_pacote_decodificado(pacote->rx_timestamp_us, t_fila, time_us_64());
+
+    int rssi_copiado = pacote->rssi;
+    float snr_copiado = pacote->snr_x4 / 4.0f;
+    uint8_t remetente_copiado = pacote->header_from;
+    uint32_t contador_copiado = ++pacotes_recebidos;
+    
+    // 1. Feedback visual: piscada na cor do RSSI, tocada pelo DMA; o LED
+    //    volta sozinho ao azul de fundo
+    rgb_led_pacote(rssi_copiado);
+    
+    // 2. Registra o pacote no painel; o desenho acontece no ritmo
+    //    do escalonador, coalescendo pacotes intermediários
+    dashboard_registrar_pacote(remetente_copiado,
+                               dados_copiados.temperatura,
+                               dados_copiados.umidade,
+                               dados_copiados.pressao,
+                               rssi_copiado, snr_copiado);
+    display_scheduler_request(&display_sched);
+    
+    // 3. Registra o pacote no canal de log; a escrita no console
+    //    acontece aos poucos em log_ring_drain()
+    log_pacote_t registro = {
+        .seq = contador_copiado,
+        .remetente = remetente_copiado,
+        .rssi = (int16_t)rssi_copiado,
+        .snr_x4 = pacote->snr_x4,
+        .temp_x10 = (int16_t)lroundf(dados_copiados.temperatura * 10.0f),
+        .umid = (int16_t)lroundf(dados_copiados.umidade),
+        .pres_x10 = (int16_t)lroundf(dados_copiados.pressao * 10.0f),
+    };
+    log_ring_pacote(&registro);
+    flash_log_registrar(&registro, pacote->radio);
+}
+
+#if FRAG_HABILITADO
+/**
+ * @brief Transferência remontada: um histórico em lote são quadros
+ *        compactos em sequência, que vão para o histórico do nó.
+ */
+void ao_completar_transferencia(uint8_t remetente, const uint8_t *dados, size_t tamanho) {
+    amostras_leitor_t leitor;
+    const uint8_t *p = dados;
+    const uint8_t *fim = dados + tamanho;
+    int leituras = 0;
+    while (p < fim && amostras_iniciar(&leitor, p, fim - p)) {
+        amostra_t a;
+        while (amostras_proxima(&leitor, &a)) {
+            dashboard_registrar_amostra(remetente, a.temp_x10 / 10.0f, a.umid_x10 / 10.0f, a.pres_x10 / 10.0f);
+            leituras++;
+        }
+        if (leitor.erro) {
+            break;
+        }
+        p = leitor.p;
+    }
+    if (leituras > 0) {
+        display_scheduler_request(&display_sched);
+    }
+    log_ring_texto("INFO: Transferencia de %d bytes de #%d (%d leituras)", (int)tamanho, remetente, leituras);
+}
+#endif
+
+
+// --- TAREFAS DO LOOP PRINCIPAL ---
+
+/**
+ * @brief Processa os pacotes que as interrupções dos rádios enfileiraram.
+ */
+void tarefa_recepcao(void) {
+    lora_payload_t pacote;
+    bool algum = false;
+    while (lora_rx_queue_pop(&pacote)) {
+        algum = true;
+        // Autenticação e decifragem ficam aqui, fora da ISR
+        if (!seguranca_abrir(&pacote)) {
+            continue;
+        }
+#if FRAG_HABILITADO
+        if (fragmentos_receber(&pacote, time_us_64())) {
+            continue; // Guardado na remontagem do remetente
+        }
+#endif
+        processar_pacote(&pacote, time_us_64());
+    }
+    if (algum) {
+        agenda_sinalizar(EVENTO_DISPLAY | EVENTO_LOG);
+    }
+}
+
+/**
+ * @brief Conclui o passo de rolagem, troca a página e desenha o quadro
+ *        pendente; depois se reagenda para o próximo prazo com hora marcada.
+ */
+void tarefa_painel(void) {
+    // Desliga a rolagem por hardware do gráfico no fim do passo
+    if (dashboard_poll()) {
+        display_scheduler_request(&display_sched);
+    }
+
+    // Troca de página do painel mesmo sem pacotes novos
+    if (dashboard_rotacao_pendente()) {
+        display_scheduler_request(&display_sched);
+    }
+
+    // Desenha o quadro pendente quando o intervalo mínimo tiver passado. Com
+    // a rolagem ligada nada vai ao display: o quadro espera o fim do passo
+    const rolagem_t *rolagem = dashboard_rolagem();
+    if (!rolagem_ativa(rolagem)) {
+        display_scheduler_poll(&display_sched);
+    }
+
+    uint64_t prazo = rolagem_ativa(rolagem) ? rolagem_prazo_us(rolagem)
+                                            : display_scheduler_prazo_us(&display_sched);
+    if (prazo != 0) {
+        uint64_t agora = time_us_64();
+        agenda_acordar_em(tarefa_painel_id, prazo > agora ? (uint32_t)((prazo - agora + 999) / 1000) : 0);
+    }
+}
+
+/**
+ * @brief Indica se o console pode escrever no stdio: nenhum registro do log
+ *        (nem lote do gateway) pela metade, que o texto partiria ao meio.
+ */
+bool console_pode_escrever(void) {
+#if GATEWAY_HABILITADO
+    if (gateway_transmitindo()) {
+        return false;
+    }
+#endif
+    return !log_ring_transmitindo();
+}
+
+/**
+ * @brief Reagenda o console adiado assim que o stdio ficar livre.
+ */
+void liberar_console(void) {
+    if (console_adiado && console_pode_escrever()) {
+        console_adiado = false;
+        agenda_sinalizar(EVENTO_CONSOLE);
+    }
+}
+
+/**
+ * @brief Envia ao console uma parte dos registros pendentes, sem bloquear,
+ *        e volta na próxima rodada enquanto houver o que enviar.
+ */
+void tarefa_log(void) {
+#if GATEWAY_HABILITADO
+    // O log só escreve entre dois lotes do gateway
+    if (gateway_transmitindo()) {
+        return;
+    }
+#endif
+    log_ring_drain(LOG_DRAIN_BYTES);
+    if (log_ring_transmitindo() || !log_ring_vazio()) {
+        agenda_sinalizar(EVENTO_LOG);
+    }
+    liberar_console();
+}
+
+/**
+ * @brief Grava a página cheia do log persistente (ou apaga o próximo setor)
+ *        quando os rádios estiverem ociosos, e avança o dump.
+ */
+void tarefa_flash(void) {
+    flash_log_poll();
+}
+
+/**
+ * @brief Atende os comandos do console; com um registro em envio, deixa os
+ *        caracteres no stdio e volta quando o log terminar o registro.
+ */
+void tarefa_console(void) {
+    if (!console_pode_escrever()) {
+        console_adiado = true;
+        return;
+    }
+    console_poll();
+}
+
+/**
+ * @brief Registro periódico de métricas de desempenho.
+ */
+void tarefa_metricas(void) {
+    log_metricas_t metricas = {
+        .pacotes = pacotes_recebidos,
+        .quadros_desenhados = display_sched.quadros_desenhados,
+        .quadros_descartados = display_sched.quadros_descartados,
+        .render_max_us = display_sched.render_max_us,
+        .log_descartados = log_ring_descartados(),
+    };
+    log_ring_metricas(&metricas);
+    agenda_sinalizar(EVENTO_LOG);
+}
+
+#if GATEWAY_HABILITADO
+/**
+ * @brief Encaminha os lotes ao host.
+ */
+void tarefa_gateway(void) {
+    gateway_poll();
+    if (!gateway_transmitindo()) {
+        agenda_sinalizar(EVENTO_LOG);
+    }
+    liberar_console();
+}
+#endif
+
+/**
+ * @brief Aviso do stdio (em interrupção) de que há caracteres para ler.
+ */
+void console_caracteres_disponiveis(void *param) {
+    agenda_sinalizar(EVENTO_CONSOLE);
+}
+
+/**
+ * @brief Antes de dormir: no modo de comparação do comando 'j', invalida o
+ *        cache do XIP para a ISR do rádio encontrá-lo frio.
+ */
+void antes_de_dormir(void) {
+    if (xip_frio) {
+        xip_ctrl_hw->flush = 1;
     }
 }
 
@@ -99,7 +619,6 @@ int main() {
     printf("--- Iniciando Hardware do Receptor ---\n");
     rgb_led_init();
     setup_i2c_display();
-    setup_spi_lora(); // <<< Chamada da função de correção
     printf("--------------------------------------\n\n");
 
     // --- 2. Inicialização dos Drivers e Módulos de Software ---
@@ -107,83 +626,158 @@ int main() {
     rgb_led_set_color(COR_LED_AMARELO); // Sinaliza "inicializando"
     display_startup_screen(&display);   // Mostra tela de boas-vindas
 
-    // Prepara a configuração para o módulo LoRa
-    lora_config_t config = {
-        .spi_port = LORA_SPI_PORT,
-        .interrupt_pin = LORA_INTERRUPT_PIN,
-        .cs_pin = LORA_CS_PIN,
-        .reset_pin = LORA_RESET_PIN,
-        .freq = LORA_FREQUENCY,
-        .tx_power = LORA_TX_POWER,
-        .this_address = LORA_ADDRESS_RECEIVER
+    // Prepara a configuração de cada módulo LoRa
+    lora_config_t configs[LORA_NUM_RADIOS] = {
+        {
+            .spi_port = LORA_SPI_PORT,
+            .sck_pin = LORA_SCK_PIN,
+            .mosi_pin = LORA_MOSI_PIN,
+            .miso_pin = LORA_MISO_PIN,
+            .spi_hz = LORA_SPI_HZ,
+            .transport = LORA_TRANSPORT,
+            .interrupt_pin = LORA_INTERRUPT_PIN,
+            .header_pin = LORA_HEADER_PIN,
+            .cs_pin = LORA_CS_PIN,
+            .reset_pin = LORA_RESET_PIN,
+            .freq = LORA_FREQUENCY,
+            .sync_word = LORA_SYNC_WORD,
+            .tx_power = LORA_TX_POWER,
+            .this_address = LORA_ADDRESS_RECEIVER,
+            .acks = LORA_ACKS,
+            .queue_rx = true
+        },
+#if LORA_NUM_RADIOS > 1
+        {
+            .spi_port = LORA2_SPI_PORT,
+            .sck_pin = LORA2_SCK_PIN,
+            .mosi_pin = LORA2_MOSI_PIN,
+            .miso_pin = LORA2_MISO_PIN,
+            .spi_hz = LORA_SPI_HZ,
+            .transport = LORA2_TRANSPORT,
+            .interrupt_pin = LORA2_INTERRUPT_PIN,
+            .header_pin = LORA2_HEADER_PIN,
+            .cs_pin = LORA2_CS_PIN,
+            .reset_pin = LORA2_RESET_PIN,
+            .freq = LORA2_FREQUENCY,
+            .sync_word = LORA_SYNC_WORD,
+            .tx_power = LORA_TX_POWER,
+            .this_address = LORA_ADDRESS_RECEIVER,
+            .modem = LORA2_MODEM,
+            .acks = LORA_ACKS,
+            .queue_rx = true
+        },
+#endif
     };
 
-    // Inicializa o LoRa. Se falhar, é um erro fatal.
-    if (!lora_init(&config)) {
-        printf("ERRO FATAL: Falha na inicializacao do LoRa.\n");
-        rgb_led_set_color(COR_LED_VERMELHO);
-        // Você poderia mostrar um erro no display aqui também
+    seguranca_init();
+    if (!seguranca_autoteste()) {
+        printf("ERRO FATAL: Autoteste do AES falhou.\n");
+        rgb_led_codigo(COR_LED_VERMELHO, 2);
         while (1); // Trava o programa
     }
+
+    // Inicializa os rádios. Se algum falhar, é um erro fatal.
+    link_stats_init();
+    for (int i = 0; i < LORA_NUM_RADIOS; ++i) {
+        if (!lora_init(&radios[i], &configs[i])) {
+            printf("ERRO FATAL: Falha na inicializacao do LoRa %d.\n", i + 1);
+            rgb_led_codigo(COR_LED_VERMELHO, 3);
+            // Você poderia mostrar um erro no display aqui também
+            while (1); // Trava o programa
+        }
+        printf("LoRa %d: transporte %s, SPI a %lu Hz (SCK=%d, MOSI=%d, MISO=%d, CS=%d).\n", i + 1,
+               lora_transport_name(&radios[i]), (unsigned long)radios[i].spi_hz, configs[i].sck_pin,
+               configs[i].mosi_pin, configs[i].miso_pin, configs[i].cs_pin);
+    }
      
     // --- 3. Finaliza a configuração e entra em modo de operação ---
-    lora_on_receive(on_lora_receive); // Registra a função de callback
+    adr_init(radios, LORA_NUM_RADIOS);
+#if FRAG_HABILITADO
+    fragmentos_init(radios, LORA_NUM_RADIOS);
+    fragmentos_ao_completar(ao_completar_transferencia);
+#endif
+    for (int i = 0; i < LORA_NUM_RADIOS; ++i) {
+        lora_on_receive(&radios[i], on_lora_receive); // Registra a função de callback
+#if !GATEWAY_HABILITADO
+        // O gateway repassa quadros de qualquer tamanho
+        _Static_assert(LORA_TAM_COMPACTO_MAX <= 4 + LORA_MAX_PAYLOAD, "LORA_TAM_COMPACTO_MAX maior que um quadro");
+        lora_accept_length(&radios[i], 4, LORA_TAM_ACK_MAX);
+        lora_accept_length(&radios[i], LORA_TAM_TEXTO_MIN, LORA_TAM_TEXTO_MAX);
+        lora_accept_length(&radios[i], LORA_TAM_COMPACTO_MIN, LORA_TAM_COMPACTO_MAX);
+#if FRAG_HABILITADO
+        // Fragmentos: cabeçalhos, 1 a FRAG_DADOS bytes e, se cifrados, contador e MIC
+        lora_accept_length(&radios[i], 4 + 2 + 1, 4 + 2 + FRAG_DADOS + LORA_TAM_SEGURO);
+#endif
+#endif
+#if ADR_HABILITADO
+        lora_on_ack(&radios[i], adr_ack);             // Recomendação de perfil e potência nos ACKs
+#endif
+        if (!lora_health_start(&radios[i], LORA_HEALTH_PERIOD_MS, LORA_HEALTH_MODEM_MARGEM_MS, LORA_HEALTH_NO_RX_MS)) {
+            printf("AVISO: monitor de saude do radio %d nao iniciado.\n", i + 1);
+        }
+    }
+#if TDMA_HABILITADO
+    // Beacons pelo primeiro rádio; os demais seguem em ALOHA
+    lora_on_crc_error(&radios[0], tdma_erro_crc);
+    if (!tdma_iniciar(&radios[0])) {
+        printf("AVISO: TDMA nao iniciado (beacon nao cabe no slot ou sem alarme).\n");
+    }
+#endif
     
     printf("Inicializacao completa. Endereco: #%d. Aguardando pacotes...\n", LORA_ADDRESS_RECEIVER);
     rgb_led_set_color(COR_LED_AZUL);   // Sinaliza "pronto e aguardando"
     display_wait_screen(&display);     // Mostra tela de espera
+    dashboard_init(&display);
+    display_scheduler_init(&display_sched, DISPLAY_MAX_FPS, renderizar_painel, NULL);
+    log_ring_init();
+    latencia_init();
+    if (!flash_log_init(radios_ociosos)) {
+        printf("AVISO: log na flash desativado (regiao sobreposta ao programa).\n");
+    }
+    console_registrar('l', "Histogramas de latencia radio->tela", cmd_latencias);
+    console_registrar('z', "Zera os histogramas de latencia", cmd_zerar_latencias);
+    console_registrar('d', "Contadores do display", cmd_display);
+    console_registrar('e', "Estatisticas do enlace por transmissor", cmd_enlace);
+    console_registrar('v', "Perfil e potencia recomendados (ADR)", cmd_adr);
+#if FRAG_HABILITADO
+    console_registrar('x', "Transferencias fragmentadas e remontagens", cmd_fragmentos);
+#endif
+#if TDMA_HABILITADO
+    console_registrar('q', "Superquadro TDMA: beacons e ocupacao dos slots", cmd_tdma);
+#endif
+    console_registrar('r', "Monitor de saude do radio", cmd_radio);
+    console_registrar('b', "Mede o transporte SPI dos radios", cmd_benchmark_spi);
+    console_registrar('s', "Contadores e desempenho da camada de seguranca", cmd_seguranca);
+    console_registrar('f', "Envia o log persistente da flash", cmd_flash_log);
+    console_registrar('t', "Mede o desenho de glifos das fontes", cmd_fontes);
+    console_registrar('j', "Latencia ISR->FIFO; alterna o cache do XIP frio", cmd_latencia_fifo);
+#if GATEWAY_HABILITADO
+    gateway_init();
+    console_registrar('g', "Contadores do modo gateway", cmd_gateway);
+#endif
+    console_registrar('a', "Ociosidade e tempo de CPU por tarefa", cmd_agenda);
 
-    // --- 4. Loop Principal Infinito ---
-    while (1) {
-        // Verifica se a rotina de interrupção sinalizou novos dados
-        if (novos_dados_recebidos) {
-            
-            // Variáveis locais para armazenar uma cópia segura dos dados
-            DadosRecebidos_t dados_copiados;
-            int rssi_copiado;
-            uint32_t contador_copiado;
-            
-            // --- Seção Crítica ---
-            // Desabilita a interrupção do LoRa temporariamente para evitar que
-            // as variáveis globais sejam modificadas enquanto as copiamos.
-            gpio_set_irq_enabled(LORA_INTERRUPT_PIN, GPIO_IRQ_EDGE_RISE, false);
-            
-            novos_dados_recebidos = false;        // Reseta a flag
-            dados_copiados = dados_atuais;        // Copia a estrutura de dados
-            rssi_copiado = ultimo_rssi;           // Copia o RSSI
-            contador_copiado = pacotes_recebidos; // Copia o contador
-
-            // Reabilita a interrupção. O tempo desativado é mínimo.
-            gpio_set_irq_enabled(LORA_INTERRUPT_PIN, GPIO_IRQ_EDGE_RISE, true);
-            // --- Fim da Seção Crítica ---
-            
-            
-            // A partir daqui, trabalhamos apenas com as cópias, que são seguras.
-            
-            // 1. Feedback visual para o usuário
-            rgb_led_set_color(COR_LED_VERDE);
-            
-            // 2. Atualiza o display OLED com os dados copiados
-            display_update_data(&display,
-                                dados_copiados.temperatura,
-                                dados_copiados.umidade,
-                                dados_copiados.pressao,
-                                rssi_copiado,
-                                contador_copiado);
-            
-            // 3. Imprime um log no console para debug
-            printf("Pacote #%lu | T:%.1f, H:%.0f, P:%.1f | RSSI: %d\n",
-                   contador_copiado, dados_copiados.temperatura,
-                   dados_copiados.umidade, dados_copiados.pressao, rssi_copiado);
-            
-            // 4. Retorna o LED à cor de "pronto" após um breve piscar
-            sleep_ms(100);
-            rgb_led_set_color(COR_LED_AZUL);
-        }
+    // --- 4. Tarefas do loop principal, na ordem de prioridade ---
+    agenda_registrar("recepcao", tarefa_recepcao, EVENTO_RX, 0);
+    tarefa_painel_id = agenda_registrar("painel", tarefa_painel, EVENTO_DISPLAY, AGENDA_PAINEL_MS);
+#if GATEWAY_HABILITADO
+    agenda_registrar("gateway", tarefa_gateway, EVENTO_GATEWAY, AGENDA_GATEWAY_MS);
+#endif
+    agenda_registrar("console", tarefa_console, EVENTO_CONSOLE, AGENDA_CONSOLE_MS);
+#if FRAG_HABILITADO
+    agenda_registrar("fragmentos", tarefa_fragmentos, 0, AGENDA_FRAG_MS);
+#endif
+    agenda_registrar("log", tarefa_log, EVENTO_LOG, AGENDA_LOG_MS);
+    agenda_registrar("flash", tarefa_flash, 0, AGENDA_FLASH_MS);
+    agenda_registrar("metricas", tarefa_metricas, 0, LOG_METRICAS_MS);
+    stdio_set_chars_available_callback(console_caracteres_disponiveis, NULL);
+    agenda_ao_dormir(antes_de_dormir);
 
-        // Deixa a CPU em um loop de baixa energia. A interrupção do LoRa a acordará.
-        tight_loop_contents();
-    }
+    // Pacotes que chegaram durante a inicialização
+    agenda_sinalizar(EVENTO_RX | EVENTO_LOG);
+
+    // --- 5. Loop principal: roda as tarefas e dorme em __wfe entre elas ---
+    agenda_executar();
 
     return 0; // Esta linha nunca será alcançada
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Mede o formato compacto de várias leituras (include/amostras.h) sobre dados
+gravados: taxa de compressão em relação ao texto "T:%.1f,H:%.1f,P:%.1f". A
+vazão do codificador e do decodificador do firmware (include/amostras.c) é
+medida por tools/testar_amostras.c, que também confere a ida e volta em C.
+
+A entrada é o CSV de tools/decodificar_log.py (registros do tipo "pacote").
+Sem arquivo, usa uma série sintética com ruído e deriva lentas.
+
+Quadro: 0xC7 | n | n x (T, H, P em décimos, varint zigzag; a primeira
+leitura é absoluta e as demais são diferenças para a anterior)
+
+Uso:
+    python3 tools/decodificar_log.py captura.bin > leituras.csv
+    python3 tools/compactar_amostras.py leituras.csv --amostras 8
+    python3 tools/compactar_amostras.py --sintetico 5000
+"""
+
+import argparse
+import csv
+import random
+from collections import defaultdict
+
+MAGICO = 0xC7
+AMOSTRAS_MAX = 32
+CABECALHO_LORA = 4  # to, from, id, flags: pago por pacote nos dois formatos
+
+
+def zigzag(v):
+    return (v << 1) ^ (v >> 31) if v < 0 else v << 1
+
+
+def dezigzag(u):
+    return (u >> 1) ^ -(u & 1)
+
+
+def codificar(leituras):
+    saida = bytearray([MAGICO, len(leituras)])
+    anterior = (0, 0, 0)
+    for leitura in leituras:
+        for atual, ant in zip(leitura, anterior):
+            u = zigzag(atual - ant) & 0xFFFFFFFF
+            while True:
+                b = u & 0x7F
+                u >>= 7
+                saida.append(b | 0x80 if u else b)
+                if not u:
+                    break
+        anterior = leitura
+    return bytes(saida)
+
+
+def decodificar(quadro):
+    """Mesmo algoritmo do firmware: uma leitura por vez, sem buffer."""
+    if len(quadro) < 2 or quadro[0] != MAGICO or not 1 <= quadro[1] <= AMOSTRAS_MAX:
+        raise ValueError("não é um quadro compacto")
+    pos, valores = 2, [0, 0, 0]
+    for _ in range(quadro[1]):
+        for k in range(3):
+            u, desloc = 0, 0
+            while True:
+                if pos >= len(quadro) or desloc >= 35:
+                    raise ValueError("quadro truncado")
+                b = quadro[pos]
+                pos += 1
+                u |= (b & 0x7F) << desloc
+                desloc += 7
+                if not b & 0x80:
+                    break
+            valores[k] += dezigzag(u)
+        yield tuple(valores)
+
+
+def texto(leitura):
+    t, h, p = leitura
+    return f"T:{t / 10:.1f},H:{h / 10:.1f},P:{p / 10:.1f}"
+
+
+def ler_csv(caminho):
+    por_no = defaultdict(list)
+    with open(caminho, newline="") as f:
+        for reg in csv.DictReader(f):
+            if reg.get("tipo") != "pacote":
+                continue
+            leitura = tuple(round(float(reg[c]) * 10) for c in ("temperatura", "umidade", "pressao"))
+            por_no[reg["remetente"]].append(leitura)
+    return por_no
+
+
+def sintetico(n):
+    rnd = random.Random(1)
+    t, h, p = 251, 450, 10125
+    leituras = []
+    for i in range(n):
+        t += rnd.choice((-1, 0, 0, 1))
+        h += rnd.choice((-2, -1, 0, 1, 2))
+        p += rnd.choice((-1, 0, 1)) + (5 if i % 500 == 0 else 0)
+        leituras.append((t, h, p))
+    return {"sintetico": leituras}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("csv", nargs="?", help="CSV de tools/decodificar_log.py")
+    ap.add_argument("--amostras", type=int, default=8, help="leituras por quadro (1 a 32, padrão 8)")
+    ap.add_argument("--sintetico", type=int, default=2000, metavar="N", help="leituras sintéticas sem CSV")
+    args = ap.parse_args()
+    if not 1 <= args.amostras <= AMOSTRAS_MAX:
+        ap.error(f"--amostras deve estar entre 1 e {AMOSTRAS_MAX}")
+
+    por_no = ler_csv(args.csv) if args.csv else sintetico(args.sintetico)
+
+    quadros, bytes_texto, bytes_compacto, leituras = [], 0, 0, 0
+    for serie in por_no.values():
+        for i in range(0, len(serie), args.amostras):
+            janela = serie[i:i + args.amostras]
+            quadro = codificar(janela)
+            if list(decodificar(quadro)) != janela:
+                raise SystemExit("ida e volta falhou")
+            quadros.append(quadro)
+            bytes_texto += sum(len(texto(x)) + CABECALHO_LORA for x in janela)
+            bytes_compacto += len(quadro) + CABECALHO_LORA
+            leituras += len(janela)
+
+    if not leituras:
+        raise SystemExit("nenhuma leitura na entrada")
+
+    print(f"{leituras} leituras de {len(por_no)} no(s), {len(quadros)} quadros de ate {args.amostras}")
+    print(f"texto:    {bytes_texto} bytes ({bytes_texto / leituras:.1f} por leitura, com cabecalho LoRa)")
+    print(f"compacto: {bytes_compacto} bytes ({bytes_compacto / leituras:.1f} por leitura)")
+    print(f"razao:    {bytes_texto / bytes_compacto:.2f}x")
+
+
+if __name__ == "__main__":
+    main()
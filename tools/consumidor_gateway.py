@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Consome o fluxo do modo gateway (-DRECEPTOR_GATEWAY=ON): valida os lotes,
+detecta lacunas na sequência e mede a taxa sustentada de quadros.
+
+Formato de cada lote (little-endian, ver include/gateway.h):
+    [0xA5 0x5A][seq u16][quadros u8][tam_corpo u16][base_us u64]
+    [registro...][crc16 u16]
+    registro: [tam u8][de u8][para u8][id u8][flags u8][rssi i16][snr_x4 i8]
+              [dt_us u32][payload...]
+
+Uso:
+    python3 tools/consumidor_gateway.py /dev/ttyACM0
+    python3 tools/consumidor_gateway.py captura.bin --csv quadros.csv
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+MAGICO = b"\xA5\x5A"
+CABECALHO = struct.Struct("<HBHQ")   # seq, quadros, tam_corpo, base_us
+REGISTRO = struct.Struct("<BBBBBhbI")  # tam, de, para, id, flags, rssi, snr_x4, dt_us
+GATEWAY_LOTE_MAX = 512  # Lote inteiro, do mágico ao CRC (include/config.h)
+
+
+def crc16(dados):
+    """CRC-16/CCITT-FALSE, igual ao firmware."""
+    crc = 0xFFFF
+    for b in dados:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def lotes(fluxo, serial):
+    """Procura o mágico e devolve (cabeçalho, corpo) de cada lote com CRC
+    válido. Bytes fora de lotes (boot, console, log) são descartados."""
+    pendente = bytearray()
+    while True:
+        bloco = fluxo.read(4096)
+        if not bloco:
+            if serial:
+                continue
+            break
+        pendente += bloco
+        while True:
+            inicio = pendente.find(MAGICO)
+            if inicio < 0:
+                del pendente[:-1]
+                break
+            del pendente[:inicio]
+            if len(pendente) < 2 + CABECALHO.size:
+                break
+            seq, n, tam, base = CABECALHO.unpack_from(pendente, 2)
+            total = 2 + CABECALHO.size + tam + 2
+            if total > GATEWAY_LOTE_MAX:
+                # Nenhum lote do firmware é maior: mágico falso (um 0xA5 0x5A
+                # no console ou num payload). Esperar tam bytes prenderia os
+                # lotes seguintes atrás dele
+                yield None
+                del pendente[:1]
+                continue
+            if len(pendente) < total:
+                break
+            dados = bytes(pendente[2:total - 2])
+            crc = struct.unpack_from("<H", pendente, total - 2)[0]
+            if crc16(dados) != crc:
+                yield None  # Sincronismo falso ou bytes corrompidos
+                del pendente[:1]
+                continue
+            del pendente[:total]
+            yield (seq, n, base), dados[CABECALHO.size:]
+
+
+def registros(base, corpo):
+    i = 0
+    while i < len(corpo):
+        tam, de, para, ident, flags, rssi, snr_x4, dt = REGISTRO.unpack_from(corpo, i)
+        i += REGISTRO.size
+        yield {
+            "tempo_us": base + dt, "de": de, "para": para, "id": ident,
+            "flags": flags, "rssi": rssi, "snr": snr_x4 / 4,
+            "payload": corpo[i:i + tam].hex(),
+        }
+        i += tam
+
+
+def abrir(origem):
+    if origem == "-":
+        return sys.stdin.buffer, False
+    if origem.startswith("/dev/") or origem.upper().startswith("COM"):
+        import serial  # pyserial
+        return serial.Serial(origem, 115200, timeout=1), True
+    return open(origem, "rb"), False
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("origem", help="arquivo, porta serial ou '-' para stdin")
+    ap.add_argument("--csv", metavar="ARQ", help="grava cada quadro encaminhado em CSV")
+    ap.add_argument("--intervalo", type=float, default=5.0, help="período do relatório em segundos")
+    args = ap.parse_args()
+
+    escritor = None
+    if args.csv:
+        saida = open(args.csv, "w", newline="")
+        escritor = csv.DictWriter(saida, fieldnames=["tempo_us", "de", "para", "id", "flags", "rssi", "snr", "payload"])
+        escritor.writeheader()
+
+    fluxo, serial = abrir(args.origem)
+    total_lotes = total_quadros = invalidos = lacunas = 0
+    seq_esperada = None
+    inicio = ultimo_relatorio = time.monotonic()
+    quadros_periodo = 0
+
+    try:
+        for lote in lotes(fluxo, serial):
+            if lote is None:
+                invalidos += 1
+                continue
+            (seq, n, base), corpo = lote
+            if seq_esperada is not None and seq != seq_esperada:
+                lacunas += (seq - seq_esperada) & 0xFFFF
+            seq_esperada = (seq + 1) & 0xFFFF
+            total_lotes += 1
+            total_quadros += n
+            quadros_periodo += n
+            if escritor:
+                escritor.writerows(registros(base, corpo))
+
+            agora = time.monotonic()
+            if serial and agora - ultimo_relatorio >= args.intervalo:
+                print(f"{quadros_periodo / (agora - ultimo_relatorio):.1f} quadros/s, "
+                      f"{total_quadros} quadros em {total_lotes} lotes, "
+                      f"{lacunas} lote(s) perdido(s), {invalidos} inválido(s)", file=sys.stderr)
+                ultimo_relatorio, quadros_periodo = agora, 0
+    except KeyboardInterrupt:
+        pass
+
+    duracao = time.monotonic() - inicio
+    taxa = f", {total_quadros / duracao:.1f} quadros/s" if serial and duracao > 0 else ""
+    print(f"{total_quadros} quadros em {total_lotes} lotes{taxa}; "
+          f"{lacunas} lote(s) perdido(s), {invalidos} inválido(s)", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
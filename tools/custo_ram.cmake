@@ -0,0 +1,50 @@
+# Relatório do custo em SRAM da opção RECEPTOR_RAM_HOTPATH, executado pelo
+# CMake depois do link:
+#
+#     cmake -DELF=receptor-lora.elf -DNM=arm-none-eabi-nm -P tools/custo_ram.cmake
+#
+# Soma as funções com endereço na SRAM (.time_critical e as do próprio SDK
+# marcadas com __not_in_flash_func) e os dados nos bancos scratch. O custo
+# da opção é a diferença entre os relatórios com ela ligada e desligada.
+
+if(NOT ELF OR NOT NM)
+    message(FATAL_ERROR "uso: cmake -DELF=<arquivo.elf> -DNM=<nm> -P custo_ram.cmake")
+endif()
+
+execute_process(COMMAND ${NM} -S --size-sort ${ELF}
+    OUTPUT_VARIABLE saida
+    RESULT_VARIABLE resultado)
+if(NOT resultado EQUAL 0)
+    message(WARNING "custo_ram: ${NM} falhou em ${ELF}")
+    return()
+endif()
+
+string(REPLACE "\n" ";" linhas "${saida}")
+set(codigo 0)
+set(funcoes 0)
+set(scratch 0)
+set(lista "")
+foreach(linha IN LISTS linhas)
+    if(NOT linha MATCHES "^(2[0-9a-f]+) ([0-9a-f]+) ([a-zA-Z]) (.+)$")
+        continue() # Flash, ROM ou símbolo sem tamanho
+    endif()
+    set(endereco ${CMAKE_MATCH_1})
+    math(EXPR tamanho "0x${CMAKE_MATCH_2}")
+    set(tipo ${CMAKE_MATCH_3})
+    set(nome ${CMAKE_MATCH_4})
+
+    if(tipo MATCHES "^[tTwW]$")
+        math(EXPR codigo "${codigo} + ${tamanho}")
+        math(EXPR funcoes "${funcoes} + 1")
+        list(APPEND lista "  ${tamanho}\t${nome}")
+    elseif(endereco MATCHES "^2004[01]")
+        # 0x20040000: scratch X; 0x20041000: scratch Y
+        math(EXPR scratch "${scratch} + ${tamanho}")
+        list(APPEND lista "  ${tamanho}\t${nome} (scratch)")
+    endif()
+endforeach()
+
+foreach(item IN LISTS lista)
+    message(STATUS "${item}")
+endforeach()
+message(STATUS "Codigo na SRAM: ${codigo} bytes em ${funcoes} funcoes; tabelas no scratch: ${scratch} bytes")
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+Decodifica o fluxo binário do receptor (LOG_SAIDA_BINARIA = 1) em CSV ou JSON.
+
+Cada registro é um quadro COBS terminado em 0x00:
+    [tipo u8][tempo_ms u32][campos...][crc16 u16]   (little-endian)
+
+Uso:
+    python3 tools/decodificar_log.py /dev/ttyACM0            # porta serial (pyserial)
+    python3 tools/decodificar_log.py captura.bin --json
+    cat captura.bin | python3 tools/decodificar_log.py -
+"""
+
+import argparse
+import csv
+import json
+import struct
+import sys
+
+REG_TEXTO = 0x01
+REG_PACOTE = 0x02
+REG_METRICAS = 0x03
+
+CAMPOS = [
+    "tipo", "tempo_ms", "seq", "remetente", "rssi", "snr", "temperatura",
+    "umidade", "pressao", "pacotes", "quadros_desenhados",
+    "quadros_descartados", "render_max_us", "log_descartados", "texto",
+]
+
+
+def crc16(dados):
+    """CRC-16/CCITT-FALSE, igual ao firmware."""
+    crc = 0xFFFF
+    for b in dados:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decodificar(quadro):
+    saida = bytearray()
+    i = 0
+    while i < len(quadro):
+        codigo = quadro[i]
+        if codigo == 0 or i + codigo > len(quadro) + 1:
+            raise ValueError("quadro COBS inválido")
+        saida += quadro[i + 1:i + codigo]
+        i += codigo
+        if codigo < 0xFF and i < len(quadro):
+            saida.append(0)
+    return bytes(saida)
+
+
+def interpretar(bruto):
+    if len(bruto) < 7:
+        raise ValueError("registro curto")
+    corpo, crc = bruto[:-2], struct.unpack("<H", bruto[-2:])[0]
+    if crc16(corpo) != crc:
+        raise ValueError("CRC inválido")
+
+    tipo, tempo_ms = struct.unpack_from("<BI", corpo)
+    resto = corpo[5:]
+    reg = {"tempo_ms": tempo_ms}
+
+    if tipo == REG_TEXTO:
+        reg["tipo"] = "texto"
+        reg["texto"] = resto.decode("utf-8", errors="replace")
+    elif tipo == REG_PACOTE:
+        seq, rem, rssi, snr4, t10, umid, p10 = struct.unpack("<IBhhhhh", resto)
+        reg.update(tipo="pacote", seq=seq, remetente=rem, rssi=rssi,
+                   snr=snr4 / 4, temperatura=t10 / 10, umidade=umid,
+                   pressao=p10 / 10)
+    elif tipo == REG_METRICAS:
+        valores = struct.unpack("<5I", resto)
+        reg["tipo"] = "metricas"
+        reg.update(zip(CAMPOS[9:14], valores))
+    else:
+        raise ValueError(f"tipo desconhecido 0x{tipo:02x}")
+    return reg
+
+
+def quadros(fluxo):
+    """Separa o fluxo nos delimitadores 0x00. Texto solto (printf do boot,
+    respostas do console) entre quadros é descartado pelo CRC."""
+    pendente = bytearray()
+    while True:
+        bloco = fluxo.read(256)
+        if not bloco:
+            break
+        pendente += bloco
+        while True:
+            fim = pendente.find(b"\x00")
+            if fim < 0:
+                break
+            quadro, pendente = bytes(pendente[:fim]), pendente[fim + 1:]
+            if quadro:
+                yield quadro
+
+
+def abrir(origem):
+    if origem == "-":
+        return sys.stdin.buffer
+    if origem.startswith("/dev/") or origem.upper().startswith("COM"):
+        import serial  # pyserial
+        return serial.Serial(origem, 115200, timeout=1)
+    return open(origem, "rb")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("origem", help="arquivo, porta serial ou '-' para stdin")
+    ap.add_argument("--json", action="store_true", help="uma linha JSON por registro (padrão: CSV)")
+    args = ap.parse_args()
+
+    escritor = None
+    if not args.json:
+        escritor = csv.DictWriter(sys.stdout, fieldnames=CAMPOS, extrasaction="ignore")
+        escritor.writeheader()
+
+    invalidos = 0
+    for quadro in quadros(abrir(args.origem)):
+        try:
+            reg = interpretar(cobs_decodificar(quadro))
+        except (ValueError, struct.error):
+            invalidos += 1
+            continue
+        if args.json:
+            print(json.dumps(reg, ensure_ascii=False))
+        else:
+            escritor.writerow(reg)
+        sys.stdout.flush()
+
+    if invalidos:
+        print(f"{invalidos} quadro(s) inválido(s) ignorado(s)", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
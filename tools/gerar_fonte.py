@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+Converte fontes BDF ou PNG para o formato do driver SSD1306
+(include/lib/ssd1306/font.c): glifos já transpostos para a ordem de página
+do display, coluna a coluna, `paginas` bytes por coluna, bit 0 no topo.
+Assim o desenho de um glifo alinhado a uma página é uma cópia de bytes.
+
+Cada fonte é dada como NOME=ARQUIVO[:FAIXA]:
+  - ARQUIVO .bdf: largura da célula = FONTBOUNDINGBOX (fonte monoespaçada);
+  - ARQUIVO .png@LxA: grade de células LxA, da esquerda para a direita e de
+    cima para baixo, começando no primeiro caractere da faixa; pixels
+    escuros acesos (--claro-aceso inverte);
+  - FAIXA: primeiro e último caractere, ex. ":-9" para "-./0123456789".
+    Padrão: os caracteres presentes no BDF, ou " " a "~" no PNG.
+A altura é arredondada para páginas inteiras de 8 pixels.
+
+Uso (alvo `fontes` do CMake):
+    python3 tools/gerar_fonte.py -o include/lib/ssd1306/font.c \\
+        font_8x8=tools/fontes/fonte8x8.bdf \\
+        font_digitos16=tools/fontes/digitos16.bdf:-9 \\
+        font_digitos24=tools/fontes/digitos24.bdf:-9
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+
+class Fonte:
+    def __init__(self, largura, altura, glifos):
+        self.largura = largura
+        self.altura = altura
+        self.glifos = glifos  # código -> lista de linhas, cada uma lista de bools
+
+
+def ler_bdf(caminho):
+    largura = altura = xoff = yoff = None
+    glifos = {}
+    with open(caminho, encoding="latin-1") as f:
+        linhas = iter(f.read().splitlines())
+    for linha in linhas:
+        campos = linha.split()
+        if not campos:
+            continue
+        if campos[0] == "FONTBOUNDINGBOX":
+            largura, altura, xoff, yoff = map(int, campos[1:5])
+        elif campos[0] == "STARTCHAR":
+            codigo, bbx, bitmap = None, None, []
+            for linha in linhas:
+                campos = linha.split()
+                if campos[0] == "ENCODING":
+                    codigo = int(campos[1])
+                elif campos[0] == "BBX":
+                    bbx = tuple(map(int, campos[1:5]))
+                elif campos[0] == "BITMAP":
+                    for linha in linhas:
+                        if linha.strip() == "ENDCHAR":
+                            break
+                        bitmap.append(int(linha.strip(), 16) << (4 * (8 - len(linha.strip()))))
+                    break
+            if codigo is None or codigo < 0 or bbx is None:
+                continue
+            gl, ga, gx, gy = bbx
+            celula = [[False] * largura for _ in range(altura)]
+            topo = (altura + yoff) - (ga + gy)
+            esquerda = gx - xoff
+            for r, bits in enumerate(bitmap[:ga]):
+                for c in range(gl):
+                    y, x = topo + r, esquerda + c
+                    if 0 <= y < altura and 0 <= x < largura and bits & (1 << (31 - c)):
+                        celula[y][x] = True
+            glifos[codigo] = celula
+    if largura is None:
+        raise SystemExit(f"{caminho}: FONTBOUNDINGBOX ausente")
+    return Fonte(largura, altura, glifos)
+
+
+def ler_png(caminho):
+    """PNG de 8 bits (cinza, RGB, paleta, com ou sem alfa), só com a biblioteca padrão."""
+    with open(caminho, "rb") as f:
+        dados = f.read()
+    if dados[:8] != b"\x89PNG\r\n\x1a\n":
+        raise SystemExit(f"{caminho}: não é PNG")
+    pos, idat, paleta = 8, b"", None
+    while pos < len(dados):
+        tamanho, tipo = struct.unpack(">I4s", dados[pos:pos + 8])
+        corpo = dados[pos + 8:pos + 8 + tamanho]
+        pos += 12 + tamanho
+        if tipo == b"IHDR":
+            w, h, prof, cor, _, _, entrelacado = struct.unpack(">IIBBBBB", corpo)
+        elif tipo == b"PLTE":
+            paleta = [corpo[i:i + 3] for i in range(0, len(corpo), 3)]
+        elif tipo == b"IDAT":
+            idat += corpo
+    if prof != 8 or entrelacado:
+        raise SystemExit(f"{caminho}: só PNG de 8 bits por canal, sem entrelaçamento")
+    canais = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[cor]
+    bruto = zlib.decompress(idat)
+    passo = w * canais
+    anterior = bytearray(passo)
+    lum = []
+    for y in range(h):
+        filtro = bruto[y * (passo + 1)]
+        linha = bytearray(bruto[y * (passo + 1) + 1:(y + 1) * (passo + 1)])
+        for i in range(passo):
+            a = linha[i - canais] if i >= canais else 0
+            b = anterior[i]
+            c = anterior[i - canais] if i >= canais else 0
+            if filtro == 1:
+                linha[i] = (linha[i] + a) & 0xFF
+            elif filtro == 2:
+                linha[i] = (linha[i] + b) & 0xFF
+            elif filtro == 3:
+                linha[i] = (linha[i] + (a + b) // 2) & 0xFF
+            elif filtro == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                linha[i] = (linha[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        anterior = linha
+        valores = []
+        for x in range(w):
+            px = linha[x * canais:(x + 1) * canais]
+            if cor == 3:
+                px = paleta[px[0]]
+            if cor in (0, 4):
+                v = px[0]
+            else:
+                v = (px[0] * 299 + px[1] * 587 + px[2] * 114) // 1000
+            if cor in (4, 6) and px[-1] < 128:
+                v = 255  # Transparente conta como fundo
+            valores.append(v)
+        lum.append(valores)
+    return lum
+
+
+def fonte_png(caminho, celula, primeiro, claro_aceso):
+    lum = ler_png(caminho)
+    cl, ca = celula
+    colunas = len(lum[0]) // cl
+    glifos = {}
+    for k in range(colunas * (len(lum) // ca)):
+        oy, ox = (k // colunas) * ca, (k % colunas) * cl
+        glifos[primeiro + k] = [[(lum[oy + y][ox + x] >= 128) == claro_aceso for x in range(cl)]
+                                for y in range(ca)]
+    return Fonte(cl, ca, glifos)
+
+
+def transpor(fonte, codigo):
+    """Glifo em bytes de página, coluna a coluna."""
+    paginas = (fonte.altura + 7) // 8
+    celula = fonte.glifos.get(codigo)
+    saida = []
+    for x in range(fonte.largura):
+        for p in range(paginas):
+            byte = 0
+            for bit in range(8):
+                y = p * 8 + bit
+                if celula and y < fonte.altura and celula[y][x]:
+                    byte |= 1 << bit
+            saida.append(byte)
+    return saida
+
+
+def nome_caractere(codigo):
+    c = chr(codigo)
+    return {"\\": "barra invertida", " ": "espaço"}.get(c, c)
+
+
+def c_char(codigo):
+    return {0x27: "'\\''", 0x5C: "'\\\\'"}.get(codigo, f"'{chr(codigo)}'")
+
+
+def gerar_c(fontes, comando):
+    saida = [
+        "// Gerado por tools/gerar_fonte.py; não editar à mão. Para regenerar:",
+        f"//     {comando}",
+        "",
+        '#include "font.h"',
+    ]
+    for nome, fonte, primeiro, ultimo in fontes:
+        paginas = (fonte.altura + 7) // 8
+        saida += [
+            "",
+            f"// {fonte.largura}x{fonte.altura} px, {paginas} página(s), "
+            f"'{nome_caractere(primeiro)}' a '{nome_caractere(ultimo)}'",
+            f"static const uint8_t {nome}_glifos[] = {{",
+        ]
+        for codigo in range(primeiro, ultimo + 1):
+            bytes_ = ", ".join(f"0x{b:02X}" for b in transpor(fonte, codigo))
+            saida.append(f"    {bytes_}, // {nome_caractere(codigo)}")
+        saida += [
+            "};",
+            "",
+            f"const ssd1306_font_t {nome} = {{",
+            f"    {nome}_glifos, {fonte.largura}, {paginas}, {c_char(primeiro)}, {c_char(ultimo)}",
+            "};",
+        ]
+    return "\n".join(saida) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("fontes", nargs="+", metavar="NOME=ARQUIVO[:FAIXA]")
+    ap.add_argument("-o", "--saida", required=True, help="arquivo .c gerado")
+    ap.add_argument("--claro-aceso", action="store_true", help="PNG: pixels claros são os acesos")
+    args = ap.parse_args()
+
+    fontes = []
+    for spec in args.fontes:
+        nome, _, resto = spec.partition("=")
+        arquivo, faixa = resto, None
+        if len(resto) > 3 and resto[-3] == ":":
+            arquivo, faixa = resto[:-3], resto[-2:]
+        if "@" in arquivo:
+            arquivo, celula = arquivo.split("@")
+            celula = tuple(map(int, celula.split("x")))
+            primeiro = ord(faixa[0]) if faixa else 0x20
+            fonte = fonte_png(arquivo, celula, primeiro, args.claro_aceso)
+        else:
+            fonte = ler_bdf(arquivo)
+        if faixa:
+            primeiro, ultimo = ord(faixa[0]), ord(faixa[1])
+        else:
+            imprimiveis = [c for c in fonte.glifos if 0x20 <= c <= 0x7E]
+            if not imprimiveis:
+                raise SystemExit(f"{arquivo}: nenhum caractere imprimível")
+            primeiro, ultimo = min(imprimiveis), max(imprimiveis)
+        fontes.append((nome, fonte, primeiro, ultimo))
+
+    comando = "python3 tools/gerar_fonte.py -o " + args.saida + " " + " ".join(args.fontes)
+    with open(args.saida, "w", newline="\n") as f:
+        f.write(gerar_c(fontes, comando))
+
+    total = 0
+    for nome, fonte, primeiro, ultimo in fontes:
+        n = (ultimo - primeiro + 1) * fonte.largura * ((fonte.altura + 7) // 8)
+        total += n
+        print(f"{nome}: {ultimo - primeiro + 1} glifos {fonte.largura}x{fonte.altura}, {n} bytes", file=sys.stderr)
+    print(f"total: {total} bytes de flash, 0 de RAM", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
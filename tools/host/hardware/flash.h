@@ -0,0 +1,28 @@
+#ifndef HOST_HARDWARE_FLASH_H
+#define HOST_HARDWARE_FLASH_H
+
+// ============================================================================
+// --- Flash simulada para os testes no host (tools/) ---
+//
+// A flash é o vetor flash_sim, no lugar do XIP; o programa de teste o define
+// e implementa as operações com a semântica de NOR (programar só zera bits).
+// Ligue com -Wl,--defsym=__flash_binary_end=flash_sim: a "imagem" termina
+// no início da flash e a região do log fica toda livre.
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+#define FLASH_PAGE_SIZE   256u
+#define FLASH_SECTOR_SIZE 4096u
+
+extern uint8_t flash_sim[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)flash_sim)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif // HOST_HARDWARE_FLASH_H
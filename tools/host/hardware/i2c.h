@@ -0,0 +1,26 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+// ============================================================================
+// --- Substituto do hardware/i2c.h para os testes no host (tools/) ---
+//
+// As instâncias só identificam o barramento; as escritas vão para o
+// dispositivo modelado no teste.
+// ============================================================================
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/types.h"
+
+typedef struct i2c_inst {
+    uint index;
+} i2c_inst_t;
+
+extern i2c_inst_t host_i2c[2];
+#define i2c0 (&host_i2c[0])
+#define i2c1 (&host_i2c[1])
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif // HOST_HARDWARE_I2C_H
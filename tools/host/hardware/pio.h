@@ -0,0 +1,13 @@
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+// Só o tipo do bloco PIO, para os cabeçalhos que o recebem como parâmetro
+#include "pico/types.h"
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+
+#define pio0 ((PIO)0)
+#define pio1 ((PIO)1)
+
+#endif // HOST_HARDWARE_PIO_H
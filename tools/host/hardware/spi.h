@@ -0,0 +1,38 @@
+#ifndef HOST_HARDWARE_SPI_H
+#define HOST_HARDWARE_SPI_H
+
+// ============================================================================
+// --- Substituto do hardware/spi.h para os testes no host (tools/) ---
+//
+// As instâncias só identificam o barramento; as transferências são do
+// modelo do periférico no teste.
+// ============================================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/types.h"
+
+typedef struct spi_inst {
+    uint index;
+} spi_inst_t;
+
+extern spi_inst_t host_spi[2];
+#define spi0 (&host_spi[0])
+#define spi1 (&host_spi[1])
+
+typedef enum { SPI_CPOL_0, SPI_CPOL_1 } spi_cpol_t;
+typedef enum { SPI_CPHA_0, SPI_CPHA_1 } spi_cpha_t;
+typedef enum { SPI_LSB_FIRST, SPI_MSB_FIRST } spi_order_t;
+
+static inline uint spi_get_index(const spi_inst_t *spi) {
+    return spi->index;
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+void spi_deinit(spi_inst_t *spi);
+uint spi_get_baudrate(const spi_inst_t *spi);
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len);
+
+#endif // HOST_HARDWARE_SPI_H
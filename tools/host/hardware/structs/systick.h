@@ -0,0 +1,19 @@
+#ifndef HOST_HARDWARE_STRUCTS_SYSTICK_H
+#define HOST_HARDWARE_STRUCTS_SYSTICK_H
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+extern systick_hw_t host_systick;
+#define systick_hw (&host_systick)
+
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS 0x4u
+#define M0PLUS_SYST_CSR_ENABLE_BITS    0x1u
+
+#endif // HOST_HARDWARE_STRUCTS_SYSTICK_H
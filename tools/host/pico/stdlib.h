@@ -0,0 +1,34 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// ============================================================================
+// --- Substituto mínimo do pico/stdlib.h para os testes no host (tools/) ---
+//
+// Só o que os módulos testados usam. As barreiras viram cercas sequenciais
+// do compilador, que também ordenam os acessos entre threads; o relógio,
+// os pinos e o número da exceção em andamento são do programa de teste.
+// ============================================================================
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/types.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+
+#define __not_in_flash_func(f)  f
+#define __time_critical_func(f) f
+#define __scratch_x(g)
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void tight_loop_contents(void) {
+}
+
+// 0 no loop principal, o número da exceção numa interrupção
+uint __get_current_exception(void);
+
+#endif // HOST_PICO_STDLIB_H
@@ -0,0 +1,31 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+// ============================================================================
+// --- Substituto do pico/time.h para os testes no host (tools/) ---
+//
+// O relógio e os timers são do programa de teste: add_repeating_timer_ms
+// só preenche a estrutura, e o teste chama o callback quando quiser.
+// ============================================================================
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int32_t alarm_id_t;
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+
+struct repeating_timer {
+    int64_t delay_us;
+    alarm_id_t alarm_id;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+
+uint64_t time_us_64(void);
+void sleep_ms(uint32_t ms);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool cancel_repeating_timer(repeating_timer_t *timer);
+
+#endif // HOST_PICO_TIME_H
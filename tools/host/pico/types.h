@@ -0,0 +1,6 @@
+#ifndef HOST_PICO_TYPES_H
+#define HOST_PICO_TYPES_H
+
+typedef unsigned int uint;
+
+#endif // HOST_PICO_TYPES_H
@@ -0,0 +1,160 @@
+// Custo de renderização das páginas do painel (include/dashboard.c, com
+// historico.c, node_table.c, rolagem.c e a tela de telemetria) no host:
+// o desenho completo de cada página, na troca de página, e o incremental
+// de cada pacote novo, em que os gráficos só acrescentam a coluna nova
+// (deslocando o buffer, ou pela rolagem por hardware no gráfico de RSSI).
+//
+//     gcc -O2 -Itools/host -Iinclude -Iinclude/lib/ssd1306 tools/medir_dashboard.c include/dashboard.c include/historico.c include/node_table.c include/rolagem.c include/link_stats.c include/display.c include/lib/ssd1306/ssd1306.c include/lib/ssd1306/font.c -lm -o medir_dashboard && ./medir_dashboard [repeticoes]
+//
+// O relógio é simulado (o painel troca de página por tempo e a rolagem
+// espera quadros do display); o I2C é um contador. Como no medir_display.c,
+// o tempo é de CPU do host e só vale como proporção entre os caminhos; os
+// bytes por quadro dão o tempo de barramento de cada um.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dashboard.h"
+#include "display.h"
+#include "link_stats.h"
+#include "config.h"
+
+#define REMETENTE 7
+
+i2c_inst_t host_i2c[2] = {{0}, {1}};
+
+static uint64_t _agora_us = 1000000;
+static struct {
+    uint32_t transacoes;
+    uint64_t bytes;
+} _i2c;
+
+uint64_t time_us_64(void) {
+    return _agora_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    _agora_us += (uint64_t)ms * 1000;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    _i2c.transacoes++;
+    _i2c.bytes += len;
+    return (int)len;
+}
+
+typedef struct {
+    const char *nome;
+    double ns;
+    uint64_t transacoes;
+    uint64_t bytes;
+    uint32_t n;
+} medida_t;
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static uint32_t _semente = 1;
+static uint8_t _header_id = 0;
+
+/**
+ * @brief Um pacote do transmissor: leituras com deriva lenta e RSSI/SNR
+ *        variando, como em processar_pacote.
+ */
+static void pacote(void) {
+    _semente = _semente * 1103515245u + 12345u;
+    uint32_t r = _semente >> 8;
+    static float temp = 23.4f, hum = 61.0f, pres = 1012.3f;
+    temp += ((int)(r % 3) - 1) * 0.1f;
+    hum += ((int)((r >> 4) % 3) - 1) * 0.5f;
+    pres += ((int)((r >> 8) % 3) - 1) * 0.1f;
+    int rssi = -70 + (int)((r >> 12) % 21) - 10;
+    float snr = 6.0f + ((int)((r >> 18) % 17) - 8) * 0.25f;
+    link_stats_registrar(REMETENTE, _header_id++, (int16_t)rssi, (int8_t)(snr * 4), _agora_us);
+    dashboard_registrar_pacote(REMETENTE, temp, hum, pres, rssi, snr);
+}
+
+/**
+ * @brief Um quadro do painel e, se ele começou um passo de rolagem, o fim
+ *        do passo no prazo, como a tarefa do painel acordada pela agenda.
+ *        Soma os dois em `m`.
+ */
+static void quadro(medida_t *m) {
+    uint32_t transacoes = _i2c.transacoes;
+    uint64_t bytes = _i2c.bytes;
+    double inicio = agora_ns();
+    dashboard_render(NULL);
+    double ns = agora_ns() - inicio;
+
+    const rolagem_t *r = dashboard_rolagem();
+    if (rolagem_ativa(r)) {
+        _agora_us = rolagem_prazo_us(r);
+        inicio = agora_ns();
+        dashboard_poll();
+        ns += agora_ns() - inicio;
+    }
+    m->ns += ns;
+    m->transacoes += _i2c.transacoes - transacoes;
+    m->bytes += _i2c.bytes - bytes;
+    m->n++;
+}
+
+static void imprimir(const medida_t *m) {
+    double n = m->n ? m->n : 1;
+    // Por transação: início, endereço, bytes com ACK e parada (~9 bits cada)
+    double bits = ((double)m->bytes + m->transacoes) * 9 + m->transacoes * 2;
+    printf("%-30s %10.0f %10.2f %10.1f %14.0f\n", m->nome, m->ns / n, m->transacoes / n, m->bytes / n,
+           bits / n / 0.4);
+}
+
+int main(int argc, char **argv) {
+    uint32_t repeticoes = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+    ssd1306_t ssd;
+    ssd1306_init(&ssd, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, DISPLAY_I2C_ADDR, I2C_PORT);
+    link_stats_init();
+    dashboard_init(&ssd);
+
+    // Históricos cheios: HISTORICO_COLUNAS colunas em todos os gráficos
+    for (uint32_t i = 0; i < HISTORICO_COLUNAS * HISTORICO_AMOSTRAS_POR_COLUNA; ++i) {
+        pacote();
+    }
+
+    // Com um nó só, as páginas giram em nó, enlace e histórico
+    medida_t completo[3] = {{.nome = "completo: telemetria"}, {.nome = "completo: enlace (2 graficos)"},
+                            {.nome = "completo: historico (3 graf.)"}};
+    medida_t incremental[3] = {{.nome = "pacote: telemetria"}, {.nome = "pacote: enlace (rolagem hw)"},
+                               {.nome = "pacote: historico"}};
+    dashboard_render(NULL); // Primeiro quadro: página 0
+    uint8_t pagina = 0;
+    for (uint32_t k = 0; k < repeticoes; ++k) {
+        // Troca de página: desenho completo
+        _agora_us += (uint64_t)DASHBOARD_PAGINA_MS * 1000;
+        pagina = (pagina + 1) % 3;
+        quadro(&completo[pagina]);
+
+        // Pacotes novos na mesma página: uma coluna nova por pacote nos
+        // gráficos do enlace e a cada HISTORICO_AMOSTRAS_POR_COLUNA no histórico
+        for (int j = 0; j < HISTORICO_AMOSTRAS_POR_COLUNA; ++j) {
+            _agora_us += 100000;
+            pacote();
+            quadro(&incremental[pagina]);
+        }
+    }
+
+    printf("%lu trocas de pagina, %u pacotes em cada; pacote: quadro e fim do passo de rolagem\n",
+           (unsigned long)repeticoes, HISTORICO_AMOSTRAS_POR_COLUNA);
+    printf("%-30s %10s %10s %10s %14s\n", "", "ns/quadro", "transacoes", "bytes I2C", "I2C 400k (us)");
+    for (int i = 0; i < 3; ++i) {
+        imprimir(&completo[i]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        imprimir(&incremental[i]);
+    }
+    const rolagem_t *r = dashboard_rolagem();
+    printf("rolagem por hardware: %lu passos, %lu incertos\n", (unsigned long)r->passos, (unsigned long)r->incertos);
+    return 0;
+}
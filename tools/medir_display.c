@@ -0,0 +1,149 @@
+// Tempo de renderização da tela de telemetria no host: o display_update_data
+// atual (layout retido, include/display.c) contra o anterior (limpar o
+// buffer pixel a pixel, 4 snprintf e cada caractere rasterizado pelo
+// ssd1306_draw_char da época, copiado abaixo), com a mesma sequência de
+// pacotes. O I2C é um contador; os bytes por atualização mostram também o
+// tempo de barramento que cada um gera.
+//
+//     gcc -O2 -Itools/host -Iinclude -Iinclude/lib/ssd1306 tools/medir_display.c include/display.c include/lib/ssd1306/ssd1306.c include/lib/ssd1306/font.c -lm -o medir_display && ./medir_display [atualizacoes]
+//
+// O tempo é de CPU do host e só vale como proporção entre os dois; no alvo
+// o agendador do display mede o tempo de renderização real.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "display.h"
+#include "config.h"
+
+i2c_inst_t host_i2c[2] = {{0}, {1}};
+
+static struct {
+    uint32_t transacoes;
+    uint64_t bytes;
+} _i2c;
+
+uint64_t time_us_64(void) {
+    return 0;
+}
+
+void sleep_ms(uint32_t ms) {
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    _i2c.transacoes++;
+    _i2c.bytes += len;
+    return (int)len;
+}
+
+// --- display_update_data antes do layout retido ---
+
+static void desenhar_char_antigo(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+    uint16_t index = c >= ' ' && c <= '~' ? (c - ' ') * 8 : 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t line = font_8x8.glyphs[index + i];
+        for (uint8_t j = 0; j < 8; ++j) {
+            ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+        }
+    }
+}
+
+static void desenhar_string_antiga(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) {
+    while (*str) {
+        desenhar_char_antigo(ssd, *str++, x, y);
+        x += 8;
+        if (x + 8 >= ssd->width) {
+            x = 0;
+            y += 8;
+        }
+        if (y + 8 >= ssd->height) {
+            break;
+        }
+    }
+}
+
+static void update_antigo(ssd1306_t *ssd, uint8_t node, float temp, float hum, float pres, int rssi, uint32_t packets) {
+    char buffer[32];
+    ssd1306_fill(ssd, false);
+    snprintf(buffer, sizeof(buffer), "T:%.1fC H:%.0f%%", temp, hum);
+    desenhar_string_antiga(ssd, buffer, 2, 0);
+    snprintf(buffer, sizeof(buffer), "P: %.1f hPa", pres);
+    desenhar_string_antiga(ssd, buffer, 2, 16);
+    snprintf(buffer, sizeof(buffer), "RSSI: %d", rssi);
+    desenhar_string_antiga(ssd, buffer, 2, 32);
+    snprintf(buffer, sizeof(buffer), "Pacotes: #%lu", (unsigned long)packets);
+    desenhar_string_antiga(ssd, buffer, 2, 48);
+    ssd1306_send_data(ssd);
+}
+
+// --- Medida ---
+
+typedef void (*update_t)(ssd1306_t *ssd, uint8_t node, float temp, float hum, float pres, int rssi, uint32_t packets);
+
+typedef struct {
+    double ns;
+    double transacoes;
+    double bytes;
+} medida_t;
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ * @brief Uma estação transmitindo a cada poucos segundos: contador sempre
+ *        muda, temperatura e pressão às vezes, RSSI quase sempre.
+ */
+static medida_t medir(ssd1306_t *ssd, update_t update, uint32_t n) {
+    uint32_t semente = 1;
+    float temp = 23.4f, hum = 61.0f, pres = 1012.3f;
+    int rssi = -60;
+    display_layout_invalidate();
+    memset(&_i2c, 0, sizeof(_i2c));
+
+    double inicio = agora_ns();
+    for (uint32_t i = 0; i < n; ++i) {
+        semente = semente * 1103515245u + 12345u;
+        uint32_t r = semente >> 8;
+        if (r % 4 == 0) temp += ((int)(r >> 4) % 3 - 1) * 0.1f;
+        if (r % 16 == 1) hum += ((int)(r >> 6) % 3 - 1);
+        if (r % 8 == 2) pres += ((int)(r >> 8) % 3 - 1) * 0.1f;
+        rssi = -60 + (int)((r >> 12) % 9) - 4;
+        update(ssd, 7, temp, hum, pres, rssi, 1000 + i);
+    }
+    double fim = agora_ns();
+    return (medida_t){(fim - inicio) / n, (double)_i2c.transacoes / n, (double)_i2c.bytes / n};
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)atoi(argv[1]) : 100000;
+    ssd1306_t ssd;
+    ssd1306_init(&ssd, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, DISPLAY_I2C_ADDR, I2C_PORT);
+
+    // Aquece caches e o branch predictor antes das medidas
+    medir(&ssd, update_antigo, n / 10 + 1);
+    medir(&ssd, display_update_data, n / 10 + 1);
+    medida_t antigo = medir(&ssd, update_antigo, n);
+    medida_t retido = medir(&ssd, display_update_data, n);
+
+    printf("%lu atualizacoes\n", (unsigned long)n);
+    printf("%-22s %12s %12s %12s %14s %14s\n", "", "ns/atualiz.", "transacoes", "bytes I2C", "I2C 400k (us)",
+           "I2C 1M (us)");
+    const struct {
+        const char *nome;
+        medida_t *m;
+    } linhas[] = {{"antigo (fill+snprintf)", &antigo}, {"layout retido", &retido}};
+    for (size_t i = 0; i < 2; ++i) {
+        medida_t *m = linhas[i].m;
+        // Por transação: início, endereço, bytes com ACK e parada (~9 bits cada)
+        double bits = (m->bytes + m->transacoes) * 9 + m->transacoes * 2;
+        printf("%-22s %12.0f %12.2f %12.1f %14.0f %14.0f\n", linhas[i].nome, m->ns, m->transacoes, m->bytes,
+               bits / 0.4, bits / 1.0);
+    }
+    printf("renderizacao %.1fx mais rapida, %.1fx menos bytes no barramento\n", antigo.ns / retido.ns,
+           antigo.bytes / retido.bytes);
+    return 0;
+}
@@ -0,0 +1,287 @@
+// Modelo de tempo dos dois transportes SPI do rádio (include/lora.c) no
+// host: o driver roda sem alterações e cada operação de hardware que ele
+// faz (CS por GPIO, chamadas do SPI do SDK, preparo do DMA e transação no
+// PIO, máscara da IRQ do DIO0) soma o seu custo em ciclos de clk_sys a um
+// relógio simulado. Mede o lora_spi_benchmark do próprio driver (o mesmo
+// do comando 'b' do console) e o atendimento de um RxDone na ISR.
+//
+//     gcc -O2 -Itools/host -Iinclude tools/medir_spi_lora.c include/lora.c -lm -o medir_spi_lora && ./medir_spi_lora
+//
+// Os custos fixos são estimativas a partir do código do SDK 2.2.0, não
+// medidas; os tempos de barramento saem do clock efetivo de cada
+// transporte. O periférico SPI só divide clk_peri por números pares (o
+// pedido de 10 MHz vira 8,93 MHz a 125 MHz) e cada transação dele são duas
+// chamadas bloqueantes com o CS por software entre elas; o PIO tem divisor
+// fracionário (4 ciclos por bit) e faz endereço e dados numa transação só.
+// Os tempos medidos no alvo pelo comando 'b' são a referência; o modelo
+// mostra de onde vem a diferença.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lora.h"
+#include "hardware/structs/systick.h"
+
+#define CLK_SYS_HZ          125000000u
+#define PINO_DIO0           10
+#define PINO_CS             17
+#define PINO_DIO0_PIO       11
+#define PINO_CS_PIO         13
+
+// Custos fixos em ciclos de clk_sys (estimativas)
+#define CUSTO_GPIO_PUT      3   // Escrita no SIO (inline)
+#define CUSTO_SPI_CHAMADA   40  // spi_*_blocking: laço, espera do BSY e dreno da FIFO de RX
+#define CUSTO_DMA_CANAL     45  // Configuração de um canal (dma_channel_configure)
+#define CUSTO_PIO_FIM       20  // Espera do primeiro byte e do fim do DMA
+#define CUSTO_IRQ_PINO      30  // gpio_set_irq_enabled: banco, reconhecimento e INTE
+
+spi_inst_t host_spi[2] = {{0}, {1}};
+systick_hw_t host_systick;
+
+static uint64_t _ciclos = 0;
+static uint _excecao = 0;
+static gpio_irq_callback_t _callback;
+
+static uint32_t _hz_spi[2];     // Clock efetivo do periférico, por barramento
+static struct {
+    uint32_t chamadas_spi;
+    uint32_t transacoes_pio;
+    uint32_t mascaras;
+} _conta;
+
+// Registradores do chip e a transação em andamento
+static uint8_t _regs[128];
+static bool _cs_baixo;
+static bool _tem_endereco;
+static uint8_t _endereco;
+
+static uint64_t ciclos_bytes(size_t bytes, double hz) {
+    return (uint64_t)(bytes * 8 * (double)CLK_SYS_HZ / hz + 0.5);
+}
+
+// --- Plataforma ---
+
+uint64_t time_us_64(void) {
+    return _ciclos / (CLK_SYS_HZ / 1000000u);
+}
+
+void sleep_ms(uint32_t ms) {
+    _ciclos += (uint64_t)ms * (CLK_SYS_HZ / 1000u);
+}
+
+uint __get_current_exception(void) {
+    return _excecao;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+    return false;
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+    return true;
+}
+
+// --- Chip: só registradores; o FIFO não interessa ao tempo ---
+
+static void acessar(uint8_t addr, const uint8_t *tx, uint8_t *rx, size_t len) {
+    uint8_t reg = addr & 0x7F;
+    for (size_t i = 0; i < len; ++i) {
+        if (addr & 0x80) {
+            uint8_t v = tx ? tx[i] : 0;
+            _regs[reg] = reg == REG_12_IRQ_FLAGS ? _regs[reg] & ~v : v;
+        } else if (rx) {
+            rx[i] = _regs[reg];
+        }
+        if (reg != REG_00_FIFO) {
+            reg++;
+        }
+    }
+}
+
+// --- Periférico SPI do RP2040 ---
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    // Como o SDK: pré-divisor par e pós-divisor inteiro, o maior clock que
+    // não passa do pedido
+    uint n = 2;
+    while (CLK_SYS_HZ / n > baudrate) {
+        n += 2;
+    }
+    _hz_spi[spi->index] = CLK_SYS_HZ / n;
+    return _hz_spi[spi->index];
+}
+
+void spi_deinit(spi_inst_t *spi) {
+}
+
+uint spi_get_baudrate(const spi_inst_t *spi) {
+    return _hz_spi[spi->index];
+}
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    _ciclos += CUSTO_SPI_CHAMADA + ciclos_bytes(len, _hz_spi[spi->index]);
+    _conta.chamadas_spi++;
+    if (_cs_baixo && !_tem_endereco && len > 0) {
+        _endereco = src[0];
+        _tem_endereco = true;
+        src++;
+        len--;
+    }
+    if (_cs_baixo && len > 0) {
+        acessar(_endereco, src, NULL, len);
+    }
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len) {
+    _ciclos += CUSTO_SPI_CHAMADA + ciclos_bytes(len, _hz_spi[spi->index]);
+    _conta.chamadas_spi++;
+    if (_cs_baixo) {
+        acessar(_endereco, NULL, dst, len);
+    }
+    return (int)len;
+}
+
+// --- Transporte PIO ---
+
+bool lora_pio_spi_init(lora_pio_spi_t *spi, PIO pio, uint sck_pin, uint mosi_pin, uint miso_pin, uint cs_pin, uint32_t hz) {
+    float div = (float)CLK_SYS_HZ / (4.0f * hz);
+    if (div < 1.0f) {
+        div = 1.0f;
+    }
+    spi->pio = pio;
+    spi->hz = (uint32_t)(CLK_SYS_HZ / (4.0f * div));
+    return cs_pin + 1 == sck_pin;
+}
+
+void lora_pio_spi_transfer(lora_pio_spi_t *spi, uint8_t addr, const uint8_t *tx, uint8_t *rx, size_t len) {
+    // Divisor fracionário: o clock médio é o pedido
+    _ciclos += 2 * CUSTO_DMA_CANAL + ciclos_bytes(1 + len, spi->hz) + CUSTO_PIO_FIM;
+    _conta.transacoes_pio++;
+    acessar(addr, tx, rx, len);
+}
+
+void lora_pio_spi_deinit(lora_pio_spi_t *spi) {
+}
+
+// --- GPIO ---
+
+void gpio_init(uint gpio) {
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+}
+
+void gpio_pull_up(uint gpio) {
+}
+
+void gpio_put(uint gpio, bool value) {
+    _ciclos += CUSTO_GPIO_PUT;
+    if (gpio == PINO_CS) {
+        _cs_baixo = !value;
+        _tem_endereco = false;
+    }
+}
+
+bool gpio_get(uint gpio) {
+    return false;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    _ciclos += CUSTO_IRQ_PINO;
+    _conta.mascaras++;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    _callback = callback;
+}
+
+// --- Medidas ---
+
+static bool iniciar(lora_radio_t *radio, lora_transport_kind_t transporte, uint32_t hz) {
+    bool pio = transporte == LORA_TRANSPORT_PIO;
+    lora_config_t config = {
+        .spi_port = pio ? spi1 : spi0, // O PIO só usa o barramento como identificador
+        .sck_pin = pio ? PINO_CS_PIO + 1 : 18,
+        .mosi_pin = pio ? PINO_CS_PIO + 2 : 19,
+        .miso_pin = pio ? PINO_CS_PIO + 3 : 16,
+        .spi_hz = hz,
+        .transport = transporte,
+        .interrupt_pin = pio ? PINO_DIO0_PIO : PINO_DIO0,
+        .cs_pin = pio ? PINO_CS_PIO : PINO_CS,
+        .freq = 915.0f,
+        .tx_power = 17,
+        .this_address = 1,
+        .modem = BW125_CR45_SF128,
+    };
+    return lora_init(radio, &config);
+}
+
+/**
+ * @brief Um RxDone de `tamanho` bytes atendido pela ISR, do despachante do
+ *        GPIO até a entrega, em microssegundos.
+ */
+static double medir_rx_done(lora_radio_t *radio, uint8_t tamanho) {
+    _regs[REG_00_FIFO] = 1; // Todo byte do FIFO vale 1: pacote para este nó
+    _regs[REG_12_IRQ_FLAGS] = IRQ_FLAG_RX_DONE;
+    _regs[REG_13_RX_NB_BYTES] = tamanho;
+    uint64_t inicio = _ciclos;
+    _excecao = 16 + 13; // IO_IRQ_BANK0
+    _callback(radio->config.interrupt_pin, GPIO_IRQ_LEVEL_HIGH);
+    _excecao = 0;
+    return (double)(_ciclos - inicio) * 1e6 / CLK_SYS_HZ;
+}
+
+int main(int argc, char **argv) {
+    uint32_t iteracoes = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000;
+    static const uint32_t clocks[] = {5000000, 8000000, LORA_SPI_MAX_HZ};
+    static const struct {
+        const char *nome;
+        lora_transport_kind_t tipo;
+    } transportes[] = {
+        {"spi", LORA_TRANSPORT_SPI},
+        {"pio", LORA_TRANSPORT_PIO},
+    };
+    static lora_radio_t radios[2];
+
+    printf("clk_sys %u MHz, %lu iteracoes; tempos por acesso em us (loop: com a mascara da IRQ)\n",
+           CLK_SYS_HZ / 1000000u, (unsigned long)iteracoes);
+    printf("%-10s %-4s %9s %8s %8s %8s %8s %9s %8s %8s\n", "pedido", "tr.", "efetivo", "1 reg", "32 regs",
+           "1 reg/isr", "MB/s", "RxDone 64", "chamadas", "mascaras");
+    for (size_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); ++c) {
+        for (size_t t = 0; t < sizeof(transportes) / sizeof(transportes[0]); ++t) {
+            lora_radio_t *radio = &radios[t];
+            if (!iniciar(radio, transportes[t].tipo, clocks[c])) {
+                printf("%s: lora_init falhou\n", transportes[t].nome);
+                return 1;
+            }
+
+            uint32_t simples_us, rajada_us;
+            memset(&_conta, 0, sizeof(_conta));
+            lora_spi_benchmark(radio, iteracoes, &simples_us, &rajada_us);
+            uint32_t chamadas = _conta.chamadas_spi + _conta.transacoes_pio;
+            uint32_t mascaras = _conta.mascaras;
+
+            // O mesmo acesso na ISR, sem a máscara
+            uint32_t isr_us, ignorado;
+            _excecao = 16 + 13;
+            lora_spi_benchmark(radio, iteracoes, &isr_us, &ignorado);
+            _excecao = 0;
+
+            double rx_us = medir_rx_done(radio, 4 + 64);
+            printf("%7.2fMHz %-4s %7.2fMHz %8.2f %8.2f %9.2f %8.2f %9.1f %8.1f %8.1f\n", clocks[c] / 1e6,
+                   transportes[t].nome, radio->spi_hz / 1e6, (double)simples_us / iteracoes,
+                   (double)rajada_us / iteracoes, (double)isr_us / iteracoes,
+                   32.0 * iteracoes / rajada_us, rx_us, (double)chamadas / (2.0 * iteracoes),
+                   (double)mascaras / (2.0 * iteracoes));
+        }
+    }
+    printf("chamadas e mascaras: chamadas ao SPI/PIO e gpio_set_irq_enabled por acesso do loop\n");
+    return 0;
+}
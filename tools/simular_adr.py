@@ -0,0 +1,331 @@
+#!/usr/bin/env python3
+"""
+Simula uma rede de transmissores confirmados por um receptor e compara
+configurações fixas com a taxa de dados adaptativa dos ACKs (include/adr.c).
+
+Modelo:
+  - nós espalhados uniformemente num disco de raio --raio ao redor do
+    receptor; perda log-distância PL(d) = PL0 + 10·n·log10(d / 1 km), com
+    sombreamento fixo por nó e desvanecimento por pacote (gaussianos, dB);
+  - ruído na banda = -174 dBm/Hz + 10·log10(BW) + figura de ruído; o pacote
+    é demodulado se a SNR atingir o piso do SF; a SNR lida pelo rádio
+    satura em +12 dB;
+  - ALOHA puro: pacotes sobrepostos no mesmo perfil se perdem (sem
+    captura); perfis diferentes não interferem. O receptor escuta os perfis
+    de --perfis, um rádio por perfil, todos na mesma frequência: é o que o
+    adr_init do firmware oferece nas recomendações. O padrão é o do
+    config.h, um rádio só (LORA_NUM_RADIOS 1, perfil 125k/SF7), em que o ADR
+    só ajusta a potência; trocar de SF exige rádios nos outros perfis na
+    mesma frequência (o segundo rádio do config.h fica em outra). O ACK
+    ocupa o rádio do perfil em que foi enviado, derrubando o que chegar
+    nesse intervalo;
+  - ADR: a mesma decisão do firmware, em quartos de dB e com as constantes
+    de config.h; o transmissor aplica cada ACK e recua para a configuração
+    inicial após ADR_RECUO_SEM_ACK envios seguidos sem ACK.
+
+Uso:
+    python3 tools/simular_adr.py
+    python3 tools/simular_adr.py --perfis 500k/SF7,125k/SF7,31k/SF9,125k/SF12 --fixo 125k/SF12
+"""
+
+import argparse
+import heapq
+import math
+import random
+
+# Mesmos valores de include/config.h
+ADR_MARGEM_DB = 10
+ADR_HISTERESE_DB = 3
+ADR_CONFIRMACOES = 4
+ADR_AMOSTRAS_MIN = 4
+ADR_EWMA_SHIFT = 2
+ADR_POTENCIA_MIN = 5
+ADR_POTENCIA_MAX = 20
+ADR_RECUO_SEM_ACK = 3
+
+
+class Perfil:
+    def __init__(self, nome, bw, sf, cr, ldro, piso_x4, posicao):
+        self.nome = nome
+        self.bw = bw
+        self.sf = sf
+        self.cr = cr            # 1 = 4/5 ... 4 = 4/8
+        self.ldro = ldro        # Otimização para taxa baixa (REG_26_MODEM_CONFIG3)
+        self.ruido_x4 = round(4 * 10 * math.log10(bw))
+        self.piso_x4 = piso_x4
+        self.posicao = posicao
+
+    def tempo_no_ar(self, carga):
+        """Semtech AN1200.13: preâmbulo de 8 símbolos, cabeçalho explícito, CRC."""
+        tsym = (1 << self.sf) / self.bw
+        bits = 8 * carga - 4 * self.sf + 28 + 16
+        simbolos = 8 + max(math.ceil(bits / (4 * (self.sf - 2 * self.ldro))) * (self.cr + 4), 0)
+        return (8 + 4.25) * tsym + simbolos * tsym
+
+
+# Perfis escutados com a configuração padrão do config.h: só o rádio 1, com
+# o modem padrão (BW125_CR45_SF128)
+PERFIS_PADRAO = "125k/SF7"
+
+# Os perfis de modem_config_t (lora.h), na ordem de include/adr.c
+PERFIS = {p.nome: p for p in [
+    Perfil("500k/SF7", 500e3, 7, 1, 0, -30, 0),
+    Perfil("125k/SF7", 125e3, 7, 1, 0, -30, 1),
+    Perfil("31k/SF9", 31.25e3, 9, 4, 0, -50, 2),
+    Perfil("125k/SF12", 125e3, 12, 4, 1, -80, 3),
+]}
+ORDEM = sorted(PERFIS.values(), key=lambda p: p.posicao)
+
+# Corrente do SX1276 no PA_BOOST por potência (mA), interpolada
+CORRENTE_MA = [(5, 20), (7, 20), (10, 25), (13, 29), (17, 90), (20, 120), (23, 140)]
+
+
+def corrente(dbm):
+    for (p0, i0), (p1, i1) in zip(CORRENTE_MA, CORRENTE_MA[1:]):
+        if p0 <= dbm <= p1:
+            return i0 + (i1 - i0) * (dbm - p0) / (p1 - p0)
+    return CORRENTE_MA[-1][1]
+
+
+# --- Decisão do receptor (espelho de include/adr.c) ---
+
+def folga(snr_x4, ouvido, atual, perfil, potencia):
+    return (snr_x4 + ouvido.ruido_x4 - perfil.ruido_x4 + 4 * (potencia - atual)
+            - perfil.piso_x4 - 4 * ADR_MARGEM_DB)
+
+
+def escolher(snr_x4, ouvido, atual, mascara, reserva_x4):
+    escolhido = ouvido
+    f = folga(snr_x4, ouvido, atual, ouvido, ADR_POTENCIA_MAX) - reserva_x4
+    for p in ORDEM:
+        if p not in mascara:
+            continue
+        escolhido = p
+        f = folga(snr_x4, ouvido, atual, p, ADR_POTENCIA_MAX) - reserva_x4
+        if f >= 0:
+            break
+    dbm = ADR_POTENCIA_MAX - (int(f / 4) if f > 0 else 0)
+    return escolhido, max(dbm, ADR_POTENCIA_MIN)
+
+
+def melhor(pa, da, pb, db):
+    return pa.posicao < pb.posicao if pa is not pb else da < db
+
+
+class EstadoReceptor:
+    def __init__(self, perfil):
+        self.modem = perfil
+        self.tx_power = ADR_POTENCIA_MAX
+        self.amostras = 0
+        self.confirmacoes = 0
+        self.divergentes = 0
+        self.snr_q8 = 0
+        self.melhoras = 0
+        self.pioras = 0
+
+    def trocar(self, perfil, potencia):
+        if melhor(perfil, potencia, self.modem, self.tx_power):
+            self.melhoras += 1
+        else:
+            self.pioras += 1
+        self.modem, self.tx_power = perfil, potencia
+        self.amostras = self.confirmacoes = 0
+
+    def avaliar(self, mascara):
+        snr_x4 = int(self.snr_q8 / 256)
+        atual = folga(snr_x4, self.modem, self.tx_power, self.modem, self.tx_power)
+        if atual < 0:
+            perfil, potencia = escolher(snr_x4, self.modem, self.tx_power, mascara, 0)
+            if perfil is not self.modem or potencia != self.tx_power:
+                self.trocar(perfil, potencia)
+            return
+        perfil, potencia = escolher(snr_x4, self.modem, self.tx_power, mascara, 4 * ADR_HISTERESE_DB)
+        if not melhor(perfil, potencia, self.modem, self.tx_power):
+            self.confirmacoes = 0
+        else:
+            self.confirmacoes += 1
+            if self.confirmacoes >= ADR_CONFIRMACOES:
+                self.trocar(perfil, potencia)
+
+    def ack(self, ouvido, snr_x4, mascara):
+        amostrar = True
+        if ouvido is not self.modem:
+            if ouvido.posicao > self.modem.posicao:
+                self.trocar(ouvido, ADR_POTENCIA_MAX)
+                self.divergentes = 0
+            else:
+                self.divergentes += 1
+                if self.divergentes >= ADR_AMOSTRAS_MIN:
+                    self.modem, self.tx_power = ouvido, ADR_POTENCIA_MAX
+                    self.amostras = self.confirmacoes = self.divergentes = 0
+                else:
+                    amostrar = False
+        else:
+            self.divergentes = 0
+        if amostrar:
+            q8 = snr_x4 * 256
+            self.snr_q8 = q8 if self.amostras == 0 else self.snr_q8 + int((q8 - self.snr_q8) / (1 << ADR_EWMA_SHIFT))
+            self.amostras += 1
+            if self.amostras >= ADR_AMOSTRAS_MIN:
+                self.avaliar(mascara)
+        return self.modem, self.tx_power
+
+
+# --- Rede ---
+
+class No:
+    def __init__(self, ident, perda_db, perfil, potencia):
+        self.ident = ident
+        self.perda_db = perda_db
+        self.perfil = perfil
+        self.potencia = potencia
+        self.inicial = (perfil, potencia)
+        self.falhas = 0
+        self.rx = None          # EstadoReceptor, criado no primeiro pacote
+
+
+def simular(args, perfil_fixo, adr, semente):
+    rnd = random.Random(semente)
+    mascara = [PERFIS[n] for n in args.perfis.split(",")]
+    nos = []
+    for i in range(args.nos):
+        d = args.raio * math.sqrt(rnd.random())
+        d = max(d, 50.0)
+        perda = args.pl0 + 10 * args.expoente * math.log10(d / 1000.0) + rnd.gauss(0, args.sombreamento)
+        nos.append(No(i, perda, perfil_fixo, ADR_POTENCIA_MAX))
+
+    eventos = [(rnd.uniform(0, args.periodo), 0, i) for i in range(args.nos)]
+    heapq.heapify(eventos)
+    ocupacao = {p.nome: [] for p in PERFIS.values()}  # (inicio, fim, é_uplink, id)
+    proximo_id = [0]
+
+    total = {"enviados": 0, "entregues": 0, "ar_s": 0.0, "bytes": 0, "energia_mj": 0.0}
+    uso_perfil = {p.nome: 0 for p in PERFIS.values()}
+    carga = args.carga + 4
+
+    def colide(perfil, inicio, fim, ident):
+        for (a, b, _, outro) in ocupacao[perfil.nome]:
+            if outro != ident and a < fim and b > inicio:
+                return True
+        return False
+
+    while eventos:
+        t, tipo, i = heapq.heappop(eventos)
+        if t > args.duracao:
+            break
+        no = nos[i]
+        if tipo == 0:
+            # Início de um envio: ocupa o perfil até o fim
+            ar = no.perfil.tempo_no_ar(carga)
+            ident = proximo_id[0]
+            proximo_id[0] += 1
+            ocupacao[no.perfil.nome].append((t, t + ar, True, ident))
+            total["enviados"] += 1
+            total["ar_s"] += ar
+            total["energia_mj"] += corrente(no.potencia) * 3.3 * ar
+            uso_perfil[no.perfil.nome] += 1
+            heapq.heappush(eventos, (t + ar, 1, i))
+            no.envio = (t, t + ar, ident, no.perfil, no.potencia)
+            continue
+
+        # Fim do envio: entrega, ACK e decisão
+        inicio, fim, ident, perfil, potencia = no.envio
+        ruido = -174 + 10 * math.log10(perfil.bw) + args.figura_ruido
+        snr = potencia - no.perda_db - rnd.gauss(0, args.desvanecimento) - ruido
+        entregue = (perfil in mascara and snr * 4 >= perfil.piso_x4
+                    and not colide(perfil, inicio, fim, ident))
+        ack_ok = False
+        if entregue:
+            total["entregues"] += 1
+            total["bytes"] += args.carga
+            extra = 0
+            if adr:
+                if no.rx is None:
+                    no.rx = EstadoReceptor(perfil)
+                snr_x4 = max(min(int(round(snr * 4)), 48), -128)
+                rec = no.rx.ack(perfil, snr_x4, mascara)
+                extra = 4
+            ar_ack = perfil.tempo_no_ar(4 + extra)
+            ocupacao[perfil.nome].append((fim, fim + ar_ack, False, -1))
+            total["ar_s"] += ar_ack
+            # Enlace simétrico; o receptor transmite na potência máxima
+            snr_ack = ADR_POTENCIA_MAX - no.perda_db - rnd.gauss(0, args.desvanecimento) - ruido
+            ack_ok = snr_ack * 4 >= perfil.piso_x4
+            if ack_ok and adr:
+                no.perfil, no.potencia = rec
+        if adr:
+            if ack_ok:
+                no.falhas = 0
+            else:
+                no.falhas += 1
+                if no.falhas >= ADR_RECUO_SEM_ACK:
+                    no.falhas = 0
+                    no.perfil, no.potencia = no.inicial
+
+        # Descarta ocupações que já não alcançam nenhum pacote futuro
+        limite = t - 10.0
+        for nome in ocupacao:
+            ocupacao[nome] = [o for o in ocupacao[nome] if o[1] > limite]
+        heapq.heappush(eventos, (t + rnd.expovariate(1.0 / args.periodo), 0, i))
+
+    total["uso"] = uso_perfil
+    total["nos"] = nos
+    return total
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--nos", type=int, default=60, help="transmissores (padrão 60)")
+    ap.add_argument("--raio", type=float, default=5000.0, help="raio da área, em m")
+    ap.add_argument("--periodo", type=float, default=300.0, help="intervalo médio entre envios de cada nó, em s")
+    ap.add_argument("--duracao", type=float, default=6 * 3600.0, help="tempo simulado, em s")
+    ap.add_argument("--carga", type=int, default=20, help="bytes de dados por pacote (sem o cabeçalho)")
+    ap.add_argument("--perfis", default=PERFIS_PADRAO,
+                    help="perfis dos rádios do receptor na mesma frequência (padrão: o do config.h)")
+    ap.add_argument("--fixo", help="perfil de todos os nós sem ADR e inicial com ADR (padrão: o mais lento de --perfis)")
+    ap.add_argument("--pl0", type=float, default=128.95, help="perda a 1 km, em dB")
+    ap.add_argument("--expoente", type=float, default=2.32, help="expoente de perda")
+    ap.add_argument("--sombreamento", type=float, default=7.8, help="desvio do sombreamento por nó, em dB")
+    ap.add_argument("--desvanecimento", type=float, default=2.0, help="desvio por pacote, em dB")
+    ap.add_argument("--figura-ruido", type=float, default=6.0, help="figura de ruído do receptor, em dB")
+    ap.add_argument("--semente", type=int, default=1)
+    args = ap.parse_args()
+
+    escutados = sorted((PERFIS[n] for n in args.perfis.split(",")), key=lambda p: p.posicao)
+    if args.fixo is None:
+        args.fixo = escutados[-1].nome
+    if PERFIS[args.fixo] not in escutados:
+        ap.error(f"--fixo {args.fixo} fora de --perfis: nenhum pacote seria recebido")
+
+    # Cada perfil escutado com potência fixa, e o ADR partindo do mais lento
+    cenarios = [(f"fixo {args.fixo}", PERFIS[args.fixo], False)]
+    cenarios += [(f"fixo {p.nome}", p, False) for p in escutados if p.nome != args.fixo]
+    cenarios.append((f"ADR (inicio {args.fixo})", PERFIS[args.fixo], True))
+    print(f"{args.nos} nos em {args.raio / 1000:.1f} km, um pacote de {args.carga} B a cada "
+          f"{args.periodo:.0f} s por no, {args.duracao / 3600:.1f} h simuladas")
+    print(f"receptor escuta {', '.join(p.nome for p in escutados)}"
+          + (" (so a potencia se adapta)" if len(escutados) == 1 else ""))
+    print(f"{'cenario':<26} {'entrega':>8} {'ar total':>10} {'carga':>9} {'vazao':>9} {'mJ/entregue':>12}")
+    base = None
+    for nome, perfil, adr in cenarios:
+        r = simular(args, perfil, adr, args.semente)
+        pdr = r["entregues"] / max(r["enviados"], 1)
+        vazao = 8 * r["bytes"] / args.duracao
+        mj = r["energia_mj"] / max(r["entregues"], 1)
+        carga = r["ar_s"] / args.duracao  # Erlangs somados em todos os perfis
+        print(f"{nome:<26} {100 * pdr:7.1f}% {r['ar_s']:9.0f}s {carga:5.3f}Erl "
+              f"{vazao:7.1f}b/s {mj:12.2f}")
+        if adr:
+            uso = ", ".join(f"{k} {100 * v / max(r['enviados'], 1):.0f}%" for k, v in r["uso"].items() if v)
+            print(f"{'':<26} envios por perfil: {uso}")
+            trocas = sum(n.rx.melhoras + n.rx.pioras for n in r["nos"] if n.rx)
+            print(f"{'':<26} trocas recomendadas: {trocas} ({trocas / args.nos:.1f} por no)")
+            if base and base[2] > 0:
+                print(f"{'':<26} contra {base[0]}: ar x{r['ar_s'] / base[1]:.2f}, "
+                      f"vazao x{vazao / base[2]:.2f}, energia x{mj / base[3]:.2f}")
+        elif base is None:
+            base = (nome, r["ar_s"], vazao, mj)
+
+
+if __name__ == "__main__":
+    main()
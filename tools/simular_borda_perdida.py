@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Injeta interrupções perdidas e travamentos do modem num modelo do receptor
+e mede o que o monitor de saúde (lora_health_check em include/lora.c)
+recupera, comparando o limite antigo de modem ocupado (fixo) com o atual
+(tempo no ar de um quadro de 255 B no perfil, mais a folga).
+
+Modelo, como no firmware:
+  - quadros chegam um depois do outro, com intervalos exponenciais de média
+    --intervalo-s, cada um ocupando o modem pelo seu tempo no ar;
+  - com probabilidade --perda-borda o RxDone não é atendido pela ISR e o
+    DIO0 fica alto; o próximo quadro sobrescreve o FIFO (o anterior se
+    perde) até o monitor ver o DIO0 alto em duas verificações seguidas e
+    atender o pacote pendente;
+  - a uma taxa de --travamentos por hora o modem trava com sinal detectado
+    e só volta com um rearme; os quadros do período se perdem;
+  - a cada --periodo-ms o monitor verifica o DIO0 e o modem; com o modem
+    ocupado por verificações que somam o limite, rearma a recepção. Se era
+    um quadro legítimo e longo, ele é abortado por engano.
+
+Uso:
+    python3 tools/simular_borda_perdida.py
+    python3 tools/simular_borda_perdida.py --perfil 125k/SF7 --tamanho 30 --perda-borda 0.05
+"""
+
+import argparse
+import random
+
+from simular_adr import PERFIS
+
+# Mesmos valores de include/config.h e include/lora.h
+LORA_HEALTH_PERIOD_MS = 250
+LORA_HEALTH_MODEM_MARGEM_MS = 500
+LORA_MAX_QUADRO = 4 + 251
+
+
+def simular(args, perfil, limite_s, rnd):
+    periodo = args.periodo_ms / 1000.0
+    ar = perfil.tempo_no_ar(4 + args.tamanho)
+
+    # Quadros (início, fim) e travamentos (início), sem sobreposição
+    quadros, t = [], 0.0
+    while True:
+        t += rnd.expovariate(1.0 / args.intervalo_s)
+        if t + ar > args.duracao_s:
+            break
+        quadros.append((t, t + ar))
+        t += ar
+    travamentos = sorted(rnd.uniform(0, args.duracao_s)
+                         for _ in range(int(args.travamentos * args.duracao_s / 3600 + 0.5)))
+
+    r = {"quadros": len(quadros), "entregues": 0, "sobrescritos": 0, "abortados": 0, "no_travamento": 0,
+         "recuperadas": 0, "lat_borda": [], "travamentos": 0, "lat_travamento": []}
+    pendente_desde = None   # DIO0 alto sem atendimento desde
+    travado_desde = None
+    altos, ocupadas = 0, 0
+    q = 0                   # Próximo quadro a terminar
+    abortado = None         # Índice do quadro abortado pelo rearme
+
+    k = 1
+    while k * periodo <= args.duracao_s:
+        agora = k * periodo
+        k += 1
+        if travado_desde is None and travamentos and travamentos[0] <= agora:
+            travado_desde = travamentos.pop(0)
+
+        # Quadros terminados desde a verificação anterior
+        while q < len(quadros) and quadros[q][1] <= agora:
+            inicio, fim = quadros[q]
+            if q == abortado:
+                pass
+            elif travado_desde is not None and travado_desde <= fim:
+                r["no_travamento"] += 1
+            elif pendente_desde is not None:
+                r["sobrescritos"] += 1      # O FIFO guarda só o último
+                pendente_desde = fim
+            elif rnd.random() < args.perda_borda:
+                pendente_desde = fim
+            else:
+                r["entregues"] += 1
+            q += 1
+
+        # 1. DIO0 alto em duas verificações seguidas: atende o pendente
+        if pendente_desde is not None:
+            altos += 1
+            if altos >= 2:
+                altos = 0
+                r["entregues"] += 1
+                r["recuperadas"] += 1
+                r["lat_borda"].append(agora - pendente_desde)
+                pendente_desde = None
+            continue
+        altos = 0
+
+        # 3. Modem ocupado por mais que o limite: rearma
+        recebendo = q < len(quadros) and quadros[q][0] <= agora and q != abortado
+        if travado_desde is not None or recebendo:
+            ocupadas += 1
+            if ocupadas * periodo >= limite_s:
+                ocupadas = 0
+                if travado_desde is not None:
+                    r["travamentos"] += 1
+                    r["lat_travamento"].append(agora - travado_desde)
+                    travado_desde = None
+                else:
+                    r["abortados"] += 1
+                    abortado = q
+            continue
+        ocupadas = 0
+    return r
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--perfil", default="125k/SF12")
+    ap.add_argument("--tamanho", type=int, default=64, help="bytes de mensagem por quadro")
+    ap.add_argument("--intervalo-s", type=float, default=30.0, help="intervalo médio entre quadros")
+    ap.add_argument("--perda-borda", type=float, default=0.02, help="probabilidade de um RxDone não ser atendido")
+    ap.add_argument("--travamentos", type=float, default=2.0, help="travamentos do modem por hora")
+    ap.add_argument("--periodo-ms", type=float, default=LORA_HEALTH_PERIOD_MS)
+    ap.add_argument("--margem-ms", type=float, default=LORA_HEALTH_MODEM_MARGEM_MS)
+    ap.add_argument("--fixo-ms", type=float, default=2000.0, help="limite fixo para comparar")
+    ap.add_argument("--duracao-s", type=float, default=7 * 86400.0)
+    ap.add_argument("--semente", type=int, default=1)
+    args = ap.parse_args()
+
+    perfil = PERFIS[args.perfil]
+    maximo = perfil.tempo_no_ar(LORA_MAX_QUADRO)
+    print(f"{args.perfil}: quadro de {4 + args.tamanho} B = {1000 * perfil.tempo_no_ar(4 + args.tamanho):.0f} ms "
+          f"no ar, de 255 B = {1000 * maximo:.0f} ms; {args.duracao_s / 86400:.1f} dias")
+    limites = [(f"fixo {args.fixo_ms:.0f} ms", args.fixo_ms / 1000.0),
+               ("tempo no ar + folga", maximo + args.margem_ms / 1000.0)]
+    print(f"{'limite':>20} {'limite':>8} {'quadros':>8} {'entregues':>9} {'sobrescr.':>9} {'abortados':>9} "
+          f"{'travado':>8} {'borda ms':>9} {'trav. s':>8}")
+    for nome, limite in limites:
+        r = simular(args, perfil, limite, random.Random(args.semente))
+        lat_b = r["lat_borda"]
+        lat_t = r["lat_travamento"]
+        print(f"{nome:>20} {limite:7.2f}s {r['quadros']:8d} {r['entregues']:9d} {r['sobrescritos']:9d} "
+              f"{r['abortados']:9d} {r['no_travamento']:8d} "
+              f"{1000 * max(lat_b) if lat_b else 0:9.0f} {sum(lat_t) / len(lat_t) if lat_t else 0:8.1f}")
+    print("borda ms: maior atraso de um RxDone perdido até o monitor; trav. s: duração média de um travamento")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,303 @@
+// Simulador do log na flash (include/flash_log.c) no host, com cortes de
+// energia no meio das gravações e dos apagamentos e várias voltas do anel.
+//
+// Compilar numa linha só (a flash simulada faz o papel do fim da imagem):
+//     gcc -O2 -Itools/host -Iinclude -Wl,--defsym=__flash_binary_end=flash_sim -o simular_flash_log tools/simular_flash_log.c include/flash_log.c include/crc.c
+//     ./simular_flash_log [boots] [semente]
+//
+// O módulo roda sem alterações sobre uma flash em RAM com a semântica de
+// NOR: apagar deixa 0xFF e programar só zera bits. Um corte no meio de uma
+// programação deixa um prefixo da página gravado; no meio de um apagamento,
+// uma parte aleatória dos bytes do setor apagada (um registro assim pode
+// passar pelo CRC-16 por acaso, ~1 em 65536; essas colisões são contadas à
+// parte e não entram nas conferências). Depois de cada boot
+// (com ou sem corte) o simulador confere:
+//   - nenhum registro de página gravada por inteiro se perdeu, a não ser
+//     pelo apagamento do próprio anel;
+//   - a busca binária do boot acha o mesmo fim que uma varredura completa:
+//     o primeiro registro novo continua a sequência do último válido;
+//   - o dump sai em ordem estritamente crescente de sequência, com todos
+//     os registros válidos da flash e os da página em RAM.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include "flash_log.h"
+#include "config.h"
+#include "crc.h"
+#include "hardware/flash.h"
+
+#define REG_BYTES        32u
+#define REGS_POR_SETOR   (FLASH_SECTOR_SIZE / REG_BYTES)
+#define LOG_REGS         (FLASH_LOG_SETORES * REGS_POR_SETOR)
+#define LOG_OFFSET       (PICO_FLASH_SIZE_BYTES - FLASH_LOG_SETORES * FLASH_SECTOR_SIZE)
+#define NENHUM           0xFFFFFFFFu
+
+uint8_t flash_sim[PICO_FLASH_SIZE_BYTES];
+
+static uint64_t _agora_us;
+static uint32_t _aleatorio = 1;
+
+static jmp_buf _corte;
+static int32_t _ops_ate_corte = -1;     // Operações na flash até o corte (-1 = nenhum)
+static uint32_t _confirmado[LOG_REGS];  // Sequência dos registros de páginas gravadas por inteiro
+static uint32_t _escrito[LOG_REGS];     // Última sequência programada no slot, inteira ou não
+static uint32_t _colisoes[64];          // Sequências de registros corrompidos que passaram pelo CRC
+static uint32_t _num_colisoes;
+static uint32_t _esperado = NENHUM;     // Sequência do primeiro registro gravado depois do boot
+static uint32_t _falhas = 0;
+
+static struct {
+    uint32_t boots;
+    uint32_t cortes_programa;
+    uint32_t cortes_apagamento;
+    uint32_t registros;
+    uint32_t paginas;
+    uint32_t voltas;
+    uint32_t colisoes;
+} _sim;
+
+uint64_t time_us_64(void) {
+    return _agora_us;
+}
+
+// Sem o canal de log: nenhum registro em envio segura o dump
+bool log_ring_transmitindo(void) {
+    return false;
+}
+
+static uint32_t aleatorio(void) {
+    // xorshift32
+    _aleatorio ^= _aleatorio << 13;
+    _aleatorio ^= _aleatorio >> 17;
+    _aleatorio ^= _aleatorio << 5;
+    return _aleatorio;
+}
+
+static void falha(const char *msg, unsigned long a, unsigned long b) {
+    if (_falhas++ < 10) {
+        printf("FALHA boot %lu: %s (%lu, %lu)\n", (unsigned long)_sim.boots, msg, a, b);
+    }
+}
+
+static const uint8_t *slot_flash(uint32_t slot) {
+    return flash_sim + LOG_OFFSET + slot * REG_BYTES;
+}
+
+static bool slot_valido(uint32_t slot, uint32_t *seq) {
+    const uint8_t *r = slot_flash(slot);
+    uint16_t crc = (uint16_t)(r[30] | r[31] << 8);
+    memcpy(seq, r, 4);
+    return *seq != NENHUM && crc16_ccitt(0xFFFF, r, 30) == crc;
+}
+
+/**
+ * @brief Registro válido que é mesmo o que foi programado no slot, e não
+ *        restos de um apagamento interrompido que acertaram o CRC.
+ */
+static bool slot_legitimo(uint32_t slot, uint32_t *seq) {
+    return slot_valido(slot, seq) && *seq == _escrito[slot];
+}
+
+static bool colisao(uint32_t seq) {
+    for (uint32_t i = 0; i < _num_colisoes; ++i) {
+        if (_colisoes[i] == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool cortar_agora(void) {
+    return _ops_ate_corte >= 0 && _ops_ate_corte-- == 0;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs < LOG_OFFSET || flash_offs % FLASH_SECTOR_SIZE || count != FLASH_SECTOR_SIZE) {
+        falha("apagamento fora da regiao ou desalinhado", flash_offs, count);
+        return;
+    }
+    uint32_t primeiro = (flash_offs - LOG_OFFSET) / REG_BYTES;
+    for (uint32_t i = 0; i < REGS_POR_SETOR; ++i) {
+        _confirmado[primeiro + i] = NENHUM;
+    }
+    if (cortar_agora()) {
+        for (size_t i = 0; i < count; ++i) {
+            if (aleatorio() & 1) {
+                flash_sim[flash_offs + i] = 0xFF;
+            }
+        }
+        _sim.cortes_apagamento++;
+        longjmp(_corte, 1);
+    }
+    memset(flash_sim + flash_offs, 0xFF, count);
+    for (uint32_t i = 0; i < REGS_POR_SETOR; ++i) {
+        _escrito[primeiro + i] = NENHUM;
+    }
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs < LOG_OFFSET || flash_offs % FLASH_PAGE_SIZE || count != FLASH_PAGE_SIZE) {
+        falha("programacao fora da regiao ou desalinhada", flash_offs, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if ((flash_sim[flash_offs + i] & data[i]) != data[i]) {
+            falha("programacao sobre bytes nao apagados", flash_offs + i, flash_sim[flash_offs + i]);
+            break;
+        }
+    }
+    uint32_t primeiro = (flash_offs - LOG_OFFSET) / REG_BYTES;
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE / REG_BYTES; ++i) {
+        memcpy(&_escrito[primeiro + i], data + i * REG_BYTES, 4);
+    }
+    uint32_t seq;
+    memcpy(&seq, data, 4);
+    if (_esperado != NENHUM) {
+        if (seq != _esperado) {
+            falha("fim do log errado no boot: sequencia gravada, esperada", seq, _esperado);
+        }
+        _esperado = NENHUM;
+    }
+    if (cortar_agora()) {
+        size_t n = aleatorio() % count;
+        for (size_t i = 0; i < n; ++i) {
+            flash_sim[flash_offs + i] &= data[i];
+        }
+        _sim.cortes_programa++;
+        longjmp(_corte, 1);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        flash_sim[flash_offs + i] &= data[i];
+    }
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE / REG_BYTES; ++i) {
+        uint32_t s;
+        _confirmado[primeiro + i] = slot_valido(primeiro + i, &s) ? s : NENHUM;
+    }
+    if (primeiro == 0) {
+        _sim.voltas++;
+    }
+    _sim.paginas++;
+}
+
+/**
+ * @brief Confere a flash depois do boot: registros confirmados intactos e
+ *        a sequência esperada do próximo registro (maior válida + 1).
+ */
+static void conferir_boot(void) {
+    uint32_t maior = NENHUM;
+    _num_colisoes = 0;
+    for (uint32_t slot = 0; slot < LOG_REGS; ++slot) {
+        uint32_t seq;
+        bool valido = slot_legitimo(slot, &seq);
+        if (_confirmado[slot] != NENHUM && (!valido || seq != _confirmado[slot])) {
+            falha("registro confirmado perdido: slot, seq", slot, _confirmado[slot]);
+        }
+        if (!valido && slot_valido(slot, &seq)) {
+            _sim.colisoes++;
+            if (_num_colisoes < 64) {
+                _colisoes[_num_colisoes++] = seq;
+            }
+            continue;
+        }
+        if (valido && (maior == NENHUM || seq > maior)) {
+            maior = seq;
+        }
+    }
+    _esperado = maior == NENHUM ? 0 : maior + 1;
+}
+
+/**
+ * @brief Roda o dump do módulo com o stdout num arquivo temporário e confere
+ *        a ordem das sequências.
+ */
+static void conferir_dump(uint32_t na_ram) {
+    uint32_t validos = 0;
+    for (uint32_t slot = 0; slot < LOG_REGS; ++slot) {
+        uint32_t seq;
+        validos += slot_valido(slot, &seq);
+    }
+
+    fflush(stdout);
+    int salvo = dup(STDOUT_FILENO);
+    FILE *tmp = tmpfile();
+    dup2(fileno(tmp), STDOUT_FILENO);
+    flash_log_dump();
+    for (int i = 0; i < 100000; ++i) {
+        flash_log_poll();
+    }
+    fflush(stdout);
+    dup2(salvo, STDOUT_FILENO);
+    close(salvo);
+
+    rewind(tmp);
+    char linha[200];
+    uint32_t lidos = 0;
+    long anterior = -1;
+    bool fim = false;
+    while (fgets(linha, sizeof(linha), tmp)) {
+        if (linha[0] == '#') {
+            long seq = strtol(linha + 1, NULL, 10);
+            lidos++;
+            if (colisao((uint32_t)seq)) {
+                continue;
+            }
+            if (seq <= anterior) {
+                falha("dump fora de ordem", (unsigned long)seq, (unsigned long)anterior);
+            }
+            anterior = seq;
+        }
+        fim |= strncmp(linha, "Fim do log.", 11) == 0;
+    }
+    fclose(tmp);
+    if (!fim || lidos != validos + na_ram) {
+        falha("dump incompleto: lidos, esperados", lidos, validos + na_ram);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t boots = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+    _aleatorio = argc > 2 ? (uint32_t)atoi(argv[2]) | 1 : 1;
+    memset(flash_sim, 0x5A, sizeof(flash_sim)); // Região nunca apagada
+    for (uint32_t i = 0; i < LOG_REGS; ++i) {
+        _confirmado[i] = NENHUM;
+        _escrito[i] = NENHUM;
+    }
+
+    log_pacote_t p = {0};
+    for (_sim.boots = 1; _sim.boots <= boots; ++_sim.boots) {
+        // Boot: um corte em ~2/3 deles, numa operação sorteada
+        _ops_ate_corte = aleatorio() % 3 ? (int32_t)(aleatorio() % 64) : -1;
+        uint32_t registros = aleatorio() % (2 * LOG_REGS);
+        if (setjmp(_corte) == 0) {
+            conferir_boot();
+            if (!flash_log_init(NULL)) {
+                falha("init recusou a regiao", 0, 0);
+                break;
+            }
+            for (uint32_t i = 0; i < registros; ++i) {
+                _agora_us += 1000;
+                p.remetente = (uint8_t)i;
+                p.rssi = -(int16_t)(aleatorio() % 120);
+                flash_log_registrar(&p, 0);
+                _sim.registros++;
+                flash_log_poll();
+            }
+            // Sem corte: confere o dump antes do "desligamento"
+            _ops_ate_corte = -1;
+            flash_log_stats_t st = flash_log_stats();
+            conferir_dump(registros - st.gravados - st.descartados);
+        }
+        _esperado = NENHUM;
+    }
+
+    printf("%lu boots, %lu registros, %lu paginas, %lu voltas do anel, %lu cortes na programacao, "
+           "%lu no apagamento, %lu colisoes do CRC\n",
+           (unsigned long)boots, (unsigned long)_sim.registros, (unsigned long)_sim.paginas,
+           (unsigned long)_sim.voltas, (unsigned long)_sim.cortes_programa, (unsigned long)_sim.cortes_apagamento,
+           (unsigned long)_sim.colisoes);
+    printf("%s: %lu falhas\n", _falhas ? "FALHA" : "OK", (unsigned long)_falhas);
+    return _falhas ? 1 : 0;
+}
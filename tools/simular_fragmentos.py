@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Mede a vazão útil das transferências fragmentadas (include/fragmentos.c)
+em função da perda de quadros, para vários tamanhos de janela.
+
+Modelo, como no firmware:
+  - a transferência vai em fragmentos de FRAG_DADOS bytes com 2 de
+    cabeçalho próprio e os 4 do quadro;
+  - o transmissor envia os fragmentos não confirmados da janela, o último
+    pedindo o SACK, e espera até --espera-ms por ele; FRAG_TENTATIVAS
+    janelas seguidas sem progresso encerram a transferência como falha;
+  - o receptor responde o pedido com o SACK (base + mapa de 32 bits)
+    depois de --virada-ms (loop principal e troca de modo do rádio);
+  - cada quadro, nos dois sentidos, se perde com probabilidade --perdas.
+
+A janela de 1 fragmento é o parar-e-esperar de lora_send_to_wait: um ACK
+por quadro. A vazão conta só os bytes das transferências concluídas, sobre
+o tempo de todas, inclusive as que falharam.
+
+Uso:
+    python3 tools/simular_fragmentos.py
+    python3 tools/simular_fragmentos.py --perfil 31k/SF9 --tamanho 2048 --janelas 1,8
+"""
+
+import argparse
+import math
+import random
+
+from simular_adr import PERFIS
+
+# Mesmos valores de include/config.h e include/fragmentos.c
+FRAG_DADOS = 224
+FRAG_TENTATIVAS = 5
+FRAG_CABECALHO = 2
+SACK_BYTES = 6
+
+
+def transferir(args, perfil, janela, perda, rnd):
+    """Uma transferência. Retorna (concluída, duração em s, quadros enviados)."""
+    total = math.ceil(args.tamanho / FRAG_DADOS)
+    espera = args.espera_ms / 1000.0
+    virada = args.virada_ms / 1000.0
+    ar_sack = perfil.tempo_no_ar(4 + SACK_BYTES)
+
+    recebidos = set()       # No receptor
+    confirmados = set()     # No transmissor
+    base, sem_progresso, t, quadros = 0, 0, 0.0, 0
+    while sem_progresso < FRAG_TENTATIVAS:
+        pendentes = [i for i in range(base, min(base + janela, total)) if i not in confirmados]
+        pedido_chegou = False
+        for i in pendentes:
+            n = args.tamanho - i * FRAG_DADOS if i == total - 1 else FRAG_DADOS
+            t += perfil.tempo_no_ar(4 + FRAG_CABECALHO + n)
+            quadros += 1
+            if rnd.random() >= perda:
+                recebidos.add(i)
+                pedido_chegou = i == pendentes[-1]
+
+        if not pedido_chegou or rnd.random() < perda:
+            t += espera             # Pedido ou SACK perdido: espera inteira
+            sem_progresso += 1
+            continue
+        t += virada + ar_sack
+
+        # SACK: primeiro que falta e os 32 seguintes
+        base_rx = 0
+        while base_rx < total and base_rx in recebidos:
+            base_rx += 1
+        novos = set(range(base_rx)) | {i for i in range(base_rx, min(base_rx + 32, total)) if i in recebidos}
+        progresso = bool(novos - confirmados)
+        confirmados |= novos
+        while base < total and base in confirmados:
+            base += 1
+        if base == total:
+            return True, t, quadros
+        sem_progresso = 0 if progresso else sem_progresso + 1
+    return False, t, quadros
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--tamanho", type=int, default=4096, help="bytes por transferência (padrão: FRAG_MAX_BYTES)")
+    ap.add_argument("--perfil", default="125k/SF7")
+    ap.add_argument("--perdas", default="0,0.05,0.1,0.2,0.3", help="probabilidades de perda de cada quadro")
+    ap.add_argument("--janelas", default="1,4,8,16", help="tamanhos de janela a comparar (1 = parar-e-esperar)")
+    ap.add_argument("--espera-ms", type=float, default=1000.0, help="espera pelo SACK (FRAG_ESPERA_MS)")
+    ap.add_argument("--virada-ms", type=float, default=10.0, help="atraso do receptor até transmitir o SACK")
+    ap.add_argument("--repeticoes", type=int, default=200, help="transferências por ponto")
+    ap.add_argument("--semente", type=int, default=1)
+    args = ap.parse_args()
+
+    perfil = PERFIS[args.perfil]
+    janelas = [int(j) for j in args.janelas.split(",")]
+    total = math.ceil(args.tamanho / FRAG_DADOS)
+    bruta = 8 * FRAG_DADOS / perfil.tempo_no_ar(4 + FRAG_CABECALHO + FRAG_DADOS)
+    print(f"{args.perfil}: {args.tamanho} B em {total} fragmentos; um fragmento cheio sozinho no ar "
+          f"= {bruta:.0f} b/s; espera pelo SACK {args.espera_ms:.0f} ms")
+    print(f"{'perda':>6} |" + "".join(f" {'janela ' + str(j):>10} {'ok':>5} {'q/frag':>6} |" for j in janelas))
+    for perda in map(float, args.perdas.split(",")):
+        linha = f"{100 * perda:5.0f}% |"
+        for j in janelas:
+            rnd = random.Random(args.semente)
+            bytes_ok, tempo, quadros, ok = 0, 0.0, 0, 0
+            for _ in range(args.repeticoes):
+                concluida, t, q = transferir(args, perfil, j, perda, rnd)
+                tempo += t
+                quadros += q
+                if concluida:
+                    ok += 1
+                    bytes_ok += args.tamanho
+            linha += (f" {8 * bytes_ok / tempo:8.0f}b/s {100 * ok / args.repeticoes:4.0f}% "
+                      f"{quadros / (args.repeticoes * total):6.2f} |")
+        print(linha)
+
+
+if __name__ == "__main__":
+    main()
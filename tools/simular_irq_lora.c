@@ -0,0 +1,513 @@
+// Sequências de flags de interrupção do SX127x roteirizadas contra o
+// include/lora.c no host: o driver roda sem alterações sobre um modelo do
+// chip (registradores, FIFO, flags e o nível do DIO0) e das interrupções de
+// GPIO por nível do RP2040.
+//
+//     gcc -O2 -Itools/host -Iinclude tools/simular_irq_lora.c include/lora.c -lm -o simular_irq_lora && ./simular_irq_lora
+//
+// A interrupção entra de novo enquanto o DIO0 estiver alto e habilitado,
+// como no hardware; uma ISR que não baixa o pino nunca termina, e o
+// simulador a interrompe em LIMITE_ENTRADAS como falha. Roteiros:
+//   - RxDone seguidos: o segundo chega durante o atendimento do primeiro;
+//   - RX, ACK automático (TxDone) e RX de novo, e um envio do loop;
+//   - envio do loop com um RxDone (que gera ACK) chegando no meio das
+//     transações, e com um beacon do alarme já no ar: nada é sobrescrito;
+//   - rajada acima de LORA_IRQ_MAX_EVENTS: reentrada para o restante;
+//   - pacote com erro de CRC;
+//   - ValidHeader (DIO3) atendido com o RxDone do pacote anterior pendente:
+//     o filtro de tamanho não rearma a recepção por cima dele;
+//   - DIO0 preso em alto sem flags: a ISR mascara o pino e o monitor de
+//     saúde o devolve.
+// Em todos, nenhuma transação do loop principal pode começar com o DIO0
+// habilitado (a ISR usaria o barramento no meio dela). Como no NVIC, uma
+// interrupção pendente entra assim que o loop desmascara o pino.
+
+#include <stdio.h>
+#include <string.h>
+#include "lora.h"
+#include "hardware/structs/systick.h"
+
+#define PINO_DIO0       10
+#define PINO_CS         17
+#define PINO_HEADER     11
+#define ENDERECO        1
+#define REMETENTE       2
+#define LIMITE_ENTRADAS 1000
+
+#define EXCECAO_TIMER   (16 + 0)    // TIMER_IRQ_0: alarme do monitor de saúde
+#define EXCECAO_GPIO    (16 + 13)   // IO_IRQ_BANK0
+
+spi_inst_t host_spi[2] = {{0}, {1}};
+systick_hw_t host_systick;
+
+static uint64_t _agora_us = 1000000;
+static uint _excecao = 0;
+static int _falhas = 0;
+
+// Interrupções de GPIO
+static gpio_irq_callback_t _callback;
+static bool _irq_habilitada[32];
+
+// Modelo do SX127x
+static struct {
+    uint8_t regs[128];
+    uint8_t fifo[256];
+    uint8_t rx_pos;         // Onde o modem grava o próximo pacote recebido
+    bool preso;             // DIO0 em curto com o 3V3
+    uint32_t rajada;        // Pacotes que ainda chegam, um a cada RxDone lido pela ISR
+    bool cs_baixo;
+    bool tem_endereco;
+    uint8_t endereco;
+    uint32_t transacoes_loop;
+    bool chegar_no_meio;    // Um RxDone na próxima transação do loop
+} _chip;
+
+static lora_radio_t _radio;
+static uint32_t _recebidos;
+static lora_payload_t _ultimo;
+static uint _pino_header;    // DIO3 do próximo iniciar() (0 = sem)
+
+static uint32_t atender_irqs(void);
+static lora_irq_stats_t _antes;
+
+#define DELTA(campo) (lora_irq_stats(&_radio).campo - _antes.campo)
+
+// --- Plataforma ---
+
+// Cada leitura do relógio avança 1 us: as esperas do driver terminam
+uint64_t time_us_64(void) {
+    return _agora_us++;
+}
+
+void sleep_ms(uint32_t ms) {
+    _agora_us += ms * 1000ull;
+}
+
+uint __get_current_exception(void) {
+    return _excecao;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+    out->delay_us = delay_ms * 1000ll;
+    out->callback = callback;
+    out->user_data = user_data;
+    return true;
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+    timer->callback = NULL;
+    return true;
+}
+
+bool lora_pio_spi_init(lora_pio_spi_t *spi, PIO pio, uint sck_pin, uint mosi_pin, uint miso_pin, uint cs_pin, uint32_t hz) {
+    return false;
+}
+
+void lora_pio_spi_transfer(lora_pio_spi_t *spi, uint8_t addr, const uint8_t *tx, uint8_t *rx, size_t len) {
+}
+
+void lora_pio_spi_deinit(lora_pio_spi_t *spi) {
+}
+
+// --- Modelo do SX127x ---
+
+static uint8_t modo(void) {
+    return _chip.regs[REG_01_OP_MODE] & 0x07;
+}
+
+static bool dio0(void) {
+    uint8_t mapa = _chip.regs[REG_40_DIO_MAPPING1] & 0xC0;
+    uint8_t flags = _chip.regs[REG_12_IRQ_FLAGS];
+    return _chip.preso || (mapa == 0x00 && (flags & IRQ_FLAG_RX_DONE)) ||
+           (mapa == 0x40 && (flags & IRQ_FLAG_TX_DONE));
+}
+
+/**
+ * @brief Um quadro termina de chegar: vai para o FIFO depois do anterior,
+ *        como no RX contínuo, e levanta RxDone (e o erro de CRC).
+ */
+static bool chegar_pacote(uint8_t para, uint8_t id, uint8_t flags, bool erro_crc) {
+    if (modo() != MODE_RXCONTINUOUS) {
+        return false;
+    }
+    uint8_t quadro[8] = {para, REMETENTE, id, flags, 'a', 'b', 'c', id};
+    _chip.regs[REG_10_FIFO_RX_CURRENT_ADDR] = _chip.rx_pos;
+    _chip.regs[REG_13_RX_NB_BYTES] = sizeof(quadro);
+    for (size_t i = 0; i < sizeof(quadro); ++i) {
+        _chip.fifo[_chip.rx_pos++] = quadro[i];
+    }
+    _chip.regs[REG_19_PKT_SNR_VALUE] = 20;
+    _chip.regs[REG_1A_PKT_RSSI_VALUE] = 60;
+    _chip.regs[REG_12_IRQ_FLAGS] |= IRQ_FLAG_RX_DONE | (erro_crc ? IRQ_FLAG_PAYLOAD_CRC_ERROR : 0);
+    return true;
+}
+
+/**
+ * @brief A transmissão termina: TxDone e volta sozinho ao standby.
+ */
+static void concluir_tx(void) {
+    if (modo() == MODE_TX) {
+        _chip.regs[REG_12_IRQ_FLAGS] |= IRQ_FLAG_TX_DONE;
+        _chip.regs[REG_01_OP_MODE] = LONG_RANGE_MODE | MODE_STDBY;
+    }
+}
+
+static void escrever(uint8_t reg, uint8_t valor) {
+    switch (reg) {
+        case REG_00_FIFO:
+            _chip.fifo[_chip.regs[REG_0D_FIFO_ADDR_PTR]++] = valor;
+            break;
+        case REG_12_IRQ_FLAGS:
+            _chip.regs[reg] &= ~valor; // Escrever 1 limpa
+            break;
+        case REG_0F_FIFO_RX_BASE_ADDR:
+            _chip.regs[reg] = valor;
+            _chip.rx_pos = valor;
+            break;
+        default:
+            _chip.regs[reg] = valor;
+    }
+}
+
+static uint8_t ler(uint8_t reg) {
+    if (reg == REG_00_FIFO) {
+        return _chip.fifo[_chip.regs[REG_0D_FIFO_ADDR_PTR]++];
+    }
+    uint8_t valor = _chip.regs[reg];
+    // O RSSI é a última leitura de um RxDone: o próximo quadro da rajada
+    // termina enquanto a ISR ainda entrega este
+    if (reg == REG_1A_PKT_RSSI_VALUE && _chip.rajada > 0 && chegar_pacote(ENDERECO, 0x80 | _chip.rajada, 0, false)) {
+        _chip.rajada--;
+    }
+    return valor;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio != PINO_CS) {
+        return;
+    }
+    if (!value) {
+        if (_excecao == 0) {
+            _chip.transacoes_loop++;
+            if (_irq_habilitada[PINO_DIO0]) {
+                printf("  transacao do loop com o DIO0 habilitado\n");
+                _falhas++;
+            }
+            if (_chip.chegar_no_meio) {
+                _chip.chegar_no_meio = false;
+                chegar_pacote(ENDERECO, 20, 0, false);
+            }
+        }
+        _chip.tem_endereco = false;
+    }
+    _chip.cs_baixo = !value;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len && _chip.cs_baixo; ++i) {
+        if (!_chip.tem_endereco) {
+            _chip.endereco = src[i];
+            _chip.tem_endereco = true;
+            continue;
+        }
+        uint8_t reg = _chip.endereco & 0x7F;
+        escrever(reg, src[i]);
+        if (reg != REG_00_FIFO) {
+            _chip.endereco++; // Rajada: endereço incrementado, menos no FIFO
+        }
+    }
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repeated_tx_data, uint8_t *dst, size_t len) {
+    for (size_t i = 0; i < len && _chip.cs_baixo; ++i) {
+        uint8_t reg = _chip.endereco & 0x7F;
+        dst[i] = ler(reg);
+        if (reg != REG_00_FIFO) {
+            _chip.endereco++;
+        }
+    }
+    return (int)len;
+}
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    return baudrate;
+}
+
+void spi_deinit(spi_inst_t *spi) {
+}
+
+uint spi_get_baudrate(const spi_inst_t *spi) {
+    return LORA_SPI_DEFAULT_HZ;
+}
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+}
+
+// --- GPIO ---
+
+void gpio_init(uint gpio) {
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+}
+
+void gpio_pull_up(uint gpio) {
+}
+
+bool gpio_get(uint gpio) {
+    return gpio == PINO_DIO0 && dio0();
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+    if (event_mask != GPIO_IRQ_LEVEL_HIGH) {
+        printf("  pino %u: interrupcao por borda, nao por nivel\n", gpio);
+        _falhas++;
+    }
+    _irq_habilitada[gpio] = enabled;
+    if (enabled && _excecao == 0) {
+        atender_irqs(); // Pendente: entra ao desmascarar
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    _callback = callback;
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+}
+
+/**
+ * @brief Entra na ISR enquanto o DIO0 estiver alto e habilitado.
+ * @return Entradas na interrupção.
+ */
+static uint32_t atender_irqs(void) {
+    uint32_t entradas = 0;
+    while (_irq_habilitada[PINO_DIO0] && dio0()) {
+        if (++entradas > LIMITE_ENTRADAS) {
+            printf("  ISR em laco: DIO0 alto depois de %u entradas\n", LIMITE_ENTRADAS);
+            _falhas++;
+            break;
+        }
+        _excecao = EXCECAO_GPIO;
+        _callback(PINO_DIO0, GPIO_IRQ_LEVEL_HIGH);
+        _excecao = 0;
+    }
+    return entradas;
+}
+
+/**
+ * @brief Uma verificação do monitor de saúde, no contexto do alarme, e as
+ *        interrupções que ela deixar pendentes.
+ */
+static uint32_t verificar_saude(void) {
+    _agora_us += _radio.health_timer.delay_us;
+    _excecao = EXCECAO_TIMER;
+    _radio.health_timer.callback(&_radio.health_timer);
+    _excecao = 0;
+    return atender_irqs();
+}
+
+// --- Roteiros ---
+
+static void ao_receber(lora_payload_t *p) {
+    _recebidos++;
+    _ultimo = *p;
+}
+
+static void conferir(const char *nome, bool ok) {
+    printf("  %-56s %s\n", nome, ok ? "ok" : "FALHA");
+    _falhas += !ok;
+}
+
+/**
+ * @brief Chip novo (registradores zerados) e rádio reinicializado em RX.
+ */
+static void iniciar(const char *roteiro, bool acks) {
+    printf("%s\n", roteiro);
+    memset(&_chip, 0, sizeof(_chip));
+    lora_config_t config = {
+        .spi_port = spi0,
+        .sck_pin = 18,
+        .mosi_pin = 19,
+        .miso_pin = 16,
+        .transport = LORA_TRANSPORT_SPI,
+        .interrupt_pin = PINO_DIO0,
+        .cs_pin = PINO_CS,
+        .freq = 915.0f,
+        .tx_power = 17,
+        .this_address = ENDERECO,
+        .modem = BW125_CR45_SF128,
+        .acks = acks,
+        .header_pin = _pino_header,
+    };
+    if (!lora_init(&_radio, &config) || !lora_health_start(&_radio, 250, 500, 0)) {
+        conferir("lora_init e lora_health_start", false);
+    }
+    lora_on_receive(&_radio, ao_receber);
+    _recebidos = 0;
+    _antes = lora_irq_stats(&_radio);
+}
+
+static void roteiro_rx_seguidos(void) {
+    iniciar("RxDone seguidos", false);
+    _chip.rajada = 1;
+    chegar_pacote(ENDERECO, 1, 0, false);
+    uint32_t entradas = atender_irqs();
+    conferir("uma entrada atende os dois RxDone", entradas == 1 && DELTA(events) == 2);
+    conferir("dois pacotes entregues, o segundo por ultimo", _recebidos == 2 && _ultimo.header_id == 0x81);
+    conferir("DIO0 baixo e flags limpos", !dio0() && _chip.regs[REG_12_IRQ_FLAGS] == 0);
+}
+
+static void roteiro_ack(void) {
+    iniciar("RX, ACK e RX", true);
+    chegar_pacote(ENDERECO, 7, 0, false);
+    atender_irqs();
+    conferir("pacote entregue e ACK no FIFO",
+             _recebidos == 1 && _chip.fifo[0] == REMETENTE && _chip.fifo[2] == 7 && _chip.fifo[3] == FLAGS_ACK);
+    conferir("chip em TX com o DIO0 em TxDone", modo() == MODE_TX && (_chip.regs[REG_40_DIO_MAPPING1] & 0xC0) == 0x40);
+
+    concluir_tx();
+    uint32_t entradas = atender_irqs();
+    conferir("TxDone: uma entrada e volta ao RX continuo",
+             entradas == 1 && modo() == MODE_RXCONTINUOUS && (_chip.regs[REG_40_DIO_MAPPING1] & 0xC0) == 0x00);
+
+    chegar_pacote(ENDERECO, 8, FLAGS_ACK, false);
+    atender_irqs();
+    conferir("ACK recebido depois da propria TX", _radio.ack_received && _radio.last_ack_payload.header_id == 8);
+
+    // Envio do loop: o TxDone deixa o rádio em standby, e o loop volta ao RX
+    uint32_t transacoes = _chip.transacoes_loop;
+    uint8_t dados[3] = {1, 2, 3};
+    lora_send(&_radio, dados, sizeof(dados), REMETENTE);
+    concluir_tx();
+    atender_irqs();
+    lora_set_mode_rx_continuous(&_radio);
+    conferir("envio do loop: TxDone atendido, loop mascarou o DIO0",
+             _chip.transacoes_loop > transacoes && modo() == MODE_RXCONTINUOUS && DELTA(stale_events) == 0);
+}
+
+static void roteiro_tx_no_meio(void) {
+    iniciar("Envio do loop com ISR e beacon", true);
+    static const uint8_t dados[3] = {4, 5, 6};
+    static const uint8_t quadro[7] = {REMETENTE, ENDERECO, 0, 0, 4, 5, 6};
+    _radio.last_header_id = 0;
+
+    // O RxDone chega na primeira transação (o standby); ACK automático ligado
+    _chip.chegar_no_meio = true;
+    uint32_t recebidos = _recebidos;
+    bool enviado = lora_send(&_radio, dados, sizeof(dados), REMETENTE);
+    conferir("RxDone no meio: quadro do loop inteiro no FIFO",
+             enviado && modo() == MODE_TX && _chip.regs[REG_22_PAYLOAD_LENGTH] == sizeof(quadro) &&
+             memcmp(_chip.fifo, quadro, sizeof(quadro)) == 0);
+    conferir("ISR so depois da sequencia (nenhum ACK no meio)", _recebidos == recebidos);
+
+    // Com o quadro no ar, o beacon do alarme espera e o envio do loop não o aborta
+    concluir_tx();
+    atender_irqs();
+    lora_set_mode_rx_continuous(&_radio);
+    static const uint8_t beacon[2] = {0xBE, 0xAC};
+    _excecao = EXCECAO_TIMER;
+    bool b = lora_send_async(&_radio, beacon, sizeof(beacon), BROADCAST_ADDRESS, FLAGS_BEACON);
+    _excecao = 0;
+    enviado = lora_send(&_radio, dados, sizeof(dados), REMETENTE);
+    conferir("beacon no ar: o envio do loop espera e nao o sobrescreve",
+             b && !enviado && _chip.fifo[0] == BROADCAST_ADDRESS && _chip.fifo[4] == 0xBE);
+}
+
+static void roteiro_limite(void) {
+    iniciar("Rajada acima do limite por entrada", false);
+    _chip.rajada = LORA_IRQ_MAX_EVENTS;
+    chegar_pacote(ENDERECO, 1, 0, false);
+    uint32_t entradas = atender_irqs();
+    conferir("para no limite e entra de novo para o restante",
+             entradas == 2 && DELTA(bound_hits) == 1 && DELTA(events_per_entry[LORA_IRQ_MAX_EVENTS]) == 1);
+    conferir("todos os pacotes entregues", _recebidos == LORA_IRQ_MAX_EVENTS + 1);
+}
+
+static void roteiro_crc(void) {
+    iniciar("Erro de CRC", false);
+    chegar_pacote(ENDERECO, 1, 0, true);
+    atender_irqs();
+    conferir("descartado e contado", _recebidos == 0 && DELTA(crc_errors) == 1 && !dio0());
+}
+
+/**
+ * @brief Uma entrada na ISR do DIO3 (ValidHeader).
+ */
+static void atender_header(void) {
+    _chip.regs[REG_12_IRQ_FLAGS] |= IRQ_FLAG_VALID_HEADER;
+    _excecao = EXCECAO_GPIO;
+    _callback(PINO_HEADER, GPIO_IRQ_LEVEL_HIGH);
+    _excecao = 0;
+}
+
+static void roteiro_header(void) {
+    _pino_header = PINO_HEADER;
+    iniciar("ValidHeader com RxDone pendente", false);
+    _pino_header = 0;
+    lora_accept_length(&_radio, 4, 6); // Os quadros do simulador têm 8 bytes
+
+    // O RxDone de um pacote bom ainda não atendido quando o DIO3 entra
+    chegar_pacote(ENDERECO, 30, 0, false);
+    atender_header();
+    conferir("filtro nao rearma com RxDone pendente",
+             DELTA(length_rejects) == 0 && (_chip.regs[REG_12_IRQ_FLAGS] & IRQ_FLAG_RX_DONE));
+    atender_irqs();
+    conferir("pacote anterior entregue pelo DIO0", _recebidos == 1 && _ultimo.header_id == 30);
+
+    // Sem RxDone pendente, um tamanho fora da janela é recusado
+    _chip.regs[REG_13_RX_NB_BYTES] = 40;
+    atender_header();
+    conferir("sem RxDone pendente: tamanho fora da janela recusado",
+             DELTA(length_rejects) == 1 && modo() == MODE_RXCONTINUOUS);
+}
+
+static void roteiro_dio0_preso(void) {
+    iniciar("DIO0 preso em alto sem flags", false);
+    _chip.preso = true;
+    uint32_t entradas = atender_irqs();
+    conferir("ISR mascara o pino depois das entradas vazias",
+             entradas == LORA_IRQ_MAX_VAZIAS && DELTA(dio0_masks) == 1 && !_irq_habilitada[PINO_DIO0]);
+
+    // Mascarado, o pino continua alto mas não é mais "IRQ perdida"
+    entradas = verificar_saude();
+    lora_health_t h = lora_health_stats(&_radio);
+    conferir("monitor devolve o pino; ainda preso, a ISR mascara de novo",
+             h.dio0_unmasks == 1 && h.missed_irqs == 0 && entradas == LORA_IRQ_MAX_VAZIAS && DELTA(dio0_masks) == 2);
+
+    _chip.preso = false;
+    entradas = verificar_saude();
+    h = lora_health_stats(&_radio);
+    conferir("solto: pino devolvido e habilitado", h.dio0_unmasks == 2 && entradas == 0 && _irq_habilitada[PINO_DIO0]);
+
+    chegar_pacote(ENDERECO, 9, 0, false);
+    atender_irqs();
+    conferir("recepcao normal depois", _recebidos == 1 && _ultimo.header_id == 9);
+
+    // Entradas vazias isoladas (flag já limpo pelo monitor) não acumulam
+    _antes = lora_irq_stats(&_radio);
+    for (int i = 0; i < 3 * LORA_IRQ_MAX_VAZIAS; ++i) {
+        _chip.preso = true;
+        _excecao = EXCECAO_GPIO;
+        _callback(PINO_DIO0, GPIO_IRQ_LEVEL_HIGH);
+        _excecao = 0;
+        _chip.preso = false;
+        chegar_pacote(ENDERECO, 10, 0, false);
+        atender_irqs();
+    }
+    conferir("entradas vazias intercaladas com eventos nao mascaram", DELTA(dio0_masks) == 0 && _irq_habilitada[PINO_DIO0]);
+}
+
+int main(void) {
+    roteiro_rx_seguidos();
+    roteiro_ack();
+    roteiro_tx_no_meio();
+    roteiro_limite();
+    roteiro_crc();
+    roteiro_header();
+    roteiro_dio0_preso();
+    printf("%s\n", _falhas ? "FALHA" : "OK");
+    return _falhas ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""
+Compara ALOHA puro com o superquadro TDMA sincronizado por beacon
+(include/tdma.c) numa rede de transmissores com um receptor.
+
+Modelo:
+  - cada nó gera leituras a intervalos exponenciais de média --periodo e
+    guarda até --fila delas; no ALOHA cada leitura é enviada na hora, no
+    TDMA uma por superquadro, no slot do nó;
+  - o receptor atribui slots como o firmware: um remetente novo ouvido
+    ganha o primeiro slot livre no beacon seguinte; sem vaga, ou antes
+    disso, o nó usa um slot de contenção sorteado, com recuo exponencial
+    (transmite com probabilidade 1/2^k após k tentativas sem ACK);
+  - o beacon se perde para cada nó com probabilidade --perda-beacon; o nó
+    então extrapola o superquadro pelo próprio relógio, que deriva até
+    --ppm do receptor;
+  - um pacote se perde se sobrepuser outro no ar (sem captura) ou uma
+    transmissão do receptor (beacon ou ACK: o rádio é half-duplex). Todo
+    pacote entregue é confirmado com um ACK de 4 bytes.
+
+Uso:
+    python3 tools/simular_tdma.py
+    python3 tools/simular_tdma.py --nos 5,10,20,40 --periodo 1.5
+"""
+
+import argparse
+import bisect
+import random
+
+from simular_adr import PERFIS
+
+# Mesmos valores de include/config.h
+TDMA_SLOTS = 20
+TDMA_SLOTS_LIVRES = 3
+TDMA_SLOT_MS = 150
+TDMA_GUARDA_US = 2000
+TDMA_CABECALHO = 12
+
+
+class No:
+    def __init__(self, ident, rnd, args):
+        self.ident = ident
+        self.ppm = rnd.uniform(-args.ppm, args.ppm) * 1e-6
+        self.fila = 0
+        self.slot = None
+        self.slot_anunciado = None
+        self.recuo = 0              # Tentativas seguidas sem ACK na contenção
+        self.descartes = 0
+
+
+def gerar_leituras(rnd, args):
+    """Instantes das leituras de cada nó, iguais nos dois esquemas."""
+    leituras = []
+    for _ in range(args.n):
+        t, lista = rnd.uniform(0, args.periodo), []
+        while t < args.duracao:
+            lista.append(t)
+            t += rnd.expovariate(1.0 / args.periodo)
+        leituras.append(lista)
+    return leituras
+
+
+def entregar(envios, ocupado_rx, ar_ack):
+    """
+    Marca os envios (inicio, fim, no) entregues. `ocupado_rx` são as
+    transmissões já conhecidas do receptor (beacons); os ACKs entram à
+    medida que os pacotes são entregues, em ordem de término.
+    """
+    envios.sort()
+    colidiu = [False] * len(envios)
+    fim_max, dono_max = -1.0, -1
+    for i, (ini, fim, _) in enumerate(envios):
+        if ini < fim_max:
+            colidiu[i] = True
+            colidiu[dono_max] = True
+        if fim > fim_max:
+            fim_max, dono_max = fim, i
+
+    ocupado = sorted(ocupado_rx)
+    inicios = [a for a, _ in ocupado]
+    entregues = []
+    for i in sorted(range(len(envios)), key=lambda k: envios[k][1]):
+        ini, fim, no = envios[i]
+        if colidiu[i]:
+            continue
+        # Transmissões do receptor que começaram antes do fim do pacote
+        k = bisect.bisect_left(inicios, fim)
+        if any(b > ini for a, b in ocupado[max(0, k - 8):k]):
+            continue
+        entregues.append(envios[i])
+        j = bisect.bisect_left(inicios, fim)
+        inicios.insert(j, fim)
+        ocupado.insert(j, (fim, fim + ar_ack))
+    return entregues
+
+
+def simular_aloha(args, leituras, perfil):
+    ar = perfil.tempo_no_ar(args.carga + 4)
+    envios = [(t, t + ar, i) for i, lista in enumerate(leituras) for t in lista]
+    entregues = entregar(envios, [], perfil.tempo_no_ar(4))
+    return len(envios), len(entregues), 0
+
+
+def simular_tdma(args, leituras, perfil, rnd):
+    ar = perfil.tempo_no_ar(args.carga + 4)
+    slot_s = TDMA_SLOT_MS / 1000.0
+    superquadro = slot_s * TDMA_SLOTS
+    primeiro_livre = TDMA_SLOTS - TDMA_SLOTS_LIVRES
+    nos = [No(i, rnd, args) for i in range(args.n)]
+    proxima = [0] * args.n                      # Índice da próxima leitura de cada nó
+    dono = {}                                   # slot -> nó
+    pendentes = []                              # Nós ouvidos sem slot, atribuídos no próximo beacon
+    envios, beacons = [], []
+    referencia = [None] * args.n                # (início do superquadro no relógio do nó, instante real)
+    t = 0.0
+
+    while t < args.duracao:
+        contencao = set()
+        # Beacon: anuncia as atribuições pendentes
+        for no in pendentes:
+            livres = [s for s in range(1, primeiro_livre) if s not in dono]
+            if livres:
+                dono[livres[0]] = no
+                nos[no].slot_anunciado = livres[0]
+        pendentes = []
+        n_pares = len(dono)
+        ar_beacon = perfil.tempo_no_ar(4 + TDMA_CABECALHO + 2 * n_pares)
+        beacons.append((t, t + ar_beacon))
+
+        for no in nos:
+            if rnd.random() >= args.perda_beacon:
+                referencia[no.ident] = (t, t)   # Sincronizado neste beacon
+                if no.slot_anunciado is not None:
+                    no.slot, no.slot_anunciado = no.slot_anunciado, None
+            elif referencia[no.ident] is None:
+                continue                        # Nunca ouviu um beacon: ainda em silêncio
+            else:
+                # Extrapola o superquadro pelo relógio local, que deriva
+                base, real = referencia[no.ident]
+                referencia[no.ident] = (base + superquadro, real + superquadro * (1 + no.ppm))
+
+            # Leituras geradas até o fim deste superquadro entram na fila
+            lista = leituras[no.ident]
+            while proxima[no.ident] < len(lista) and lista[proxima[no.ident]] < t + superquadro:
+                proxima[no.ident] += 1
+                if no.fila < args.fila:
+                    no.fila += 1
+                else:
+                    no.descartes += 1
+            if no.fila == 0:
+                continue
+            if no.slot is not None:
+                slot = no.slot
+            elif rnd.random() < 1.0 / (1 << min(no.recuo, 6)):
+                slot = rnd.randrange(primeiro_livre, TDMA_SLOTS)
+                contencao.add(no.ident)
+            else:
+                continue
+            _, real = referencia[no.ident]
+            ini = real + slot * slot_s * (1 + no.ppm) + TDMA_GUARDA_US * 1e-6
+            envios.append((ini, ini + ar, no.ident))
+            no.fila -= 1
+        t += superquadro
+
+        # Remetentes novos entregues neste superquadro pedem slot
+        entregues_sq = {no for _, _, no in entregar([e for e in envios if e[0] >= t - superquadro],
+                                                    beacons[-2:], perfil.tempo_no_ar(4))}
+        for no in contencao:
+            nos[no].recuo = 0 if no in entregues_sq else nos[no].recuo + 1
+        for no in entregues_sq:
+            if nos[no].slot is None and no not in dono.values() and no not in pendentes:
+                pendentes.append(no)
+
+    entregues = entregar(envios, beacons, perfil.tempo_no_ar(4))
+    descartes = sum(no.descartes for no in nos)
+    return len(envios), len(entregues), descartes
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--nos", default="4,8,16,24,32,48", help="quantidades de nós a comparar")
+    ap.add_argument("--periodo", type=float, default=2 * TDMA_SLOTS * TDMA_SLOT_MS / 1000.0,
+                    help="intervalo médio entre leituras de cada nó, em s (padrão: dois superquadros)")
+    ap.add_argument("--duracao", type=float, default=3600.0, help="tempo simulado, em s")
+    ap.add_argument("--carga", type=int, default=20, help="bytes de dados por pacote (sem o cabeçalho)")
+    ap.add_argument("--fila", type=int, default=4, help="leituras guardadas por nó no TDMA")
+    ap.add_argument("--perfil", default="125k/SF7")
+    ap.add_argument("--perda-beacon", type=float, default=0.02, help="probabilidade de um nó perder o beacon")
+    ap.add_argument("--ppm", type=float, default=20.0, help="deriva máxima dos relógios dos nós")
+    ap.add_argument("--semente", type=int, default=1)
+    args = ap.parse_args()
+
+    perfil = PERFIS[args.perfil]
+    ar = perfil.tempo_no_ar(args.carga + 4)
+    print(f"{args.perfil}: pacote de {args.carga + 4} B = {ar * 1000:.1f} ms no ar; superquadro de "
+          f"{TDMA_SLOTS} x {TDMA_SLOT_MS} ms ({TDMA_SLOTS - 1 - TDMA_SLOTS_LIVRES} atribuíveis, "
+          f"{TDMA_SLOTS_LIVRES} de contenção); uma leitura a cada {args.periodo:.1f} s por nó")
+    print(f"{'nos':>4} {'carga':>7} | {'ALOHA entrega':>13} {'vazao':>8} | "
+          f"{'TDMA entrega':>12} {'vazao':>8} {'fila cheia':>10} | {'ganho':>6}")
+    for n in map(int, args.nos.split(",")):
+        args.n = n
+        leituras = gerar_leituras(random.Random(args.semente), args)
+        total = sum(len(lista) for lista in leituras)
+        g = total * ar / args.duracao
+        env_a, ent_a, _ = simular_aloha(args, leituras, perfil)
+        env_t, ent_t, desc_t = simular_tdma(args, leituras, perfil, random.Random(args.semente + 1))
+        vazao_a = 8 * args.carga * ent_a / args.duracao
+        vazao_t = 8 * args.carga * ent_t / args.duracao
+        print(f"{n:4d} {g:5.2f}Erl | {100 * ent_a / max(total, 1):12.1f}% {vazao_a:6.0f}b/s | "
+              f"{100 * ent_t / max(total, 1):11.1f}% {vazao_t:6.0f}b/s {desc_t:10d} | "
+              f"x{vazao_t / max(vazao_a, 1e-9):5.2f}")
+
+
+if __name__ == "__main__":
+    main()
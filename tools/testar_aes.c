@@ -0,0 +1,119 @@
+// Vetores de resposta conhecida do include/aes.c no host, mais completos que
+// os do seguranca_autoteste (que roda no alvo, com pouca flash para eles):
+// AES-128 do FIPS-197, os quatro blocos do CTR do SP 800-38A F.5.1 e os
+// quatro exemplos de CMAC da RFC 4493, este também em partes divididas em
+// todas as posições possíveis, como na verificação do MIC.
+//
+//     gcc -O2 -Iinclude tools/testar_aes.c include/aes.c -o testar_aes && ./testar_aes
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "aes.h"
+
+static int _falhas = 0;
+
+static void resultado(const char *nome, bool ok) {
+    printf("%-32s %s\n", nome, ok ? "ok" : "FALHA");
+    _falhas += !ok;
+}
+
+static void conferir(const char *nome, const uint8_t *obtido, const uint8_t *esperado, size_t len) {
+    bool ok = memcmp(obtido, esperado, len) == 0;
+    resultado(nome, ok);
+    if (!ok) {
+        printf("  obtido:   ");
+        for (size_t i = 0; i < len; ++i) {
+            printf("%02x", obtido[i]);
+        }
+        printf("\n  esperado: ");
+        for (size_t i = 0; i < len; ++i) {
+            printf("%02x", esperado[i]);
+        }
+        printf("\n");
+    }
+}
+
+int main(void) {
+    // FIPS-197, apêndice C.1
+    static const uint8_t k_fips[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                       0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    static const uint8_t p_fips[16] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                       0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    static const uint8_t c_fips[16] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+                                       0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+    // SP 800-38A e RFC 4493: mesma chave e mesma mensagem de 64 bytes
+    static const uint8_t k[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                  0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+    static const uint8_t msg[64] = {
+        0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+        0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+        0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+        0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+    };
+    static const uint8_t iv[16] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+                                   0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+    static const uint8_t ctr[64] = {
+        0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+        0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+        0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+        0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee,
+    };
+    static const struct {
+        size_t len;
+        uint8_t mac[16];
+    } cmac[] = {
+        {0, {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46}},
+        {16, {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c}},
+        {40, {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27}},
+        {64, {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe}},
+    };
+
+    aes128_t aes;
+    aes_cmac_t c;
+    uint8_t buf[64];
+    char nome[64];
+
+    aes128_init(&aes, k_fips);
+    aes128_cifrar_bloco(&aes, p_fips, buf);
+    conferir("FIPS-197 C.1", buf, c_fips, 16);
+
+    aes128_init(&aes, k);
+    memcpy(buf, msg, 64);
+    aes128_ctr(&aes, iv, buf, 64);
+    conferir("SP 800-38A F.5.1 CTR", buf, ctr, 64);
+    aes128_ctr(&aes, iv, buf, 64);
+    conferir("SP 800-38A F.5.2 (decifrar)", buf, msg, 64);
+
+    // Comprimentos que não fecham o bloco: prefixo do fluxo completo
+    bool prefixos = true;
+    for (size_t n = 1; n < 64; ++n) {
+        memcpy(buf, msg, n);
+        aes128_ctr(&aes, iv, buf, n);
+        prefixos &= memcmp(buf, ctr, n) == 0;
+    }
+    resultado("CTR com 1..63 bytes", prefixos);
+
+    for (size_t i = 0; i < sizeof(cmac) / sizeof(cmac[0]); ++i) {
+        aes_cmac_iniciar(&c, &aes);
+        aes_cmac_atualizar(&c, msg, cmac[i].len);
+        aes_cmac_finalizar(&c, buf);
+        snprintf(nome, sizeof(nome), "RFC 4493 CMAC %zu bytes", cmac[i].len);
+        conferir(nome, buf, cmac[i].mac, 16);
+
+        bool partes = true;
+        for (size_t corte = 0; corte <= cmac[i].len; ++corte) {
+            aes_cmac_iniciar(&c, &aes);
+            aes_cmac_atualizar(&c, msg, corte);
+            aes_cmac_atualizar(&c, msg + corte, cmac[i].len - corte);
+            aes_cmac_finalizar(&c, buf);
+            partes &= memcmp(buf, cmac[i].mac, 16) == 0;
+        }
+        snprintf(nome, sizeof(nome), "RFC 4493 CMAC %zu bytes em partes", cmac[i].len);
+        resultado(nome, partes);
+    }
+
+    printf("%s\n", _falhas ? "FALHA" : "OK");
+    return _falhas ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+// Ida e volta do formato compacto de leituras (include/amostras.c) no host:
+// amostras_codificar, o lado do transmissor, que o firmware do receptor não
+// chama, contra o amostras_iniciar/amostras_proxima do receptor. Confere
+// séries aleatórias, os extremos das faixas dos sensores contra
+// AMOSTRAS_BYTES_MAX, quadros truncados e cabeçalhos inválidos, e mede a
+// vazão do decodificador.
+//
+//     gcc -O2 -Iinclude tools/testar_amostras.c include/amostras.c -o testar_amostras && ./testar_amostras [leituras]
+//
+// A vazão é de CPU do host; no alvo vale a proporção para o tempo de
+// processar_pacote, não o número absoluto.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "amostras.h"
+
+// Faixas físicas dos sensores, em décimos (as de AMOSTRAS_BYTES_MAX)
+#define T_MIN   -400
+#define T_MAX   850
+#define H_MIN   0
+#define H_MAX   1000
+#define P_MIN   3000
+#define P_MAX   11000
+
+static int _falhas = 0;
+static uint32_t _semente = 1;
+
+static void resultado(const char *nome, bool ok) {
+    printf("  %-58s %s\n", nome, ok ? "ok" : "FALHA");
+    _falhas += !ok;
+}
+
+static uint32_t aleatorio(void) {
+    _semente = _semente * 1103515245u + 12345u;
+    return _semente >> 8;
+}
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ * @brief Série como a de um transmissor: passeio aleatório curto com um
+ *        salto de pressão de vez em quando (a mesma do compactar_amostras.py).
+ */
+static void serie(amostra_t *a, uint32_t n) {
+    static const int8_t passo_t[4] = {-1, 0, 0, 1};
+    amostra_t v = {251, 450, 10125};
+    for (uint32_t i = 0; i < n; ++i) {
+        v.temp_x10 += passo_t[aleatorio() % 4];
+        v.umid_x10 += (int32_t)(aleatorio() % 5) - 2;
+        v.pres_x10 += (int32_t)(aleatorio() % 3) - 1 + (i % 500 == 0 ? 5 : 0);
+        a[i] = v;
+    }
+}
+
+/**
+ * @brief Decodifica um quadro inteiro.
+ * @return Leituras decodificadas, ou -1 se o leitor recusar ou acusar erro.
+ */
+static int decodificar(const uint8_t *quadro, size_t len, amostra_t *saida) {
+    amostras_leitor_t leitor;
+    if (!amostras_iniciar(&leitor, quadro, len)) {
+        return -1;
+    }
+    int n = 0;
+    while (amostras_proxima(&leitor, &saida[n])) {
+        n++;
+    }
+    return leitor.erro ? -1 : n;
+}
+
+static bool ida_e_volta(const amostra_t *a, uint8_t n, size_t *bytes) {
+    uint8_t quadro[2 + 15 * AMOSTRAS_MAX];
+    amostra_t lidas[AMOSTRAS_MAX];
+    size_t len = amostras_codificar(a, n, quadro, sizeof(quadro));
+    if (bytes) {
+        *bytes = len;
+    }
+    return len > 0 && decodificar(quadro, len, lidas) == n && memcmp(lidas, a, n * sizeof(amostra_t)) == 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t total = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000000;
+    if (total < AMOSTRAS_MAX) {
+        total = AMOSTRAS_MAX;
+    }
+    amostra_t *leituras = malloc(total * sizeof(amostra_t));
+    if (leituras == NULL) {
+        return 1;
+    }
+
+    printf("ida e volta\n");
+    serie(leituras, total);
+    bool ok = true;
+    for (uint8_t n = 1; n <= AMOSTRAS_MAX; ++n) {
+        for (uint32_t i = 0; i + n <= total && i + n <= 4096; i += n) {
+            ok &= ida_e_volta(&leituras[i], n, NULL);
+        }
+    }
+    resultado("serie com 1 a AMOSTRAS_MAX leituras por quadro", ok);
+
+    // Valores grandes (até ±2^29, diferenças ainda dentro do int32):
+    // varints de 5 bytes
+    ok = true;
+    for (int k = 0; k < 2000; ++k) {
+        amostra_t a[AMOSTRAS_MAX];
+        for (int i = 0; i < AMOSTRAS_MAX; ++i) {
+            a[i] = (amostra_t){(int32_t)((aleatorio() << 6) ^ aleatorio()) - (1 << 29),
+                               (int32_t)(aleatorio() << 5) - (1 << 28), -(int32_t)aleatorio()};
+        }
+        ok &= ida_e_volta(a, (uint8_t)(1 + k % AMOSTRAS_MAX), NULL);
+    }
+    resultado("valores ate +-2^29 (varints de 5 bytes)", ok);
+
+    // Pior caso nas faixas dos sensores: extremos alternados
+    ok = true;
+    size_t maior = 0;
+    for (int k = 0; k < 1000; ++k) {
+        amostra_t a[AMOSTRAS_MAX];
+        for (int i = 0; i < AMOSTRAS_MAX; ++i) {
+            bool alto = (i + k) & 1;
+            a[i] = (amostra_t){alto ? T_MAX : T_MIN, alto ? H_MAX : H_MIN, alto ? P_MAX : P_MIN};
+            if (k > 0) {
+                a[i].temp_x10 = T_MIN + (int32_t)(aleatorio() % (T_MAX - T_MIN + 1));
+                a[i].umid_x10 = H_MIN + (int32_t)(aleatorio() % (H_MAX - H_MIN + 1));
+                a[i].pres_x10 = P_MIN + (int32_t)(aleatorio() % (P_MAX - P_MIN + 1));
+            }
+        }
+        size_t len;
+        ok &= ida_e_volta(a, AMOSTRAS_MAX, &len);
+        maior = len > maior ? len : maior;
+    }
+    char nome[80];
+    snprintf(nome, sizeof(nome), "faixas dos sensores: maior quadro %zu <= AMOSTRAS_BYTES_MAX (%d)", maior,
+             AMOSTRAS_BYTES_MAX);
+    resultado(nome, ok && maior <= AMOSTRAS_BYTES_MAX);
+
+    printf("quadros invalidos\n");
+    uint8_t quadro[2 + 15 * AMOSTRAS_MAX];
+    amostra_t lidas[AMOSTRAS_MAX];
+    size_t len = amostras_codificar(leituras, 8, quadro, sizeof(quadro));
+    ok = true;
+    for (size_t corte = 2; corte < len; ++corte) {
+        ok &= decodificar(quadro, corte, lidas) == -1;
+    }
+    resultado("todo prefixo do quadro acusa erro", ok);
+    resultado("texto, magico errado, n = 0 e n > AMOSTRAS_MAX recusados",
+              decodificar((const uint8_t *)"T:25.1,H:45.0,P:1012.5", 22, lidas) == -1 &&
+              decodificar((const uint8_t[]){0xC6, 1, 0, 0, 0}, 5, lidas) == -1 &&
+              decodificar((const uint8_t[]){AMOSTRAS_MAGICO, 0}, 2, lidas) == -1 &&
+              decodificar((const uint8_t[]){AMOSTRAS_MAGICO, AMOSTRAS_MAX + 1, 0, 0, 0}, 5, lidas) == -1);
+    resultado("varint de mais de 5 bytes recusado",
+              decodificar((const uint8_t[]){AMOSTRAS_MAGICO, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0, 0}, 10,
+                          lidas) == -1);
+    bool capacidade = true;
+    for (size_t c = 0; c < len; ++c) {
+        capacidade &= amostras_codificar(leituras, 8, quadro, c) == 0;
+    }
+    resultado("codificar sem espaco devolve 0 em toda capacidade menor",
+              capacidade && amostras_codificar(leituras, 8, quadro, len) == len &&
+              amostras_codificar(leituras, 0, quadro, sizeof(quadro)) == 0 &&
+              amostras_codificar(leituras, AMOSTRAS_MAX + 1, quadro, sizeof(quadro)) == 0);
+
+    // Vazão: a série inteira em quadros de 8 leituras, como o
+    // compactar_amostras.py por padrão
+    const uint8_t por_quadro = 8;
+    uint32_t n_quadros = total / por_quadro;
+    uint8_t *quadros = malloc((size_t)n_quadros * (2 + 15 * por_quadro));
+    size_t *tamanhos = malloc(n_quadros * sizeof(size_t));
+    if (quadros == NULL || tamanhos == NULL) {
+        return 1;
+    }
+    size_t bytes = 0;
+    double inicio = agora_ns();
+    for (uint32_t q = 0; q < n_quadros; ++q) {
+        tamanhos[q] = amostras_codificar(&leituras[q * por_quadro], por_quadro, quadros + bytes, 2 + 15 * por_quadro);
+        bytes += tamanhos[q];
+    }
+    double codificar_ns = agora_ns() - inicio;
+
+    int64_t soma = 0;
+    uint32_t decodificadas = 0;
+    inicio = agora_ns();
+    const uint8_t *p = quadros;
+    for (uint32_t q = 0; q < n_quadros; ++q) {
+        amostras_leitor_t leitor;
+        amostra_t a;
+        if (amostras_iniciar(&leitor, p, tamanhos[q])) {
+            while (amostras_proxima(&leitor, &a)) {
+                soma += a.temp_x10 + a.umid_x10 + a.pres_x10;
+                decodificadas++;
+            }
+        }
+        p += tamanhos[q];
+    }
+    double decodificar_ns = agora_ns() - inicio;
+
+    int64_t esperada = 0;
+    for (uint32_t i = 0; i < n_quadros * por_quadro; ++i) {
+        esperada += leituras[i].temp_x10 + leituras[i].umid_x10 + leituras[i].pres_x10;
+    }
+    resultado("vazao: todas as leituras decodificadas e iguais", decodificadas == n_quadros * por_quadro &&
+              soma == esperada);
+
+    printf("%lu leituras em quadros de %u: %.2f bytes por leitura (com o cabecalho LoRa de 4)\n",
+           (unsigned long)decodificadas, por_quadro, (double)(bytes + 4u * n_quadros) / decodificadas);
+    printf("codificacao (C): %.0f leituras/s, %.1f ns por leitura\n", decodificadas / codificar_ns * 1e9,
+           codificar_ns / decodificadas);
+    printf("decodificacao (C): %.0f leituras/s, %.1f ns por leitura\n", decodificadas / decodificar_ns * 1e9,
+           decodificar_ns / decodificadas);
+    printf("%s\n", _falhas ? "FALHA" : "OK");
+    free(quadros);
+    free(tamanhos);
+    free(leituras);
+    return _falhas ? 1 : 0;
+}
@@ -0,0 +1,300 @@
+// Estatísticas do enlace (include/link_stats.c) no host, contra referências
+// em double calculadas sobre a mesma sequência: Welford (média e desvio),
+// EWMA, P² do percentil LINK_PERCENTIL contra o percentil exato da amostra
+// ordenada, e a perda inferida das lacunas de header_id (perdas, duplicados,
+// volta do contador em 255, reinício do transmissor e a EWMA da perda).
+//
+//     gcc -O2 -fsanitize=undefined -fno-sanitize-recover -Itools/host -Iinclude tools/testar_link_stats.c include/link_stats.c -lm -o testar_link_stats && ./testar_link_stats [amostras]
+//
+// Com -fsanitize=undefined um estouro de inteiro com sinal ou um
+// deslocamento de valor negativo aborta o teste.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "link_stats.h"
+#include "config.h"
+
+#define ALFA (1.0 / (1 << LINK_EWMA_SHIFT))
+
+static int _falhas = 0;
+static uint32_t _semente = 1;
+static uint64_t _agora_us = 1000000;
+
+uint64_t time_us_64(void) {
+    return _agora_us;
+}
+
+static void resultado(const char *nome, bool ok) {
+    printf("  %-58s %s\n", nome, ok ? "ok" : "FALHA");
+    _falhas += !ok;
+}
+
+static uint32_t aleatorio(void) {
+    _semente = _semente * 1103515245u + 12345u;
+    return _semente >> 8;
+}
+
+/**
+ * @brief Aproximadamente normal (soma de 12 uniformes), em torno de `media`.
+ */
+static int16_t normal(int media, int desvio) {
+    int32_t soma = 0;
+    for (int i = 0; i < 12; ++i) {
+        soma += (int32_t)(aleatorio() % 1001);
+    }
+    return (int16_t)(media + (soma - 6000) * desvio / 1000);
+}
+
+static int comparar(const void *a, const void *b) {
+    return *(const int16_t *)a - *(const int16_t *)b;
+}
+
+/**
+ * @brief P² de referência em double (Jain & Chlamtac, 1985).
+ */
+typedef struct {
+    double q[5], n[5], d[5];
+    uint32_t amostras;
+} p2_ref_t;
+
+static void p2_ref_adicionar(p2_ref_t *r, double x) {
+    const double p = LINK_PERCENTIL / 100.0;
+    const double incremento[5] = {0, p / 2, p, (1 + p) / 2, 1};
+    if (r->amostras < 5) {
+        int i = r->amostras++;
+        for (; i > 0 && r->q[i - 1] > x; --i) {
+            r->q[i] = r->q[i - 1];
+        }
+        r->q[i] = x;
+        if (r->amostras == 5) {
+            for (int k = 0; k < 5; ++k) {
+                r->n[k] = k + 1;
+                r->d[k] = 1 + 4 * incremento[k];
+            }
+        }
+        return;
+    }
+    r->amostras++;
+    int k;
+    if (x < r->q[0]) {
+        r->q[0] = x;
+        k = 0;
+    } else if (x >= r->q[4]) {
+        r->q[4] = x;
+        k = 3;
+    } else {
+        for (k = 0; k < 3 && x >= r->q[k + 1]; ++k) {
+        }
+    }
+    for (int i = k + 1; i < 5; ++i) {
+        r->n[i]++;
+    }
+    for (int i = 0; i < 5; ++i) {
+        r->d[i] += incremento[i];
+    }
+    for (int i = 1; i <= 3; ++i) {
+        double d = r->d[i] - r->n[i];
+        if ((d >= 1 && r->n[i + 1] - r->n[i] > 1) || (d <= -1 && r->n[i - 1] - r->n[i] < -1)) {
+            int s = d > 0 ? 1 : -1;
+            double *q = r->q, *n = r->n;
+            double qp = q[i] + s / (n[i + 1] - n[i - 1]) *
+                        ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                         (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+            q[i] = q[i - 1] < qp && qp < q[i + 1] ? qp : q[i] + s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+            n[i] += s;
+        }
+    }
+}
+
+/**
+ * @brief Percentil LINK_PERCENTIL exato da amostra ordenada, interpolado
+ *        entre as duas amostras vizinhas.
+ */
+static double percentil(const int16_t *ordenadas, uint32_t n) {
+    double h = (n - 1) * (LINK_PERCENTIL / 100.0);
+    uint32_t k = (uint32_t)h;
+    return k + 1 < n ? ordenadas[k] + (h - k) * (ordenadas[k + 1] - ordenadas[k]) : ordenadas[k];
+}
+
+static bool perto(double a, double b, double tolerancia) {
+    return fabs(a - b) <= tolerancia;
+}
+
+/**
+ * @brief Um transmissor com RSSI normal (ou em degraus, se `degraus`) e SNR
+ *        uniforme, sem perdas; compara os agregados com as referências.
+ */
+static void metricas(uint8_t remetente, uint32_t n, bool degraus) {
+    int16_t *rssi = malloc(n * sizeof(int16_t));
+    int16_t *snr = malloc(n * sizeof(int16_t));
+    if (rssi == NULL || snr == NULL) {
+        exit(1);
+    }
+    double soma = 0, ewma = 0;
+    p2_ref_t p2 = {0}, p2_snr = {0};
+    int16_t min = INT16_MAX, max = INT16_MIN;
+    for (uint32_t i = 0; i < n; ++i) {
+        rssi[i] = degraus ? (int16_t)(-120 + (int)(i * 7 / n) * 12 + (int)(aleatorio() % 3))
+                          : normal(-95, 8);
+        snr[i] = (int16_t)((int)(aleatorio() % 121) - 80); // -20 a +10 dB
+        link_stats_registrar(remetente, (uint8_t)i, rssi[i], (int8_t)snr[i], _agora_us += 1000);
+        soma += rssi[i];
+        ewma = i == 0 ? rssi[i] : ewma + (rssi[i] - ewma) * ALFA;
+        p2_ref_adicionar(&p2, rssi[i]);
+        p2_ref_adicionar(&p2_snr, snr[i] / 4.0);
+        min = rssi[i] < min ? rssi[i] : min;
+        max = rssi[i] > max ? rssi[i] : max;
+    }
+    double media = soma / n, m2 = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        m2 += (rssi[i] - media) * (rssi[i] - media);
+    }
+    double desvio = n > 1 ? sqrt(m2 / (n - 1)) : 0;
+
+    link_stats_t s;
+    link_resumo_t r, rs;
+    link_stats_copiar_no(remetente, &s);
+    link_stats_resumir(&s.rssi, 1.0f, &r);
+    link_stats_resumir(&s.snr, 4.0f, &rs);
+
+    qsort(rssi, n, sizeof(int16_t), comparar);
+    qsort(snr, n, sizeof(int16_t), comparar);
+    double p = percentil(rssi, n), p_snr = percentil(snr, n) / 4.0;
+
+    char nome[96];
+    snprintf(nome, sizeof(nome), "%s, %lu amostras: contagem, min e max exatos",
+             degraus ? "RSSI em degraus" : "RSSI normal", (unsigned long)n);
+    resultado(nome, s.rssi.amostras == n && s.snr.amostras == n && r.min == min && r.max == max);
+    snprintf(nome, sizeof(nome), "  Welford: media %.3f (%.3f), desvio %.3f (%.3f)", r.media, media, r.desvio,
+             desvio);
+    resultado(nome, perto(r.media, media, 0.01) && perto(r.desvio, desvio, 0.01));
+    snprintf(nome, sizeof(nome), "  EWMA: %.3f (%.3f)", r.ewma, ewma);
+    resultado(nome, perto(r.ewma, ewma, 0.05));
+    // P² não é exato; a tolerância é a de uma fração do desvio
+    // Até 5 amostras o percentil é exato; depois o P² é uma estimativa
+    double tolerancia = n <= 5 ? 0.001 : 1.0;
+    snprintf(nome, sizeof(nome), "  P2 p%d: RSSI %.2f (%.2f), SNR %.2f (%.2f)", LINK_PERCENTIL, r.percentil, p,
+             rs.percentil, p_snr);
+    resultado(nome, perto(r.percentil, p, tolerancia) && perto(rs.percentil, p_snr, tolerancia / 2));
+    // As amostras são inteiras: um empate com um marcador que em double
+    // ficou um resíduo abaixo leva os dois por caminhos diferentes, mas
+    // sem se afastar de um pedaço de dB
+    if (n >= 5) {
+        double q = s.rssi.p2_altura_q16[2] / 65536.0, q_snr = s.snr.p2_altura_q16[2] / 262144.0;
+        snprintf(nome, sizeof(nome), "  P2 em ponto fixo x double: %.3f (%.3f), %.3f (%.3f)", q, p2.q[2], q_snr,
+                 p2_snr.q[2]);
+        resultado(nome, perto(q, p2.q[2], 0.5) && perto(q_snr, p2_snr.q[2], 0.25));
+    }
+    free(rssi);
+    free(snr);
+}
+
+/**
+ * @brief Sequência de header_id roteirizada: cada passo é o salto para o
+ *        próximo id (1 = sem perda, 0 = duplicado). Compara perdas,
+ *        duplicados e a EWMA da perda com a referência pacote a pacote.
+ */
+static void perdas(uint8_t remetente, const uint8_t *saltos, size_t n, uint32_t perdas_esperadas,
+                   uint32_t duplicados_esperados, const char *nome) {
+    uint8_t id = 200; // Passa pela volta em 255 logo no começo
+    double per = 0;
+    uint32_t amostras = 1;
+    link_stats_registrar(remetente, id, -90, 20, _agora_us += 1000);
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t salto = saltos[i];
+        id = (uint8_t)(id + salto);
+        link_stats_registrar(remetente, id, -90, 20, _agora_us += 1000);
+        if (salto == 0 || salto > LINK_SALTO_MAX) {
+            amostras += salto != 0;
+            continue;
+        }
+        for (uint8_t k = 1; k < salto; ++k) {
+            per += (1 - per) * ALFA;
+        }
+        per -= per * ALFA;
+        amostras++;
+    }
+
+    link_stats_t s;
+    link_stats_copiar_no(remetente, &s);
+    double per_q16 = s.per_ewma_q16 / 65536.0;
+    double esperada = 100.0 * perdas_esperadas / (n + 1 - duplicados_esperados + perdas_esperadas);
+    char texto[96];
+    snprintf(texto, sizeof(texto), "%s: %lu perdas, %lu duplicados", nome, (unsigned long)s.perdidos,
+             (unsigned long)s.duplicados);
+    resultado(texto, s.perdidos == perdas_esperadas && s.duplicados == duplicados_esperados &&
+              s.recebidos == n + 1 && s.rssi.amostras == amostras);
+    snprintf(texto, sizeof(texto), "  PER %.2f%% (%.2f%%), recente %.4f (%.4f)", link_stats_per(&s), esperada,
+             per_q16, per);
+    resultado(texto, perto(link_stats_per(&s), esperada, 0.01) && perto(per_q16, per, 0.002));
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = argc > 1 ? (uint32_t)atoi(argv[1]) : 200000;
+    link_stats_init();
+
+    printf("metricas\n");
+    uint8_t remetente = 1;
+    static const uint32_t poucas[] = {1, 2, 3, 4, 5, 6, 40};
+    for (size_t i = 0; i < sizeof(poucas) / sizeof(poucas[0]); ++i) {
+        link_stats_init();
+        metricas(remetente, poucas[i], false);
+    }
+    link_stats_init();
+    metricas(remetente++, n, false);
+    metricas(remetente++, n, true);
+
+    printf("perdas pelo header_id\n");
+    uint8_t saltos[2000];
+    for (size_t i = 0; i < sizeof(saltos); ++i) {
+        saltos[i] = 1;
+    }
+    perdas(remetente++, saltos, sizeof(saltos), 0, 0, "sem lacunas, com a volta em 255");
+
+    // Rajadas: 3 perdas a cada 50 pacotes, um duplicado a cada 97
+    uint32_t perdidos = 0, duplicados = 0;
+    for (size_t i = 0; i < sizeof(saltos); ++i) {
+        saltos[i] = i % 50 == 49 ? 4 : i % 97 == 96 ? 0 : 1;
+        perdidos += saltos[i] == 4 ? 3 : 0;
+        duplicados += saltos[i] == 0;
+    }
+    perdas(remetente++, saltos, sizeof(saltos), perdidos, duplicados, "rajadas e duplicados");
+
+    // Perdas isoladas aleatórias, ~20%, e saltos no limite LINK_SALTO_MAX
+    perdidos = duplicados = 0;
+    for (size_t i = 0; i < sizeof(saltos); ++i) {
+        saltos[i] = 1;
+        while (aleatorio() % 5 == 0 && saltos[i] < 8) {
+            saltos[i]++;
+        }
+        if (i == 700) {
+            saltos[i] = LINK_SALTO_MAX;
+        }
+        perdidos += saltos[i] - 1;
+    }
+    perdas(remetente++, saltos, sizeof(saltos), perdidos, 0, "~20% de perda e um salto de LINK_SALTO_MAX");
+
+    // Transmissor reiniciado: um salto acima do limite ressincroniza sem
+    // contar perdas
+    for (size_t i = 0; i < 100; ++i) {
+        saltos[i] = i == 50 ? LINK_SALTO_MAX + 1 : i == 80 ? 200 : 1;
+    }
+    perdas(remetente++, saltos, 100, 0, 0, "saltos acima de LINK_SALTO_MAX ressincronizam");
+
+    printf("tabela\n");
+    link_stats_init();
+    for (uint8_t i = 0; i < MAX_NOS; ++i) {
+        link_stats_registrar(10 + i, 0, -80, 0, _agora_us += 1000);
+    }
+    link_stats_registrar(10, 1, -80, 0, _agora_us += 1000); // O 10 deixa de ser o mais antigo
+    link_stats_registrar(99, 0, -80, 0, _agora_us += 1000);
+    link_stats_t s;
+    resultado("cheia: o transmissor ouvido ha mais tempo da lugar ao novo",
+              link_stats_count() == MAX_NOS && link_stats_copiar_no(99, &s) && s.recebidos == 1 &&
+              link_stats_copiar_no(10, &s) && s.recebidos == 2 && !link_stats_copiar_no(11, &s));
+
+    printf("%s\n", _falhas ? "FALHA" : "OK");
+    return _falhas ? 1 : 0;
+}
@@ -0,0 +1,405 @@
+// Rolagem por hardware do gráfico de RSSI (include/rolagem.c e o painel em
+// include/dashboard.c) contra um modelo do SSD1306 no host. O mock do I2C
+// decodifica as transações como o testar_ssd1306.c e mantém a GDDRAM; a
+// rolagem horizontal (0x27/0x2F/0x2E) desloca a GDDRAM no tempo simulado,
+// com o primeiro passo entre 2 e 3 quadros após ligar e os seguintes a cada
+// 3 quadros, numa fase sorteada a cada vez. Confere que nada é escrito com a
+// rolagem ligada e que a GDDRAM volta a ser igual ao espelho (ram_buffer)
+// sempre que a rolagem para, inclusive depois de passos incertos.
+//
+//     gcc -O2 -Itools/host -Iinclude -Iinclude/lib/ssd1306 tools/testar_rolagem.c include/dashboard.c include/display_scheduler.c include/historico.c include/node_table.c include/rolagem.c include/link_stats.c include/display.c include/lib/ssd1306/ssd1306.c include/lib/ssd1306/font.c -lm -o testar_rolagem && ./testar_rolagem [pacotes]
+//
+// A tarefa do painel é a de main.c (tarefa_painel), acordada pela agenda em
+// milissegundos inteiros; a cada pacote ela também é sinalizada.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dashboard.h"
+#include "display.h"
+#include "display_scheduler.h"
+#include "link_stats.h"
+#include "rolagem.h"
+#include "config.h"
+
+#define REMETENTE 7
+
+i2c_inst_t host_i2c[2] = {{0}, {1}};
+
+static int _falhas = 0;
+static uint64_t _agora_us = 1000000;
+static uint32_t _semente = 1;
+
+// Modelo do SSD1306
+static struct {
+    uint8_t gddram[8][128];
+    uint8_t modo;               // SET_MEM_ADDR: 0 horizontal, 1 vertical, 2 página
+    uint8_t col0, col1, pag0, pag1;
+    uint8_t col, pag;           // Ponteiro de escrita, mantido entre transações
+    uint8_t cmd[8];             // Comando em andamento e argumentos recebidos
+    uint8_t n_cmd, faltam;
+    uint32_t transacoes;
+
+    // Rolagem horizontal configurada e em andamento
+    bool rolar_esquerda;
+    uint8_t rolar_p0, rolar_p1, rolar_intervalo;
+    bool rolando;
+    uint64_t primeiro_passo_us; // Instante do primeiro passo desde o 0x2F
+    uint32_t passos;            // Colunas deslocadas desde o início
+} _oled;
+
+uint64_t time_us_64(void) {
+    return _agora_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    _agora_us += (uint64_t)ms * 1000;
+}
+
+static uint32_t aleatorio(void) {
+    _semente = _semente * 1103515245u + 12345u;
+    return _semente >> 8;
+}
+
+static void falha(const char *msg, unsigned a) {
+    if (_falhas++ < 10) {
+        printf("  FALHA: %s (%u)\n", msg, a);
+    }
+}
+
+static void resultado(const char *nome, bool ok) {
+    printf("  %-58s %s\n", nome, ok ? "ok" : "FALHA");
+    _falhas += !ok;
+}
+
+static uint8_t argumentos(uint8_t c) {
+    switch (c) {
+        case SET_MEM_ADDR: case SET_CONTRAST: case SET_CHARGE_PUMP: case SET_MUX_RATIO: case SET_DISP_OFFSET:
+        case SET_DISP_CLK_DIV: case SET_PRECHARGE: case SET_COM_PIN_CFG: case SET_VCOM_DESEL:
+            return 1;
+        case SET_COL_ADDR: case SET_PAGE_ADDR: case SET_VSCROLL_AREA:
+            return 2;
+        case SET_VHSCROLL_RIGHT: case SET_VHSCROLL_LEFT:
+            return 5;
+        case SET_HSCROLL_RIGHT: case SET_HSCROLL_LEFT:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Aplica os passos da rolagem em andamento até agora: cada um leva
+ *        as páginas roladas uma coluna para o lado, com a coluna que sai
+ *        voltando pelo outro.
+ */
+static void rolar_ate_agora(void) {
+    if (!_oled.rolando || _agora_us < _oled.primeiro_passo_us) {
+        return;
+    }
+    uint32_t total = (uint32_t)((_agora_us - _oled.primeiro_passo_us) / (3 * DISPLAY_QUADRO_US)) + 1;
+    for (; _oled.passos < total; ++_oled.passos) {
+        for (uint8_t p = _oled.rolar_p0; p <= _oled.rolar_p1; ++p) {
+            uint8_t *linha = _oled.gddram[p];
+            if (_oled.rolar_esquerda) {
+                uint8_t primeira = linha[0];
+                memmove(linha, linha + 1, 127);
+                linha[127] = primeira;
+            } else {
+                uint8_t ultima = linha[127];
+                memmove(linha + 1, linha, 127);
+                linha[0] = ultima;
+            }
+        }
+    }
+}
+
+static void executar(const uint8_t *c) {
+    switch (c[0]) {
+        case SET_MEM_ADDR:
+            _oled.modo = c[1];
+            break;
+        case SET_COL_ADDR:
+            _oled.col = _oled.col0 = c[1];
+            _oled.col1 = c[2];
+            break;
+        case SET_PAGE_ADDR:
+            _oled.pag = _oled.pag0 = c[1];
+            _oled.pag1 = c[2];
+            break;
+        case SET_HSCROLL_LEFT:
+        case SET_HSCROLL_RIGHT:
+            if (_oled.rolando) {
+                falha("rolagem configurada com a rolagem ligada", c[0]);
+            }
+            _oled.rolar_esquerda = c[0] == SET_HSCROLL_LEFT;
+            _oled.rolar_p0 = c[2];
+            _oled.rolar_intervalo = c[3];
+            _oled.rolar_p1 = c[4];
+            break;
+        case SET_SCROLL_ON:
+            if (_oled.rolar_intervalo != SSD1306_SCROLL_3_FRAMES) {
+                falha("modelo so tem o intervalo de 3 quadros", _oled.rolar_intervalo);
+            }
+            // O quadro em curso termina numa fase qualquer; o primeiro passo
+            // vem 2 quadros inteiros depois dele
+            _oled.rolando = true;
+            _oled.passos = 0;
+            _oled.primeiro_passo_us = _agora_us + aleatorio() % DISPLAY_QUADRO_US + 2 * DISPLAY_QUADRO_US;
+            break;
+        case SET_SCROLL_OFF:
+            rolar_ate_agora();
+            _oled.rolando = false;
+            break;
+    }
+}
+
+static void comando(uint8_t b) {
+    if (_oled.faltam == 0) {
+        _oled.n_cmd = 0;
+        _oled.faltam = argumentos(b) + 1;
+    }
+    _oled.cmd[_oled.n_cmd++] = b;
+    if (--_oled.faltam == 0) {
+        executar(_oled.cmd);
+    }
+}
+
+static void dado(uint8_t b) {
+    if (_oled.rolando) {
+        falha("escrita na GDDRAM com a rolagem ligada", _oled.col);
+    }
+    _oled.gddram[_oled.pag][_oled.col] = b;
+    if (++_oled.pag > _oled.pag1) {
+        _oled.pag = _oled.pag0;
+        if (++_oled.col > _oled.col1) {
+            _oled.col = _oled.col0;
+        }
+    }
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    _oled.transacoes++;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t controle = src[i++];
+        size_t fim = (controle & 0x80) && i < len ? i + 1 : len;
+        for (; i < fim; ++i) {
+            if (controle & 0x40) {
+                dado(src[i]);
+            } else {
+                comando(src[i]);
+            }
+        }
+    }
+    return (int)len;
+}
+
+static bool gddram_igual(const ssd1306_t *ssd) {
+    for (uint8_t x = 0; x < ssd->width; ++x) {
+        for (uint8_t p = 0; p < ssd->pages; ++p) {
+            if (_oled.gddram[p][x] != ssd->ram_buffer[1 + x * ssd->pages + p]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// --- Rolagem isolada: um gráfico de faixa com margem, sem o painel ---
+
+static uint8_t _coluna = 0;
+static bool _redesenhar = false;
+
+static void coluna_nova(void *ctx, bool incerto) {
+    ssd1306_t *ssd = ctx;
+    if (incerto) {
+        _redesenhar = true;
+        return;
+    }
+    for (uint8_t p = 2; p <= 4; ++p) {
+        ssd->ram_buffer[1 + (ssd->width - 1) * ssd->pages + p] = (uint8_t)(_coluna * 29 + p);
+    }
+    _coluna++;
+}
+
+/**
+ * @brief Um passo inteiro: liga, chama rolagem_poll() `antes` us antes do
+ *        prazo (nada deve acontecer) e de novo `atraso` us depois dele.
+ */
+static bool passo(ssd1306_t *ssd, rolagem_t *r, uint32_t atraso) {
+    rolagem_iniciar(r);
+    uint64_t prazo = rolagem_prazo_us(r);
+    _agora_us = prazo - 1000;
+    uint32_t transacoes = _oled.transacoes;
+    bool cedo = !rolagem_poll(r) && rolagem_ativa(r) && _oled.transacoes == transacoes;
+    _agora_us = prazo + atraso;
+    bool terminou = rolagem_poll(r) && !rolagem_ativa(r);
+    if (_redesenhar) {
+        _redesenhar = false;
+        ssd1306_send_region(ssd, r->x0, ssd->width - 1, r->p0, r->p1);
+    }
+    _agora_us += 10000;
+    return cedo && terminou;
+}
+
+static void testar_rolagem(void) {
+    ssd1306_t ssd;
+    rolagem_t r;
+    ssd1306_init(&ssd, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, DISPLAY_I2C_ADDR, I2C_PORT);
+    ssd1306_config(&ssd);
+    for (uint8_t x = 16; x < ssd.width; ++x) {
+        for (uint8_t p = 0; p < ssd.pages; ++p) {
+            ssd.ram_buffer[1 + x * ssd.pages + p] = (uint8_t)(x * 37 + p);
+        }
+    }
+    ssd1306_send_data(&ssd);
+    rolagem_init(&r, &ssd, 16, 2, 4, coluna_nova, &ssd);
+
+    printf("rolagem_poll\n");
+    bool ok = true, igual = true;
+    for (int i = 0; i < 2000; ++i) {
+        ok &= passo(&ssd, &r, aleatorio() % (DISPLAY_QUADRO_US / 2));
+        igual &= gddram_igual(&ssd);
+    }
+    resultado("antes do prazo nada no barramento; no prazo o passo termina", ok);
+    resultado("2000 passos na janela: GDDRAM igual ao espelho", igual && r.passos == 2000 && r.incertos == 0);
+
+    // Loop preso: a faixa rola 1 a 4 colunas e a margem recebe colunas do
+    // gráfico
+    ok = igual = true;
+    for (int i = 0; i < 500; ++i) {
+        ok &= passo(&ssd, &r, DISPLAY_QUADRO_US / 2 + 1 + aleatorio() % (10 * DISPLAY_QUADRO_US));
+        igual &= gddram_igual(&ssd);
+    }
+    resultado("500 passos atrasados: todos incertos", ok && r.incertos == 500 && r.passos == 2000);
+    resultado("margem e grafico redesenhados: GDDRAM igual ao espelho", igual);
+}
+
+// --- Painel inteiro, com a tarefa do painel de main.c ---
+
+static display_scheduler_t _sched;
+static uint64_t _acordar_us = 0;
+static uint32_t _divergencias = 0;
+static uint32_t _verificacoes = 0;
+
+static void renderizar(void *ctx) {
+    dashboard_render(ctx);
+}
+
+/**
+ * @brief Uma passada de tarefa_painel (main.c) e o reagendamento pela
+ *        agenda, em milissegundos inteiros.
+ */
+static void tarefa_painel(const ssd1306_t *ssd) {
+    if (dashboard_poll()) {
+        display_scheduler_request(&_sched);
+    }
+    if (dashboard_rotacao_pendente()) {
+        display_scheduler_request(&_sched);
+    }
+    const rolagem_t *rolagem = dashboard_rolagem();
+    if (!rolagem_ativa(rolagem)) {
+        display_scheduler_poll(&_sched);
+    }
+
+    uint64_t prazo = rolagem_ativa(rolagem) ? rolagem_prazo_us(rolagem) : display_scheduler_prazo_us(&_sched);
+    uint64_t ms = (uint64_t)AGENDA_PAINEL_MS;
+    if (prazo != 0) {
+        uint64_t ate = prazo > _agora_us ? (prazo - _agora_us + 999) / 1000 : 0;
+        ms = ate < ms ? ate : ms;
+    }
+    _acordar_us = _agora_us + ms * 1000;
+
+    if (!rolagem_ativa(rolagem)) {
+        _verificacoes++;
+        _divergencias += !gddram_igual(ssd);
+    }
+}
+
+static void pacote(void) {
+    uint32_t r = aleatorio();
+    static int rssi = -70;
+    rssi += (int)(r % 5) - 2;
+    rssi = rssi < -110 ? -110 : rssi > -40 ? -40 : rssi;
+    float snr = 6.0f + ((int)((r >> 8) % 17) - 8) * 0.25f;
+    link_stats_registrar(REMETENTE, (uint8_t)r, (int16_t)rssi, (int8_t)(snr * 4), _agora_us);
+    dashboard_registrar_pacote(REMETENTE, 23.4f, 61.0f, 1012.3f, rssi, snr);
+    display_scheduler_request(&_sched);
+}
+
+/**
+ * @brief Pacotes a cada 50 a 300 ms; a tarefa do painel roda quando a
+ *        agenda a acorda e a cada pacote. Com `travas`, de vez em quando o
+ *        loop fica preso até 60 ms numa operação da flash. Com `pacotes` 0,
+ *        para assim que um passo de rolagem começar.
+ */
+static void rodar(const ssd1306_t *ssd, uint32_t pacotes, bool travas) {
+    static uint64_t proximo_pacote = 0;
+    bool ate_rolar = pacotes == 0;
+    while (ate_rolar ? !rolagem_ativa(dashboard_rolagem()) : pacotes > 0) {
+        uint64_t evento = proximo_pacote < _acordar_us ? proximo_pacote : _acordar_us;
+        _agora_us = evento > _agora_us ? evento : _agora_us;
+        if (travas && aleatorio() % 16 == 0) {
+            _agora_us += aleatorio() % 60000;
+        }
+        // A agenda acorda a tarefa um pouco depois do prazo
+        _agora_us += aleatorio() % 200;
+        if (_agora_us >= proximo_pacote) {
+            pacote();
+            pacotes -= pacotes > 0;
+            proximo_pacote = _agora_us + 50000 + aleatorio() % 250000;
+        }
+        tarefa_painel(ssd);
+    }
+}
+
+static void testar_painel(uint32_t pacotes) {
+    ssd1306_t ssd;
+    memset(&_oled, 0, sizeof(_oled));
+    ssd1306_init(&ssd, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, DISPLAY_I2C_ADDR, I2C_PORT);
+    display_init(&ssd);
+    link_stats_init();
+    dashboard_init(&ssd);
+    display_scheduler_init(&_sched, DISPLAY_MAX_FPS, renderizar, NULL);
+    _acordar_us = _agora_us;
+
+    printf("painel (%lu pacotes)\n", (unsigned long)pacotes);
+    int falhas = _falhas;
+    rodar(&ssd, pacotes, false);
+    const rolagem_t *r = dashboard_rolagem();
+    char nome[80];
+    snprintf(nome, sizeof(nome), "%lu passos, nenhum incerto", (unsigned long)r->passos);
+    resultado(nome, r->passos > pacotes / 8 && r->incertos == 0);
+    snprintf(nome, sizeof(nome), "GDDRAM igual ao espelho nas %lu paradas", (unsigned long)_verificacoes);
+    resultado(nome, _divergencias == 0 && _falhas == falhas);
+
+    // Um quadro pedido no meio do passo não escreve nada e sai no fim dele
+    rodar(&ssd, 0, false);
+    uint32_t transacoes = _oled.transacoes;
+    dashboard_render(NULL);
+    bool adiado = _oled.transacoes == transacoes && !dashboard_poll();
+    _agora_us = rolagem_prazo_us(r);
+    adiado &= dashboard_poll();
+    display_scheduler_request(&_sched);
+    resultado("quadro durante o passo adiado e pedido no fim do passo", adiado);
+
+    printf("painel com o loop preso na flash\n");
+    falhas = _falhas;
+    _verificacoes = 0;
+    uint32_t passos = r->passos;
+    rodar(&ssd, pacotes, true);
+    snprintf(nome, sizeof(nome), "%lu passos, %lu incertos", (unsigned long)(r->passos - passos),
+             (unsigned long)r->incertos);
+    resultado(nome, r->incertos > 0);
+    snprintf(nome, sizeof(nome), "GDDRAM igual ao espelho nas %lu paradas", (unsigned long)_verificacoes);
+    resultado(nome, _divergencias == 0 && _falhas == falhas);
+}
+
+int main(int argc, char **argv) {
+    uint32_t pacotes = argc > 1 ? (uint32_t)atoi(argv[1]) : 20000;
+    testar_rolagem();
+    testar_painel(pacotes);
+    printf("%s\n", _falhas ? "FALHA" : "OK");
+    return _falhas ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+// Mock do barramento I2C para o driver do display (include/lib/ssd1306 e
+// include/display.c) no host. Cada i2c_write_blocking é uma transação; o
+// mock a decodifica como o SSD1306 (bytes de controle Co/D#C, comandos com
+// seus argumentos, dados no endereçamento vertical dentro da janela) e
+// mantém uma cópia da GDDRAM. Confere quantas transações e bytes cada
+// operação gasta e se a GDDRAM termina igual ao framebuffer.
+//
+//     gcc -O2 -Itools/host -Iinclude -Iinclude/lib/ssd1306 tools/testar_ssd1306.c include/display.c include/lib/ssd1306/ssd1306.c include/lib/ssd1306/font.c -lm -o testar_ssd1306 && ./testar_ssd1306
+//
+// A comparação com o driver antigo (um comando por transação, com o 0x80
+// de controle) é calculada, não executada: 25 transações na configuração e
+// 6 antes de cada envio do framebuffer.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "display.h"
+#include "config.h"
+
+i2c_inst_t host_i2c[2] = {{0}, {1}};
+
+static int _falhas = 0;
+
+// Modelo do SSD1306
+static struct {
+    uint8_t gddram[8][128];
+    uint8_t modo;               // SET_MEM_ADDR: 0 horizontal, 1 vertical, 2 página
+    uint8_t col0, col1, pag0, pag1;
+    uint8_t col, pag;           // Ponteiro de escrita, mantido entre transações
+    bool ligado;
+    uint8_t cmd[8];             // Comando em andamento e argumentos recebidos
+    uint8_t n_cmd, faltam;
+    uint32_t transacoes, bytes, comandos, dados;
+} _oled;
+
+uint64_t time_us_64(void) {
+    return 0;
+}
+
+void sleep_ms(uint32_t ms) {
+}
+
+static void falha(const char *msg, unsigned a) {
+    if (_falhas++ < 10) {
+        printf("  FALHA: %s (%u)\n", msg, a);
+    }
+}
+
+static void resultado(const char *nome, bool ok) {
+    printf("  %-58s %s\n", nome, ok ? "ok" : "FALHA");
+    _falhas += !ok;
+}
+
+static uint8_t argumentos(uint8_t c) {
+    switch (c) {
+        case SET_MEM_ADDR: case SET_CONTRAST: case SET_CHARGE_PUMP: case SET_MUX_RATIO: case SET_DISP_OFFSET:
+        case SET_DISP_CLK_DIV: case SET_PRECHARGE: case SET_COM_PIN_CFG: case SET_VCOM_DESEL:
+            return 1;
+        case SET_COL_ADDR: case SET_PAGE_ADDR: case SET_VSCROLL_AREA:
+            return 2;
+        case SET_VHSCROLL_RIGHT: case SET_VHSCROLL_LEFT:
+            return 5;
+        case SET_HSCROLL_RIGHT: case SET_HSCROLL_LEFT:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void executar(const uint8_t *c) {
+    switch (c[0]) {
+        case SET_MEM_ADDR:
+            _oled.modo = c[1];
+            break;
+        case SET_COL_ADDR:
+            _oled.col = _oled.col0 = c[1];
+            _oled.col1 = c[2];
+            break;
+        case SET_PAGE_ADDR:
+            _oled.pag = _oled.pag0 = c[1];
+            _oled.pag1 = c[2];
+            break;
+        case SET_DISP | 0x00:
+        case SET_DISP | 0x01:
+            _oled.ligado = c[0] & 0x01;
+            break;
+    }
+    _oled.comandos++;
+}
+
+static void comando(uint8_t b) {
+    if (_oled.faltam == 0) {
+        _oled.n_cmd = 0;
+        _oled.faltam = argumentos(b) + 1;
+    }
+    _oled.cmd[_oled.n_cmd++] = b;
+    if (--_oled.faltam == 0) {
+        executar(_oled.cmd);
+    }
+}
+
+static void dado(uint8_t b) {
+    if (_oled.modo != 1) {
+        falha("dados fora do enderecamento vertical", _oled.modo);
+        return;
+    }
+    _oled.gddram[_oled.pag][_oled.col] = b;
+    if (++_oled.pag > _oled.pag1) {
+        _oled.pag = _oled.pag0;
+        if (++_oled.col > _oled.col1) {
+            _oled.col = _oled.col0;
+        }
+    }
+    _oled.dados++;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    if (i2c != I2C_PORT || addr != DISPLAY_I2C_ADDR || nostop) {
+        falha("barramento, endereco ou nostop errado", addr);
+    }
+    _oled.transacoes++;
+    _oled.bytes += len;
+
+    // Co = 1: um byte e outro controle; Co = 0: o resto da transação.
+    // D/C# escolhe entre comando e dado
+    size_t i = 0;
+    while (i < len) {
+        uint8_t controle = src[i++];
+        if (controle & 0x3F) {
+            falha("byte de controle invalido", controle);
+        }
+        size_t fim = (controle & 0x80) && i < len ? i + 1 : len;
+        for (; i < fim; ++i) {
+            if (controle & 0x40) {
+                dado(src[i]);
+            } else {
+                comando(src[i]);
+            }
+        }
+    }
+    if (_oled.faltam) {
+        falha("comando incompleto no fim da transacao", _oled.cmd[0]);
+        _oled.faltam = 0;
+    }
+    return (int)len;
+}
+
+static bool gddram_igual(const ssd1306_t *ssd) {
+    for (uint8_t x = 0; x < ssd->width; ++x) {
+        for (uint8_t p = 0; p < ssd->pages; ++p) {
+            if (_oled.gddram[p][x] != ssd->ram_buffer[1 + x * ssd->pages + p]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void zerar_contagem(void) {
+    _oled.transacoes = _oled.bytes = _oled.comandos = _oled.dados = 0;
+}
+
+static void preencher(ssd1306_t *ssd, uint8_t semente) {
+    for (size_t i = 1; i < ssd->bufsize; ++i) {
+        ssd->ram_buffer[i] = (uint8_t)(i * 37 + semente);
+    }
+}
+
+int main(void) {
+    ssd1306_t ssd;
+    const size_t quadro = DISPLAY_WIDTH * DISPLAY_HEIGHT / 8;
+
+    printf("ssd1306_config\n");
+    ssd1306_init(&ssd, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, DISPLAY_I2C_ADDR, I2C_PORT);
+    ssd1306_config(&ssd);
+    resultado("uma transacao com os 25 bytes de comando", _oled.transacoes == 1 && _oled.bytes == 1 + 25);
+    resultado("16 comandos, display ligado, enderecamento vertical",
+              _oled.comandos == 16 && _oled.ligado && _oled.modo == 1);
+    resultado("contadores do driver iguais aos do barramento",
+              ssd.i2c_transactions == _oled.transacoes && ssd.i2c_bytes == _oled.bytes);
+
+    printf("ssd1306_send_data\n");
+    zerar_contagem();
+    preencher(&ssd, 1);
+    ssd1306_send_data(&ssd);
+    resultado("janela e quadro numa transacao", _oled.transacoes == 1 &&
+              _oled.bytes == SSD1306_WINDOW_PREFIX + 1 + quadro && _oled.dados == quadro);
+    resultado("GDDRAM igual ao framebuffer", gddram_igual(&ssd));
+
+    printf("ssd1306_send_columns\n");
+    static const uint8_t faixas[][2] = {{40, 47}, {0, 3}, {1, 1}, {120, 127}};
+    for (size_t f = 0; f < sizeof(faixas) / sizeof(faixas[0]); ++f) {
+        uint8_t x0 = faixas[f][0], x1 = faixas[f][1];
+        preencher(&ssd, (uint8_t)(2 + f));
+        uint8_t copia[1 + 128 * 8 + SSD1306_WINDOW_PREFIX];
+        memcpy(copia, ssd.ram_buffer - SSD1306_WINDOW_PREFIX, sizeof(copia));
+        zerar_contagem();
+        ssd1306_send_columns(&ssd, x0, x1);
+        char nome[80];
+        snprintf(nome, sizeof(nome), "colunas %u..%u: uma transacao de %u bytes", x0, x1,
+                 (unsigned)(SSD1306_WINDOW_PREFIX + 1 + (x1 - x0 + 1) * 8));
+        resultado(nome, _oled.transacoes == 1 && _oled.bytes == SSD1306_WINDOW_PREFIX + 1 + (x1 - x0 + 1) * 8u);
+
+        // Só as colunas enviadas conferem; as outras têm o conteúdo anterior
+        bool ok = true;
+        for (uint8_t x = x0; x <= x1; ++x) {
+            for (uint8_t p = 0; p < 8; ++p) {
+                ok &= _oled.gddram[p][x] == ssd.ram_buffer[1 + x * 8 + p];
+            }
+        }
+        snprintf(nome, sizeof(nome), "colunas %u..%u: GDDRAM certa e framebuffer restaurado", x0, x1);
+        resultado(nome, ok && memcmp(copia, ssd.ram_buffer - SSD1306_WINDOW_PREFIX, sizeof(copia)) == 0);
+    }
+
+    printf("ssd1306_send_region\n");
+    preencher(&ssd, 9);
+    ssd1306_send_data(&ssd);
+    preencher(&ssd, 10);
+    zerar_contagem();
+    ssd1306_send_region(&ssd, 10, 30, 2, 3);
+    resultado("21 colunas x 2 paginas numa transacao",
+              _oled.transacoes == 1 && _oled.bytes == SSD1306_WINDOW_PREFIX + 1 + 21 * 2);
+    zerar_contagem();
+    ssd1306_send_region(&ssd, 0, 127, 1, 6);
+    resultado("128 colunas x 6 paginas: janela so na primeira transacao",
+              _oled.comandos == 2 && _oled.bytes == SSD1306_WINDOW_PREFIX + _oled.transacoes + 128 * 6);
+    ssd1306_send_region(&ssd, 0, 127, 0, 0);
+    ssd1306_send_region(&ssd, 0, 127, 7, 7);
+    ssd1306_send_region(&ssd, 0, 9, 2, 3);
+    ssd1306_send_region(&ssd, 31, 127, 2, 3);
+    resultado("GDDRAM igual ao framebuffer depois das regioes", gddram_igual(&ssd));
+
+    printf("rolagem\n");
+    zerar_contagem();
+    ssd1306_scroll_horizontal(&ssd, true, 4, 6, SSD1306_SCROLL_5_FRAMES);
+    resultado("configurar e ligar numa transacao", _oled.transacoes == 1 && _oled.comandos == 3);
+    zerar_contagem();
+    ssd1306_scroll_stop(&ssd);
+    resultado("parar: um comando", _oled.transacoes == 1 && _oled.bytes == 2);
+
+    printf("display.c\n");
+    memset(&_oled, 0, sizeof(_oled));
+    display_init(&ssd);
+    resultado("display_init: configuracao e tela limpa, 2 transacoes", _oled.transacoes == 2 && gddram_igual(&ssd));
+    zerar_contagem();
+    display_update_data(&ssd, 7, 23.4f, 61.0f, 1012.3f, -58, 41);
+    resultado("primeira telemetria: tela inteira", _oled.transacoes == 1 && _oled.dados == quadro);
+    zerar_contagem();
+    display_update_data(&ssd, 7, 23.4f, 61.0f, 1012.3f, -58, 41);
+    resultado("mesmos valores: nada no barramento", _oled.transacoes == 0);
+    zerar_contagem();
+    display_update_data(&ssd, 7, 23.4f, 61.0f, 1012.3f, -58, 42);
+    resultado("um digito: uma transacao de 8 colunas",
+              _oled.transacoes == 1 && _oled.bytes == SSD1306_WINDOW_PREFIX + 1 + 8 * 8);
+    display_update_data(&ssd, 12, 19.9f, 58.0f, 998.7f, -101, 100);
+    resultado("GDDRAM igual ao framebuffer", gddram_igual(&ssd));
+
+    // Antes: cada comando era uma transação de 2 bytes (0x80 + comando)
+    // (o mesmo número de bytes de controle que a janela com Co = 1 de agora)
+    printf("config: 1 transacao de 26 bytes (antes 25 de 2); quadro: 1 transacao (antes 7), %u bytes\n",
+           (unsigned)(SSD1306_WINDOW_PREFIX + 1 + quadro));
+    printf("%s\n", _falhas ? "FALHA" : "OK");
+    return _falhas ? 1 : 0;
+}